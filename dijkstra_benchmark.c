@@ -342,14 +342,28 @@ DijkstraResult dijkstra_traditional(Graph *g, int source, bool verbose) {
 #define CTX_VERTICES_PROCESSED "vertices_processed"
 #define CTX_VERBOSE "verbose"
 
+/* Interned handles for the keys above, resolved once at chain build time */
+static EventContextKey key_graph, key_source, key_distances, key_predecessors,
+                       key_heap, key_vertices_processed, key_verbose;
+
+static void dijkstra_intern_keys(void) {
+    key_graph = event_key_intern(CTX_GRAPH);
+    key_source = event_key_intern(CTX_SOURCE);
+    key_distances = event_key_intern(CTX_DISTANCES);
+    key_predecessors = event_key_intern(CTX_PREDECESSORS);
+    key_heap = event_key_intern(CTX_HEAP);
+    key_vertices_processed = event_key_intern(CTX_VERTICES_PROCESSED);
+    key_verbose = event_key_intern(CTX_VERBOSE);
+}
+
 /* Event 1: Initialize distances */
 EventResult event_initialize(EventContext *context, void *user_data) {
     global_profile.context_lookups += 3;
     
     void *graph_ptr, *source_ptr, *verbose_ptr;
-    event_context_get(context, CTX_GRAPH, &graph_ptr);
-    event_context_get(context, CTX_SOURCE, &source_ptr);
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    event_context_get_k(context, key_graph, &graph_ptr);
+    event_context_get_k(context, key_source, &source_ptr);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
 
     Graph *g = (Graph *)graph_ptr;
     int *source = (int *)source_ptr;
@@ -373,8 +387,8 @@ EventResult event_initialize(EventContext *context, void *user_data) {
     }
     distances[*source] = 0;
 
-    event_context_set(context, CTX_DISTANCES, distances);
-    event_context_set(context, CTX_PREDECESSORS, predecessors);
+    event_context_set_k(context, key_distances, distances);
+    event_context_set_k(context, key_predecessors, predecessors);
 
     return event_result_success();
 }
@@ -384,9 +398,9 @@ EventResult event_create_heap(EventContext *context, void *user_data) {
     global_profile.context_lookups += 3;
 
     void *graph_ptr, *source_ptr, *verbose_ptr;
-    event_context_get(context, CTX_GRAPH, &graph_ptr);
-    event_context_get(context, CTX_SOURCE, &source_ptr);
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    event_context_get_k(context, key_graph, &graph_ptr);
+    event_context_get_k(context, key_source, &source_ptr);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
 
     Graph *g = (Graph *)graph_ptr;
     int *source = (int *)source_ptr;
@@ -403,12 +417,9 @@ EventResult event_create_heap(EventContext *context, void *user_data) {
     MinHeap *heap = heap_create(g->num_vertices);
     heap_insert(heap, *source, 0);
 
-    event_context_set(context, CTX_HEAP, heap);
+    event_context_set_k(context, key_heap, heap);
 
-    int *vertices_processed = malloc(sizeof(int));
-    profile_alloc(sizeof(int));
-    *vertices_processed = 0;
-    event_context_set(context, CTX_VERTICES_PROCESSED, vertices_processed);
+    event_context_set_i64_k(context, key_vertices_processed, 0);
 
     return event_result_success();
 }
@@ -417,19 +428,19 @@ EventResult event_create_heap(EventContext *context, void *user_data) {
 EventResult event_process_vertices(EventContext *context, void *user_data) {
     global_profile.context_lookups += 5;
 
-    void *graph_ptr, *heap_ptr, *distances_ptr, *predecessors_ptr, *vertices_processed_ptr, *verbose_ptr;
-    event_context_get(context, CTX_GRAPH, &graph_ptr);
-    event_context_get(context, CTX_HEAP, &heap_ptr);
-    event_context_get(context, CTX_DISTANCES, &distances_ptr);
-    event_context_get(context, CTX_PREDECESSORS, &predecessors_ptr);
-    event_context_get(context, CTX_VERTICES_PROCESSED, &vertices_processed_ptr);
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    void *graph_ptr, *heap_ptr, *distances_ptr, *predecessors_ptr, *verbose_ptr;
+    int64_t vertices_processed = 0;
+    event_context_get_k(context, key_graph, &graph_ptr);
+    event_context_get_k(context, key_heap, &heap_ptr);
+    event_context_get_k(context, key_distances, &distances_ptr);
+    event_context_get_k(context, key_predecessors, &predecessors_ptr);
+    event_context_get_i64_k(context, key_vertices_processed, &vertices_processed);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
 
     Graph *g = (Graph *)graph_ptr;
     MinHeap *heap = (MinHeap *)heap_ptr;
     int *distances = (int *)distances_ptr;
     int *predecessors = (int *)predecessors_ptr;
-    int *vertices_processed = (int *)vertices_processed_ptr;
     bool *verbose = (bool *)verbose_ptr;
 
     if (!g || !heap || !distances || !predecessors) {
@@ -443,7 +454,7 @@ EventResult event_process_vertices(EventContext *context, void *user_data) {
     while (!heap_is_empty(heap)) {
         HeapNode current = heap_extract_min(heap);
         int u = current.vertex;
-        (*vertices_processed)++;
+        vertices_processed++;
 
         if (current.distance > distances[u]) {
             continue;
@@ -471,9 +482,11 @@ EventResult event_process_vertices(EventContext *context, void *user_data) {
     }
 
     if (verbose && *verbose) {
-        printf("[EventChain] Processed %d vertices\n", *vertices_processed);
+        printf("[EventChain] Processed %lld vertices\n", (long long)vertices_processed);
     }
 
+    event_context_set_i64_k(context, key_vertices_processed, vertices_processed);
+
     return event_result_success();
 }
 
@@ -482,8 +495,8 @@ EventResult event_cleanup(EventContext *context, void *user_data) {
     global_profile.context_lookups += 2;
 
     void *heap_ptr, *verbose_ptr;
-    event_context_get(context, CTX_HEAP, &heap_ptr);
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    event_context_get_k(context, key_heap, &heap_ptr);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
 
     MinHeap *heap = (MinHeap *)heap_ptr;
     bool *verbose = (bool *)verbose_ptr;
@@ -510,7 +523,7 @@ EventResult logging_middleware(
     global_profile.middleware_calls++;
 
     void *verbose_ptr;
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
     bool *verbose = (bool *)verbose_ptr;
 
     if (verbose && *verbose) {
@@ -578,7 +591,7 @@ EventResult profiling_middleware(
     size_t mem_after = global_profile.memory_allocated;
 
     void *verbose_ptr;
-    event_context_get(context, CTX_VERBOSE, &verbose_ptr);
+    event_context_get_k(context, key_verbose, &verbose_ptr);
     bool *verbose = (bool *)verbose_ptr;
 
     if (verbose && *verbose) {
@@ -597,6 +610,7 @@ DijkstraResult dijkstra_eventchains(Graph *g, int source, bool verbose, bool use
 
     /* Create event chain */
     EventChain *chain = event_chain_create_strict();
+    dijkstra_intern_keys();
 
     /* Add middleware if requested */
     TimingData timing_data = {0, verbose};
@@ -639,9 +653,10 @@ DijkstraResult dijkstra_eventchains(Graph *g, int source, bool verbose, bool use
     ChainResult chain_result = event_chain_execute(chain);
 
     if (chain_result.success) {
+        /* Take ownership of the results straight out of the context */
         void *distances_ptr, *predecessors_ptr;
-        event_context_get(ctx, CTX_DISTANCES, &distances_ptr);
-        event_context_get(ctx, CTX_PREDECESSORS, &predecessors_ptr);
+        event_context_take(ctx, CTX_DISTANCES, &distances_ptr, NULL);
+        event_context_take(ctx, CTX_PREDECESSORS, &predecessors_ptr, NULL);
 
         result.distances = (int *)distances_ptr;
         result.predecessors = (int *)predecessors_ptr;
@@ -7,9 +7,85 @@
 #include <time.h>
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 #define INITIAL_CAPACITY 8
 
+/* ==================== Allocator ==================== */
+
+static void *default_malloc(size_t size, void *user_data) {
+    (void)user_data;
+    return malloc(size);
+}
+
+static void *default_realloc(void *ptr, size_t size, void *user_data) {
+    (void)user_data;
+    return realloc(ptr, size);
+}
+
+static void default_free(void *ptr, void *user_data) {
+    (void)user_data;
+    free(ptr);
+}
+
+/* Every library allocation goes through here (see event_chain_set_allocator) */
+static EventChainAllocator allocator = {
+    default_malloc,
+    default_realloc,
+    default_free,
+    NULL
+};
+
+static void *ec_malloc(size_t size) {
+    return allocator.malloc_fn(size, allocator.user_data);
+}
+
+static void *ec_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+
+    size_t total = count * size;
+    void *ptr = allocator.malloc_fn(total, allocator.user_data);
+    if (ptr) memset(ptr, 0, total);
+    return ptr;
+}
+
+static void *ec_realloc(void *ptr, size_t size) {
+    return allocator.realloc_fn(ptr, size, allocator.user_data);
+}
+
+static void ec_free(void *ptr) {
+    if (ptr) allocator.free_fn(ptr, allocator.user_data);
+}
+
+static char *ec_strndup(const char *s, size_t n) {
+    size_t len = strnlen(s, n);
+    char *dup = ec_malloc(len + 1);
+    if (!dup) return NULL;
+    memcpy(dup, s, len);
+    dup[len] = '\0';
+    return dup;
+}
+
+EventChainErrorCode event_chain_set_allocator(const EventChainAllocator *custom) {
+    if (!custom) {
+        allocator.malloc_fn = default_malloc;
+        allocator.realloc_fn = default_realloc;
+        allocator.free_fn = default_free;
+        allocator.user_data = NULL;
+        return EC_SUCCESS;
+    }
+
+    if (!custom->malloc_fn || !custom->realloc_fn || !custom->free_fn) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    allocator = *custom;
+    return EC_SUCCESS;
+}
+
 /* ==================== Utility Functions ==================== */
 /**
  * @brief Creates a newly allocated copy of a string up to a specified length.
@@ -87,13 +163,15 @@ static bool safe_add(size_t a, size_t b, size_t *result) {
 
 /**
  * Secure memory zeroing (won't be optimized away)
+ *
+ * A plain memset followed by a compiler barrier that claims to read the
+ * buffer, so the store can't be elided but still runs at memset speed
+ * (arena contexts wipe whole chunks).
  */
 static void secure_zero(void *ptr, size_t len) {
     if (!ptr || len == 0) return;
-    volatile unsigned char *p = ptr;
-    while (len--) {
-        *p++ = 0;
-    }
+    memset(ptr, 0, len);
+    __asm__ __volatile__("" : : "r"(ptr) : "memory");
 }
 
 /**
@@ -185,8 +263,217 @@ static void sanitize_error_message(
 
 /* ==================== RefCountedValue Implementation ==================== */
 
+/* ---- Biased reference counting ---- */
+
+/*
+ * A thread-safe value is biased toward the thread that created it: that
+ * thread keeps its references in ref_count using plain loads and stores,
+ * while every other thread adds to shared_count atomically. shared_count
+ * stores its count times RC_ONE, leaving two flag bits:
+ *
+ *   RC_MERGED - the owner's count was folded in; shared_count is the total
+ *               and every thread, the owner included, now updates it
+ *   RC_QUEUED - another thread drove the unmerged count below zero (it
+ *               released a reference the owner handed over), so the value
+ *               sits in the owner's queue until the owner merges it
+ *
+ * The value is freed when a release leaves shared_count at exactly
+ * RC_MERGED, or by the owner's merge when that leaves it there.
+ */
+#define RC_MERGED ((int64_t)1)
+#define RC_QUEUED ((int64_t)2)
+#define RC_FLAGS  (RC_MERGED | RC_QUEUED)
+#define RC_ONE    ((int64_t)4)
+
+/* Lives for the whole process; recycled when its thread exits */
+struct RefCountOwner {
+    pthread_mutex_t lock;
+    RefCountedValue *queue;     /* Values awaiting a merge (under lock) */
+    int pending;                /* Queue is non-empty (atomic hint) */
+    bool active;                /* Bound to a live thread (under lock) */
+    RefCountOwner *next_free;
+};
+
+static pthread_mutex_t rc_owner_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t rc_owner_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rc_owner_key;
+static RefCountOwner *rc_owner_free = NULL;
+static __thread RefCountOwner *rc_owner_self = NULL;
+
+static void rc_destroy(RefCountedValue *value) {
+    if (value->cleanup && value->data) {
+        value->cleanup(value->data);
+    }
+    secure_zero(value, sizeof(RefCountedValue));
+    ec_free(value);
+}
+
+/**
+ * Fold the owner's count into shared_count. Only the owner thread may call
+ * this, or any thread holding owner->lock while the owner is inactive.
+ * Returns true if the value is now dead and must be destroyed.
+ */
+static bool rc_merge(RefCountedValue *value, bool dequeue) {
+    int64_t local = (int64_t)__atomic_load_n(&value->ref_count, __ATOMIC_RELAXED);
+    __atomic_store_n(&value->ref_count, 0, __ATOMIC_RELAXED);
+
+    int64_t old = __atomic_load_n(&value->shared_count, __ATOMIC_RELAXED);
+    int64_t merged;
+    do {
+        merged = (old + local * RC_ONE) | RC_MERGED;
+        if (dequeue) merged &= ~RC_QUEUED;
+    } while (!__atomic_compare_exchange_n(&value->shared_count, &old, merged, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    return merged == RC_MERGED;
+}
+
+static void rc_owner_drain(RefCountOwner *owner) {
+    pthread_mutex_lock(&owner->lock);
+    RefCountedValue *value = owner->queue;
+    owner->queue = NULL;
+    __atomic_store_n(&owner->pending, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&owner->lock);
+
+    while (value) {
+        RefCountedValue *next = value->queue_next;
+        if (rc_merge(value, true)) {
+            rc_destroy(value);
+        }
+        value = next;
+    }
+}
+
+/* Thread exit: merge everything queued, then make the record reusable */
+static void rc_owner_retire(void *arg) {
+    RefCountOwner *owner = arg;
+
+    pthread_mutex_lock(&owner->lock);
+    while (owner->queue) {
+        pthread_mutex_unlock(&owner->lock);
+        rc_owner_drain(owner);
+        pthread_mutex_lock(&owner->lock);
+    }
+    owner->active = false;
+    pthread_mutex_unlock(&owner->lock);
+
+    pthread_mutex_lock(&rc_owner_lock);
+    owner->next_free = rc_owner_free;
+    rc_owner_free = owner;
+    pthread_mutex_unlock(&rc_owner_lock);
+}
+
+static void rc_owner_key_create(void) {
+    pthread_key_create(&rc_owner_key, rc_owner_retire);
+}
+
+static RefCountOwner *rc_owner_current(void) {
+    if (rc_owner_self) return rc_owner_self;
+
+    pthread_once(&rc_owner_once, rc_owner_key_create);
+
+    pthread_mutex_lock(&rc_owner_lock);
+    RefCountOwner *owner = rc_owner_free;
+    if (owner) rc_owner_free = owner->next_free;
+    pthread_mutex_unlock(&rc_owner_lock);
+
+    if (!owner) {
+        owner = ec_calloc(1, sizeof(RefCountOwner));
+        if (!owner) return NULL;
+        if (pthread_mutex_init(&owner->lock, NULL) != 0) {
+            ec_free(owner);
+            return NULL;
+        }
+    }
+
+    /* Taking the lock orders us after any merge done while it was idle */
+    pthread_mutex_lock(&owner->lock);
+    owner->active = true;
+    pthread_mutex_unlock(&owner->lock);
+
+    pthread_setspecific(rc_owner_key, owner);
+    rc_owner_self = owner;
+    return owner;
+}
+
+static void rc_owner_enqueue(RefCountedValue *value) {
+    RefCountOwner *owner = value->owner;
+    bool dead = false;
+
+    pthread_mutex_lock(&owner->lock);
+    if (owner->active) {
+        value->queue_next = owner->queue;
+        owner->queue = value;
+        __atomic_store_n(&owner->pending, 1, __ATOMIC_RELAXED);
+    } else {
+        /* Nobody owns the count any more; merge it ourselves */
+        dead = rc_merge(value, true);
+    }
+    pthread_mutex_unlock(&owner->lock);
+
+    if (dead) {
+        rc_destroy(value);
+    }
+}
+
+/* True if the calling thread may use the biased (plain) count */
+static inline bool rc_is_biased_owner(const RefCountedValue *value) {
+    return value->owner && value->owner == rc_owner_self &&
+           !(__atomic_load_n(&value->shared_count, __ATOMIC_RELAXED) & RC_MERGED);
+}
+
+static EventChainErrorCode rc_shared_retain(RefCountedValue *value) {
+    if (rc_is_biased_owner(value)) {
+        size_t count = __atomic_load_n(&value->ref_count, __ATOMIC_RELAXED);
+        if (count >= SIZE_MAX) {
+            return EC_ERROR_OVERFLOW;
+        }
+        __atomic_store_n(&value->ref_count, count + 1, __ATOMIC_RELAXED);
+        return EC_SUCCESS;
+    }
+
+    __atomic_fetch_add(&value->shared_count, RC_ONE, __ATOMIC_RELAXED);
+    return EC_SUCCESS;
+}
+
+static EventChainErrorCode rc_shared_release(RefCountedValue *value) {
+    if (rc_is_biased_owner(value)) {
+        RefCountOwner *owner = value->owner;
+        size_t count = __atomic_load_n(&value->ref_count, __ATOMIC_RELAXED);
+        __atomic_store_n(&value->ref_count, count - 1, __ATOMIC_RELAXED);
+        if (count == 1 && rc_merge(value, false)) {
+            rc_destroy(value);
+        }
+        if (__atomic_load_n(&owner->pending, __ATOMIC_RELAXED)) {
+            rc_owner_drain(owner);
+        }
+        return EC_SUCCESS;
+    }
+
+    int64_t old = __atomic_load_n(&value->shared_count, __ATOMIC_RELAXED);
+    int64_t updated;
+    bool enqueue;
+    do {
+        if (old == RC_MERGED) {
+            fprintf(stderr, "ERROR: Attempted to release already-freed value\n");
+            return EC_ERROR_INVALID_PARAMETER;
+        }
+        updated = old - RC_ONE;
+        enqueue = !(old & RC_FLAGS) && updated < 0;
+        if (enqueue) updated |= RC_QUEUED;
+    } while (!__atomic_compare_exchange_n(&value->shared_count, &old, updated, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (updated == RC_MERGED) {
+        rc_destroy(value);
+    } else if (enqueue) {
+        rc_owner_enqueue(value);
+    }
+    return EC_SUCCESS;
+}
+
 RefCountedValue *ref_counted_value_create(void *data, ValueCleanupFunc cleanup) {
-    RefCountedValue *value = calloc(1, sizeof(RefCountedValue));
+    RefCountedValue *value = ec_calloc(1, sizeof(RefCountedValue));
     if (!value) return NULL;
 
     value->data = data;
@@ -196,9 +483,39 @@ RefCountedValue *ref_counted_value_create(void *data, ValueCleanupFunc cleanup)
     return value;
 }
 
+RefCountedValue *ref_counted_value_create_shared(void *data, ValueCleanupFunc cleanup) {
+    RefCountOwner *owner = rc_owner_current();
+    if (!owner) return NULL;
+
+    RefCountedValue *value = ref_counted_value_create(data, cleanup);
+    if (!value) return NULL;
+
+    value->thread_safe = true;
+    value->owner = owner;
+    return value;
+}
+
+/**
+ * Thread-safe value with no owner: every update is atomic. Used where no
+ * thread is more likely than another to touch the count.
+ */
+static RefCountedValue *ref_counted_value_create_atomic(void *data, ValueCleanupFunc cleanup) {
+    RefCountedValue *value = ref_counted_value_create(data, cleanup);
+    if (!value) return NULL;
+
+    value->thread_safe = true;
+    value->ref_count = 0;
+    value->shared_count = RC_ONE | RC_MERGED;
+    return value;
+}
+
 EventChainErrorCode ref_counted_value_retain(RefCountedValue *value) {
     if (!value) return EC_ERROR_NULL_POINTER;
 
+    if (value->thread_safe) {
+        return rc_shared_retain(value);
+    }
+
     /* Check for overflow */
     if (value->ref_count >= SIZE_MAX) {
         return EC_ERROR_OVERFLOW;
@@ -211,6 +528,10 @@ EventChainErrorCode ref_counted_value_retain(RefCountedValue *value) {
 EventChainErrorCode ref_counted_value_release(RefCountedValue *value) {
     if (!value) return EC_ERROR_NULL_POINTER;
 
+    if (value->thread_safe) {
+        return rc_shared_release(value);
+    }
+
     if (value->ref_count == 0) {
         /* Double-free attempt */
         fprintf(stderr, "ERROR: Attempted to release already-freed value\n");
@@ -224,13 +545,25 @@ EventChainErrorCode ref_counted_value_release(RefCountedValue *value) {
         if (value->cleanup && value->data) {
             value->cleanup(value->data);
         }
+
+        /* Arena nodes are reclaimed with their context */
+        bool arena_owned = value->arena_owned;
         secure_zero(value, sizeof(RefCountedValue));
-        free(value);
+        if (!arena_owned) {
+            ec_free(value);
+        }
     }
 
     return EC_SUCCESS;
 }
 
+void ref_counted_value_process_queued(void) {
+    RefCountOwner *owner = rc_owner_self;
+    if (owner && __atomic_load_n(&owner->pending, __ATOMIC_RELAXED)) {
+        rc_owner_drain(owner);
+    }
+}
+
 void *ref_counted_value_get_data(const RefCountedValue *value) {
     if (!value) return NULL;
     return value->data;
@@ -238,976 +571,7205 @@ void *ref_counted_value_get_data(const RefCountedValue *value) {
 
 size_t ref_counted_value_get_count(const RefCountedValue *value) {
     if (!value) return 0;
-    return value->ref_count;
-}
-
-/* ==================== EventContext Implementation ==================== */
 
-EventContext *event_context_create(void) {
-    EventContext *context = calloc(1, sizeof(EventContext));
-    if (!context) {
-        return NULL;
+    if (value->thread_safe) {
+        int64_t shared = __atomic_load_n(&value->shared_count, __ATOMIC_ACQUIRE);
+        int64_t total = (int64_t)__atomic_load_n(&value->ref_count, __ATOMIC_RELAXED) +
+                        (shared - (shared & RC_FLAGS)) / RC_ONE;
+        return total > 0 ? (size_t)total : 0;
     }
 
-    context->capacity = INITIAL_CAPACITY;
-    context->count = 0;
-    context->total_memory_bytes = sizeof(EventContext);
+    return value->ref_count;
+}
 
-    /* Allocate all arrays */
-    context->keys = calloc(context->capacity, sizeof(char *));
-    context->values = calloc(context->capacity, sizeof(RefCountedValue *));
+/* ==================== Cleanup Queue ==================== */
 
-    if (!context->keys || !context->values) {
-        free(context->keys);
-        free(context->values);
-        free(context);
-        return NULL;
+typedef struct {
+    ValueCleanupFunc cleanup;
+    void *data;
+} CleanupItem;
+
+struct EventCleanupQueue {
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;      /* Background mode only */
+    CleanupItem *items;                 /* Pending (under lock) */
+    size_t count;
+    size_t capacity;
+    CleanupItem *spare;                 /* Drained buffer kept for reuse */
+    size_t spare_capacity;
+    bool background;
+    bool shutdown;
+    pthread_t thread;
+};
+
+/**
+ * Hand a cleanup to the queue; false if it could not be queued (run it)
+ */
+static bool cleanup_queue_push(EventCleanupQueue *queue, ValueCleanupFunc cleanup, void *data) {
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->count == queue->capacity) {
+        size_t new_capacity = queue->capacity ? queue->capacity * 2 : INITIAL_CAPACITY * 8;
+        size_t new_size;
+        CleanupItem *grown = safe_multiply(new_capacity, sizeof(CleanupItem), &new_size)
+                             ? ec_realloc(queue->items, new_size) : NULL;
+        if (!grown) {
+            pthread_mutex_unlock(&queue->lock);
+            return false;
+        }
+        queue->items = grown;
+        queue->capacity = new_capacity;
     }
 
-    /* Account for array memory */
-    size_t array_memory;
-    if (!safe_multiply(context->capacity, sizeof(char *), &array_memory)) {
-        free(context->keys);
-        free(context->values);
-        free(context);
-        return NULL;
+    queue->items[queue->count].cleanup = cleanup;
+    queue->items[queue->count].data = data;
+    if (queue->count++ == 0 && queue->background) {
+        pthread_cond_signal(&queue->work_available);
     }
-    context->total_memory_bytes += array_memory;
 
-    if (!safe_multiply(context->capacity, sizeof(RefCountedValue *), &array_memory)) {
-        free(context->keys);
-        free(context->values);
-        free(context);
-        return NULL;
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+/**
+ * Swap out the pending batch and run it. Called with queue->lock held;
+ * the lock is dropped while the cleanups run and held again on return.
+ */
+static size_t cleanup_queue_run_batch(EventCleanupQueue *queue) {
+    CleanupItem *batch = queue->items;
+    size_t batch_count = queue->count;
+    size_t batch_capacity = queue->capacity;
+    queue->items = queue->spare;
+    queue->capacity = queue->spare_capacity;
+    queue->count = 0;
+    queue->spare = NULL;
+    queue->spare_capacity = 0;
+    pthread_mutex_unlock(&queue->lock);
+
+    for (size_t i = 0; i < batch_count; i++) {
+        batch[i].cleanup(batch[i].data);
     }
-    context->total_memory_bytes += array_memory;
 
-    return context;
+    /* Keep the buffer for the next swap so steady state never reallocates */
+    pthread_mutex_lock(&queue->lock);
+    if (!queue->spare) {
+        queue->spare = batch;
+        queue->spare_capacity = batch_capacity;
+    } else {
+        ec_free(batch);
+    }
+    return batch_count;
 }
 
-void event_context_destroy(EventContext *context) {
-    if (!context) return;
+static void *cleanup_queue_reclaimer(void *arg) {
+    EventCleanupQueue *queue = arg;
 
-    /* Release all entries */
-    for (size_t i = 0; i < context->count; i++) {
-        /* Free key */
-        if (context->keys[i]) {
-            secure_zero(context->keys[i], strlen(context->keys[i]));
-            free(context->keys[i]);
+    pthread_mutex_lock(&queue->lock);
+    for (;;) {
+        while (queue->count == 0 && !queue->shutdown) {
+            pthread_cond_wait(&queue->work_available, &queue->lock);
         }
+        if (queue->count == 0) break;
+        cleanup_queue_run_batch(queue);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return NULL;
+}
 
-        /* Release ref-counted value */
-        if (context->values[i]) {
-            ref_counted_value_release(context->values[i]);
+EventCleanupQueue *event_cleanup_queue_create(bool background) {
+    EventCleanupQueue *queue = ec_calloc(1, sizeof(EventCleanupQueue));
+    if (!queue) return NULL;
+
+    if (pthread_mutex_init(&queue->lock, NULL) != 0) {
+        ec_free(queue);
+        return NULL;
+    }
+    queue->background = background;
+
+    if (background) {
+        pthread_cond_init(&queue->work_available, NULL);
+        if (pthread_create(&queue->thread, NULL, cleanup_queue_reclaimer, queue) != 0) {
+            pthread_cond_destroy(&queue->work_available);
+            pthread_mutex_destroy(&queue->lock);
+            ec_free(queue);
+            return NULL;
         }
     }
 
-    /* Free arrays */
-    free(context->keys);
-    free(context->values);
+    return queue;
+}
 
-    /* Zero structure */
-    secure_zero(context, sizeof(EventContext));
+void event_cleanup_queue_destroy(EventCleanupQueue *queue) {
+    if (!queue) return;
+
+    if (queue->background) {
+        /* The reclaimer empties the queue before it exits */
+        pthread_mutex_lock(&queue->lock);
+        queue->shutdown = true;
+        pthread_cond_signal(&queue->work_available);
+        pthread_mutex_unlock(&queue->lock);
+        pthread_join(queue->thread, NULL);
+        pthread_cond_destroy(&queue->work_available);
+    } else {
+        event_cleanup_queue_drain(queue);
+    }
 
-    free(context);
+    pthread_mutex_destroy(&queue->lock);
+    ec_free(queue->items);
+    ec_free(queue->spare);
+    ec_free(queue);
 }
 
-EventChainErrorCode event_context_set_with_cleanup(
-    EventContext *context,
-    const char *key,
-    void *value,
-    ValueCleanupFunc cleanup
-) {
-    if (!context) return EC_ERROR_NULL_POINTER;
-    if (!key) return EC_ERROR_NULL_POINTER;
+size_t event_cleanup_queue_drain(EventCleanupQueue *queue) {
+    if (!queue) return 0;
 
-    /* Validate key length */
-    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
-    if (key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
-        return EC_ERROR_KEY_TOO_LONG;
-    }
-    if (key_len == 0) {
-        return EC_ERROR_INVALID_PARAMETER;
+    size_t ran = 0;
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count > 0) {
+        ran += cleanup_queue_run_batch(queue);
     }
+    pthread_mutex_unlock(&queue->lock);
+    return ran;
+}
 
-    /* Check if key already exists */
-    for (size_t i = 0; i < context->count; i++) {
-        if (context->keys[i] && strcmp(context->keys[i], key) == 0) {
-            /* Key exists - release old value and create new */
-            if (context->values[i]) {
-                /* Subtract old value memory */
-                context->total_memory_bytes -= sizeof(RefCountedValue);
-                ref_counted_value_release(context->values[i]);
-            }
+size_t event_cleanup_queue_pending(EventCleanupQueue *queue) {
+    if (!queue) return 0;
 
-            /* Create new ref-counted value */
-            RefCountedValue *new_value = ref_counted_value_create(value, cleanup);
-            if (!new_value) {
-                return EC_ERROR_OUT_OF_MEMORY;
-            }
+    pthread_mutex_lock(&queue->lock);
+    size_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
 
-            context->values[i] = new_value;
-            context->total_memory_bytes += sizeof(RefCountedValue);
-            return EC_SUCCESS;
-        }
+/* ==================== EventContext Implementation ==================== */
+
+#if EVENTCHAINS_MAX_CONTEXT_ENTRIES >= 0xFFFF
+#error "EventContext index slots store entry indices in 16 bits"
+#endif
+
+#define CONTEXT_FINGERPRINT_MASK 0xFFFF0000u
+#define CONTEXT_ENTRY_MASK 0x0000FFFFu
+#define CONTEXT_NOT_FOUND SIZE_MAX
+
+/**
+ * FNV-1a over at most EVENTCHAINS_MAX_KEY_LENGTH + 1 bytes; longer keys
+ * can never match a stored key anyway
+ */
+static uint32_t context_key_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i <= EVENTCHAINS_MAX_KEY_LENGTH && key[i] != '\0'; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
     }
+    return hash;
+}
 
-    /* Check capacity limits */
-    if (context->count >= EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
-        return EC_ERROR_CAPACITY_EXCEEDED;
+/**
+ * Index slot count for an entry capacity: a power of two, load <= 1/2
+ */
+static size_t context_index_size(size_t capacity) {
+    size_t size = INITIAL_CAPACITY;
+    while (size < capacity * 2) {
+        size *= 2;
     }
+    return size;
+}
 
-    /* Calculate memory needed for new entry */
-    size_t new_memory = key_len + 1 + sizeof(RefCountedValue);
-    size_t total_after;
-    if (!safe_add(context->total_memory_bytes, new_memory, &total_after)) {
-        return EC_ERROR_OVERFLOW;
+/**
+ * Bytes used by the entry arrays and index for a given capacity
+ */
+static size_t context_array_memory(size_t capacity) {
+    return capacity * (sizeof(char *) + sizeof(RefCountedValue *) + sizeof(uint32_t) +
+                       sizeof(EventContextKey) + sizeof(unsigned char) +
+                       sizeof(EventInlineValue)) +
+           context_index_size(capacity) * sizeof(uint32_t);
+}
+
+static void context_index_insert(EventContext *context, uint32_t hash, size_t entry) {
+    size_t slot = hash & context->index_mask;
+    while (context->index_slots[slot] != 0) {
+        slot = (slot + 1) & context->index_mask;
     }
+    context->index_slots[slot] = (hash & CONTEXT_FINGERPRINT_MASK) | (uint32_t)(entry + 1);
+}
 
-    if (total_after > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
-        return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+/**
+ * Re-index every entry (after growth)
+ */
+static void context_index_rebuild(EventContext *context) {
+    memset(context->index_slots, 0, (context->index_mask + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < context->count; i++) {
+        context_index_insert(context, context->key_hashes[i], i);
     }
+}
 
-    /* Expand if needed */
-    if (context->count >= context->capacity) {
-        size_t new_capacity;
-        if (!safe_multiply(context->capacity, 2, &new_capacity)) {
-            return EC_ERROR_OVERFLOW;
-        }
+/* Slot in the index holding an entry; the entry must be indexed */
+static size_t context_index_slot_of(const EventContext *context, size_t entry) {
+    size_t slot = context->key_hashes[entry] & context->index_mask;
+    while ((context->index_slots[slot] & CONTEXT_ENTRY_MASK) != (uint32_t)(entry + 1)) {
+        slot = (slot + 1) & context->index_mask;
+    }
+    return slot;
+}
 
-        /* Cap at maximum */
-        if (new_capacity > EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
-            new_capacity = EVENTCHAINS_MAX_CONTEXT_ENTRIES;
+/**
+ * Drop an entry from the index without tombstones
+ *
+ * Backward-shift deletion: every later slot in the probe run whose home
+ * is at or before the hole moves into it, so lookups that stop at the
+ * first empty slot stay correct.
+ */
+static void context_index_erase(EventContext *context, size_t entry) {
+    size_t mask = context->index_mask;
+    size_t hole = context_index_slot_of(context, entry);
+
+    for (size_t next = (hole + 1) & mask; context->index_slots[next] != 0; next = (next + 1) & mask) {
+        uint32_t packed = context->index_slots[next];
+        size_t home = context->key_hashes[(packed & CONTEXT_ENTRY_MASK) - 1] & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            context->index_slots[hole] = packed;
+            hole = next;
         }
+    }
+    context->index_slots[hole] = 0;
+}
 
-        /* Reallocate arrays */
-        char **new_keys = realloc(context->keys, sizeof(char *) * new_capacity);
-        if (!new_keys) {
-            return EC_ERROR_OUT_OF_MEMORY;
-        }
-        context->keys = new_keys;
+/* Point an entry's index slot at the position it is moving to */
+static void context_index_move(EventContext *context, size_t from, size_t to) {
+    size_t slot = context_index_slot_of(context, from);
+    context->index_slots[slot] = (context->index_slots[slot] & CONTEXT_FINGERPRINT_MASK) |
+                                 (uint32_t)(to + 1);
+}
 
-        RefCountedValue **new_values = realloc(
-            context->values,
-            sizeof(RefCountedValue *) * new_capacity
-        );
-        if (!new_values) {
-            return EC_ERROR_OUT_OF_MEMORY;
+/**
+ * Find the entry for a key: fingerprint, then full hash, then strcmp
+ *
+ * @return Entry index, or CONTEXT_NOT_FOUND
+ */
+static size_t context_find(const EventContext *context, const char *key, uint32_t hash) {
+    uint32_t fingerprint = hash & CONTEXT_FINGERPRINT_MASK;
+    size_t slot = hash & context->index_mask;
+
+    for (;;) {
+        uint32_t packed = context->index_slots[slot];
+        if (packed == 0) {
+            return CONTEXT_NOT_FOUND;
         }
-        context->values = new_values;
 
-        /* Zero new entries */
-        for (size_t i = context->capacity; i < new_capacity; i++) {
-            context->keys[i] = NULL;
-            context->values[i] = NULL;
+        if ((packed & CONTEXT_FINGERPRINT_MASK) == fingerprint) {
+            size_t entry = (packed & CONTEXT_ENTRY_MASK) - 1;
+            if (context->key_hashes[entry] == hash &&
+                strcmp(context->keys[entry], key) == 0) {
+                return entry;
+            }
         }
 
-        /* Update memory tracking */
-        size_t old_array_memory, new_array_memory;
-        safe_multiply(context->capacity, sizeof(char *) + sizeof(RefCountedValue *), &old_array_memory);
-        safe_multiply(new_capacity, sizeof(char *) + sizeof(RefCountedValue *), &new_array_memory);
-        context->total_memory_bytes += (new_array_memory - old_array_memory);
-
-        context->capacity = new_capacity;
+        slot = (slot + 1) & context->index_mask;
     }
+}
 
-    /* Add new entry */
-    context->keys[context->count] = strndup(key, EVENTCHAINS_MAX_KEY_LENGTH);
-    if (!context->keys[context->count]) {
-        return EC_ERROR_OUT_OF_MEMORY;
-    }
+/* ---- Context arena ---- */
 
-    /* Create ref-counted value */
-    RefCountedValue *new_value = ref_counted_value_create(value, cleanup);
-    if (!new_value) {
-        free(context->keys[context->count]);
-        context->keys[context->count] = NULL;
-        return EC_ERROR_OUT_OF_MEMORY;
-    }
+struct EventContextArenaChunk {
+    struct EventContextArenaChunk *next;
+    size_t size;                /* Usable bytes after the header */
+    size_t used;                /* Bytes handed out (kept current by context_arena_seal) */
+};
 
-    context->values[context->count] = new_value;
-    context->total_memory_bytes += new_memory;
-    context->count++;
+#define CONTEXT_ARENA_ALIGN ((size_t)16)
+#define CONTEXT_ARENA_ROUND(n) (((n) + CONTEXT_ARENA_ALIGN - 1) & ~(CONTEXT_ARENA_ALIGN - 1))
+#define CONTEXT_ARENA_HEADER CONTEXT_ARENA_ROUND(sizeof(struct EventContextArenaChunk))
 
-    return EC_SUCCESS;
+/**
+ * Record how much of the current chunk is in use
+ */
+static void context_arena_seal(EventContext *context) {
+    struct EventContextArenaChunk *head = context->arena_chunks;
+    if (head) {
+        head->used = (size_t)(context->arena_cursor - ((unsigned char *)head + CONTEXT_ARENA_HEADER));
+    }
 }
 
-EventChainErrorCode event_context_set(
+static bool context_arena_add_chunk(EventContext *context, size_t min_size) {
+    size_t size = context->arena_chunk_size > min_size ? context->arena_chunk_size : min_size;
+    size_t total;
+    if (!safe_add(CONTEXT_ARENA_HEADER, size, &total)) {
+        return false;
+    }
+
+    struct EventContextArenaChunk *chunk = ec_malloc(total);
+    if (!chunk) {
+        return false;
+    }
+
+    context_arena_seal(context);
+    chunk->next = context->arena_chunks;
+    chunk->size = size;
+    chunk->used = 0;
+    context->arena_chunks = chunk;
+    context->arena_cursor = (unsigned char *)chunk + CONTEXT_ARENA_HEADER;
+    context->arena_limit = context->arena_cursor + size;
+    return true;
+}
+
+/**
+ * Wipe the used part of each chunk from head until (not including) stop, and free it
+ */
+static void context_arena_release(struct EventContextArenaChunk *head,
+                                  struct EventContextArenaChunk *stop) {
+    while (head != stop) {
+        struct EventContextArenaChunk *next = head->next;
+        secure_zero(head, CONTEXT_ARENA_HEADER + head->used);
+        ec_free(head);
+        head = next;
+    }
+}
+
+/*
+ * Allocation for everything a context owns: bump-allocated in arena mode,
+ * the library allocator otherwise. context_free is a no-op in arena mode.
+ */
+static void *context_alloc(EventContext *context, size_t size) {
+    if (!context->arena_chunks) {
+        return ec_malloc(size);
+    }
+
+    if (size > SIZE_MAX - CONTEXT_ARENA_ALIGN) {
+        return NULL;
+    }
+    size = CONTEXT_ARENA_ROUND(size);
+
+    if ((size_t)(context->arena_limit - context->arena_cursor) < size &&
+        !context_arena_add_chunk(context, size)) {
+        return NULL;
+    }
+
+    void *ptr = context->arena_cursor;
+    context->arena_cursor += size;
+    return ptr;
+}
+
+static void *context_calloc(EventContext *context, size_t count, size_t size) {
+    size_t total;
+    if (!safe_multiply(count, size, &total)) {
+        return NULL;
+    }
+
+    void *ptr = context_alloc(context, total);
+    if (ptr) memset(ptr, 0, total);
+    return ptr;
+}
+
+static void *context_realloc(EventContext *context, void *ptr, size_t old_size, size_t new_size) {
+    if (!context->arena_chunks) {
+        return ec_realloc(ptr, new_size);
+    }
+
+    /* The old block stays in the arena until clear */
+    void *grown = context_alloc(context, new_size);
+    if (grown && ptr) {
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return grown;
+}
+
+static void context_free(EventContext *context, void *ptr) {
+    if (!context->arena_chunks) {
+        ec_free(ptr);
+    }
+}
+
+static char *context_strndup(EventContext *context, const char *s, size_t n) {
+    size_t len = strnlen(s, n);
+    char *dup = context_alloc(context, len + 1);
+    if (!dup) return NULL;
+    memcpy(dup, s, len);
+    dup[len] = '\0';
+    return dup;
+}
+
+static RefCountedValue *context_value_create(
     EventContext *context,
-    const char *key,
-    void *value
+    void *data,
+    ValueCleanupFunc cleanup
 ) {
-    return event_context_set_with_cleanup(context, key, value, NULL);
+    if (!context->arena_chunks) {
+        return ref_counted_value_create(data, cleanup);
+    }
+
+    RefCountedValue *value = context_calloc(context, 1, sizeof(RefCountedValue));
+    if (!value) return NULL;
+
+    value->data = data;
+    value->ref_count = 1;
+    value->cleanup = cleanup;
+    value->arena_owned = true;
+    return value;
+}
+
+/* ---- Borrow epochs ---- */
+
+#define CONTEXT_EPOCH_MAX_DEPTH 64
+
+/**
+ * Park something the context is letting go of until the epoch ends
+ *
+ * Returns false (caller releases now) outside an epoch, for NULL, or if
+ * the deferred list cannot grow.
+ */
+static bool context_epoch_defer(EventContext *context, void *ptr) {
+    if (context->epoch_depth == 0 || !ptr) return false;
+
+    if (context->epoch_deferred_count == context->epoch_deferred_capacity) {
+        size_t new_capacity = context->epoch_deferred_capacity ?
+                              context->epoch_deferred_capacity * 2 : INITIAL_CAPACITY;
+        size_t new_size;
+        if (!safe_multiply(new_capacity, sizeof(void *), &new_size)) {
+            return false;
+        }
+        void **grown = ec_realloc(context->epoch_deferred, new_size);
+        if (!grown) return false;
+        context->epoch_deferred = grown;
+        context->epoch_deferred_capacity = new_capacity;
+    }
+
+    context->epoch_deferred[context->epoch_deferred_count++] = ptr;
+    return true;
+}
+
+/**
+ * Release the context's reference to a value, queueing its cleanup if the
+ * value dies with it and the context has a cleanup queue
+ */
+static void context_value_release(EventContext *context, RefCountedValue *value) {
+    EventCleanupQueue *queue = context->cleanup_queue;
+    if (queue && !value->thread_safe && value->ref_count == 1 &&
+        value->cleanup && value->data &&
+        cleanup_queue_push(queue, value->cleanup, value->data)) {
+        value->cleanup = NULL;
+    }
+    ref_counted_value_release(value);
+}
+
+/**
+ * Drop the context's reference to a value, deferred while an epoch is open
+ *
+ * Returns true if the value was parked rather than released.
+ */
+static bool context_value_drop(EventContext *context, RefCountedValue *value) {
+    if (context_epoch_defer(context, value)) {
+        return true;
+    }
+
+    context_value_release(context, value);
+    return false;
+}
+
+/**
+ * Move parked arena nodes to the heap before the arena is reset
+ */
+static void context_epoch_evacuate_arena(EventContext *context) {
+    for (size_t i = 0; i < context->epoch_deferred_count; i++) {
+        RefCountedValue *node = context->epoch_deferred[i];
+        if (!node->arena_owned) continue;
+
+        RefCountedValue *heap_node = ref_counted_value_create(node->data, node->cleanup);
+        if (!heap_node) {
+            /* Out of memory: release early rather than lose the cleanup */
+            context_value_release(context, node);
+        } else {
+            heap_node->codec = node->codec;
+            heap_node->size = node->size;
+            heap_node->stamp = node->stamp;
+            heap_node->spilled = node->spilled;
+        }
+        secure_zero(node, sizeof(RefCountedValue));
+        context->epoch_deferred[i] = heap_node;
+    }
+}
+
+/* ---- Spill file ---- */
+
+/*
+ * Spilled bytes are appended to an unlinked temporary file with pwrite()
+ * and read back through shared mappings of it, one per segment. Segments
+ * are never remapped, so pointers handed out stay put until clear.
+ */
+
+struct EventContextSpillSegment {
+    struct EventContextSpillSegment *next;  /* Older segment */
+    unsigned char *map;
+    size_t size;
+    size_t used;
+    off_t offset;                           /* Where the segment starts in the file */
+};
+
+/* Place of an entry in the spill order, parallel to the entry arrays */
+struct EventContextSpillLink {
+    size_t prev;                    /* Entry index, CONTEXT_NOT_FOUND at the ends */
+    size_t next;
+    bool linked;
+};
+
+struct EventContextSpill {
+    int fd;
+    off_t file_size;
+    struct EventContextSpillSegment *segments;  /* Newest first */
+    size_t budget;                  /* Resident bytes allowed */
+    size_t spilled_bytes;
+    uint64_t clock;                 /* Source of RefCountedValue stamps */
+
+    /*
+     * Entries holding resident sized values, in stamp order, so a victim
+     * is found without scanning. An entry overwritten by a plain value
+     * may linger until it reaches the head.
+     */
+    struct EventContextSpillLink *links;
+    size_t link_capacity;
+    size_t oldest;                  /* Next victim, or CONTEXT_NOT_FOUND */
+    size_t newest;
+};
+
+/* Bytes a stored value counts toward the context's memory */
+static size_t context_value_memory(const RefCountedValue *value) {
+    return sizeof(RefCountedValue) + (value->spilled ? 0 : value->size);
+}
+
+static void spill_release_segments(struct EventContextSpill *spill) {
+    struct EventContextSpillSegment *segment = spill->segments;
+    while (segment) {
+        struct EventContextSpillSegment *next = segment->next;
+        munmap(segment->map, segment->size);
+        ec_free(segment);
+        segment = next;
+    }
+    spill->segments = NULL;
+    spill->file_size = 0;
+    spill->spilled_bytes = 0;
+}
+
+static bool spill_links_reserve(struct EventContextSpill *spill, size_t capacity) {
+    if (capacity <= spill->link_capacity) return true;
+
+    struct EventContextSpillLink *links = ec_realloc(spill->links, capacity * sizeof(*links));
+    if (!links) return false;
+    for (size_t i = spill->link_capacity; i < capacity; i++) {
+        links[i].linked = false;
+    }
+    spill->links = links;
+    spill->link_capacity = capacity;
+    return true;
+}
+
+static void spill_unlink(struct EventContextSpill *spill, size_t i) {
+    if (i >= spill->link_capacity || !spill->links[i].linked) return;
+
+    struct EventContextSpillLink *link = &spill->links[i];
+    if (link->prev != CONTEXT_NOT_FOUND) {
+        spill->links[link->prev].next = link->next;
+    } else {
+        spill->oldest = link->next;
+    }
+    if (link->next != CONTEXT_NOT_FOUND) {
+        spill->links[link->next].prev = link->prev;
+    } else {
+        spill->newest = link->prev;
+    }
+    link->linked = false;
+}
+
+/**
+ * Put entry i where it belongs in the spill order: last if it holds a
+ * freshly stamped resident sized value, nowhere otherwise
+ */
+static void context_spill_track(EventContext *context, size_t i) {
+    struct EventContextSpill *spill = context->spill;
+    if (!spill) return;
+
+    spill_unlink(spill, i);
+    const RefCountedValue *node = context->values[i];
+    if (!node || node->size == 0 || node->spilled || i >= spill->link_capacity) return;
+
+    struct EventContextSpillLink *link = &spill->links[i];
+    link->prev = spill->newest;
+    link->next = CONTEXT_NOT_FOUND;
+    link->linked = true;
+    if (spill->newest != CONTEXT_NOT_FOUND) {
+        spill->links[spill->newest].next = i;
+    } else {
+        spill->oldest = i;
+    }
+    spill->newest = i;
+}
+
+/**
+ * Follow the swap-remove of entry i: the last entry's link takes its place
+ */
+static void context_spill_detach(EventContext *context, size_t i, size_t last) {
+    struct EventContextSpill *spill = context->spill;
+    if (!spill) return;
+
+    spill_unlink(spill, i);
+    if (i == last || last >= spill->link_capacity || !spill->links[last].linked) return;
+
+    struct EventContextSpillLink *link = &spill->links[i];
+    *link = spill->links[last];
+    spill->links[last].linked = false;
+    if (link->prev != CONTEXT_NOT_FOUND) {
+        spill->links[link->prev].next = i;
+    } else {
+        spill->oldest = i;
+    }
+    if (link->next != CONTEXT_NOT_FOUND) {
+        spill->links[link->next].prev = i;
+    } else {
+        spill->newest = i;
+    }
+}
+
+/**
+ * Copy size bytes into the file
+ *
+ * @return Where they can be read, or NULL if the file can't grow
+ */
+static void *spill_write(struct EventContextSpill *spill, const void *data, size_t size) {
+    size_t stored = (size + 7) & ~(size_t)7;
+    if (stored < size) return NULL;
+
+    struct EventContextSpillSegment *segment = spill->segments;
+    if (!segment || segment->size - segment->used < stored) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t segment_size = stored > EVENTCHAINS_SPILL_SEGMENT ? stored : EVENTCHAINS_SPILL_SEGMENT;
+        segment_size = (segment_size + page - 1) / page * page;
+
+        segment = ec_malloc(sizeof(*segment));
+        if (!segment) return NULL;
+        if (ftruncate(spill->fd, spill->file_size + (off_t)segment_size) != 0) {
+            ec_free(segment);
+            return NULL;
+        }
+        segment->map = mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            spill->fd, spill->file_size);
+        if (segment->map == MAP_FAILED) {
+            ec_free(segment);
+            return NULL;
+        }
+        segment->size = segment_size;
+        segment->used = 0;
+        segment->offset = spill->file_size;
+        segment->next = spill->segments;
+        spill->segments = segment;
+        spill->file_size += (off_t)segment_size;
+    }
+
+    /* Through the file, so the bytes land in the page cache, not our pages */
+    const unsigned char *from = data;
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = pwrite(spill->fd, from + written, size - written,
+                           segment->offset + (off_t)(segment->used + written));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return NULL;
+        written += (size_t)n;
+    }
+
+    void *mapped = segment->map + segment->used;
+    segment->used += stored;
+    spill->spilled_bytes += size;
+    return mapped;
+}
+
+/**
+ * Move entry i's sized value into the spill file
+ *
+ * The entry gets a new node pointing into the mapping; the old one is
+ * dropped as usual, so references and borrows of it stay valid.
+ */
+static bool context_spill_entry(EventContext *context, size_t i) {
+    RefCountedValue *node = context->values[i];
+    void *mapped = spill_write(context->spill, node->data, node->size);
+    if (!mapped) return false;
+
+    RefCountedValue *spilled = context_value_create(context, mapped, NULL);
+    if (!spilled) {
+        context->spill->spilled_bytes -= node->size;   /* File space is simply lost */
+        return false;
+    }
+    spilled->codec = node->codec;
+    spilled->size = node->size;
+    spilled->stamp = node->stamp;
+    spilled->spilled = true;
+
+    context->values[i] = spilled;
+    context->total_memory_bytes -= node->size;
+    spill_unlink(context->spill, i);
+    context_value_drop(context, node);
+    return true;
+}
+
+/**
+ * Spill least recently stored values until needed more bytes fit the
+ * budget, leaving entry keep alone
+ *
+ * @return Whether they fit
+ */
+static bool context_spill_make_room(EventContext *context, size_t needed, size_t keep) {
+    struct EventContextSpill *spill = context->spill;
+    if (!spill) return false;
+
+    size_t victim = spill->oldest;
+    while (needed > spill->budget || context->total_memory_bytes > spill->budget - needed) {
+        if (victim == CONTEXT_NOT_FOUND) return false;
+
+        size_t next = spill->links[victim].next;
+        const RefCountedValue *node = context->values[victim];
+        if (victim == keep) {
+            /* Skipped, not unlinked */
+        } else if (!node || node->size == 0 || node->spilled) {
+            spill_unlink(spill, victim);
+        } else if (!context_spill_entry(context, victim)) {
+            return false;
+        }
+        victim = next;
+    }
+    return true;
+}
+
+/**
+ * Copy a spilled value back into memory before a reference to it can
+ * outlive the mapping
+ */
+static EventChainErrorCode context_spill_fault_in(EventContext *context, size_t i) {
+    RefCountedValue *node = context->values[i];
+    if (!node || !node->spilled) return EC_SUCCESS;
+
+    context_spill_make_room(context, node->size, i);
+    size_t total_after;
+    if (!safe_add(context->total_memory_bytes, node->size, &total_after)) {
+        return EC_ERROR_OVERFLOW;
+    }
+    if (total_after > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+        return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+    }
+
+    void *copy = ec_malloc(node->size ? node->size : 1);
+    if (!copy) return EC_ERROR_OUT_OF_MEMORY;
+    memcpy(copy, node->data, node->size);
+
+    RefCountedValue *resident = context_value_create(context, copy, ec_free);
+    if (!resident) {
+        ec_free(copy);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    resident->codec = node->codec;
+    resident->size = node->size;
+    resident->stamp = ++context->spill->clock;
+
+    context->values[i] = resident;
+    context->total_memory_bytes = total_after;
+    context->spill->spilled_bytes -= node->size;
+    context_spill_track(context, i);
+    context_value_drop(context, node);
+    return EC_SUCCESS;
+}
+
+/**
+ * Give back the file's space once nothing can point into it (clear)
+ */
+static void context_spill_reset(EventContext *context) {
+    if (!context->spill) return;
+
+    for (size_t i = 0; i < context->spill->link_capacity; i++) {
+        context->spill->links[i].linked = false;
+    }
+    context->spill->oldest = context->spill->newest = CONTEXT_NOT_FOUND;
+
+    /* Values parked by an open epoch may still point into the mappings */
+    if (context->epoch_depth > 0) return;
+
+    /* Rewritten from the start either way; shrinking returns the disk space */
+    spill_release_segments(context->spill);
+    int err = ftruncate(context->spill->fd, 0);
+    (void)err;
+}
+
+static void context_spill_destroy(EventContext *context) {
+    if (!context->spill) return;
+
+    spill_release_segments(context->spill);
+    close(context->spill->fd);
+    ec_free(context->spill->links);
+    ec_free(context->spill);
+    context->spill = NULL;
+}
+
+/* ---- Change log ---- */
+
+struct EventContextChangeRecord {
+    uint64_t version;
+    size_t key_offset;          /* NUL-terminated key in change_keys */
+    uint32_t hash;
+};
+
+/**
+ * Forget every record; readers behind the current version must resync
+ */
+static void context_changes_drop(EventContext *context) {
+    context->change_count = 0;
+    context->change_keys_size = 0;
+    context->change_base = context->version;
+}
+
+static bool context_changes_reserve(EventContext *context, size_t key_size) {
+    if (context->change_count == context->change_capacity) {
+        size_t new_capacity = context->change_capacity ?
+                              context->change_capacity * 2 : INITIAL_CAPACITY;
+        size_t new_size;
+        if (!safe_multiply(new_capacity, sizeof(struct EventContextChangeRecord), &new_size)) {
+            return false;
+        }
+        struct EventContextChangeRecord *grown = ec_realloc(context->changes, new_size);
+        if (!grown) return false;
+        context->changes = grown;
+        context->change_capacity = new_capacity;
+    }
+
+    if (key_size > context->change_keys_capacity - context->change_keys_size) {
+        size_t new_capacity = context->change_keys_capacity ? context->change_keys_capacity : 256;
+        while (new_capacity - context->change_keys_size < key_size) {
+            if (!safe_multiply(new_capacity, 2, &new_capacity)) return false;
+        }
+        char *grown = ec_realloc(context->change_keys, new_capacity);
+        if (!grown) return false;
+        context->change_keys = grown;
+        context->change_keys_capacity = new_capacity;
+    }
+    return true;
+}
+
+/**
+ * Note that key was set or removed, if the context records changes
+ *
+ * A log that can't grow is dropped rather than left with a hole, so
+ * readers behind it are told to resync.
+ */
+static void context_log_change(EventContext *context, const char *key, uint32_t hash) {
+    if (!context->record_changes) return;
+
+    context->version++;
+    size_t key_size = strlen(key) + 1;
+    if (!context_changes_reserve(context, key_size)) {
+        context_changes_drop(context);
+        return;
+    }
+
+    struct EventContextChangeRecord *record = &context->changes[context->change_count++];
+    record->version = context->version;
+    record->key_offset = context->change_keys_size;
+    record->hash = hash;
+    memcpy(context->change_keys + context->change_keys_size, key, key_size);
+    context->change_keys_size += key_size;
+}
+
+/* ---- Prefix index ---- */
+
+/*
+ * Crit-bit tree over a heap or arena context's keys
+ * (event_context_index_prefixes). Each internal node splits the keys
+ * below it on one bit: byte is the first byte where they differ and
+ * otherbits has every bit set except the deciding one. The leaves are the
+ * entries' own key strings, which stay put while the entry lives, so the
+ * tree copies nothing and costs one node per key. All keys under a prefix
+ * form a single subtree, ordered bytewise.
+ */
+typedef struct PrefixNode {
+    void *child[2];             /* A key or a PrefixNode each */
+    uint32_t byte;
+    uint8_t otherbits;
+    uint8_t leaves;             /* Bit d set: child[d] is a key */
+} PrefixNode;
+
+struct EventContextPrefixIndex {
+    void *root;                 /* A key, a PrefixNode or NULL */
+    uint8_t root_leaf;
+    PrefixNode *spare;          /* Set aside by context_prefix_reserve() */
+};
+
+/* A child slot, plus where its leaf flag lives */
+typedef struct {
+    void **slot;
+    uint8_t *leaves;
+    uint8_t bit;
+} PrefixRef;
+
+static inline PrefixRef prefix_root_ref(struct EventContextPrefixIndex *index) {
+    PrefixRef ref = { &index->root, &index->root_leaf, 1 };
+    return ref;
+}
+
+static inline PrefixRef prefix_child_ref(PrefixNode *node, int dir) {
+    PrefixRef ref = { &node->child[dir], &node->leaves, (uint8_t)(1u << dir) };
+    return ref;
+}
+
+static inline bool prefix_ref_is_key(PrefixRef ref) {
+    return (*ref.leaves & ref.bit) != 0;
+}
+
+static inline void prefix_ref_set(PrefixRef ref, void *target, bool is_key) {
+    *ref.slot = target;
+    if (is_key) {
+        *ref.leaves |= ref.bit;
+    } else {
+        *ref.leaves &= (uint8_t)~ref.bit;
+    }
+}
+
+/* 1 if key has node's deciding bit set; bytes past the end read as 0 */
+static inline int prefix_direction(const PrefixNode *node, const unsigned char *key, size_t len) {
+    unsigned c = node->byte < len ? key[node->byte] : 0;
+    return (int)((1u + (node->otherbits | c)) >> 8);
+}
+
+static void prefix_free_nodes(void *target, bool is_key) {
+    if (!target || is_key) return;
+    PrefixNode *node = target;
+    prefix_free_nodes(node->child[0], node->leaves & 1);
+    prefix_free_nodes(node->child[1], node->leaves & 2);
+    ec_free(node);
+}
+
+typedef bool (*PrefixVisitFunc)(char *key, void *arg);
+
+/**
+ * Visit every key under target, in byte order
+ *
+ * @return false if the visitor stopped the walk
+ */
+static bool prefix_walk(void *target, bool is_key, PrefixVisitFunc visit, void *arg) {
+    if (!target) return true;
+    if (is_key) return visit(target, arg);
+
+    PrefixNode *node = target;
+    return prefix_walk(node->child[0], node->leaves & 1, visit, arg) &&
+           prefix_walk(node->child[1], node->leaves & 2, visit, arg);
+}
+
+/**
+ * Make sure the next context_prefix_insert() has a node to use
+ *
+ * Called before an insert changes anything, so running out of memory
+ * leaves the entry arrays and the tree in step.
+ */
+static bool context_prefix_reserve(EventContext *context) {
+    struct EventContextPrefixIndex *index = context->prefix_index;
+    if (!index || index->spare) return true;
+    index->spare = ec_malloc(sizeof(PrefixNode));
+    return index->spare != NULL;
+}
+
+/**
+ * Add an entry's key (not already in the tree)
+ */
+static void context_prefix_insert(EventContext *context, char *key) {
+    struct EventContextPrefixIndex *index = context->prefix_index;
+    if (!index) return;
+
+    PrefixRef ref = prefix_root_ref(index);
+    if (!index->root) {
+        prefix_ref_set(ref, key, true);
+        return;
+    }
+
+    /* The key it would meet on a lookup differs from it at the new node's bit */
+    const unsigned char *bytes = (const unsigned char *)key;
+    size_t len = strlen(key);
+    while (!prefix_ref_is_key(ref)) {
+        PrefixNode *node = *ref.slot;
+        ref = prefix_child_ref(node, prefix_direction(node, bytes, len));
+    }
+    const unsigned char *closest = *ref.slot;
+
+    uint32_t byte = 0;
+    while (bytes[byte] == closest[byte]) {
+        if (!bytes[byte]) return;
+        byte++;
+    }
+    unsigned diff = bytes[byte] ^ closest[byte];
+    diff |= diff >> 1;
+    diff |= diff >> 2;
+    diff |= diff >> 4;
+    uint8_t otherbits = (uint8_t)((diff & ~(diff >> 1)) ^ 255);
+    int dir = (int)((1u + (otherbits | closest[byte])) >> 8);
+
+    PrefixNode *fresh = index->spare;
+    index->spare = NULL;
+    fresh->byte = byte;
+    fresh->otherbits = otherbits;
+    fresh->leaves = 0;
+    prefix_ref_set(prefix_child_ref(fresh, 1 - dir), key, true);
+
+    /* Hang it above the first node that splits on a later bit */
+    ref = prefix_root_ref(index);
+    while (!prefix_ref_is_key(ref)) {
+        PrefixNode *node = *ref.slot;
+        if (node->byte > byte || (node->byte == byte && node->otherbits > otherbits)) break;
+        ref = prefix_child_ref(node, prefix_direction(node, bytes, len));
+    }
+    prefix_ref_set(prefix_child_ref(fresh, dir), *ref.slot, prefix_ref_is_key(ref));
+    prefix_ref_set(ref, fresh, false);
+}
+
+/**
+ * Take a node out from above the subtree at (parent's) child dir: its
+ * sibling takes the parent's place
+ */
+static void prefix_unlink(struct EventContextPrefixIndex *index, PrefixRef above, int dir) {
+    PrefixNode *parent = *above.slot;
+    PrefixRef sibling = prefix_child_ref(parent, 1 - dir);
+    prefix_ref_set(above, *sibling.slot, prefix_ref_is_key(sibling));
+
+    if (!index->spare) {
+        index->spare = parent;
+    } else {
+        ec_free(parent);
+    }
+}
+
+/**
+ * Remove an entry's key; key is the entry's own string
+ */
+static void context_prefix_erase(EventContext *context, const char *key) {
+    struct EventContextPrefixIndex *index = context->prefix_index;
+    if (!index || !index->root) return;
+
+    const unsigned char *bytes = (const unsigned char *)key;
+    size_t len = strlen(key);
+    PrefixRef ref = prefix_root_ref(index);
+    PrefixRef above = ref;
+    int dir = -1;
+    while (!prefix_ref_is_key(ref)) {
+        PrefixNode *node = *ref.slot;
+        above = ref;
+        dir = prefix_direction(node, bytes, len);
+        ref = prefix_child_ref(node, dir);
+    }
+    if (*ref.slot != key) return;
+
+    if (dir < 0) {
+        prefix_ref_set(ref, NULL, false);
+    } else {
+        prefix_unlink(index, above, dir);
+    }
+}
+
+/**
+ * Find the subtree holding every key that starts with prefix
+ *
+ * @param top_out - Receives the subtree's slot
+ * @param above_out - Receives the slot of the node over it (slot NULL if
+ *                    the subtree is the whole tree)
+ * @param dir_out - Receives which child of that node the subtree is
+ * @return false if no key starts with prefix
+ */
+static bool context_prefix_find(struct EventContextPrefixIndex *index, const char *prefix,
+                                size_t len, PrefixRef *top_out, PrefixRef *above_out,
+                                int *dir_out) {
+    if (!index->root) return false;
+
+    const unsigned char *bytes = (const unsigned char *)prefix;
+    PrefixRef ref = prefix_root_ref(index);
+    PrefixRef top = ref;
+    PrefixRef above = { NULL, NULL, 0 };
+    int top_dir = -1;
+    while (!prefix_ref_is_key(ref)) {
+        PrefixNode *node = *ref.slot;
+        int dir = prefix_direction(node, bytes, len);
+        PrefixRef next = prefix_child_ref(node, dir);
+        /* Nodes splitting inside the prefix narrow the match; later ones don't */
+        if (node->byte < len) {
+            above = ref;
+            top = next;
+            top_dir = dir;
+        }
+        ref = next;
+    }
+    if (strncmp(*ref.slot, prefix, len) != 0) return false;
+
+    *top_out = top;
+    *above_out = above;
+    *dir_out = top_dir;
+    return true;
+}
+
+/**
+ * Empty the tree (the keys are going away with their entries)
+ */
+static void context_prefix_reset(EventContext *context) {
+    struct EventContextPrefixIndex *index = context->prefix_index;
+    if (!index) return;
+    prefix_free_nodes(index->root, index->root_leaf);
+    index->root = NULL;
+    index->root_leaf = 0;
+}
+
+static void context_prefix_destroy(EventContext *context) {
+    context_prefix_reset(context);
+    if (context->prefix_index) {
+        ec_free(context->prefix_index->spare);
+        ec_free(context->prefix_index);
+        context->prefix_index = NULL;
+    }
+}
+
+/* ---- Persistent backend (HAMT) ---- */
+
+/*
+ * Persistent contexts keep their entries in a hash array mapped trie.
+ * Nodes and leaves never change once reachable from a root, so any number
+ * of snapshots share them; a write copies only the path from the root to
+ * the changed leaf. Reference counts are atomic so versions can be
+ * released from different threads.
+ */
+
+#define HAMT_BITS 5
+#define HAMT_MASK 31u
+#define HAMT_HASH_BITS 32
+
+typedef struct {
+    uint32_t refs;                  /* Must stay first (see hamt_retain) */
+    uint32_t hash;
+    unsigned char type;             /* EventValueType */
+    RefCountedValue *value;         /* EVENT_VALUE_POINTER only (owned) */
+    EventInlineValue inline_value;
+    size_t key_len;
+    char key[];
+} HamtLeaf;
+
+/*
+ * Branch nodes hold one child per set bit of bitmap, in bit order; leafmap
+ * marks the children that are leaves. Keys whose full hashes collide end
+ * up in a collision node: collision_count leaves and no bitmap.
+ */
+typedef struct EventContextHamtNode {
+    uint32_t refs;                  /* Must stay first (see hamt_retain) */
+    uint32_t bitmap;
+    uint32_t leafmap;
+    uint32_t collision_count;
+    void *children[];
+} HamtNode;
+
+static unsigned hamt_child_count(const HamtNode *node) {
+    return node->collision_count ? node->collision_count
+                                 : (unsigned)__builtin_popcount(node->bitmap);
+}
+
+static bool hamt_child_is_leaf(const HamtNode *node, uint32_t bit) {
+    return node->collision_count || (node->leafmap & bit);
+}
+
+/* Leaves and nodes both start with their reference count */
+static void hamt_retain(void *child) {
+    __atomic_add_fetch((uint32_t *)child, 1, __ATOMIC_RELAXED);
+}
+
+static bool hamt_leaf_matches(const HamtLeaf *leaf, const char *key, uint32_t hash) {
+    return leaf->hash == hash && strcmp(leaf->key, key) == 0;
+}
+
+static size_t hamt_leaf_memory(const HamtLeaf *leaf) {
+    return sizeof(HamtLeaf) + leaf->key_len + 1 +
+           (leaf->type == EVENT_VALUE_POINTER ? sizeof(RefCountedValue) : 0);
+}
+
+static void hamt_leaf_release(HamtLeaf *leaf) {
+    if (__atomic_sub_fetch(&leaf->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    if (leaf->value) {
+        ref_counted_value_release(leaf->value);
+    }
+    secure_zero(leaf, sizeof(HamtLeaf) + leaf->key_len + 1);
+    ec_free(leaf);
+}
+
+static void hamt_node_release(HamtNode *node) {
+    if (!node || __atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    if (node->collision_count) {
+        for (unsigned i = 0; i < node->collision_count; i++) {
+            hamt_leaf_release(node->children[i]);
+        }
+    } else {
+        unsigned i = 0;
+        for (uint32_t bits = node->bitmap; bits; bits &= bits - 1, i++) {
+            uint32_t bit = bits & (~bits + 1);
+            if (node->leafmap & bit) {
+                hamt_leaf_release(node->children[i]);
+            } else {
+                hamt_node_release(node->children[i]);
+            }
+        }
+    }
+
+    ec_free(node);
+}
+
+static void hamt_child_release(void *child, bool is_leaf) {
+    if (is_leaf) {
+        hamt_leaf_release(child);
+    } else {
+        hamt_node_release(child);
+    }
+}
+
+static HamtNode *hamt_node_alloc(unsigned count) {
+    HamtNode *node = ec_malloc(sizeof(HamtNode) + count * sizeof(void *));
+    if (!node) return NULL;
+
+    node->refs = 1;
+    node->bitmap = 0;
+    node->leafmap = 0;
+    node->collision_count = 0;
+    return node;
+}
+
+/**
+ * Copy node with child idx replaced; consumes the reference to child
+ */
+static HamtNode *hamt_copy_replace(
+    const HamtNode *node,
+    unsigned idx,
+    uint32_t bit,
+    void *child,
+    bool child_is_leaf
+) {
+    unsigned count = hamt_child_count(node);
+    HamtNode *copy = hamt_node_alloc(count);
+    if (!copy) {
+        hamt_child_release(child, child_is_leaf);
+        return NULL;
+    }
+
+    copy->bitmap = node->bitmap;
+    copy->collision_count = node->collision_count;
+    copy->leafmap = child_is_leaf ? (node->leafmap | bit) : (node->leafmap & ~bit);
+    for (unsigned i = 0; i < count; i++) {
+        if (i == idx) {
+            copy->children[i] = child;
+        } else {
+            copy->children[i] = node->children[i];
+            hamt_retain(copy->children[i]);
+        }
+    }
+    return copy;
+}
+
+/**
+ * Copy node with a leaf added at idx (bit in a branch); consumes the leaf
+ */
+static HamtNode *hamt_copy_insert(const HamtNode *node, unsigned idx, uint32_t bit, HamtLeaf *leaf) {
+    unsigned count = hamt_child_count(node);
+    HamtNode *copy = hamt_node_alloc(count + 1);
+    if (!copy) {
+        hamt_leaf_release(leaf);
+        return NULL;
+    }
+
+    if (node->collision_count) {
+        copy->collision_count = node->collision_count + 1;
+    } else {
+        copy->bitmap = node->bitmap | bit;
+        copy->leafmap = node->leafmap | bit;
+    }
+
+    for (unsigned i = 0, j = 0; i <= count; i++) {
+        if (i == idx) {
+            copy->children[i] = leaf;
+        } else {
+            copy->children[i] = node->children[j++];
+            hamt_retain(copy->children[i]);
+        }
+    }
+    return copy;
+}
+
+/**
+ * Copy node without child idx (bit in a branch)
+ */
+static HamtNode *hamt_copy_remove(const HamtNode *node, unsigned idx, uint32_t bit) {
+    unsigned count = hamt_child_count(node);
+    HamtNode *copy = hamt_node_alloc(count - 1);
+    if (!copy) return NULL;
+
+    if (node->collision_count) {
+        copy->collision_count = node->collision_count - 1;
+    } else {
+        copy->bitmap = node->bitmap & ~bit;
+        copy->leafmap = node->leafmap & ~bit;
+    }
+
+    for (unsigned i = 0, j = 0; i < count; i++) {
+        if (i != idx) {
+            copy->children[j] = node->children[i];
+            hamt_retain(copy->children[j]);
+            j++;
+        }
+    }
+    return copy;
+}
+
+/**
+ * Build the smallest subtree holding two leaves with different keys;
+ * consumes both references
+ */
+static HamtNode *hamt_merge(HamtLeaf *a, HamtLeaf *b, unsigned shift) {
+    if (shift >= HAMT_HASH_BITS) {
+        HamtNode *bucket = hamt_node_alloc(2);
+        if (!bucket) {
+            hamt_leaf_release(a);
+            hamt_leaf_release(b);
+            return NULL;
+        }
+        bucket->collision_count = 2;
+        bucket->children[0] = a;
+        bucket->children[1] = b;
+        return bucket;
+    }
+
+    uint32_t bit_a = 1u << ((a->hash >> shift) & HAMT_MASK);
+    uint32_t bit_b = 1u << ((b->hash >> shift) & HAMT_MASK);
+
+    if (bit_a == bit_b) {
+        HamtNode *child = hamt_merge(a, b, shift + HAMT_BITS);
+        if (!child) return NULL;
+
+        HamtNode *node = hamt_node_alloc(1);
+        if (!node) {
+            hamt_node_release(child);
+            return NULL;
+        }
+        node->bitmap = bit_a;
+        node->children[0] = child;
+        return node;
+    }
+
+    HamtNode *node = hamt_node_alloc(2);
+    if (!node) {
+        hamt_leaf_release(a);
+        hamt_leaf_release(b);
+        return NULL;
+    }
+    node->bitmap = bit_a | bit_b;
+    node->leafmap = bit_a | bit_b;
+    node->children[0] = bit_a < bit_b ? (void *)a : (void *)b;
+    node->children[1] = bit_a < bit_b ? (void *)b : (void *)a;
+    return node;
+}
+
+static HamtLeaf *hamt_find(const HamtNode *node, const char *key, uint32_t hash) {
+    unsigned shift = 0;
+
+    while (node) {
+        if (node->collision_count) {
+            for (unsigned i = 0; i < node->collision_count; i++) {
+                HamtLeaf *leaf = node->children[i];
+                if (hamt_leaf_matches(leaf, key, hash)) return leaf;
+            }
+            return NULL;
+        }
+
+        uint32_t bit = 1u << ((hash >> shift) & HAMT_MASK);
+        if (!(node->bitmap & bit)) return NULL;
+
+        unsigned idx = (unsigned)__builtin_popcount(node->bitmap & (bit - 1));
+        if (node->leafmap & bit) {
+            HamtLeaf *leaf = node->children[idx];
+            return hamt_leaf_matches(leaf, key, hash) ? leaf : NULL;
+        }
+
+        node = node->children[idx];
+        shift += HAMT_BITS;
+    }
+
+    return NULL;
+}
+
+/**
+ * New version of the subtree with leaf stored under its key
+ *
+ * The leaf reference is borrowed. *replaced receives the leaf previously
+ * stored under the key, if any.
+ *
+ * @return New subtree, or NULL if out of memory
+ */
+static HamtNode *hamt_assoc(const HamtNode *node, unsigned shift, HamtLeaf *leaf,
+                            const HamtLeaf **replaced) {
+    if (!node) {
+        HamtNode *fresh = hamt_node_alloc(1);
+        if (!fresh) return NULL;
+        fresh->bitmap = 1u << ((leaf->hash >> shift) & HAMT_MASK);
+        fresh->leafmap = fresh->bitmap;
+        fresh->children[0] = leaf;
+        hamt_retain(leaf);
+        return fresh;
+    }
+
+    if (node->collision_count) {
+        for (unsigned i = 0; i < node->collision_count; i++) {
+            HamtLeaf *existing = node->children[i];
+            if (hamt_leaf_matches(existing, leaf->key, leaf->hash)) {
+                *replaced = existing;
+                hamt_retain(leaf);
+                return hamt_copy_replace(node, i, 0, leaf, true);
+            }
+        }
+        hamt_retain(leaf);
+        return hamt_copy_insert(node, node->collision_count, 0, leaf);
+    }
+
+    uint32_t bit = 1u << ((leaf->hash >> shift) & HAMT_MASK);
+    unsigned idx = (unsigned)__builtin_popcount(node->bitmap & (bit - 1));
+
+    if (!(node->bitmap & bit)) {
+        hamt_retain(leaf);
+        return hamt_copy_insert(node, idx, bit, leaf);
+    }
+
+    if (node->leafmap & bit) {
+        HamtLeaf *existing = node->children[idx];
+        if (hamt_leaf_matches(existing, leaf->key, leaf->hash)) {
+            *replaced = existing;
+            hamt_retain(leaf);
+            return hamt_copy_replace(node, idx, bit, leaf, true);
+        }
+
+        /* Two keys now share this slot: push both one level down */
+        hamt_retain(existing);
+        hamt_retain(leaf);
+        HamtNode *sub = hamt_merge(existing, leaf, shift + HAMT_BITS);
+        if (!sub) return NULL;
+        return hamt_copy_replace(node, idx, bit, sub, false);
+    }
+
+    HamtNode *sub = hamt_assoc(node->children[idx], shift + HAMT_BITS, leaf, replaced);
+    if (!sub) return NULL;
+    return hamt_copy_replace(node, idx, bit, sub, false);
+}
+
+/**
+ * New version of the subtree without key
+ *
+ * @param out - Receives the new subtree (NULL when it became empty)
+ * @param removed - Receives the removed leaf (still owned by the old version)
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND or EC_ERROR_OUT_OF_MEMORY
+ */
+static EventChainErrorCode hamt_dissoc(
+    const HamtNode *node,
+    unsigned shift,
+    const char *key,
+    uint32_t hash,
+    HamtNode **out,
+    const HamtLeaf **removed
+) {
+    if (!node) return EC_ERROR_NOT_FOUND;
+
+    unsigned count = hamt_child_count(node);
+    unsigned idx;
+    uint32_t bit = 0;
+
+    if (node->collision_count) {
+        for (idx = 0; idx < count; idx++) {
+            if (hamt_leaf_matches(node->children[idx], key, hash)) break;
+        }
+        if (idx == count) return EC_ERROR_NOT_FOUND;
+        *removed = node->children[idx];
+    } else {
+        bit = 1u << ((hash >> shift) & HAMT_MASK);
+        if (!(node->bitmap & bit)) return EC_ERROR_NOT_FOUND;
+        idx = (unsigned)__builtin_popcount(node->bitmap & (bit - 1));
+
+        if (!(node->leafmap & bit)) {
+            HamtNode *sub = NULL;
+            EventChainErrorCode err = hamt_dissoc(
+                node->children[idx], shift + HAMT_BITS, key, hash, &sub, removed);
+            if (err != EC_SUCCESS) return err;
+
+            if (sub) {
+                *out = hamt_copy_replace(node, idx, bit, sub, false);
+                return *out ? EC_SUCCESS : EC_ERROR_OUT_OF_MEMORY;
+            }
+            /* Child became empty: drop its slot below */
+        } else {
+            if (!hamt_leaf_matches(node->children[idx], key, hash)) return EC_ERROR_NOT_FOUND;
+            *removed = node->children[idx];
+        }
+    }
+
+    if (count == 1) {
+        *out = NULL;
+        return EC_SUCCESS;
+    }
+
+    *out = hamt_copy_remove(node, idx, bit);
+    return *out ? EC_SUCCESS : EC_ERROR_OUT_OF_MEMORY;
+}
+
+/**
+ * Constant-time membership: compares against every leaf
+ */
+static void hamt_has_constant_time(const HamtNode *node, const char *key, bool *found) {
+    if (!node) return;
+
+    unsigned count = hamt_child_count(node);
+    uint32_t bits = node->bitmap;
+    for (unsigned i = 0; i < count; i++) {
+        uint32_t bit = bits & (~bits + 1);
+        bits &= bits - 1;
+
+        if (hamt_child_is_leaf(node, bit)) {
+            const HamtLeaf *leaf = node->children[i];
+            if (constant_time_strcmp(leaf->key, key, EVENTCHAINS_MAX_KEY_LENGTH)) {
+                *found = true;
+            }
+        } else {
+            hamt_has_constant_time(node->children[i], key, found);
+        }
+    }
+}
+
+/**
+ * New unshared leaf; inline entries copy data/size, POINTER entries get
+ * their value attached by the caller once limits are checked
+ */
+static HamtLeaf *hamt_leaf_create(
+    const char *key,
+    size_t key_len,
+    uint32_t hash,
+    EventValueType type,
+    const void *data,
+    size_t size
+) {
+    HamtLeaf *leaf = ec_malloc(sizeof(HamtLeaf) + key_len + 1);
+    if (!leaf) return NULL;
+
+    leaf->refs = 1;
+    leaf->hash = hash;
+    leaf->type = (unsigned char)type;
+    leaf->value = NULL;
+    leaf->key_len = key_len;
+    memcpy(leaf->key, key, key_len);
+    leaf->key[key_len] = '\0';
+    memset(&leaf->inline_value, 0, sizeof(EventInlineValue));
+
+    if (type != EVENT_VALUE_POINTER) {
+        memcpy(leaf->inline_value.as.bytes, data, size);
+        leaf->inline_value.size = size;
+    }
+    return leaf;
+}
+
+/**
+ * Free a leaf that was never published, without running value cleanup
+ */
+static void hamt_leaf_abandon(HamtLeaf *leaf) {
+    ec_free(leaf->value);
+    ec_free(leaf);
+}
+
+/**
+ * Store a value in a persistent context by publishing a new root
+ *
+ * POINTER entries wrap value/cleanup; inline entries copy data/size.
+ */
+static EventChainErrorCode persistent_put(
+    EventContext *context,
+    const char *key,
+    size_t key_len,
+    uint32_t hash,
+    EventValueType type,
+    void *value,
+    ValueCleanupFunc cleanup,
+    const EventValueCodec *codec,
+    const void *data,
+    size_t size
+) {
+    const HamtLeaf *existing = hamt_find(context->hamt_root, key, hash);
+    if (!existing && context->count >= EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    HamtLeaf *leaf = hamt_leaf_create(key, key_len, hash, type, data, size);
+    if (!leaf) return EC_ERROR_OUT_OF_MEMORY;
+
+    size_t existing_memory = existing ? hamt_leaf_memory(existing) : 0;
+    size_t total_after;
+    if (!safe_add(context->total_memory_bytes - existing_memory, hamt_leaf_memory(leaf), &total_after)) {
+        ec_free(leaf);
+        return EC_ERROR_OVERFLOW;
+    }
+    if (total_after > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+        ec_free(leaf);
+        return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+    }
+
+    if (type == EVENT_VALUE_POINTER) {
+        leaf->value = ref_counted_value_create(value, cleanup);
+        if (!leaf->value) {
+            ec_free(leaf);
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+        leaf->value->codec = codec;
+    }
+
+    const HamtLeaf *replaced = NULL;
+    HamtNode *root = hamt_assoc(context->hamt_root, 0, leaf, &replaced);
+    if (!root) {
+        /* The value was never stored: don't run its cleanup */
+        hamt_leaf_abandon(leaf);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    hamt_leaf_release(leaf);
+
+    if (!context_epoch_defer(context, context->hamt_root)) {
+        hamt_node_release(context->hamt_root);
+    }
+    context->hamt_root = root;
+    context->total_memory_bytes = total_after;
+    if (!replaced) {
+        context->count++;
+    }
+    context_log_change(context, key, hash);
+    return EC_SUCCESS;
+}
+
+static EventChainErrorCode persistent_remove(EventContext *context, const char *key, uint32_t hash) {
+    HamtNode *root = NULL;
+    const HamtLeaf *removed = NULL;
+    EventChainErrorCode err = hamt_dissoc(context->hamt_root, 0, key, hash, &root, &removed);
+    if (err != EC_SUCCESS) return err;
+
+    context->total_memory_bytes -= hamt_leaf_memory(removed);
+    context->count--;
+
+    if (!context_epoch_defer(context, context->hamt_root)) {
+        hamt_node_release(context->hamt_root);
+    }
+    context->hamt_root = root;
+    context_log_change(context, key, hash);
+    return EC_SUCCESS;
+}
+
+/* ---- Concurrent backend ---- */
+
+/*
+ * A concurrent context splits its keys over CONTEXT_SHARDS tries of the
+ * persistent kind. Writers serialize per shard on a mutex and publish a
+ * new root; readers take no lock, they only announce themselves in one of
+ * the shard's two reader counts (picked by the shard's epoch) while they
+ * walk the (immutable) trie. A replaced root is freed as soon as the shard
+ * is seen with no readers at all. Under a steady stream of readers that
+ * never happens, so once CONTEXT_SHARD_RETIRED roots are waiting the
+ * writer flips the epoch and waits only for the readers already inside.
+ */
+
+#define CONTEXT_SHARD_BITS 4
+#define CONTEXT_SHARDS (1u << CONTEXT_SHARD_BITS)
+#define CONTEXT_SHARD_RETIRED 64
+
+struct EventContextShard {
+    uint32_t readers[2];                    /* Lock-free readers, by epoch parity */
+    uint32_t epoch;                         /* Parity new readers register under */
+    HamtNode *root;                         /* Published with release semantics */
+    pthread_mutex_t lock;                   /* Serializes writers */
+    size_t count;                           /* Entries (under lock) */
+    size_t memory_bytes;                    /* Accounted bytes (under lock) */
+    HamtNode *retired[CONTEXT_SHARD_RETIRED];
+    size_t retired_count;
+    unsigned char padding[64];              /* Keep shards off each other's lines */
+};
+
+typedef struct EventContextShard ContextShard;
+
+/* Top hash bits pick the shard; the trie consumes the low bits first */
+static ContextShard *context_shard(const EventContext *context, uint32_t hash) {
+    return &context->shards[hash >> (HAMT_HASH_BITS - CONTEXT_SHARD_BITS)];
+}
+
+static HamtNode *shard_read_begin(ContextShard *shard, unsigned *ticket) {
+    *ticket = __atomic_load_n(&shard->epoch, __ATOMIC_RELAXED) & 1u;
+    __atomic_add_fetch(&shard->readers[*ticket], 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&shard->root, __ATOMIC_SEQ_CST);
+}
+
+static void shard_read_end(ContextShard *shard, unsigned ticket) {
+    __atomic_sub_fetch(&shard->readers[ticket], 1, __ATOMIC_RELEASE);
+}
+
+static bool shard_quiescent(ContextShard *shard) {
+    return __atomic_load_n(&shard->readers[0], __ATOMIC_SEQ_CST) == 0 &&
+           __atomic_load_n(&shard->readers[1], __ATOMIC_SEQ_CST) == 0;
+}
+
+static void shard_wait_readers(ContextShard *shard, unsigned parity) {
+    while (__atomic_load_n(&shard->readers[parity], __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+}
+
+static void shard_drain(ContextShard *shard) {
+    for (size_t i = 0; i < shard->retired_count; i++) {
+        hamt_node_release(shard->retired[i]);
+        shard->retired[i] = NULL;
+    }
+    shard->retired_count = 0;
+}
+
+/**
+ * Retire a root replaced under the shard lock
+ *
+ * A reader that could still be walking it registered before the new root
+ * was published, so once both reader counts read zero every retired root
+ * is unreachable.
+ */
+static void shard_retire(ContextShard *shard, HamtNode *old_root) {
+    if (!old_root) return;
+
+    if (shard->retired_count == CONTEXT_SHARD_RETIRED) {
+        /*
+         * Bound the backlog. Stragglers still on the idle parity go first;
+         * after the flip new readers use that parity, so the wait for the
+         * current one only covers readers that were already inside.
+         */
+        unsigned parity = __atomic_load_n(&shard->epoch, __ATOMIC_RELAXED) & 1u;
+        shard_wait_readers(shard, parity ^ 1u);
+        __atomic_store_n(&shard->epoch, parity ^ 1u, __ATOMIC_SEQ_CST);
+        shard_wait_readers(shard, parity);
+        shard_drain(shard);
+    }
+
+    shard->retired[shard->retired_count++] = old_root;
+    if (shard_quiescent(shard)) {
+        shard_drain(shard);
+    }
+}
+
+static void shard_publish(ContextShard *shard, HamtNode *root) {
+    HamtNode *old_root = shard->root;
+    __atomic_store_n(&shard->root, root, __ATOMIC_SEQ_CST);
+    shard_retire(shard, old_root);
+}
+
+/**
+ * Store a value in a concurrent context (see persistent_put)
+ */
+static EventChainErrorCode concurrent_put(
+    EventContext *context,
+    const char *key,
+    size_t key_len,
+    uint32_t hash,
+    EventValueType type,
+    void *value,
+    ValueCleanupFunc cleanup,
+    const EventValueCodec *codec,
+    const void *data,
+    size_t size
+) {
+    ContextShard *shard = context_shard(context, hash);
+
+    HamtLeaf *leaf = hamt_leaf_create(key, key_len, hash, type, data, size);
+    if (!leaf) return EC_ERROR_OUT_OF_MEMORY;
+    size_t leaf_memory = hamt_leaf_memory(leaf);
+
+    EventChainErrorCode err = EC_SUCCESS;
+    pthread_mutex_lock(&shard->lock);
+
+    const HamtLeaf *existing = hamt_find(shard->root, key, hash);
+    size_t existing_memory = existing ? hamt_leaf_memory(existing) : 0;
+
+    /* Reserve against the context-wide limits shared by all shards */
+    if (!existing &&
+        __atomic_add_fetch(&context->count, 1, __ATOMIC_RELAXED) > EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
+        __atomic_sub_fetch(&context->count, 1, __ATOMIC_RELAXED);
+        err = EC_ERROR_CAPACITY_EXCEEDED;
+    } else if (__atomic_add_fetch(&context->total_memory_bytes, leaf_memory, __ATOMIC_RELAXED) -
+               existing_memory > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+        __atomic_sub_fetch(&context->total_memory_bytes, leaf_memory, __ATOMIC_RELAXED);
+        if (!existing) __atomic_sub_fetch(&context->count, 1, __ATOMIC_RELAXED);
+        err = EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+    }
+
+    if (err == EC_SUCCESS && type == EVENT_VALUE_POINTER) {
+        /* Any thread may drop the last reference, so no thread is favoured */
+        leaf->value = ref_counted_value_create_atomic(value, cleanup);
+        if (!leaf->value) {
+            err = EC_ERROR_OUT_OF_MEMORY;
+        } else {
+            leaf->value->codec = codec;
+        }
+    }
+
+    HamtNode *root = NULL;
+    if (err == EC_SUCCESS) {
+        const HamtLeaf *replaced = NULL;
+        root = hamt_assoc(shard->root, 0, leaf, &replaced);
+        if (!root) err = EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (err == EC_SUCCESS) {
+        __atomic_sub_fetch(&context->total_memory_bytes, existing_memory, __ATOMIC_RELAXED);
+        shard->memory_bytes += leaf_memory - existing_memory;
+        if (!existing) shard->count++;
+        shard_publish(shard, root);
+    } else if (err == EC_ERROR_OUT_OF_MEMORY) {
+        __atomic_sub_fetch(&context->total_memory_bytes, leaf_memory, __ATOMIC_RELAXED);
+        if (!existing) __atomic_sub_fetch(&context->count, 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    if (err != EC_SUCCESS) {
+        hamt_leaf_abandon(leaf);
+        return err;
+    }
+
+    hamt_leaf_release(leaf);
+    return EC_SUCCESS;
+}
+
+static EventChainErrorCode concurrent_remove(EventContext *context, const char *key, uint32_t hash) {
+    ContextShard *shard = context_shard(context, hash);
+
+    pthread_mutex_lock(&shard->lock);
+
+    HamtNode *root = NULL;
+    const HamtLeaf *removed = NULL;
+    EventChainErrorCode err = hamt_dissoc(shard->root, 0, key, hash, &root, &removed);
+    if (err == EC_SUCCESS) {
+        size_t memory = hamt_leaf_memory(removed);
+        shard->memory_bytes -= memory;
+        shard->count--;
+        __atomic_sub_fetch(&context->total_memory_bytes, memory, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&context->count, 1, __ATOMIC_RELAXED);
+        shard_publish(shard, root);
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+    return err;
+}
+
+static void concurrent_clear(EventContext *context) {
+    for (unsigned i = 0; i < CONTEXT_SHARDS; i++) {
+        ContextShard *shard = &context->shards[i];
+        pthread_mutex_lock(&shard->lock);
+
+        __atomic_sub_fetch(&context->total_memory_bytes, shard->memory_bytes, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&context->count, shard->count, __ATOMIC_RELAXED);
+        shard->memory_bytes = 0;
+        shard->count = 0;
+        shard_publish(shard, NULL);
+
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+/* ---- Mapped backend ---- */
+
+/*
+ * A serialized image (event_context_serialize) is read in place by a
+ * mapped context:
+ *
+ *   header | entries[count] | index[index_slots] | keys, codec names, bytes
+ *
+ * Offsets count from the start of the image and everything is 8-byte
+ * aligned. Integers are in the writer's byte order, which the header
+ * records. Loading checks only the header; each record is bounds-checked
+ * when it is used, so a corrupt image reads as missing entries, never
+ * out of bounds.
+ */
+
+#define CONTEXT_IMAGE_MAGIC 0x58544345u     /* "ECTX" */
+#define CONTEXT_IMAGE_VERSION 1
+#define CONTEXT_IMAGE_BYTE_ORDER 0x0102u
+#define CONTEXT_IMAGE_ALIGN ((size_t)8)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t byte_order;
+    uint32_t count;
+    uint32_t index_slots;           /* Power of two, more than count */
+    uint64_t size;                  /* Whole image */
+    uint64_t entries_offset;        /* ContextImageEntry[count] */
+    uint64_t index_offset;          /* uint32_t entry + 1 per slot, 0 = empty */
+} ContextImageHeader;
+
+typedef struct {
+    uint64_t key_offset;            /* key_len bytes and a NUL */
+    uint64_t codec_offset;          /* Codec name (pointer values), 0 = none */
+    uint64_t value_offset;          /* Encoded bytes (pointer) or inline bytes (SMALL) */
+    uint64_t value_size;
+    union {
+        int64_t i64;
+        double f64;
+    } scalar;                       /* I64 and F64 */
+    uint32_t key_len;
+    uint32_t hash;
+    uint8_t type;                   /* EventValueType */
+    uint8_t reserved[7];
+} ContextImageEntry;
+
+static const ContextImageHeader *image_header(const EventContext *context) {
+    return (const ContextImageHeader *)context->mapped_image;
+}
+
+static const ContextImageEntry *image_entry(const EventContext *context, size_t entry) {
+    const ContextImageEntry *entries = (const ContextImageEntry *)
+        (context->mapped_image + image_header(context)->entries_offset);
+    return &entries[entry];
+}
+
+/* [offset, offset + size) lies inside the image */
+static bool image_range_ok(const EventContext *context, uint64_t offset, uint64_t size) {
+    return offset <= context->mapped_size && size <= context->mapped_size - offset;
+}
+
+/* NUL-terminated string at offset, or NULL if it would run off the image */
+static const char *image_string(const EventContext *context, uint64_t offset) {
+    if (offset == 0 || offset >= context->mapped_size) return NULL;
+
+    const char *s = (const char *)context->mapped_image + offset;
+    return memchr(s, '\0', context->mapped_size - offset) ? s : NULL;
+}
+
+static const char *image_entry_key(const EventContext *context, const ContextImageEntry *record) {
+    if (!image_range_ok(context, record->key_offset, (uint64_t)record->key_len + 1)) {
+        return NULL;
+    }
+    const char *key = (const char *)context->mapped_image + record->key_offset;
+    return key[record->key_len] == '\0' ? key : NULL;
+}
+
+/**
+ * Find an entry through the image's own index
+ *
+ * @return Entry index, or CONTEXT_NOT_FOUND
+ */
+static size_t mapped_find(const EventContext *context, const char *key, uint32_t hash) {
+    const ContextImageHeader *header = image_header(context);
+    const uint32_t *index = (const uint32_t *)(context->mapped_image + header->index_offset);
+    uint32_t mask = header->index_slots - 1;
+
+    /* Bounded, in case a corrupt index has no empty slot */
+    uint32_t slot = hash & mask;
+    for (uint32_t probes = 0; probes < header->index_slots; probes++) {
+        uint32_t packed = index[slot];
+        if (packed == 0) return CONTEXT_NOT_FOUND;
+
+        size_t entry = (size_t)packed - 1;
+        if (entry < header->count) {
+            const ContextImageEntry *record = image_entry(context, entry);
+            const char *stored = record->hash == hash ? image_entry_key(context, record) : NULL;
+            if (stored && strcmp(stored, key) == 0) {
+                return entry;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+    return CONTEXT_NOT_FOUND;
+}
+
+/**
+ * Decoded form of a pointer entry, decoded on first use
+ *
+ * Decoded values are cached in context->values (allocated on first use)
+ * and published with compare-and-swap, so concurrent readers are safe;
+ * a reader that loses the race drops its own copy.
+ *
+ * @return The cached value, or NULL for a null entry, an unregistered
+ *         codec or a failed decode
+ */
+static RefCountedValue *mapped_value(const EventContext *context, size_t entry) {
+    RefCountedValue ***cache_ref = (RefCountedValue ***)&context->values;
+    RefCountedValue **cache = __atomic_load_n(cache_ref, __ATOMIC_ACQUIRE);
+    if (!cache) {
+        RefCountedValue **fresh = ec_calloc(image_header(context)->count, sizeof(RefCountedValue *));
+        if (!fresh) return NULL;
+        if (__atomic_compare_exchange_n(cache_ref, &cache, fresh, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            cache = fresh;
+        } else {
+            ec_free(fresh);
+        }
+    }
+
+    RefCountedValue *node = __atomic_load_n(&cache[entry], __ATOMIC_ACQUIRE);
+    if (node) return node;
+
+    const ContextImageEntry *record = image_entry(context, entry);
+    const char *codec_name = image_string(context, record->codec_offset);
+    const EventValueCodec *codec = codec_name ? event_codec_find(codec_name) : NULL;
+    if (!codec || !codec->decode ||
+        !image_range_ok(context, record->value_offset, record->value_size)) {
+        return NULL;
+    }
+
+    void *data = codec->decode(context->mapped_image + record->value_offset,
+                               (size_t)record->value_size);
+    if (!data) return NULL;
+
+    /* Readers on any thread may retain it, so no thread is favoured */
+    RefCountedValue *fresh = ref_counted_value_create_atomic(data, codec->cleanup);
+    if (!fresh) {
+        if (codec->cleanup) codec->cleanup(data);
+        return NULL;
+    }
+    fresh->codec = codec;
+
+    RefCountedValue *expected = NULL;
+    if (__atomic_compare_exchange_n(&cache[entry], &expected, fresh, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return fresh;
+    }
+    ref_counted_value_release(fresh);
+    return expected;
+}
+
+/**
+ * Where an entry's value lives, whichever backend holds it
+ *
+ * Concurrent lookups copy the inline value and the pointer value's data
+ * into the slot, since the leaf may be reclaimed once the read ends;
+ * stored and value still point into the leaf. Mapped lookups build the
+ * inline value in copy from the image record; a SMALL value's bytes are
+ * also in mapped_bytes, which stays valid with the image.
+ */
+typedef struct {
+    unsigned char type;                     /* EventValueType */
+    RefCountedValue *value;                 /* EVENT_VALUE_POINTER only */
+    void *data;                             /* value's data, safe after lookup */
+    const EventInlineValue *inline_value;   /* Safe to read after lookup */
+    const EventInlineValue *stored;         /* The backend's own storage */
+    EventInlineValue copy;
+    const unsigned char *mapped_bytes;      /* Mapped SMALL values only */
+} ContextSlot;
+
+static bool context_slot_at(const EventContext *context, size_t entry, ContextSlot *slot) {
+    if (entry == CONTEXT_NOT_FOUND) return false;
+
+    slot->type = context->value_types[entry];
+    slot->value = context->values[entry];
+    slot->data = ref_counted_value_get_data(slot->value);
+    slot->inline_value = &context->inline_values[entry];
+    slot->stored = slot->inline_value;
+    return true;
+}
+
+static bool mapped_slot_at(const EventContext *context, size_t entry, ContextSlot *slot) {
+    if (entry == CONTEXT_NOT_FOUND) return false;
+
+    const ContextImageEntry *record = image_entry(context, entry);
+    memset(&slot->copy, 0, sizeof(slot->copy));
+    slot->type = record->type;
+    slot->value = NULL;
+
+    switch ((EventValueType)record->type) {
+        case EVENT_VALUE_POINTER:
+            if (record->codec_offset) {
+                /* Unregistered codec or failed decode: nothing to hand out */
+                slot->value = mapped_value(context, entry);
+                if (!slot->value) return false;
+            }
+            break;
+        case EVENT_VALUE_I64:
+            slot->copy.as.i64 = record->scalar.i64;
+            slot->copy.size = sizeof(int64_t);
+            break;
+        case EVENT_VALUE_F64:
+            slot->copy.as.f64 = record->scalar.f64;
+            slot->copy.size = sizeof(double);
+            break;
+        case EVENT_VALUE_SMALL:
+            if (record->value_size > EVENTCHAINS_SMALL_VALUE_SIZE ||
+                !image_range_ok(context, record->value_offset, record->value_size)) {
+                return false;
+            }
+            slot->mapped_bytes = context->mapped_image + record->value_offset;
+            memcpy(slot->copy.as.bytes, slot->mapped_bytes, (size_t)record->value_size);
+            slot->copy.size = (size_t)record->value_size;
+            break;
+        default:
+            return false;
+    }
+
+    slot->data = ref_counted_value_get_data(slot->value);
+    slot->inline_value = &slot->copy;
+    slot->stored = &slot->copy;
+    return true;
+}
+
+static bool context_lookup(const EventContext *context, const char *key, uint32_t hash,
+                           ContextSlot *slot) {
+    if (context->mapped) {
+        return mapped_slot_at(context, mapped_find(context, key, hash), slot);
+    }
+
+    if (context->persistent) {
+        const HamtLeaf *leaf = hamt_find(context->hamt_root, key, hash);
+        if (!leaf) return false;
+
+        slot->type = leaf->type;
+        slot->value = leaf->value;
+        slot->data = ref_counted_value_get_data(leaf->value);
+        slot->inline_value = &leaf->inline_value;
+        slot->stored = slot->inline_value;
+        return true;
+    }
+
+    if (context->concurrent) {
+        ContextShard *shard = context_shard(context, hash);
+        unsigned ticket;
+        const HamtLeaf *leaf = hamt_find(shard_read_begin(shard, &ticket), key, hash);
+        if (leaf) {
+            slot->type = leaf->type;
+            slot->value = leaf->value;
+            slot->data = ref_counted_value_get_data(leaf->value);
+            slot->copy = leaf->inline_value;
+            slot->inline_value = &slot->copy;
+            slot->stored = &leaf->inline_value;
+        }
+        shard_read_end(shard, ticket);
+        return leaf != NULL;
+    }
+
+    return context_slot_at(context, context_find(context, key, hash), slot);
+}
+
+/**
+ * Called once per entry by context_walk(); return false to stop
+ */
+typedef bool (*ContextWalkFunc)(const char *key, uint32_t hash, const ContextSlot *slot, void *arg);
+
+/**
+ * Visit every leaf under a node, in trie order
+ *
+ * @return false if the visitor stopped the walk
+ */
+static bool hamt_walk(const HamtNode *node, ContextWalkFunc visit, void *arg) {
+    if (!node) return true;
+
+    unsigned count = hamt_child_count(node);
+    uint32_t bits = node->bitmap;
+    for (unsigned i = 0; i < count; i++) {
+        uint32_t bit = bits & (~bits + 1);
+        bits &= bits - 1;
+
+        if (hamt_child_is_leaf(node, bit)) {
+            const HamtLeaf *leaf = node->children[i];
+            ContextSlot slot;
+            slot.type = leaf->type;
+            slot.value = leaf->value;
+            slot.data = ref_counted_value_get_data(leaf->value);
+            slot.inline_value = &leaf->inline_value;
+            slot.stored = slot.inline_value;
+            if (!visit(leaf->key, leaf->hash, &slot, arg)) {
+                return false;
+            }
+        } else if (!hamt_walk(node->children[i], visit, arg)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Visit every entry, in unspecified order
+ *
+ * Persistent and concurrent contexts are walked from retained roots (a
+ * snapshot), so visit may write to them; other contexts must not change
+ * until the walk returns.
+ */
+static void context_walk(const EventContext *context, ContextWalkFunc visit, void *arg) {
+    if (context->persistent || context->concurrent) {
+        unsigned shards = context->concurrent ? CONTEXT_SHARDS : 1;
+        for (unsigned s = 0; s < shards; s++) {
+            HamtNode *root;
+            if (context->concurrent) {
+                ContextShard *shard = &context->shards[s];
+                unsigned ticket;
+                root = shard_read_begin(shard, &ticket);
+                if (root) hamt_retain(root);
+                shard_read_end(shard, ticket);
+            } else {
+                root = context->hamt_root;
+                if (root) hamt_retain(root);
+            }
+
+            bool more = hamt_walk(root, visit, arg);
+            hamt_node_release(root);
+            if (!more) return;
+        }
+        return;
+    }
+
+    ContextSlot slot;
+    for (size_t i = 0; i < context->count; i++) {
+        if (context->mapped) {
+            const ContextImageEntry *record = image_entry(context, i);
+            const char *key = image_entry_key(context, record);
+            if (!key || !mapped_slot_at(context, i, &slot)) continue;
+            if (!visit(key, record->hash, &slot, arg)) return;
+        } else {
+            context_slot_at(context, i, &slot);
+            if (!visit(context->keys[i], context->key_hashes[i], &slot, arg)) return;
+        }
+    }
+}
+
+/* ---- Scopes ---- */
+
+/*
+ * A scope frame remembers where the entries written inside it start (new
+ * keys are always appended, and entries below base are never moved while
+ * the scope is open) and journals the outer values it overwrites, so a
+ * pop only touches what the scope itself wrote. A persistent context
+ * simply keeps the root to go back to.
+ */
+
+#define CONTEXT_SCOPE_MAX_DEPTH 64
+
+struct EventContextScope {
+    size_t base;                        /* First entry created inside the scope */
+    size_t first_save;                  /* Its first record in scope_saves */
+    struct EventContextHamtNode *root;  /* Persistent: root to restore (owned) */
+    size_t count;                       /* Persistent: count to restore */
+    size_t memory_bytes;                /* Persistent: accounting to restore */
+    uint64_t version;                   /* Context version when pushed */
+};
+
+struct EventContextScopeSave {
+    size_t entry;
+    unsigned char type;                 /* EventValueType */
+    RefCountedValue *value;             /* Reference held until restored */
+    EventInlineValue inline_value;
+};
+
+/**
+ * Make room for one more element in a heap array that doubles
+ *
+ * @return The (possibly moved) array, or NULL if it cannot grow
+ */
+static void *scope_array_reserve(void *array, size_t *capacity, size_t count, size_t element) {
+    if (count < *capacity) return array;
+
+    size_t new_capacity = *capacity ? *capacity * 2 : INITIAL_CAPACITY;
+    size_t new_size;
+    if (!safe_multiply(new_capacity, element, &new_size)) {
+        return NULL;
+    }
+    void *grown = ec_realloc(array, new_size);
+    if (!grown) return NULL;
+
+    *capacity = new_capacity;
+    return grown;
+}
+
+/* An entry that predates the innermost open scope stays where it is */
+static bool context_entry_pinned(const EventContext *context, size_t entry) {
+    return context->scope_depth > 0 &&
+           entry < context->scopes[context->scope_depth - 1].base;
+}
+
+/**
+ * Journal an outer entry's value before the innermost scope overwrites it
+ *
+ * The saved reference is taken out of the entry (values[entry] becomes
+ * NULL), so the caller stores the new value without releasing anything.
+ *
+ * @return false if the journal cannot grow
+ */
+static bool context_scope_save(EventContext *context, size_t entry) {
+    if (!context_entry_pinned(context, entry)) return true;
+
+    /* Only the first overwrite in a scope needs the original */
+    const struct EventContextScope *scope = &context->scopes[context->scope_depth - 1];
+    for (size_t i = scope->first_save; i < context->scope_save_count; i++) {
+        if (context->scope_saves[i].entry == entry) return true;
+    }
+
+    struct EventContextScopeSave *saves = scope_array_reserve(
+        context->scope_saves, &context->scope_save_capacity,
+        context->scope_save_count, sizeof(struct EventContextScopeSave));
+    if (!saves) return false;
+    context->scope_saves = saves;
+
+    struct EventContextScopeSave *save = &context->scope_saves[context->scope_save_count++];
+    save->entry = entry;
+    save->type = context->value_types[entry];
+    save->value = context->values[entry];
+    save->inline_value = context->inline_values[entry];
+
+    if (save->value) {
+        context->total_memory_bytes -= context_value_memory(save->value);
+        context->values[entry] = NULL;
+    }
+    return true;
+}
+
+/**
+ * Log again every key changed since a scope was pushed: its pop has
+ * changed each of them back
+ */
+static void context_changes_relog(EventContext *context, uint64_t since) {
+    if (!context->record_changes) return;
+
+    if (since < context->change_base) {
+        /* The scope's records are gone, so its keys are unknown */
+        context->version++;
+        context_changes_drop(context);
+        return;
+    }
+
+    size_t end = context->change_count;
+    size_t i = end;
+    while (i > 0 && context->changes[i - 1].version > since) {
+        i--;
+    }
+
+    char key[EVENTCHAINS_MAX_KEY_LENGTH + 1];
+    for (; i < end; i++) {
+        /* Copied out: logging may move the records and keys */
+        const struct EventContextChangeRecord *record = &context->changes[i];
+        uint32_t hash = record->hash;
+        const char *stored = context->change_keys + record->key_offset;
+        memcpy(key, stored, strlen(stored) + 1);
+
+        context_log_change(context, key, hash);
+        if (context->change_count <= i) return;     /* Log dropped */
+    }
+}
+
+/**
+ * Close every scope without restoring anything (clear and destroy)
+ */
+static void context_scope_discard(EventContext *context) {
+    for (size_t i = 0; i < context->scope_save_count; i++) {
+        if (context->scope_saves[i].value) {
+            context_value_drop(context, context->scope_saves[i].value);
+        }
+    }
+    if (context->scope_saves) {
+        secure_zero(context->scope_saves,
+                    context->scope_save_count * sizeof(struct EventContextScopeSave));
+    }
+    context->scope_save_count = 0;
+
+    for (size_t i = 0; i < context->scope_depth; i++) {
+        hamt_node_release(context->scopes[i].root);
+        context->scopes[i].root = NULL;
+    }
+    context->scope_depth = 0;
+}
+
+/* ---- Lifecycle ---- */
+
+/**
+ * Allocate empty entry arrays and index at the given capacity
+ */
+static bool context_init_arrays(EventContext *context, size_t capacity) {
+    context->capacity = capacity;
+
+    size_t index_size = context_index_size(context->capacity);
+    context->index_mask = index_size - 1;
+
+    context->keys = context_calloc(context, context->capacity, sizeof(char *));
+    context->values = context_calloc(context, context->capacity, sizeof(RefCountedValue *));
+    context->key_hashes = context_calloc(context, context->capacity, sizeof(uint32_t));
+    context->index_slots = context_calloc(context, index_size, sizeof(uint32_t));
+    context->entry_keys = context_calloc(context, context->capacity, sizeof(EventContextKey));
+    context->value_types = context_calloc(context, context->capacity, sizeof(unsigned char));
+    context->inline_values = context_calloc(context, context->capacity, sizeof(EventInlineValue));
+
+    return context->keys && context->values && context->key_hashes &&
+           context->index_slots && context->entry_keys &&
+           context->value_types && context->inline_values;
+}
+
+static void context_free_arrays(EventContext *context) {
+    context_free(context, context->keys);
+    context_free(context, context->values);
+    context_free(context, context->key_hashes);
+    context_free(context, context->index_slots);
+    context_free(context, context->entry_keys);
+    context_free(context, context->value_types);
+    if (context->inline_values && !context->arena_chunks) {
+        secure_zero(context->inline_values, context->capacity * sizeof(EventInlineValue));
+    }
+    context_free(context, context->inline_values);
+}
+
+/**
+ * Release every entry's key and value (values' cleanup functions run)
+ */
+static void context_release_entries(EventContext *context) {
+    context_prefix_reset(context);
+    for (size_t i = 0; i < context->count; i++) {
+        /* Free key; arena keys are wiped with their chunk */
+        if (context->keys[i]) {
+            if (!context->arena_chunks) {
+                secure_zero(context->keys[i], strlen(context->keys[i]));
+                ec_free(context->keys[i]);
+            }
+            context->keys[i] = NULL;
+        }
+
+        /* Release ref-counted value */
+        if (context->values[i]) {
+            context_value_drop(context, context->values[i]);
+            context->values[i] = NULL;
+        }
+    }
+}
+
+/**
+ * Release everything parked by the epochs that just closed
+ */
+static void context_epoch_flush(EventContext *context) {
+    for (size_t i = 0; i < context->epoch_deferred_count; i++) {
+        if (context->persistent) {
+            hamt_node_release(context->epoch_deferred[i]);
+        } else if (context->epoch_deferred[i]) {
+            context_value_release(context, context->epoch_deferred[i]);
+        }
+        context->epoch_deferred[i] = NULL;
+    }
+    context->epoch_deferred_count = 0;
+}
+
+EventContext *event_context_create(void) {
+    EventContext *context = ec_calloc(1, sizeof(EventContext));
+    if (!context) {
+        return NULL;
+    }
+
+    context->count = 0;
+    context->total_memory_bytes = sizeof(EventContext);
+
+    /* Interned-key slots are allocated on first *_k access */
+    context->key_slots = NULL;
+    context->key_slot_count = 0;
+
+    if (!context_init_arrays(context, INITIAL_CAPACITY)) {
+        context_free_arrays(context);
+        ec_free(context);
+        return NULL;
+    }
+
+    /* Account for array memory */
+    context->total_memory_bytes += context_array_memory(context->capacity);
+
+    return context;
+}
+
+/**
+ * Create an arena context whose first chunk holds at least first_chunk
+ * bytes and whose arrays start (and restart on clear) at capacity
+ */
+static EventContext *context_create_arena_sized(
+    size_t chunk_size,
+    size_t first_chunk,
+    size_t capacity
+) {
+    if (chunk_size == 0) {
+        chunk_size = EVENTCHAINS_CONTEXT_ARENA_CHUNK;
+    }
+
+    /* The first chunk always holds the context and its initial arrays */
+    size_t minimum = CONTEXT_ARENA_ROUND(sizeof(EventContext)) +
+                     context_array_memory(capacity) + 8 * CONTEXT_ARENA_ALIGN;
+    if (first_chunk < minimum) {
+        first_chunk = minimum;
+    }
+    if (first_chunk < chunk_size) {
+        first_chunk = chunk_size;
+    }
+
+    EventContext bootstrap;
+    memset(&bootstrap, 0, sizeof(bootstrap));
+    bootstrap.arena_chunk_size = chunk_size;
+    bootstrap.arena_reset_capacity = capacity;
+    if (!context_arena_add_chunk(&bootstrap, first_chunk)) {
+        return NULL;
+    }
+
+    EventContext *context = context_alloc(&bootstrap, sizeof(EventContext));
+    *context = bootstrap;
+    context->arena_reset = context->arena_cursor;
+    context->total_memory_bytes = sizeof(EventContext);
+
+    /* Cannot fail: the chunk was sized for it */
+    context_init_arrays(context, capacity);
+    context->total_memory_bytes += context_array_memory(context->capacity);
+
+    return context;
+}
+
+EventContext *event_context_create_arena(size_t chunk_size) {
+    return context_create_arena_sized(chunk_size, 0, INITIAL_CAPACITY);
+}
+
+void event_context_destroy(EventContext *context) {
+    if (!context) return;
+
+    /* Destroying ends any open epoch */
+    context->epoch_depth = 0;
+    context_epoch_flush(context);
+    ec_free(context->epoch_deferred);
+    context->epoch_deferred = NULL;
+
+    /* Open scopes are abandoned: saved values are released, not restored */
+    context_scope_discard(context);
+    ec_free(context->scopes);
+    ec_free(context->scope_saves);
+    context->scopes = NULL;
+    context->scope_saves = NULL;
+    event_context_record_changes(context, false);
+
+    if (context->persistent) {
+        /* Nodes still shared with other snapshots survive */
+        hamt_node_release(context->hamt_root);
+        secure_zero(context, sizeof(EventContext));
+        ec_free(context);
+        return;
+    }
+
+    if (context->mapped) {
+        /* The image belongs to the caller; only the decode cache is ours */
+        if (context->values) {
+            for (size_t i = 0; i < context->count; i++) {
+                ref_counted_value_release(context->values[i]);
+            }
+            ec_free(context->values);
+        }
+        secure_zero(context, sizeof(EventContext));
+        ec_free(context);
+        return;
+    }
+
+    if (context->concurrent) {
+        for (unsigned i = 0; i < CONTEXT_SHARDS; i++) {
+            ContextShard *shard = &context->shards[i];
+            shard_drain(shard);
+            hamt_node_release(shard->root);
+            pthread_mutex_destroy(&shard->lock);
+        }
+        ec_free(context->shards);
+        secure_zero(context, sizeof(EventContext));
+        ec_free(context);
+        return;
+    }
+
+    /* Release all entries */
+    context_release_entries(context);
+    ec_free(context->key_slots);
+    context_spill_destroy(context);
+    context_prefix_destroy(context);
+
+    if (context->arena_chunks) {
+        /* The context itself lives in the last chunk */
+        context_arena_seal(context);
+        context_arena_release(context->arena_chunks, NULL);
+        return;
+    }
+
+    /* Free arrays */
+    context_free_arrays(context);
+
+    /* Zero structure */
+    secure_zero(context, sizeof(EventContext));
+
+    ec_free(context);
+}
+
+EventContext *event_context_create_persistent(void) {
+    EventContext *context = ec_calloc(1, sizeof(EventContext));
+    if (!context) {
+        return NULL;
+    }
+
+    context->persistent = true;
+    context->hamt_root = NULL;
+    context->total_memory_bytes = sizeof(EventContext);
+    return context;
+}
+
+EventContext *event_context_create_concurrent(void) {
+    EventContext *context = ec_calloc(1, sizeof(EventContext));
+    if (!context) {
+        return NULL;
+    }
+
+    context->shards = ec_calloc(CONTEXT_SHARDS, sizeof(ContextShard));
+    if (!context->shards) {
+        ec_free(context);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < CONTEXT_SHARDS; i++) {
+        if (pthread_mutex_init(&context->shards[i].lock, NULL) != 0) {
+            while (i-- > 0) {
+                pthread_mutex_destroy(&context->shards[i].lock);
+            }
+            ec_free(context->shards);
+            ec_free(context);
+            return NULL;
+        }
+    }
+
+    context->concurrent = true;
+    context->total_memory_bytes = sizeof(EventContext) + CONTEXT_SHARDS * sizeof(ContextShard);
+    return context;
+}
+
+EventContext *event_context_snapshot(const EventContext *context) {
+    if (!context || !context->persistent) {
+        return NULL;
+    }
+
+    EventContext *snapshot = ec_calloc(1, sizeof(EventContext));
+    if (!snapshot) {
+        return NULL;
+    }
+
+    snapshot->persistent = true;
+    snapshot->hamt_root = context->hamt_root;
+    if (snapshot->hamt_root) {
+        hamt_retain(snapshot->hamt_root);
+    }
+    snapshot->count = context->count;
+    snapshot->total_memory_bytes = context->total_memory_bytes;
+    return snapshot;
+}
+
+/**
+ * Grow the entry arrays (and the index with them) to new_capacity
+ */
+static EventChainErrorCode context_grow(EventContext *context, size_t new_capacity) {
+    /* New index first: it is the only step that cannot be kept on failure */
+    size_t new_index_size = context_index_size(new_capacity);
+    uint32_t *new_index = context_calloc(context, new_index_size, sizeof(uint32_t));
+    if (!new_index) {
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Reallocate arrays; a larger array left behind on failure is harmless */
+    size_t old_capacity = context->capacity;
+    char **new_keys = context_realloc(context, context->keys,
+                                      sizeof(char *) * old_capacity,
+                                      sizeof(char *) * new_capacity);
+    if (!new_keys) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->keys = new_keys;
+
+    RefCountedValue **new_values = context_realloc(
+        context, context->values,
+        sizeof(RefCountedValue *) * old_capacity,
+        sizeof(RefCountedValue *) * new_capacity
+    );
+    if (!new_values) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->values = new_values;
+
+    uint32_t *new_hashes = context_realloc(context, context->key_hashes,
+                                           sizeof(uint32_t) * old_capacity,
+                                           sizeof(uint32_t) * new_capacity);
+    if (!new_hashes) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->key_hashes = new_hashes;
+
+    EventContextKey *new_entry_keys = context_realloc(
+        context, context->entry_keys,
+        sizeof(EventContextKey) * old_capacity,
+        sizeof(EventContextKey) * new_capacity
+    );
+    if (!new_entry_keys) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->entry_keys = new_entry_keys;
+
+    unsigned char *new_types = context_realloc(context, context->value_types,
+                                               sizeof(unsigned char) * old_capacity,
+                                               sizeof(unsigned char) * new_capacity);
+    if (!new_types) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->value_types = new_types;
+
+    EventInlineValue *new_inline = context_realloc(
+        context, context->inline_values,
+        sizeof(EventInlineValue) * old_capacity,
+        sizeof(EventInlineValue) * new_capacity
+    );
+    if (!new_inline) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    context->inline_values = new_inline;
+
+    if (context->spill && !spill_links_reserve(context->spill, new_capacity)) {
+        context_free(context, new_index);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Zero new entries */
+    for (size_t i = context->capacity; i < new_capacity; i++) {
+        context->keys[i] = NULL;
+        context->values[i] = NULL;
+        context->key_hashes[i] = 0;
+        context->entry_keys[i] = EVENT_CONTEXT_KEY_INVALID;
+        context->value_types[i] = EVENT_VALUE_POINTER;
+        memset(&context->inline_values[i], 0, sizeof(EventInlineValue));
+    }
+
+    /* Update memory tracking */
+    context->total_memory_bytes += context_array_memory(new_capacity) -
+                                   context_array_memory(context->capacity);
+
+    context_free(context, context->index_slots);
+    context->index_slots = new_index;
+    context->index_mask = new_index_size - 1;
+    context->capacity = new_capacity;
+    context_index_rebuild(context);
+
+    return EC_SUCCESS;
+}
+
+/**
+ * Replace the value of an existing entry
+ *
+ * Stores adopt (the caller's reference) instead of wrapping value/cleanup
+ * if it is given.
+ */
+static EventChainErrorCode context_replace_value(
+    EventContext *context,
+    size_t entry,
+    void *value,
+    ValueCleanupFunc cleanup,
+    RefCountedValue *adopt
+) {
+    /* Sized values count their bytes, so an overwrite can go over the limit */
+    if (adopt && adopt->size) {
+        RefCountedValue *old_value = context->values[entry];
+        size_t total_after = context->total_memory_bytes -
+                             (old_value ? context_value_memory(old_value) : 0);
+        if (!safe_add(total_after, context_value_memory(adopt), &total_after)) {
+            return EC_ERROR_OVERFLOW;
+        }
+        if (total_after > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+            return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+        }
+    }
+
+    /* An outer entry overwritten inside a scope keeps its value for the pop */
+    if (!context_scope_save(context, entry)) {
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Release old value and create new */
+    RefCountedValue *old_value = context->values[entry];
+    bool reuse = false;
+    if (old_value) {
+        /* Subtract old value memory */
+        context->total_memory_bytes -= context_value_memory(old_value);
+
+        /* Arena nodes never escape the context, so its slot can be reused */
+        reuse = !adopt && old_value->arena_owned && old_value->ref_count == 1;
+        if (context_value_drop(context, old_value)) {
+            reuse = false;
+        }
+    }
+
+    /* An inline value is simply overwritten */
+    context->value_types[entry] = EVENT_VALUE_POINTER;
+    context_log_change(context, context->keys[entry], context->key_hashes[entry]);
+
+    /* Create new ref-counted value */
+    RefCountedValue *new_value;
+    if (adopt) {
+        new_value = adopt;
+    } else if (reuse) {
+        new_value = old_value;
+        new_value->data = value;
+        new_value->ref_count = 1;
+        new_value->cleanup = cleanup;
+        new_value->arena_owned = true;
+        new_value->codec = NULL;
+        new_value->size = 0;
+        new_value->stamp = 0;
+        new_value->spilled = false;
+    } else {
+        new_value = context_value_create(context, value, cleanup);
+    }
+    if (!new_value) {
+        context->values[entry] = NULL;
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    context->values[entry] = new_value;
+    context->total_memory_bytes += context_value_memory(new_value);
+    context_spill_track(context, entry);
+    return EC_SUCCESS;
+}
+
+/**
+ * Append a new entry for a key known not to be present
+ *
+ * Pointer entries get a ref-counted wrapper for value/cleanup, or take
+ * over adopt (the caller's reference) if it is given. Inline entries are
+ * left for the caller to fill in.
+ */
+static EventChainErrorCode context_insert(
+    EventContext *context,
+    const char *key,
+    size_t key_len,
+    uint32_t hash,
+    EventValueType type,
+    void *value,
+    ValueCleanupFunc cleanup,
+    RefCountedValue *adopt,
+    size_t *entry_out
+) {
+    /* Check capacity limits */
+    if (context->count >= EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    /* Calculate memory needed for new entry (inline values are pre-counted) */
+    size_t new_memory = key_len + 1;
+    if (type == EVENT_VALUE_POINTER) {
+        new_memory += adopt ? context_value_memory(adopt) : sizeof(RefCountedValue);
+    }
+    size_t total_after;
+    if (!safe_add(context->total_memory_bytes, new_memory, &total_after)) {
+        return EC_ERROR_OVERFLOW;
+    }
+
+    if (total_after > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+        return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+    }
+    if (!context_prefix_reserve(context)) {
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Expand if needed */
+    if (context->count >= context->capacity) {
+        size_t new_capacity;
+        if (!safe_multiply(context->capacity, 2, &new_capacity)) {
+            return EC_ERROR_OVERFLOW;
+        }
+
+        /* Cap at maximum */
+        if (new_capacity > EVENTCHAINS_MAX_CONTEXT_ENTRIES) {
+            new_capacity = EVENTCHAINS_MAX_CONTEXT_ENTRIES;
+        }
+
+        EventChainErrorCode err = context_grow(context, new_capacity);
+        if (err != EC_SUCCESS) {
+            return err;
+        }
+    }
+
+    /* Add new entry */
+    context->keys[context->count] = context_strndup(context, key, EVENTCHAINS_MAX_KEY_LENGTH);
+    if (!context->keys[context->count]) {
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Create ref-counted value */
+    RefCountedValue *new_value = adopt;
+    if (type == EVENT_VALUE_POINTER && !adopt) {
+        new_value = context_value_create(context, value, cleanup);
+        if (!new_value) {
+            context_free(context, context->keys[context->count]);
+            context->keys[context->count] = NULL;
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    context->values[context->count] = new_value;
+    context->value_types[context->count] = (unsigned char)type;
+    context->key_hashes[context->count] = hash;
+    context->entry_keys[context->count] = EVENT_CONTEXT_KEY_INVALID;
+    context_index_insert(context, hash, context->count);
+    context_prefix_insert(context, context->keys[context->count]);
+    context_spill_track(context, context->count);
+    context->total_memory_bytes += new_memory;
+
+    /* Inline inserts are logged when context_store_inline() fills them */
+    if (type == EVENT_VALUE_POINTER) {
+        context_log_change(context, context->keys[context->count], hash);
+    }
+
+    if (entry_out) *entry_out = context->count;
+    context->count++;
+
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_set_with_cleanup(
+    EventContext *context,
+    const char *key,
+    void *value,
+    ValueCleanupFunc cleanup
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+
+    /* Validate key length */
+    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
+    if (key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+        return EC_ERROR_KEY_TOO_LONG;
+    }
+    if (key_len == 0) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    uint32_t hash = context_key_hash(key);
+
+    if (context->persistent) {
+        return persistent_put(context, key, key_len, hash, EVENT_VALUE_POINTER,
+                              value, cleanup, NULL, NULL, 0);
+    }
+    if (context->concurrent) {
+        return concurrent_put(context, key, key_len, hash, EVENT_VALUE_POINTER,
+                              value, cleanup, NULL, NULL, 0);
+    }
+
+    /* Check if key already exists */
+    size_t existing = context_find(context, key, hash);
+    if (existing != CONTEXT_NOT_FOUND) {
+        return context_replace_value(context, existing, value, cleanup, NULL);
+    }
+
+    return context_insert(context, key, key_len, hash, EVENT_VALUE_POINTER, value, cleanup, NULL, NULL);
+}
+
+EventChainErrorCode event_context_set(
+    EventContext *context,
+    const char *key,
+    void *value
+) {
+    return event_context_set_with_cleanup(context, key, value, NULL);
+}
+
+EventChainErrorCode event_context_get_ref(
+    EventContext *context,
+    const char *key,
+    RefCountedValue **value_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!value_out) return EC_ERROR_NULL_POINTER;
+
+    if (context->persistent || context->mapped) {
+        ContextSlot slot;
+        if (!context_lookup(context, key, context_key_hash(key), &slot)) {
+            *value_out = NULL;
+            return EC_ERROR_NOT_FOUND;
+        }
+        if (slot.type != EVENT_VALUE_POINTER) {
+            *value_out = NULL;
+            return EC_ERROR_TYPE_MISMATCH;
+        }
+
+        *value_out = slot.value;
+        ref_counted_value_retain(slot.value);
+        return EC_SUCCESS;
+    }
+
+    if (context->concurrent) {
+        /*
+         * Retain inside the read section: a writer that replaces the leaf
+         * retires the old root, which keeps the value alive until every
+         * reader that could see it has left.
+         */
+        uint32_t hash = context_key_hash(key);
+        ContextShard *shard = context_shard(context, hash);
+        unsigned ticket;
+        const HamtLeaf *leaf = hamt_find(shard_read_begin(shard, &ticket), key, hash);
+
+        EventChainErrorCode err = !leaf ? EC_ERROR_NOT_FOUND :
+                                  leaf->type != EVENT_VALUE_POINTER ? EC_ERROR_TYPE_MISMATCH :
+                                  EC_SUCCESS;
+        *value_out = err == EC_SUCCESS ? leaf->value : NULL;
+        if (*value_out) {
+            ref_counted_value_retain(*value_out);
+        }
+
+        shard_read_end(shard, ticket);
+        return err;
+    }
+
+    size_t entry = context_find(context, key, context_key_hash(key));
+    if (entry != CONTEXT_NOT_FOUND) {
+        if (context->value_types[entry] != EVENT_VALUE_POINTER) {
+            *value_out = NULL;
+            return EC_ERROR_TYPE_MISMATCH;
+        }
+
+        /* The reference may outlive the spill file's mapping */
+        EventChainErrorCode err = context_spill_fault_in(context, entry);
+        if (err != EC_SUCCESS) {
+            *value_out = NULL;
+            return err;
+        }
+
+        RefCountedValue *node = context->values[entry];
+        if (node && node->arena_owned) {
+            /* The reference may outlive the arena: move the node to the heap */
+            RefCountedValue *heap_node = ref_counted_value_create(node->data, node->cleanup);
+            if (!heap_node) {
+                *value_out = NULL;
+                return EC_ERROR_OUT_OF_MEMORY;
+            }
+            heap_node->codec = node->codec;
+            heap_node->size = node->size;
+            heap_node->stamp = node->stamp;
+            heap_node->spilled = node->spilled;
+            secure_zero(node, sizeof(RefCountedValue));
+            context->values[entry] = node = heap_node;
+        }
+
+        *value_out = node;
+        if (*value_out) {
+            ref_counted_value_retain(*value_out);
+        }
+        return EC_SUCCESS;
+    }
+
+    *value_out = NULL;
+    return EC_ERROR_NOT_FOUND;
+}
+
+EventChainErrorCode event_context_get(
+    const EventContext *context,
+    const char *key,
+    void **value_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!value_out) return EC_ERROR_NULL_POINTER;
+
+    ContextSlot slot;
+    if (!context_lookup(context, key, context_key_hash(key), &slot)) {
+        *value_out = NULL;
+        return EC_ERROR_NOT_FOUND;
+    }
+
+    if (slot.type != EVENT_VALUE_POINTER) {
+        *value_out = NULL;
+        return EC_ERROR_TYPE_MISMATCH;
+    }
+
+    *value_out = slot.data;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_epoch_begin(EventContext *context) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->concurrent) return EC_SUCCESS;
+
+    if (context->epoch_depth >= CONTEXT_EPOCH_MAX_DEPTH) {
+        return EC_ERROR_OVERFLOW;
+    }
+    context->epoch_depth++;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_epoch_end(EventContext *context) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->concurrent) return EC_SUCCESS;
+
+    if (context->epoch_depth == 0) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+    if (--context->epoch_depth == 0) {
+        context_epoch_flush(context);
+
+        /* The end of an execution is the foreground queue's drain point */
+        if (context->cleanup_queue && !context->cleanup_queue->background) {
+            event_cleanup_queue_drain(context->cleanup_queue);
+        }
+    }
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_set_cleanup_queue(
+    EventContext *context,
+    EventCleanupQueue *queue
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->persistent || context->concurrent || context->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    context->cleanup_queue = queue;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_borrow(
+    const EventContext *context,
+    const char *key,
+    void **value_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!value_out) return EC_ERROR_NULL_POINTER;
+
+    if (context->concurrent || context->epoch_depth == 0) {
+        *value_out = NULL;
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    /* Anything the epoch could lose is deferred, so a plain read is enough */
+    return event_context_get(context, key, value_out);
+}
+
+bool event_context_has(
+    const EventContext *context,
+    const char *key,
+    bool constant_time
+) {
+    if (!context || !key) return false;
+
+    if (context->persistent) {
+        if (constant_time) {
+            bool found = false;
+            hamt_has_constant_time(context->hamt_root, key, &found);
+            return found;
+        }
+        return hamt_find(context->hamt_root, key, context_key_hash(key)) != NULL;
+    }
+
+    if (context->concurrent) {
+        bool found = false;
+        if (constant_time) {
+            for (unsigned i = 0; i < CONTEXT_SHARDS; i++) {
+                ContextShard *shard = &context->shards[i];
+                unsigned ticket;
+                hamt_has_constant_time(shard_read_begin(shard, &ticket), key, &found);
+                shard_read_end(shard, ticket);
+            }
+        } else {
+            uint32_t hash = context_key_hash(key);
+            ContextShard *shard = context_shard(context, hash);
+            unsigned ticket;
+            found = hamt_find(shard_read_begin(shard, &ticket), key, hash) != NULL;
+            shard_read_end(shard, ticket);
+        }
+        return found;
+    }
+
+    if (context->mapped) {
+        if (constant_time) {
+            /* Every record is compared, as for the array backend below */
+            bool found = false;
+            for (size_t i = 0; i < context->count; i++) {
+                const char *stored = image_entry_key(context, image_entry(context, i));
+                if (stored && constant_time_strcmp(stored, key, EVENTCHAINS_MAX_KEY_LENGTH)) {
+                    found = true;
+                }
+            }
+            return found;
+        }
+        return mapped_find(context, key, context_key_hash(key)) != CONTEXT_NOT_FOUND;
+    }
+
+    if (constant_time) {
+        /*
+         * Constant-time comparison for sensitive keys. Deliberately not
+         * indexed: probe length would leak information about the key.
+         */
+        bool found = false;
+        for (size_t i = 0; i < context->count; i++) {
+            if (context->keys[i]) {
+                if (constant_time_strcmp(context->keys[i], key, EVENTCHAINS_MAX_KEY_LENGTH)) {
+                    found = true;
+                    /* Don't break - must check all entries for constant time */
+                }
+            }
+        }
+        return found;
+    } else {
+        /* Fast path for non-sensitive keys */
+        return context_find(context, key, context_key_hash(key)) != CONTEXT_NOT_FOUND;
+    }
+}
+
+/**
+ * Remove entry i from the arrays and index. values[i] must still be live
+ * (its size comes off the memory total), so callers drop it afterwards.
+ */
+static void context_detach_entry(EventContext *context, size_t i) {
+    context_log_change(context, context->keys[i], context->key_hashes[i]);
+
+    /* Update memory tracking (inline values have no separate allocation) */
+    size_t key_len = strlen(context->keys[i]);
+    context->total_memory_bytes -= key_len + 1 +
+                                   (context->values[i] ? context_value_memory(context->values[i]) : 0);
+
+    /* Free key */
+    context_prefix_erase(context, context->keys[i]);
+    secure_zero(context->keys[i], key_len);
+    context_free(context, context->keys[i]);
+
+    /* Unbind the removed entry's interned key */
+    EventContextKey bound = context->entry_keys[i];
+    if (bound != EVENT_CONTEXT_KEY_INVALID && bound < context->key_slot_count &&
+        context->key_slots[bound] == (uint32_t)(i + 1)) {
+        context->key_slots[bound] = 0;
+    }
+
+    /*
+     * Swap-remove: the last entry fills the hole, so only its index slot
+     * and interned-key binding change. This is why entry order is
+     * unspecified.
+     */
+    context_index_erase(context, i);
+    size_t last = context->count - 1;
+    context_spill_detach(context, i, last);
+    if (i != last) {
+        context_index_move(context, last, i);
+
+        context->keys[i] = context->keys[last];
+        context->values[i] = context->values[last];
+        context->key_hashes[i] = context->key_hashes[last];
+        context->entry_keys[i] = context->entry_keys[last];
+        context->value_types[i] = context->value_types[last];
+        context->inline_values[i] = context->inline_values[last];
+
+        EventContextKey moved = context->entry_keys[i];
+        if (moved != EVENT_CONTEXT_KEY_INVALID && moved < context->key_slot_count &&
+            context->key_slots[moved] == (uint32_t)(last + 1)) {
+            context->key_slots[moved] = (uint32_t)(i + 1);
+        }
+    }
+
+    /* Clear last entry */
+    context->keys[last] = NULL;
+    context->values[last] = NULL;
+    context->key_hashes[last] = 0;
+    context->entry_keys[last] = EVENT_CONTEXT_KEY_INVALID;
+    context->value_types[last] = EVENT_VALUE_POINTER;
+    secure_zero(&context->inline_values[last], sizeof(EventInlineValue));
+
+    context->count--;
+}
+
+EventChainErrorCode event_context_remove(EventContext *context, const char *key) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+
+    if (context->persistent) {
+        return persistent_remove(context, key, context_key_hash(key));
+    }
+    if (context->concurrent) {
+        return concurrent_remove(context, key, context_key_hash(key));
+    }
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    size_t i = context_find(context, key, context_key_hash(key));
+    if (i == CONTEXT_NOT_FOUND) {
+        return EC_ERROR_NOT_FOUND;
+    }
+    if (context_entry_pinned(context, i)) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    /* Release ref-counted value */
+    RefCountedValue *node = context->values[i];
+    context_detach_entry(context, i);
+    if (node) {
+        context_value_drop(context, node);
+    }
+    return EC_SUCCESS;
+}
+
+typedef struct {
+    EventContextVisitFunc visit;
+    void *user_data;
+} ForeachArgs;
+
+static bool foreach_visit(const char *key, uint32_t hash, const ContextSlot *slot, void *arg) {
+    (void)hash;
+    const ForeachArgs *args = arg;
+    const void *value = slot->type == EVENT_VALUE_POINTER ? slot->data
+                                                          : (const void *)slot->inline_value;
+    return args->visit(key, (EventValueType)slot->type, value, args->user_data);
+}
+
+EventChainErrorCode event_context_foreach(
+    const EventContext *context,
+    EventContextVisitFunc visit,
+    void *user_data
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!visit) return EC_ERROR_NULL_POINTER;
+
+    ForeachArgs args = { visit, user_data };
+    context_walk(context, foreach_visit, &args);
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_index_prefixes(EventContext *context, bool enabled) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->persistent || context->concurrent || context->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    if (!enabled) {
+        context_prefix_destroy(context);
+        return EC_SUCCESS;
+    }
+    if (context->prefix_index) return EC_SUCCESS;
+
+    context->prefix_index = ec_calloc(1, sizeof(struct EventContextPrefixIndex));
+    if (!context->prefix_index) return EC_ERROR_OUT_OF_MEMORY;
+
+    for (size_t i = 0; i < context->count; i++) {
+        if (!context_prefix_reserve(context)) {
+            context_prefix_destroy(context);
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+        context_prefix_insert(context, context->keys[i]);
+    }
+    return EC_SUCCESS;
+}
+
+typedef struct {
+    const char *prefix;
+    size_t len;
+    EventContext *context;
+    ForeachArgs foreach;
+    size_t count;
+} PrefixArgs;
+
+/* Indexed keys: look the entry up, then report it as foreach would */
+static bool prefix_visit_entry(char *key, void *arg) {
+    PrefixArgs *args = arg;
+    uint32_t hash = context_key_hash(key);
+    ContextSlot slot;
+    if (!context_slot_at(args->context, context_find(args->context, key, hash), &slot)) {
+        return true;
+    }
+    return foreach_visit(key, hash, &slot, &args->foreach);
+}
+
+/* Unindexed contexts: every entry goes past the filter */
+static bool prefix_filter(const char *key, uint32_t hash, const ContextSlot *slot, void *arg) {
+    PrefixArgs *args = arg;
+    if (strncmp(key, args->prefix, args->len) != 0) return true;
+    return foreach_visit(key, hash, slot, &args->foreach);
+}
+
+EventChainErrorCode event_context_iterate_prefix(
+    const EventContext *context,
+    const char *prefix,
+    EventContextVisitFunc visit,
+    void *user_data
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!prefix) return EC_ERROR_NULL_POINTER;
+    if (!visit) return EC_ERROR_NULL_POINTER;
+
+    PrefixArgs args = { prefix, strlen(prefix), (EventContext *)context, { visit, user_data }, 0 };
+    if (!context->prefix_index) {
+        context_walk(context, prefix_filter, &args);
+        return EC_SUCCESS;
+    }
+
+    PrefixRef top, above;
+    int dir;
+    if (context_prefix_find(context->prefix_index, prefix, args.len, &top, &above, &dir)) {
+        prefix_walk(*top.slot, prefix_ref_is_key(top), prefix_visit_entry, &args);
+    }
+    return EC_SUCCESS;
+}
+
+static bool prefix_check_pinned(char *key, void *arg) {
+    PrefixArgs *args = arg;
+    size_t i = context_find(args->context, key, context_key_hash(key));
+    return !context_entry_pinned(args->context, i);
+}
+
+/* Subtree already out of the tree: drop the entry without touching it */
+static bool prefix_remove_entry(char *key, void *arg) {
+    PrefixArgs *args = arg;
+    EventContext *context = args->context;
+    size_t i = context_find(context, key, context_key_hash(key));
+
+    RefCountedValue *node = context->values[i];
+    context_detach_entry(context, i);
+    if (node) {
+        context_value_drop(context, node);
+    }
+    args->count++;
+    return true;
+}
+
+/* Shared backends are walked as a snapshot, so removing as we go is safe */
+static bool prefix_remove_shared(const char *key, uint32_t hash, const ContextSlot *slot, void *arg) {
+    (void)slot;
+    PrefixArgs *args = arg;
+    if (strncmp(key, args->prefix, args->len) != 0) return true;
+
+    EventChainErrorCode err = args->context->persistent
+                              ? persistent_remove(args->context, key, hash)
+                              : concurrent_remove(args->context, key, hash);
+    if (err == EC_SUCCESS) args->count++;
+    return true;
+}
+
+EventChainErrorCode event_context_remove_prefix(
+    EventContext *context,
+    const char *prefix,
+    size_t *removed_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!prefix) return EC_ERROR_NULL_POINTER;
+    if (removed_out) *removed_out = 0;
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    PrefixArgs args = { prefix, strlen(prefix), context, { NULL, NULL }, 0 };
+
+    if (context->persistent || context->concurrent) {
+        context_walk(context, prefix_remove_shared, &args);
+        if (removed_out) *removed_out = args.count;
+        return EC_SUCCESS;
+    }
+
+    struct EventContextPrefixIndex *index = context->prefix_index;
+    if (!index) {
+        /* Nothing goes unless everything can */
+        for (size_t i = 0; i < context->count; i++) {
+            if (strncmp(context->keys[i], prefix, args.len) == 0 &&
+                context_entry_pinned(context, i)) {
+                return EC_ERROR_INVALID_PARAMETER;
+            }
+        }
+        /* Swap-remove refills i from the end, which was already checked */
+        for (size_t i = context->count; i-- > 0;) {
+            if (strncmp(context->keys[i], prefix, args.len) == 0) {
+                prefix_remove_entry(context->keys[i], &args);
+            }
+        }
+        if (removed_out) *removed_out = args.count;
+        return EC_SUCCESS;
+    }
+
+    PrefixRef top, above;
+    int dir;
+    if (!context_prefix_find(index, prefix, args.len, &top, &above, &dir)) {
+        return EC_SUCCESS;
+    }
+    void *subtree = *top.slot;
+    bool subtree_is_key = prefix_ref_is_key(top);
+    if (!prefix_walk(subtree, subtree_is_key, prefix_check_pinned, &args)) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    /* Cut the whole subtree loose, then drop its entries with the index set aside */
+    if (above.slot) {
+        prefix_unlink(index, above, dir);
+    } else {
+        prefix_ref_set(top, NULL, false);
+    }
+    context->prefix_index = NULL;
+    prefix_walk(subtree, subtree_is_key, prefix_remove_entry, &args);
+    context->prefix_index = index;
+    prefix_free_nodes(subtree, subtree_is_key);
+
+    if (removed_out) *removed_out = args.count;
+    return EC_SUCCESS;
+}
+
+size_t event_context_count(const EventContext *context) {
+    if (!context) return 0;
+    return __atomic_load_n(&context->count, __ATOMIC_RELAXED);
+}
+
+size_t event_context_memory_usage(const EventContext *context) {
+    if (!context) return 0;
+    return __atomic_load_n(&context->total_memory_bytes, __ATOMIC_RELAXED);
+}
+
+EventChainErrorCode event_context_set_sized(
+    EventContext *context,
+    const char *key,
+    void *value,
+    size_t size,
+    ValueCleanupFunc cleanup
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!value && size > 0) return EC_ERROR_NULL_POINTER;
+
+    /* Validate key length */
+    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
+    if (key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+        return EC_ERROR_KEY_TOO_LONG;
+    }
+    if (key_len == 0) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    /* Other backends account for leaves, not value bytes */
+    if (context->persistent || context->concurrent || context->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    uint32_t hash = context_key_hash(key);
+    size_t entry = context_find(context, key, hash);
+    size_t needed;
+    if (!safe_add(sizeof(RefCountedValue), size, &needed)) {
+        return EC_ERROR_OVERFLOW;
+    }
+    if (entry == CONTEXT_NOT_FOUND) {
+        if (!safe_add(needed, key_len + 1, &needed)) return EC_ERROR_OVERFLOW;
+    } else {
+        /* An overwrite keeps its key and gives back the old value's bytes */
+        const RefCountedValue *existing = context->values[entry];
+        size_t freed = existing ? context_value_memory(existing) : 0;
+        needed = needed > freed ? needed - freed : 0;
+    }
+
+    /* Make room by spilling older values; if that isn't enough, spill this one */
+    bool fits = !context->spill || context_spill_make_room(context, needed, entry);
+    RefCountedValue *node;
+    if (fits) {
+        node = context_value_create(context, value, cleanup);
+    } else {
+        void *mapped = spill_write(context->spill, value, size);
+        if (!mapped) return EC_ERROR_MEMORY_LIMIT_EXCEEDED;
+        node = context_value_create(context, mapped, NULL);
+        if (!node) context->spill->spilled_bytes -= size;
+    }
+    if (!node) return EC_ERROR_OUT_OF_MEMORY;
+    node->size = size;
+    node->spilled = !fits;
+    node->stamp = context->spill ? ++context->spill->clock : 0;
+
+    EventChainErrorCode err = entry != CONTEXT_NOT_FOUND
+        ? context_replace_value(context, entry, NULL, NULL, node)
+        : context_insert(context, key, key_len, hash, EVENT_VALUE_POINTER, NULL, NULL, node, NULL);
+    if (err != EC_SUCCESS) {
+        /* Never stored: the caller keeps the value */
+        if (node->spilled) context->spill->spilled_bytes -= size;
+        node->cleanup = NULL;
+        ref_counted_value_release(node);
+        return err;
+    }
+
+    /* A spilled copy replaces the caller's buffer right away */
+    if (node->spilled && cleanup) {
+        cleanup(value);
+    }
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_enable_spill(
+    EventContext *context,
+    const char *directory,
+    size_t budget
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->persistent || context->concurrent || context->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    if (budget == 0 || budget > EVENTCHAINS_MAX_CONTEXT_MEMORY) {
+        budget = EVENTCHAINS_MAX_CONTEXT_MEMORY;
+    }
+    if (context->spill) {
+        context->spill->budget = budget;
+        return EC_SUCCESS;
+    }
+
+    if (!directory) {
+        directory = getenv("TMPDIR");
+        if (!directory || directory[0] == '\0') directory = "/tmp";
+    }
+
+    static const char name[] = "/eventchains-spill-XXXXXX";
+    size_t dir_len = strlen(directory);
+    char *path = ec_malloc(dir_len + sizeof(name));
+    if (!path) return EC_ERROR_OUT_OF_MEMORY;
+    memcpy(path, directory, dir_len);
+    memcpy(path + dir_len, name, sizeof(name));
+
+    /* Unlinked at once: the file goes away with the descriptor */
+    int fd = mkstemp(path);
+    if (fd >= 0) unlink(path);
+    ec_free(path);
+    if (fd < 0) return EC_ERROR_INVALID_PARAMETER;
+
+    struct EventContextSpill *spill = ec_calloc(1, sizeof(struct EventContextSpill));
+    if (!spill || !spill_links_reserve(spill, context->capacity)) {
+        ec_free(spill);
+        close(fd);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    spill->fd = fd;
+    spill->budget = budget;
+    spill->oldest = spill->newest = CONTEXT_NOT_FOUND;
+    context->spill = spill;
+
+    /* Sized values stored before now spill first, in entry order */
+    for (size_t i = 0; i < context->count; i++) {
+        context_spill_track(context, i);
+    }
+    return EC_SUCCESS;
+}
+
+size_t event_context_spilled_bytes(const EventContext *context) {
+    if (!context || !context->spill) return 0;
+    return context->spill->spilled_bytes;
+}
+
+static bool context_log_cleared(const char *key, uint32_t hash, const ContextSlot *slot, void *arg) {
+    (void)slot;
+    context_log_change(arg, key, hash);
+    return true;
+}
+
+void event_context_clear(EventContext *context) {
+    if (!context || context->mapped) return;
+
+    if (context->record_changes) {
+        context_walk(context, context_log_cleared, context);
+    }
+    context_scope_discard(context);
+
+    if (context->persistent) {
+        if (!context_epoch_defer(context, context->hamt_root)) {
+            hamt_node_release(context->hamt_root);
+        }
+        context->hamt_root = NULL;
+        context->count = 0;
+        context->total_memory_bytes = sizeof(EventContext);
+        return;
+    }
+
+    if (context->concurrent) {
+        concurrent_clear(context);
+        return;
+    }
+
+    /* Release all entries */
+    context_release_entries(context);
+    context_spill_reset(context);
+
+    if (context->arena_chunks) {
+        context_epoch_evacuate_arena(context);
+
+        /* Drop every chunk but the first, which holds the context */
+        struct EventContextArenaChunk *first = context->arena_chunks;
+        while (first->next) {
+            first = first->next;
+        }
+        context_arena_seal(context);
+        context_arena_release(context->arena_chunks, first);
+
+        unsigned char *first_used_end = (unsigned char *)first + CONTEXT_ARENA_HEADER + first->used;
+        context->arena_chunks = first;
+        context->arena_cursor = context->arena_reset;
+        context->arena_limit = (unsigned char *)first + CONTEXT_ARENA_HEADER + first->size;
+        secure_zero(context->arena_cursor, (size_t)(first_used_end - context->arena_cursor));
+
+        /* Cannot fail: the first chunk was sized for it */
+        context_init_arrays(context, context->arena_reset_capacity);
+        context->count = 0;
+        context->total_memory_bytes = sizeof(EventContext) +
+                                      context_array_memory(context->capacity) +
+                                      context->key_slot_count * sizeof(uint32_t);
+        return;
+    }
+
+    for (size_t i = 0; i < context->count; i++) {
+        context->key_hashes[i] = 0;
+        context->entry_keys[i] = EVENT_CONTEXT_KEY_INVALID;
+        context->value_types[i] = EVENT_VALUE_POINTER;
+        secure_zero(&context->inline_values[i], sizeof(EventInlineValue));
+    }
+
+    /* Reset counters but keep arrays allocated */
+    context->count = 0;
+    memset(context->index_slots, 0, (context->index_mask + 1) * sizeof(uint32_t));
+    context->total_memory_bytes = sizeof(EventContext) +
+                                  context_array_memory(context->capacity) +
+                                  context->key_slot_count * sizeof(uint32_t);
+}
+
+EventChainErrorCode event_context_push_scope(EventContext *context) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->concurrent || context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    if (context->scope_depth >= CONTEXT_SCOPE_MAX_DEPTH) {
+        return EC_ERROR_OVERFLOW;
+    }
+    struct EventContextScope *scopes = scope_array_reserve(
+        context->scopes, &context->scope_capacity,
+        context->scope_depth, sizeof(struct EventContextScope));
+    if (!scopes) return EC_ERROR_OUT_OF_MEMORY;
+    context->scopes = scopes;
+
+    struct EventContextScope *scope = &context->scopes[context->scope_depth++];
+    scope->base = context->count;
+    scope->first_save = context->scope_save_count;
+    scope->root = NULL;
+    scope->count = context->count;
+    scope->memory_bytes = context->total_memory_bytes;
+    scope->version = context->version;
+
+    /* A persistent context's snapshot is its root */
+    if (context->persistent && context->hamt_root) {
+        hamt_retain(context->hamt_root);
+        scope->root = context->hamt_root;
+    }
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_pop_scope(EventContext *context) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->scope_depth == 0) return EC_ERROR_INVALID_PARAMETER;
+
+    struct EventContextScope *scope = &context->scopes[--context->scope_depth];
+
+    if (context->persistent) {
+        if (!context_epoch_defer(context, context->hamt_root)) {
+            hamt_node_release(context->hamt_root);
+        }
+        context->hamt_root = scope->root;
+        context->count = scope->count;
+        context->total_memory_bytes = scope->memory_bytes;
+        scope->root = NULL;
+        context_changes_relog(context, scope->version);
+        return EC_SUCCESS;
+    }
+
+    /* The scope's own entries sit at the end, so dropping them moves nothing */
+    while (context->count > scope->base) {
+        size_t last = context->count - 1;
+        RefCountedValue *node = context->values[last];
+        context_detach_entry(context, last);
+        if (node) {
+            context_value_drop(context, node);
+        }
+    }
+
+    /* Put back what the scope overwrote (each entry is journaled once) */
+    for (size_t i = context->scope_save_count; i-- > scope->first_save;) {
+        struct EventContextScopeSave *save = &context->scope_saves[i];
+        size_t entry = save->entry;
+
+        if (context->values[entry]) {
+            context->total_memory_bytes -= context_value_memory(context->values[entry]);
+            context_value_drop(context, context->values[entry]);
+        }
+        context->values[entry] = save->value;
+        context->value_types[entry] = save->type;
+        context->inline_values[entry] = save->inline_value;
+        if (save->value) {
+            context->total_memory_bytes += context_value_memory(save->value);
+        }
+        context_spill_track(context, entry);
+        secure_zero(save, sizeof(*save));
+    }
+    context->scope_save_count = scope->first_save;
+    context_changes_relog(context, scope->version);
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_record_changes(EventContext *context, bool enabled) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (context->concurrent || context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    if (enabled && !context->record_changes) {
+        /* Nothing was logged until now: no earlier cursor can be served */
+        context->record_changes = true;
+        context->version++;
+        context_changes_drop(context);
+    } else if (!enabled && context->record_changes) {
+        context->record_changes = false;
+        context_changes_drop(context);
+        ec_free(context->changes);
+        ec_free(context->change_keys);
+        context->changes = NULL;
+        context->change_keys = NULL;
+        context->change_capacity = 0;
+        context->change_keys_capacity = 0;
+    }
+    return EC_SUCCESS;
+}
+
+uint64_t event_context_version(const EventContext *context) {
+    if (!context) return 0;
+    return context->version;
+}
+
+EventChainErrorCode event_context_changes_since(
+    const EventContext *context,
+    uint64_t version,
+    EventContextChangeFunc visit,
+    void *user_data
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!visit) return EC_ERROR_NULL_POINTER;
+    if (!context->record_changes || version < context->change_base) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    size_t first = context->change_count;
+    while (first > 0 && context->changes[first - 1].version > version) {
+        first--;
+    }
+    if (first == context->change_count) return EC_SUCCESS;
+
+    /* Newest first, so each key is reported once, at its latest change */
+    size_t seen_size = context_index_size(context->change_count - first);
+    size_t *seen = ec_calloc(seen_size, sizeof(size_t));
+    if (!seen) return EC_ERROR_OUT_OF_MEMORY;
+
+    for (size_t i = context->change_count; i-- > first;) {
+        const struct EventContextChangeRecord *record = &context->changes[i];
+        const char *key = context->change_keys + record->key_offset;
+
+        size_t slot = record->hash & (seen_size - 1);
+        bool reported = false;
+        while (seen[slot] != 0) {
+            const struct EventContextChangeRecord *newer = &context->changes[seen[slot] - 1];
+            if (newer->hash == record->hash &&
+                strcmp(context->change_keys + newer->key_offset, key) == 0) {
+                reported = true;
+                break;
+            }
+            slot = (slot + 1) & (seen_size - 1);
+        }
+        if (reported) continue;
+        seen[slot] = i + 1;
+
+        ContextSlot current;
+        EventContextChange change;
+        change.key = key;
+        change.version = record->version;
+        change.removed = !context_lookup(context, key, record->hash, &current);
+        change.type = change.removed ? EVENT_VALUE_POINTER : (EventValueType)current.type;
+        change.value = change.removed ? NULL :
+                       current.type == EVENT_VALUE_POINTER ? current.data :
+                       (const void *)current.inline_value;
+        if (!visit(&change, user_data)) break;
+    }
+
+    ec_free(seen);
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_trim_changes(EventContext *context, uint64_t version) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!context->record_changes) return EC_ERROR_INVALID_PARAMETER;
+
+    /* A pop logs its scope's keys again from these records */
+    if (context->scope_depth > 0 && context->scopes[0].version < version) {
+        version = context->scopes[0].version;
+    }
+    if (version > context->version) {
+        version = context->version;
+    }
+    if (version <= context->change_base) return EC_SUCCESS;
+
+    size_t drop = 0;
+    while (drop < context->change_count && context->changes[drop].version <= version) {
+        drop++;
+    }
+    size_t keep = context->change_count - drop;
+    size_t key_shift = keep ? context->changes[drop].key_offset : context->change_keys_size;
+
+    memmove(context->changes, context->changes + drop,
+            keep * sizeof(struct EventContextChangeRecord));
+    memmove(context->change_keys, context->change_keys + key_shift,
+            context->change_keys_size - key_shift);
+    for (size_t i = 0; i < keep; i++) {
+        context->changes[i].key_offset -= key_shift;
+    }
+
+    context->change_count = keep;
+    context->change_keys_size -= key_shift;
+    context->change_base = version;
+    return EC_SUCCESS;
+}
+
+/* ==================== EventContext Pool ==================== */
+
+#define CONTEXT_POOL_DEFAULT_IDLE 16
+
+struct EventContextPool {
+    pthread_mutex_t lock;
+    EventContext **idle;
+    size_t idle_count;
+    size_t max_idle;
+    size_t high_water_capacity;     /* Largest entry capacity released */
+    size_t high_water_bytes;        /* Largest arena footprint released */
+};
+
+/**
+ * Arena bytes a context has used across all of its chunks
+ */
+static size_t context_arena_footprint(EventContext *context) {
+    context_arena_seal(context);
+
+    size_t used = 0;
+    for (struct EventContextArenaChunk *chunk = context->arena_chunks; chunk; chunk = chunk->next) {
+        used += chunk->used;
+    }
+    return used;
+}
+
+static size_t context_arena_first_chunk_size(const EventContext *context) {
+    const struct EventContextArenaChunk *first = context->arena_chunks;
+    while (first->next) {
+        first = first->next;
+    }
+    return first->size;
+}
+
+EventContextPool *event_context_pool_create(size_t max_idle) {
+    if (max_idle == 0) {
+        max_idle = CONTEXT_POOL_DEFAULT_IDLE;
+    }
+
+    EventContextPool *pool = ec_calloc(1, sizeof(EventContextPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->idle = ec_calloc(max_idle, sizeof(EventContext *));
+    if (!pool->idle || pthread_mutex_init(&pool->lock, NULL) != 0) {
+        ec_free(pool->idle);
+        ec_free(pool);
+        return NULL;
+    }
+
+    pool->max_idle = max_idle;
+    pool->high_water_capacity = INITIAL_CAPACITY;
+    return pool;
+}
+
+void event_context_pool_destroy(EventContextPool *pool) {
+    if (!pool) return;
+
+    for (size_t i = 0; i < pool->idle_count; i++) {
+        event_context_destroy(pool->idle[i]);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    ec_free(pool->idle);
+    secure_zero(pool, sizeof(EventContextPool));
+    ec_free(pool);
+}
+
+EventContext *event_context_pool_acquire(EventContextPool *pool) {
+    if (!pool) return NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    EventContext *context = pool->idle_count > 0 ? pool->idle[--pool->idle_count] : NULL;
+    size_t capacity = pool->high_water_capacity;
+    size_t bytes = pool->high_water_bytes;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (context) {
+        return context;
+    }
+
+    /* Sized so that a request like the largest seen so far fits in one chunk */
+    return context_create_arena_sized(0, CONTEXT_ARENA_ROUND(sizeof(EventContext)) + bytes, capacity);
+}
+
+void event_context_pool_release(EventContextPool *pool, EventContext *context) {
+    if (!context) return;
+    if (!pool || !context->arena_chunks) {
+        event_context_destroy(context);
+        return;
+    }
+
+    size_t capacity = context->capacity;
+    size_t bytes = context_arena_footprint(context);
+    size_t first_chunk = context_arena_first_chunk_size(context);
+    size_t reset_capacity = context->arena_reset_capacity;
+
+    event_context_record_changes(context, false);
+    event_context_clear(context);
+    context_spill_destroy(context);
+    context_prefix_destroy(context);
+    context->cleanup_queue = NULL;
+
+    bool keep = false;
+    pthread_mutex_lock(&pool->lock);
+    if (capacity > pool->high_water_capacity) {
+        pool->high_water_capacity = capacity;
+    }
+    if (bytes > pool->high_water_bytes) {
+        pool->high_water_bytes = bytes;
+    }
+
+    /* Undersized contexts are replaced by right-sized ones on acquire */
+    if (pool->idle_count < pool->max_idle &&
+        reset_capacity >= pool->high_water_capacity &&
+        first_chunk >= pool->high_water_bytes) {
+        pool->idle[pool->idle_count++] = context;
+        keep = true;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!keep) {
+        event_context_destroy(context);
+    }
+}
+
+/* ==================== Interned Keys ==================== */
+
+typedef struct {
+    char *name;                 /* Owned; lives for the whole process */
+    uint32_t hash;
+} InternedKey;
+
+/* Slot 0 is EVENT_CONTEXT_KEY_INVALID. Entries are immutable once published. */
+static InternedKey interned_keys[EVENTCHAINS_MAX_INTERNED_KEYS + 1];
+static uint32_t interned_key_count = 0;     /* Published count (atomic) */
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const InternedKey *interned_key_lookup(EventContextKey key) {
+    uint32_t count = __atomic_load_n(&interned_key_count, __ATOMIC_ACQUIRE);
+    if (key == EVENT_CONTEXT_KEY_INVALID || key > count) {
+        return NULL;
+    }
+    return &interned_keys[key];
+}
+
+EventContextKey event_key_intern(const char *key) {
+    if (!key) return EVENT_CONTEXT_KEY_INVALID;
+
+    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
+    if (key_len == 0 || key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+        return EVENT_CONTEXT_KEY_INVALID;
+    }
+
+    uint32_t hash = context_key_hash(key);
+    EventContextKey result = EVENT_CONTEXT_KEY_INVALID;
+
+    pthread_mutex_lock(&intern_lock);
+
+    /* Interning runs at build time, so a scan is fine */
+    for (uint32_t i = 1; i <= interned_key_count; i++) {
+        if (interned_keys[i].hash == hash && strcmp(interned_keys[i].name, key) == 0) {
+            result = i;
+            break;
+        }
+    }
+
+    if (result == EVENT_CONTEXT_KEY_INVALID && interned_key_count < EVENTCHAINS_MAX_INTERNED_KEYS) {
+        char *name = ec_strndup(key, EVENTCHAINS_MAX_KEY_LENGTH);
+        if (name) {
+            result = interned_key_count + 1;
+            interned_keys[result].name = name;
+            interned_keys[result].hash = hash;
+            __atomic_store_n(&interned_key_count, result, __ATOMIC_RELEASE);
+        }
+    }
+
+    pthread_mutex_unlock(&intern_lock);
+    return result;
+}
+
+const char *event_key_name(EventContextKey key) {
+    const InternedKey *interned = interned_key_lookup(key);
+    return interned ? interned->name : NULL;
+}
+
+/**
+ * Remember which entry an interned key resolved to (best effort)
+ */
+static void context_bind_key(EventContext *context, EventContextKey key, size_t entry) {
+    if (key >= context->key_slot_count) {
+        /* Grow to cover every key interned so far */
+        size_t new_count = (size_t)__atomic_load_n(&interned_key_count, __ATOMIC_ACQUIRE) + 1;
+        if (new_count <= key) {
+            new_count = (size_t)key + 1;
+        }
+
+        uint32_t *new_slots = ec_realloc(context->key_slots, sizeof(uint32_t) * new_count);
+        if (!new_slots) {
+            return;  /* Stay unbound; lookups take the hashed path */
+        }
+
+        for (size_t i = context->key_slot_count; i < new_count; i++) {
+            new_slots[i] = 0;
+        }
+
+        context->total_memory_bytes += (new_count - context->key_slot_count) * sizeof(uint32_t);
+        context->key_slots = new_slots;
+        context->key_slot_count = new_count;
+    }
+
+    context->key_slots[key] = (uint32_t)(entry + 1);
+    context->entry_keys[entry] = key;
+}
+
+/**
+ * Resolve an interned key: bound slot first, hashed lookup otherwise
+ */
+static size_t context_find_interned(
+    EventContext *context,
+    EventContextKey key,
+    const InternedKey *interned
+) {
+    if (key < context->key_slot_count) {
+        uint32_t bound = context->key_slots[key];
+
+        /* Bindings go stale across clear, so one is trusted only if it matches */
+        if (bound != 0 && bound - 1 < context->count && context->entry_keys[bound - 1] == key) {
+            return bound - 1;
+        }
+    }
+
+    size_t entry = context_find(context, interned->name, interned->hash);
+    if (entry != CONTEXT_NOT_FOUND) {
+        context_bind_key(context, key, entry);
+    }
+    return entry;
+}
+
+static bool context_lookup_k(
+    EventContext *context,
+    EventContextKey key,
+    const InternedKey *interned,
+    ContextSlot *slot
+) {
+    if (context->persistent || context->concurrent || context->mapped) {
+        return context_lookup(context, interned->name, interned->hash, slot);
+    }
+    return context_slot_at(context, context_find_interned(context, key, interned), slot);
+}
+
+EventChainErrorCode event_context_set_k(
+    EventContext *context,
+    EventContextKey key,
+    void *value
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+
+    const InternedKey *interned = interned_key_lookup(key);
+    if (!interned) return EC_ERROR_INVALID_PARAMETER;
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    if (context->persistent) {
+        return persistent_put(context, interned->name, strlen(interned->name), interned->hash,
+                              EVENT_VALUE_POINTER, value, NULL, NULL, NULL, 0);
+    }
+    if (context->concurrent) {
+        return concurrent_put(context, interned->name, strlen(interned->name), interned->hash,
+                              EVENT_VALUE_POINTER, value, NULL, NULL, NULL, 0);
+    }
+
+    size_t entry = context_find_interned(context, key, interned);
+    if (entry != CONTEXT_NOT_FOUND) {
+        return context_replace_value(context, entry, value, NULL, NULL);
+    }
+
+    EventChainErrorCode err = context_insert(
+        context, interned->name, strlen(interned->name), interned->hash,
+        EVENT_VALUE_POINTER, value, NULL, NULL, &entry);
+    if (err == EC_SUCCESS) {
+        context_bind_key(context, key, entry);
+    }
+    return err;
+}
+
+EventChainErrorCode event_context_get_k(
+    EventContext *context,
+    EventContextKey key,
+    void **value_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!value_out) return EC_ERROR_NULL_POINTER;
+
+    *value_out = NULL;
+
+    const InternedKey *interned = interned_key_lookup(key);
+    if (!interned) return EC_ERROR_INVALID_PARAMETER;
+
+    ContextSlot slot;
+    if (!context_lookup_k(context, key, interned, &slot)) {
+        return EC_ERROR_NOT_FOUND;
+    }
+
+    if (slot.type != EVENT_VALUE_POINTER) {
+        return EC_ERROR_TYPE_MISMATCH;
+    }
+
+    *value_out = slot.data;
+    return EC_SUCCESS;
+}
+
+/* ==================== Inline Typed Values ==================== */
+
+/**
+ * Overwrite an entry with an inline value, dropping any ref-counted one
+ */
+static EventChainErrorCode context_store_inline(
+    EventContext *context,
+    size_t entry,
+    EventValueType type,
+    const void *data,
+    size_t size
+) {
+    if (!context_scope_save(context, entry)) {
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (context->values[entry]) {
+        context->total_memory_bytes -= context_value_memory(context->values[entry]);
+        context_value_drop(context, context->values[entry]);
+        context->values[entry] = NULL;
+    }
+
+    EventInlineValue *slot = &context->inline_values[entry];
+    memcpy(slot->as.bytes, data, size);
+    slot->size = size;
+    context->value_types[entry] = (unsigned char)type;
+    context_log_change(context, context->keys[entry], context->key_hashes[entry]);
+    return EC_SUCCESS;
+}
+
+static EventChainErrorCode context_set_inline(
+    EventContext *context,
+    const char *key,
+    EventValueType type,
+    const void *data,
+    size_t size
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+
+    /* Validate key length */
+    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
+    if (key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+        return EC_ERROR_KEY_TOO_LONG;
+    }
+    if (key_len == 0) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    uint32_t hash = context_key_hash(key);
+
+    if (context->persistent) {
+        return persistent_put(context, key, key_len, hash, type, NULL, NULL, NULL, data, size);
+    }
+    if (context->concurrent) {
+        return concurrent_put(context, key, key_len, hash, type, NULL, NULL, NULL, data, size);
+    }
+
+    size_t entry = context_find(context, key, hash);
+    if (entry == CONTEXT_NOT_FOUND) {
+        EventChainErrorCode err = context_insert(
+            context, key, key_len, hash, type, NULL, NULL, NULL, &entry);
+        if (err != EC_SUCCESS) return err;
+    }
+
+    return context_store_inline(context, entry, type, data, size);
+}
+
+static EventChainErrorCode context_set_inline_k(
+    EventContext *context,
+    EventContextKey key,
+    EventValueType type,
+    const void *data,
+    size_t size
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+
+    const InternedKey *interned = interned_key_lookup(key);
+    if (!interned) return EC_ERROR_INVALID_PARAMETER;
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    if (context->persistent) {
+        return persistent_put(context, interned->name, strlen(interned->name), interned->hash,
+                              type, NULL, NULL, NULL, data, size);
+    }
+    if (context->concurrent) {
+        return concurrent_put(context, interned->name, strlen(interned->name), interned->hash,
+                              type, NULL, NULL, NULL, data, size);
+    }
+
+    size_t entry = context_find_interned(context, key, interned);
+    if (entry == CONTEXT_NOT_FOUND) {
+        EventChainErrorCode err = context_insert(
+            context, interned->name, strlen(interned->name), interned->hash,
+            type, NULL, NULL, NULL, &entry);
+        if (err != EC_SUCCESS) return err;
+        context_bind_key(context, key, entry);
+    }
+
+    return context_store_inline(context, entry, type, data, size);
+}
+
+/**
+ * Copy a scalar out of a located entry after checking its type
+ */
+static EventChainErrorCode context_read_inline(
+    bool found,
+    const ContextSlot *slot,
+    EventValueType type,
+    void *out,
+    size_t size
+) {
+    if (!found) return EC_ERROR_NOT_FOUND;
+    if (slot->type != type) return EC_ERROR_TYPE_MISMATCH;
+
+    memcpy(out, slot->inline_value->as.bytes, size);
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_set_i64(EventContext *context, const char *key, int64_t value) {
+    return context_set_inline(context, key, EVENT_VALUE_I64, &value, sizeof(value));
+}
+
+EventChainErrorCode event_context_set_f64(EventContext *context, const char *key, double value) {
+    return context_set_inline(context, key, EVENT_VALUE_F64, &value, sizeof(value));
+}
+
+EventChainErrorCode event_context_set_small(
+    EventContext *context,
+    const char *key,
+    const void *data,
+    size_t size
+) {
+    if (!data && size > 0) return EC_ERROR_NULL_POINTER;
+    if (size > EVENTCHAINS_SMALL_VALUE_SIZE) return EC_ERROR_INVALID_PARAMETER;
+    return context_set_inline(context, key, EVENT_VALUE_SMALL, data ? data : "", size);
+}
+
+EventChainErrorCode event_context_get_i64(
+    const EventContext *context,
+    const char *key,
+    int64_t *value_out
+) {
+    if (!context || !key || !value_out) return EC_ERROR_NULL_POINTER;
+    ContextSlot slot;
+    bool found = context_lookup(context, key, context_key_hash(key), &slot);
+    return context_read_inline(found, &slot, EVENT_VALUE_I64, value_out, sizeof(*value_out));
+}
+
+EventChainErrorCode event_context_get_f64(
+    const EventContext *context,
+    const char *key,
+    double *value_out
+) {
+    if (!context || !key || !value_out) return EC_ERROR_NULL_POINTER;
+    ContextSlot slot;
+    bool found = context_lookup(context, key, context_key_hash(key), &slot);
+    return context_read_inline(found, &slot, EVENT_VALUE_F64, value_out, sizeof(*value_out));
+}
+
+EventChainErrorCode event_context_get_small(
+    const EventContext *context,
+    const char *key,
+    const void **data_out,
+    size_t *size_out
+) {
+    if (!context || !key || !data_out || !size_out) return EC_ERROR_NULL_POINTER;
+
+    *data_out = NULL;
+    *size_out = 0;
+
+    ContextSlot slot;
+    if (!context_lookup(context, key, context_key_hash(key), &slot)) return EC_ERROR_NOT_FOUND;
+    if (slot.type != EVENT_VALUE_SMALL) return EC_ERROR_TYPE_MISMATCH;
+
+    *data_out = context->mapped ? slot.mapped_bytes : slot.stored->as.bytes;
+    *size_out = slot.inline_value->size;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_get_type(
+    const EventContext *context,
+    const char *key,
+    EventValueType *type_out
+) {
+    if (!context || !key || !type_out) return EC_ERROR_NULL_POINTER;
+
+    ContextSlot slot;
+    if (!context_lookup(context, key, context_key_hash(key), &slot)) return EC_ERROR_NOT_FOUND;
+
+    *type_out = (EventValueType)slot.type;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_set_i64_k(EventContext *context, EventContextKey key, int64_t value) {
+    return context_set_inline_k(context, key, EVENT_VALUE_I64, &value, sizeof(value));
+}
+
+EventChainErrorCode event_context_get_i64_k(EventContext *context, EventContextKey key, int64_t *value_out) {
+    if (!context || !value_out) return EC_ERROR_NULL_POINTER;
+
+    const InternedKey *interned = interned_key_lookup(key);
+    if (!interned) return EC_ERROR_INVALID_PARAMETER;
+
+    ContextSlot slot;
+    bool found = context_lookup_k(context, key, interned, &slot);
+    return context_read_inline(found, &slot, EVENT_VALUE_I64, value_out, sizeof(*value_out));
+}
+
+EventChainErrorCode event_context_set_f64_k(EventContext *context, EventContextKey key, double value) {
+    return context_set_inline_k(context, key, EVENT_VALUE_F64, &value, sizeof(value));
+}
+
+EventChainErrorCode event_context_get_f64_k(EventContext *context, EventContextKey key, double *value_out) {
+    if (!context || !value_out) return EC_ERROR_NULL_POINTER;
+
+    const InternedKey *interned = interned_key_lookup(key);
+    if (!interned) return EC_ERROR_INVALID_PARAMETER;
+
+    ContextSlot slot;
+    bool found = context_lookup_k(context, key, interned, &slot);
+    return context_read_inline(found, &slot, EVENT_VALUE_F64, value_out, sizeof(*value_out));
+}
+
+/* ==================== Value Transfer ==================== */
+
+/**
+ * Store under an already validated key, whichever backend holds the
+ * context
+ *
+ * Pointer values are wrapped from value/cleanup/codec, or adopt (the
+ * caller's reference) is stored as is; adopt is only for heap/arena
+ * contexts. Inline values are copied from inline_value.
+ */
+static EventChainErrorCode context_put(
+    EventContext *context,
+    const char *key,
+    size_t key_len,
+    uint32_t hash,
+    EventValueType type,
+    void *value,
+    ValueCleanupFunc cleanup,
+    const EventValueCodec *codec,
+    RefCountedValue *adopt,
+    const EventInlineValue *inline_value
+) {
+    const void *data = inline_value ? inline_value->as.bytes : NULL;
+    size_t size = inline_value ? inline_value->size : 0;
+
+    if (context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    if (context->persistent) {
+        return persistent_put(context, key, key_len, hash, type, value, cleanup, codec, data, size);
+    }
+    if (context->concurrent) {
+        return concurrent_put(context, key, key_len, hash, type, value, cleanup, codec, data, size);
+    }
+
+    size_t entry = context_find(context, key, hash);
+    if (type == EVENT_VALUE_POINTER) {
+        /* The array backend wraps values itself, so a codec needs its own node */
+        RefCountedValue *node = adopt;
+        if (!node && codec) {
+            node = context_value_create(context, value, cleanup);
+            if (!node) return EC_ERROR_OUT_OF_MEMORY;
+            node->codec = codec;
+        }
+
+        EventChainErrorCode err = entry != CONTEXT_NOT_FOUND
+            ? context_replace_value(context, entry, value, cleanup, node)
+            : context_insert(context, key, key_len, hash, type, value, cleanup, node, NULL);
+        if (err != EC_SUCCESS && node && !adopt) {
+            /* Never stored: the caller keeps the value */
+            node->cleanup = NULL;
+            ref_counted_value_release(node);
+        }
+        return err;
+    }
+
+    if (entry == CONTEXT_NOT_FOUND) {
+        EventChainErrorCode err = context_insert(
+            context, key, key_len, hash, type, NULL, NULL, NULL, &entry);
+        if (err != EC_SUCCESS) return err;
+    }
+    return context_store_inline(context, entry, type, data, size);
+}
+
+EventChainErrorCode event_context_take(
+    EventContext *context,
+    const char *key,
+    void **value_out,
+    ValueCleanupFunc *cleanup_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!value_out) return EC_ERROR_NULL_POINTER;
+
+    *value_out = NULL;
+    if (cleanup_out) *cleanup_out = NULL;
+
+    /* Snapshots and lock-free readers may still reach a shared backend's value */
+    if (context->persistent || context->concurrent || context->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    size_t i = context_find(context, key, context_key_hash(key));
+    if (i == CONTEXT_NOT_FOUND) return EC_ERROR_NOT_FOUND;
+    if (context->value_types[i] != EVENT_VALUE_POINTER) return EC_ERROR_TYPE_MISMATCH;
+    if (context_entry_pinned(context, i)) return EC_ERROR_INVALID_PARAMETER;
+
+    EventChainErrorCode err = context_spill_fault_in(context, i);
+    if (err != EC_SUCCESS) return err;
+
+    /*
+     * Ownership can only pass if nobody else holds the value, and only to
+     * a caller that accepts its cleanup.
+     */
+    RefCountedValue *node = context->values[i];
+    if (node && (ref_counted_value_get_count(node) != 1 || (node->cleanup && !cleanup_out))) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    if (node) {
+        *value_out = node->data;
+        if (cleanup_out) *cleanup_out = node->cleanup;
+
+        /* The node goes; its data now belongs to the caller */
+        node->cleanup = NULL;
+    }
+
+    context_detach_entry(context, i);
+    if (node) context_value_drop(context, node);
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_context_move(
+    EventContext *dst,
+    EventContext *src,
+    const char *key
+) {
+    if (!dst) return EC_ERROR_NULL_POINTER;
+    if (!src) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+
+    if (src->persistent || src->concurrent || src->mapped) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    size_t i = context_find(src, key, context_key_hash(key));
+    if (i == CONTEXT_NOT_FOUND) return EC_ERROR_NOT_FOUND;
+    if (dst == src) return EC_SUCCESS;
+    if (context_entry_pinned(src, i)) return EC_ERROR_INVALID_PARAMETER;
+
+    /* Spilled bytes live in src's file */
+    EventChainErrorCode err = context_spill_fault_in(src, i);
+    if (err != EC_SUCCESS) return err;
+
+    /* The source entry already holds a validated key and its hash */
+    const char *name = src->keys[i];
+    size_t key_len = strlen(name);
+    uint32_t hash = src->key_hashes[i];
+    EventValueType type = (EventValueType)src->value_types[i];
+    RefCountedValue *node = src->values[i];
+    RefCountedValue *emptied = NULL;
+
+    if (type != EVENT_VALUE_POINTER) {
+        err = context_put(dst, name, key_len, hash, type, NULL, NULL, NULL, NULL, &src->inline_values[i]);
+    } else if (node && !node->arena_owned && !dst->persistent && !dst->concurrent) {
+        /* Hand the node itself over: no copy, no count change */
+        err = context_put(dst, name, key_len, hash, type, NULL, NULL, NULL, node, NULL);
+    } else {
+        /*
+         * The node can't change hands (it lives in src's arena, or dst's
+         * backend wraps values itself), so the data moves instead. That
+         * needs the only reference.
+         */
+        if (node && ref_counted_value_get_count(node) != 1) {
+            return EC_ERROR_INVALID_PARAMETER;
+        }
+        err = context_put(dst, name, key_len, hash, type,
+                          ref_counted_value_get_data(node), node ? node->cleanup : NULL,
+                          node ? node->codec : NULL, NULL, NULL);
+        if (err == EC_SUCCESS && node) {
+            node->cleanup = NULL;
+            emptied = node;
+        }
+    }
+    if (err != EC_SUCCESS) return err;
+
+    context_detach_entry(src, i);
+    if (emptied) context_value_drop(src, emptied);
+    return EC_SUCCESS;
+}
+
+/* ==================== Serialization ==================== */
+
+/* Published in order and never removed, so readers need no lock */
+static const EventValueCodec *codecs[EVENTCHAINS_MAX_CODECS];
+static size_t codec_count = 0;              /* Published count (atomic) */
+static pthread_mutex_t codec_lock = PTHREAD_MUTEX_INITIALIZER;
+
+EventChainErrorCode event_codec_register(const EventValueCodec *codec) {
+    if (!codec || !codec->name) return EC_ERROR_NULL_POINTER;
+    if (!codec->encode || !codec->decode) return EC_ERROR_INVALID_FUNCTION_POINTER;
+
+    size_t name_len = safe_strnlen(codec->name, EVENTCHAINS_MAX_NAME_LENGTH + 1);
+    if (name_len > EVENTCHAINS_MAX_NAME_LENGTH) return EC_ERROR_NAME_TOO_LONG;
+    if (name_len == 0) return EC_ERROR_INVALID_PARAMETER;
+
+    EventChainErrorCode err = EC_SUCCESS;
+    pthread_mutex_lock(&codec_lock);
+
+    const EventValueCodec *existing = event_codec_find(codec->name);
+    if (existing) {
+        err = existing == codec ? EC_SUCCESS : EC_ERROR_INVALID_PARAMETER;
+    } else if (codec_count >= EVENTCHAINS_MAX_CODECS) {
+        err = EC_ERROR_CAPACITY_EXCEEDED;
+    } else {
+        codecs[codec_count] = codec;
+        __atomic_store_n(&codec_count, codec_count + 1, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&codec_lock);
+    return err;
+}
+
+const EventValueCodec *event_codec_find(const char *name) {
+    if (!name) return NULL;
+
+    /* A handful of codecs per process, so a scan is fine */
+    size_t count = __atomic_load_n(&codec_count, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(codecs[i]->name, name) == 0) {
+            return codecs[i];
+        }
+    }
+    return NULL;
+}
+
+EventChainErrorCode event_context_set_with_codec(
+    EventContext *context,
+    const char *key,
+    void *value,
+    const EventValueCodec *codec
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!codec) return EC_ERROR_NULL_POINTER;
+
+    /* Validate key length */
+    size_t key_len = safe_strnlen(key, EVENTCHAINS_MAX_KEY_LENGTH + 1);
+    if (key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+        return EC_ERROR_KEY_TOO_LONG;
+    }
+    if (key_len == 0) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
+
+    return context_put(context, key, key_len, context_key_hash(key), EVENT_VALUE_POINTER,
+                       value, codec->cleanup, codec, NULL, NULL);
+}
+
+/* ---- Writing images ---- */
+
+static size_t image_align(size_t offset) {
+    return (offset + CONTEXT_IMAGE_ALIGN - 1) & ~(CONTEXT_IMAGE_ALIGN - 1);
+}
+
+/*
+ * Records and bytes gathered by one walk. Offsets in records are relative
+ * to the data area until the layout is known; the first key sits at 0,
+ * so a codec_offset of 0 still means "no codec".
+ */
+typedef struct {
+    ContextImageEntry *entries;
+    size_t count;
+    size_t capacity;
+    unsigned char *data;
+    size_t data_size;
+    size_t data_capacity;
+    const EventValueCodec *last_codec;  /* Names are written once per run */
+    uint64_t last_codec_offset;
+    EventChainErrorCode err;
+} ImageWriter;
+
+/**
+ * Reserve size bytes (8-byte aligned) in the data area
+ *
+ * @return Their offset, or SIZE_MAX (with writer->err set) on failure
+ */
+static size_t image_writer_reserve(ImageWriter *writer, size_t size) {
+    size_t offset = image_align(writer->data_size);
+    if (size > SIZE_MAX - CONTEXT_IMAGE_ALIGN - offset) {
+        writer->err = EC_ERROR_OVERFLOW;
+        return SIZE_MAX;
+    }
+
+    if (offset + size > writer->data_capacity) {
+        size_t capacity = writer->data_capacity ? writer->data_capacity : 256;
+        while (capacity < offset + size) {
+            capacity = capacity > SIZE_MAX / 2 ? offset + size : capacity * 2;
+        }
+        unsigned char *data = ec_realloc(writer->data, capacity);
+        if (!data) {
+            writer->err = EC_ERROR_OUT_OF_MEMORY;
+            return SIZE_MAX;
+        }
+        writer->data = data;
+        writer->data_capacity = capacity;
+    }
+
+    memset(writer->data + writer->data_size, 0, offset + size - writer->data_size);
+    writer->data_size = offset + size;
+    return offset;
+}
+
+static size_t image_writer_string(ImageWriter *writer, const char *s, size_t len) {
+    size_t offset = image_writer_reserve(writer, len + 1);
+    if (offset != SIZE_MAX) {
+        memcpy(writer->data + offset, s, len + 1);
+    }
+    return offset;
+}
+
+/**
+ * Encode a pointer value into the data area
+ */
+static bool image_writer_encode(ImageWriter *writer, ContextImageEntry *record,
+                                const EventValueCodec *codec, const void *data) {
+    size_t size = codec->encode(data, NULL, 0);
+    if (size == SIZE_MAX) {
+        writer->err = EC_ERROR_INVALID_PARAMETER;
+        return false;
+    }
+
+    size_t offset = image_writer_reserve(writer, size);
+    if (offset == SIZE_MAX) return false;
+    if (codec->encode(data, writer->data + offset, size) != size) {
+        writer->err = EC_ERROR_INVALID_PARAMETER;
+        return false;
+    }
+
+    if (codec != writer->last_codec) {
+        size_t name_offset = image_writer_string(writer, codec->name, strlen(codec->name));
+        if (name_offset == SIZE_MAX) return false;
+        writer->last_codec = codec;
+        writer->last_codec_offset = name_offset;
+    }
+
+    record->codec_offset = writer->last_codec_offset;
+    record->value_offset = offset;
+    record->value_size = size;
+    return true;
+}
+
+static bool image_writer_visit(const char *key, uint32_t hash, const ContextSlot *slot, void *arg) {
+    ImageWriter *writer = arg;
+
+    if (writer->count == writer->capacity) {
+        size_t capacity = writer->capacity ? writer->capacity * 2 : INITIAL_CAPACITY;
+        if (capacity > UINT32_MAX / 2) {
+            writer->err = EC_ERROR_OVERFLOW;
+            return false;
+        }
+        ContextImageEntry *entries = ec_realloc(writer->entries, capacity * sizeof(ContextImageEntry));
+        if (!entries) {
+            writer->err = EC_ERROR_OUT_OF_MEMORY;
+            return false;
+        }
+        writer->entries = entries;
+        writer->capacity = capacity;
+    }
+
+    ContextImageEntry *record = &writer->entries[writer->count];
+    memset(record, 0, sizeof(*record));
+
+    size_t key_len = strlen(key);
+    size_t key_offset = image_writer_string(writer, key, key_len);
+    if (key_offset == SIZE_MAX) return false;
+    record->key_offset = key_offset;
+    record->key_len = (uint32_t)key_len;
+    record->hash = hash;
+    record->type = slot->type;
+
+    switch ((EventValueType)slot->type) {
+        case EVENT_VALUE_POINTER: {
+            const EventValueCodec *codec = slot->value ? slot->value->codec : NULL;
+            if (slot->data && !codec) {
+                /* Nothing knows how to write it */
+                writer->err = EC_ERROR_TYPE_MISMATCH;
+                return false;
+            }
+            if (slot->data && !image_writer_encode(writer, record, codec, slot->data)) {
+                return false;
+            }
+            break;
+        }
+        case EVENT_VALUE_I64:
+            record->scalar.i64 = slot->inline_value->as.i64;
+            break;
+        case EVENT_VALUE_F64:
+            record->scalar.f64 = slot->inline_value->as.f64;
+            break;
+        case EVENT_VALUE_SMALL: {
+            size_t size = slot->inline_value->size;
+            size_t offset = image_writer_reserve(writer, size);
+            if (offset == SIZE_MAX) return false;
+            memcpy(writer->data + offset, slot->inline_value->as.bytes, size);
+            record->value_offset = offset;
+            record->value_size = size;
+            break;
+        }
+    }
+
+    writer->count++;
+    return true;
+}
+
+EventChainErrorCode event_context_serialize(
+    const EventContext *context,
+    void **image_out,
+    size_t *size_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!image_out) return EC_ERROR_NULL_POINTER;
+    if (!size_out) return EC_ERROR_NULL_POINTER;
+
+    *image_out = NULL;
+    *size_out = 0;
+
+    ImageWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.err = EC_SUCCESS;
+    context_walk(context, image_writer_visit, &writer);
+
+    /* header | entries | index | data */
+    size_t index_slots = context_index_size(writer.count);
+    size_t entries_offset = image_align(sizeof(ContextImageHeader));
+    size_t index_offset = entries_offset + writer.count * sizeof(ContextImageEntry);
+    size_t data_offset = image_align(index_offset + index_slots * sizeof(uint32_t));
+    size_t size = image_align(data_offset + writer.data_size);
+
+    unsigned char *image = NULL;
+    if (writer.err == EC_SUCCESS) {
+        image = ec_malloc(size);
+        if (!image) writer.err = EC_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (image) {
+        memset(image, 0, data_offset);
+        memcpy(image + data_offset, writer.data, writer.data_size);
+        memset(image + data_offset + writer.data_size, 0, size - data_offset - writer.data_size);
+
+        ContextImageHeader *header = (ContextImageHeader *)image;
+        header->magic = CONTEXT_IMAGE_MAGIC;
+        header->version = CONTEXT_IMAGE_VERSION;
+        header->byte_order = CONTEXT_IMAGE_BYTE_ORDER;
+        header->count = (uint32_t)writer.count;
+        header->index_slots = (uint32_t)index_slots;
+        header->size = size;
+        header->entries_offset = entries_offset;
+        header->index_offset = index_offset;
+
+        ContextImageEntry *entries = (ContextImageEntry *)(image + entries_offset);
+        uint32_t *index = (uint32_t *)(image + index_offset);
+        size_t mask = index_slots - 1;
+        for (size_t i = 0; i < writer.count; i++) {
+            ContextImageEntry *record = &entries[i];
+            *record = writer.entries[i];
+            record->key_offset += data_offset;
+            if (record->codec_offset) record->codec_offset += data_offset;
+            if (record->value_size) record->value_offset += data_offset;
+
+            size_t slot = record->hash & mask;
+            while (index[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            index[slot] = (uint32_t)(i + 1);
+        }
+
+        *image_out = image;
+        *size_out = size;
+    }
+
+    ec_free(writer.entries);
+    ec_free(writer.data);
+    return writer.err;
+}
+
+void event_context_image_free(void *image) {
+    ec_free(image);
+}
+
+/* ---- Reading images ---- */
+
+/**
+ * Point view at an image after checking its header: O(1), nothing past
+ * the header is read
+ */
+static bool image_view_init(EventContext *view, const void *image, size_t size) {
+    if (!image || size < sizeof(ContextImageHeader)) return false;
+    if ((uintptr_t)image % CONTEXT_IMAGE_ALIGN != 0) return false;
+
+    const ContextImageHeader *header = image;
+    if (header->magic != CONTEXT_IMAGE_MAGIC || header->version != CONTEXT_IMAGE_VERSION ||
+        header->byte_order != CONTEXT_IMAGE_BYTE_ORDER) {
+        return false;
+    }
+    if (header->size < sizeof(ContextImageHeader) || header->size > size) return false;
+
+    /* Power of two with at least one empty slot, so probes end */
+    uint32_t slots = header->index_slots;
+    if (slots == 0 || (slots & (slots - 1)) != 0 || slots <= header->count) return false;
+
+    uint64_t image_size = header->size;
+    if (header->entries_offset % CONTEXT_IMAGE_ALIGN != 0 ||
+        header->entries_offset > image_size ||
+        header->count > (image_size - header->entries_offset) / sizeof(ContextImageEntry)) {
+        return false;
+    }
+    if (header->index_offset % sizeof(uint32_t) != 0 ||
+        header->index_offset > image_size ||
+        slots > (image_size - header->index_offset) / sizeof(uint32_t)) {
+        return false;
+    }
+
+    memset(view, 0, sizeof(*view));
+    view->mapped = true;
+    view->mapped_image = image;
+    view->mapped_size = (size_t)image_size;
+    view->count = header->count;
+    view->total_memory_bytes = sizeof(EventContext);
+    return true;
+}
+
+EventContext *event_context_load_mapped(const void *image, size_t size) {
+    EventContext view;
+    if (!image_view_init(&view, image, size)) {
+        return NULL;
+    }
+
+    EventContext *context = ec_malloc(sizeof(EventContext));
+    if (!context) {
+        return NULL;
+    }
+    *context = view;
+    return context;
+}
+
+EventContext *event_context_load(const void *image, size_t size) {
+    EventContext view;
+    if (!image_view_init(&view, image, size)) {
+        return NULL;
+    }
+
+    EventContext *context = event_context_create();
+    if (!context) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < view.count; i++) {
+        const ContextImageEntry *record = image_entry(&view, i);
+        const char *key = image_entry_key(&view, record);
+        if (!key || record->key_len == 0 || record->key_len > EVENTCHAINS_MAX_KEY_LENGTH) {
+            goto fail;
+        }
+        uint32_t hash = context_key_hash(key);
+
+        EventChainErrorCode err;
+        if (record->type == EVENT_VALUE_POINTER && record->codec_offset) {
+            /* Decode our own copy; the view's cache would hand out a shared node */
+            const char *codec_name = image_string(&view, record->codec_offset);
+            const EventValueCodec *codec = codec_name ? event_codec_find(codec_name) : NULL;
+            if (!codec || !image_range_ok(&view, record->value_offset, record->value_size)) {
+                goto fail;
+            }
+
+            void *data = codec->decode(view.mapped_image + record->value_offset,
+                                       (size_t)record->value_size);
+            if (!data) goto fail;
+
+            err = context_put(context, key, record->key_len, hash, EVENT_VALUE_POINTER,
+                              data, codec->cleanup, codec, NULL, NULL);
+            if (err != EC_SUCCESS && codec->cleanup) {
+                codec->cleanup(data);
+            }
+        } else {
+            ContextSlot slot;
+            if (!mapped_slot_at(&view, i, &slot)) goto fail;
+            err = context_put(context, key, record->key_len, hash, (EventValueType)slot.type,
+                              NULL, NULL, NULL, NULL,
+                              slot.type == EVENT_VALUE_POINTER ? NULL : slot.inline_value);
+        }
+        if (err != EC_SUCCESS) goto fail;
+    }
+    return context;
+
+fail:
+    event_context_destroy(context);
+    return NULL;
+}
+
+EventChainErrorCode event_context_get_encoded(
+    const EventContext *context,
+    const char *key,
+    const void **bytes_out,
+    size_t *size_out
+) {
+    if (!context) return EC_ERROR_NULL_POINTER;
+    if (!key) return EC_ERROR_NULL_POINTER;
+    if (!bytes_out) return EC_ERROR_NULL_POINTER;
+    if (!size_out) return EC_ERROR_NULL_POINTER;
+
+    *bytes_out = NULL;
+    *size_out = 0;
+    if (!context->mapped) return EC_ERROR_INVALID_PARAMETER;
+
+    size_t entry = mapped_find(context, key, context_key_hash(key));
+    if (entry == CONTEXT_NOT_FOUND) return EC_ERROR_NOT_FOUND;
+
+    const ContextImageEntry *record = image_entry(context, entry);
+    if (record->type != EVENT_VALUE_POINTER || record->codec_offset == 0) {
+        return EC_ERROR_TYPE_MISMATCH;
+    }
+    if (!image_range_ok(context, record->value_offset, record->value_size)) {
+        return EC_ERROR_NOT_FOUND;
+    }
+
+    *bytes_out = context->mapped_image + record->value_offset;
+    *size_out = (size_t)record->value_size;
+    return EC_SUCCESS;
+}
+
+/* ==================== EventResult Implementation ==================== */
+
+/*
+ * Per-thread ring of message buffers. Results carry a pointer into it
+ * instead of a 1 KB array, and the chain copies the text out before the
+ * slot comes round again.
+ */
+static __thread char error_arena[EVENTCHAINS_ERROR_ARENA_SLOTS][EVENTCHAINS_MAX_ERROR_LENGTH];
+static __thread size_t error_arena_next = 0;
+
+EventResult event_result_success(void) {
+    EventResult result;
+    result.success = true;
+    result.error_code = EC_SUCCESS;
+    result.error_message = "";
+    return result;
+}
+
+EventResult event_result_failure(
+    const char *error_message,
+    EventChainErrorCode error_code,
+    ErrorDetailLevel detail_level
+) {
+    EventResult result;
+    result.success = false;
+    result.error_code = error_code;
+
+    if (detail_level == ERROR_DETAIL_MINIMAL) {
+        /* Production: generic message only, nothing to copy */
+        result.error_message = "Operation failed";
+        return result;
+    }
+
+    char *slot = error_arena[error_arena_next];
+    error_arena_next = (error_arena_next + 1) % EVENTCHAINS_ERROR_ARENA_SLOTS;
+
+    sanitize_error_message(
+        slot,
+        error_message,
+        EVENTCHAINS_MAX_ERROR_LENGTH,
+        detail_level
+    );
+
+    result.error_message = slot;
+    return result;
+}
+
+EventResult event_result_failure_static(
+    const char *error_message,
+    EventChainErrorCode error_code
+) {
+    EventResult result;
+    result.success = false;
+    result.error_code = error_code;
+    result.error_message = error_message ? error_message : "Unknown error";
+    return result;
+}
+
+/* ==================== ChainableEvent Implementation ==================== */
+
+ChainableEvent *chainable_event_create(
+    EventExecuteFunc execute,
+    void *user_data,
+    const char *name
+) {
+    if (!execute) return NULL;
+    if (!is_valid_function_pointer((const void *)execute)) return NULL;
+
+    ChainableEvent *event = ec_calloc(1, sizeof(ChainableEvent));
+    if (!event) return NULL;
+
+    event->execute = execute;
+    event->user_data = user_data;
+
+    if (name) {
+        safe_strncpy(event->name, name, EVENTCHAINS_MAX_NAME_LENGTH);
+    } else {
+        safe_strncpy(event->name, "UnnamedEvent", EVENTCHAINS_MAX_NAME_LENGTH);
+    }
+
+    return event;
+}
+
+void chainable_event_destroy(ChainableEvent *event) {
+    if (!event) return;
+
+    secure_zero(event, sizeof(ChainableEvent));
+    ec_free(event);
+}
+
+/* ==================== EventMiddleware Implementation ==================== */
+
+EventMiddleware *event_middleware_create(
+    MiddlewareExecuteFunc execute,
+    void *user_data,
+    const char *name
+) {
+    if (!execute) return NULL;
+    if (!is_valid_function_pointer((const void *)execute)) return NULL;
+
+    EventMiddleware *middleware = ec_calloc(1, sizeof(EventMiddleware));
+    if (!middleware) return NULL;
+
+    middleware->execute = execute;
+    middleware->user_data = user_data;
+
+    if (name) {
+        safe_strncpy(middleware->name, name, EVENTCHAINS_MAX_NAME_LENGTH);
+    } else {
+        safe_strncpy(middleware->name, "UnnamedMiddleware", EVENTCHAINS_MAX_NAME_LENGTH);
+    }
+
+    return middleware;
+}
+
+void event_middleware_destroy(EventMiddleware *middleware) {
+    if (!middleware) return;
+
+    secure_zero(middleware, sizeof(EventMiddleware));
+    ec_free(middleware);
+}
+
+/* ==================== Execution Plans ==================== */
+
+/**
+ * Pre-validated event descriptor
+ */
+typedef struct {
+    EventExecuteFunc execute;
+    void *user_data;
+    ChainableEvent *event;      /* Passed to middleware and failure handlers */
+} PlanEvent;
+
+/**
+ * Pre-validated middleware descriptor
+ */
+typedef struct {
+    MiddlewareExecuteFunc execute;
+    void *user_data;
+} PlanMiddleware;
+
+/**
+ * What to do after an event fails, resolved from the fault tolerance mode
+ */
+typedef enum {
+    PLAN_ON_FAILURE_STOP,
+    PLAN_ON_FAILURE_CONTINUE,
+    PLAN_ON_FAILURE_ASK         /* CUSTOM mode with a handler installed */
+} PlanFailurePolicy;
+
+/**
+ * EventChainPlan - Immutable, contiguous execution plan compiled from a chain
+ *
+ * The header, event descriptors, middleware descriptors and dependency
+ * graph share a single allocation. Middleware is stored outermost first.
+ * Events are stored in a topological order of the declared dependencies
+ * (registration order when there are none), so sequential execution
+ * simply walks the array.
+ */
+struct EventChainPlan {
+    const PlanEvent *events;
+    size_t event_count;
+
+    const PlanMiddleware *middlewares;
+    size_t middleware_count;
+
+    PlanFailurePolicy on_failure;
+    bool partial_success_allowed;
+    bool skip_failed_dependents;    /* Not in BEST_EFFORT: dependents of a failure are skipped */
+    ErrorDetailLevel error_detail_level;
+
+    bool (*should_continue)(
+        const ChainableEvent *event,
+        const char *error,
+        void *user_data
+    );
+    void *failure_handler_data;
+
+    /* Dependency graph over plan indices (CSR layout) */
+    const size_t *dependent_offsets;    /* event_count + 1 entries */
+    const size_t *dependents;           /* Events unblocked by each event */
+    const size_t *prerequisite_counts;  /* Incoming edges per event */
+};
+
+/**
+ * Order events topologically, preferring registration order
+ *
+ * Fills order[] with original event indices and writes the per-event
+ * prerequisite counts and CSR adjacency (original indices) used to build
+ * the plan graph. Fails if the dependencies contain a cycle.
+ */
+static EventChainErrorCode event_chain_sort_dependencies(
+    const EventChain *chain,
+    size_t *order,
+    size_t *prerequisite_counts,
+    size_t *offsets,
+    size_t *adjacency
+) {
+    size_t n = chain->event_count;
+    size_t m = chain->dependency_count;
+
+    for (size_t i = 0; i <= n; i++) offsets[i] = 0;
+    for (size_t i = 0; i < n; i++) prerequisite_counts[i] = 0;
+
+    for (size_t e = 0; e < m; e++) {
+        offsets[chain->dependencies[e].prerequisite_index + 1]++;
+        prerequisite_counts[chain->dependencies[e].event_index]++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    /* order[] doubles as the fill cursor while building adjacency */
+    for (size_t i = 0; i < n; i++) order[i] = offsets[i];
+    for (size_t e = 0; e < m; e++) {
+        size_t from = chain->dependencies[e].prerequisite_index;
+        adjacency[order[from]++] = chain->dependencies[e].event_index;
+    }
+
+    /*
+     * Kahn's algorithm, always taking the lowest ready index so chains
+     * whose dependencies point backwards keep registration order. The
+     * quadratic scan only runs at compile time and only with dependencies.
+     */
+    size_t *remaining = ec_calloc(n ? n : 1, sizeof(size_t));
+    bool *emitted = ec_calloc(n ? n : 1, sizeof(bool));
+    if (!remaining || !emitted) {
+        ec_free(remaining);
+        ec_free(emitted);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(remaining, prerequisite_counts, n * sizeof(size_t));
+
+    size_t emitted_count = 0;
+    while (emitted_count < n) {
+        size_t next = n;
+        for (size_t i = 0; i < n; i++) {
+            if (!emitted[i] && remaining[i] == 0) {
+                next = i;
+                break;
+            }
+        }
+        if (next == n) break;  /* Cycle */
+
+        emitted[next] = true;
+        order[emitted_count++] = next;
+        for (size_t k = offsets[next]; k < offsets[next + 1]; k++) {
+            remaining[adjacency[k]]--;
+        }
+    }
+
+    ec_free(remaining);
+    ec_free(emitted);
+
+    return (emitted_count == n) ? EC_SUCCESS : EC_ERROR_INVALID_PARAMETER;
+}
+
+/**
+ * Compile the chain's events and middleware into a plan
+ *
+ * All function pointer and NULL validation happens here, once. cycle_out
+ * (may be NULL) tells a dependency cycle apart from an invalid event;
+ * both fail with EC_ERROR_INVALID_PARAMETER.
+ */
+static EventChainErrorCode event_chain_plan_compile(
+    const EventChain *chain,
+    EventChainPlan **plan_out,
+    bool *cycle_out
+) {
+    *plan_out = NULL;
+    if (cycle_out) *cycle_out = false;
+
+    for (size_t i = 0; i < chain->event_count; i++) {
+        const ChainableEvent *event = chain->events[i];
+        if (!event || !is_valid_function_pointer((const void *)event->execute)) {
+            return EC_ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    for (size_t i = 0; i < chain->middleware_count; i++) {
+        const EventMiddleware *middleware = chain->middlewares[i];
+        if (!middleware || !is_valid_function_pointer((const void *)middleware->execute)) {
+            return EC_ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    size_t n = chain->event_count;
+    size_t m = chain->dependency_count;
+
+    size_t events_bytes, middleware_bytes, graph_entries, graph_bytes, total_bytes;
+    if (!safe_multiply(n, sizeof(PlanEvent), &events_bytes) ||
+        !safe_multiply(chain->middleware_count, sizeof(PlanMiddleware), &middleware_bytes) ||
+        !safe_add(n, n + 1, &graph_entries) ||
+        !safe_add(graph_entries, m, &graph_entries) ||
+        !safe_multiply(graph_entries, sizeof(size_t), &graph_bytes) ||
+        !safe_add(sizeof(EventChainPlan), events_bytes, &total_bytes) ||
+        !safe_add(total_bytes, middleware_bytes, &total_bytes) ||
+        !safe_add(total_bytes, graph_bytes, &total_bytes)) {
+        return EC_ERROR_OVERFLOW;
+    }
+
+    EventChainPlan *plan = ec_calloc(1, total_bytes);
+    if (!plan) return EC_ERROR_OUT_OF_MEMORY;
+
+    PlanEvent *events = (PlanEvent *)(plan + 1);
+    PlanMiddleware *middlewares = (PlanMiddleware *)(events + n);
+    size_t *dependent_offsets = (size_t *)(middlewares + chain->middleware_count);
+    size_t *dependents = dependent_offsets + n + 1;
+    size_t *prerequisite_counts = dependents + m;
+
+    /* Scratch: order, original-index counts, offsets, adjacency, positions */
+    size_t scratch_entries = (4 * n) + 1 + m;
+    size_t *scratch = ec_calloc(scratch_entries ? scratch_entries : 1, sizeof(size_t));
+    if (!scratch) {
+        ec_free(plan);
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
+    size_t *order = scratch;
+    size_t *original_counts = order + n;
+    size_t *original_offsets = original_counts + n;
+    size_t *original_adjacency = original_offsets + n + 1;
+    size_t *position = original_adjacency + m;
+
+    EventChainErrorCode err = event_chain_sort_dependencies(
+        chain, order, original_counts, original_offsets, original_adjacency);
+    if (err != EC_SUCCESS) {
+        if (cycle_out) *cycle_out = (err == EC_ERROR_INVALID_PARAMETER);
+        ec_free(scratch);
+        ec_free(plan);
+        return err;
+    }
+
+    for (size_t p = 0; p < n; p++) {
+        position[order[p]] = p;
+    }
+
+    size_t edge = 0;
+    for (size_t p = 0; p < n; p++) {
+        size_t original = order[p];
+        const ChainableEvent *event = chain->events[original];
+
+        events[p].execute = event->execute;
+        events[p].user_data = event->user_data;
+        events[p].event = chain->events[original];
+
+        prerequisite_counts[p] = original_counts[original];
+        dependent_offsets[p] = edge;
+        for (size_t k = original_offsets[original]; k < original_offsets[original + 1]; k++) {
+            dependents[edge++] = position[original_adjacency[k]];
+        }
+    }
+    dependent_offsets[n] = edge;
+
+    ec_free(scratch);
+
+    /* Resolve LIFO order once: last registered middleware is outermost */
+    for (size_t i = 0; i < chain->middleware_count; i++) {
+        const EventMiddleware *middleware = chain->middlewares[chain->middleware_count - 1 - i];
+        middlewares[i].execute = middleware->execute;
+        middlewares[i].user_data = middleware->user_data;
+    }
+
+    plan->events = events;
+    plan->event_count = n;
+    plan->middlewares = middlewares;
+    plan->middleware_count = chain->middleware_count;
+    plan->dependent_offsets = dependent_offsets;
+    plan->dependents = dependents;
+    plan->prerequisite_counts = prerequisite_counts;
+    plan->error_detail_level = chain->error_detail_level;
+    plan->partial_success_allowed = (chain->fault_tolerance != FAULT_TOLERANCE_STRICT);
+    plan->skip_failed_dependents = (chain->fault_tolerance != FAULT_TOLERANCE_BEST_EFFORT);
+    plan->should_continue = chain->should_continue;
+    plan->failure_handler_data = chain->failure_handler_data;
+
+    switch (chain->fault_tolerance) {
+        case FAULT_TOLERANCE_LENIENT:
+        case FAULT_TOLERANCE_BEST_EFFORT:
+            plan->on_failure = PLAN_ON_FAILURE_CONTINUE;
+            break;
+
+        case FAULT_TOLERANCE_CUSTOM:
+            /* No handler provided, default to strict */
+            plan->on_failure = chain->should_continue ? PLAN_ON_FAILURE_ASK : PLAN_ON_FAILURE_STOP;
+            break;
+
+        case FAULT_TOLERANCE_STRICT:
+        default:
+            plan->on_failure = PLAN_ON_FAILURE_STOP;
+            break;
+    }
+
+    *plan_out = plan;
+    return EC_SUCCESS;
+}
+
+static void event_chain_plan_destroy(EventChainPlan *plan) {
+    if (!plan) return;
+    ec_free(plan);
+}
+
+/**
+ * Drop the cached plan after the chain definition changes
+ */
+static void event_chain_invalidate_plan(EventChain *chain) {
+    event_chain_plan_destroy(chain->plan);
+    chain->plan = NULL;
+}
+
+/* ==================== EventChain Implementation ==================== */
+
+/**
+ * Shared constructor; template chains carry no context of their own
+ */
+static EventChain *event_chain_create_internal(
+    FaultToleranceMode mode,
+    ErrorDetailLevel detail_level,
+    bool with_context
+) {
+    EventChain *chain = ec_calloc(1, sizeof(EventChain));
+    if (!chain) return NULL;
+
+    chain->event_capacity = INITIAL_CAPACITY;
+    chain->event_count = 0;
+    chain->events = ec_calloc(chain->event_capacity, sizeof(ChainableEvent *));
+
+    chain->middleware_capacity = INITIAL_CAPACITY;
+    chain->middleware_count = 0;
+    chain->middlewares = ec_calloc(chain->middleware_capacity, sizeof(EventMiddleware *));
+
+    /* Dependencies are rare; allocated on first use */
+    chain->dependencies = NULL;
+    chain->dependency_count = 0;
+    chain->dependency_capacity = 0;
+
+    chain->context = with_context ? event_context_create() : NULL;
+    chain->fault_tolerance = mode;
+    chain->error_detail_level = detail_level;
+    chain->should_continue = NULL;
+    chain->failure_handler_data = NULL;
+    chain->is_executing = 0;
+    chain->signal_interrupted = 0;
+    chain->plan = NULL;
+    chain->is_frozen = 0;
+
+    if (!chain->events || !chain->middlewares || (with_context && !chain->context)) {
+        ec_free(chain->events);
+        ec_free(chain->middlewares);
+        event_context_destroy(chain->context);
+        ec_free(chain);
+        return NULL;
+    }
+
+    return chain;
+}
+
+EventChain *event_chain_create_with_detail(
+    FaultToleranceMode mode,
+    ErrorDetailLevel detail_level
+) {
+    return event_chain_create_internal(mode, detail_level, true);
+}
+
+EventChain *event_chain_create_template(
+    FaultToleranceMode mode,
+    ErrorDetailLevel detail_level
+) {
+    return event_chain_create_internal(mode, detail_level, false);
+}
+
+EventChain *event_chain_create(FaultToleranceMode mode) {
+    return event_chain_create_with_detail(mode, ERROR_DETAIL_FULL);
+}
+
+void event_chain_destroy(EventChain *chain) {
+    if (!chain) return;
+
+    /* Destroy all events */
+    for (size_t i = 0; i < chain->event_count; i++) {
+        chainable_event_destroy(chain->events[i]);
+    }
+    ec_free(chain->events);
+
+    /* Destroy all middleware */
+    for (size_t i = 0; i < chain->middleware_count; i++) {
+        event_middleware_destroy(chain->middlewares[i]);
+    }
+    ec_free(chain->middlewares);
+    ec_free(chain->dependencies);
+
+    event_context_destroy(chain->context);
+    event_chain_plan_destroy(chain->plan);
+
+    secure_zero(chain, sizeof(EventChain));
+    ec_free(chain);
+}
+
+EventChainErrorCode event_chain_add_event(
+    EventChain *chain,
+    ChainableEvent *event
+) {
+    if (!chain) return EC_ERROR_NULL_POINTER;
+    if (!event) return EC_ERROR_NULL_POINTER;
+    if (!event->execute) return EC_ERROR_INVALID_PARAMETER;
+    if (!is_valid_function_pointer((const void *)event->execute)) return EC_ERROR_INVALID_PARAMETER;
+
+    /* Check for reentrancy */
+    if (chain->is_executing) {
+        return EC_ERROR_REENTRANCY;
+    }
+
+    if (chain->is_frozen) {
+        return EC_ERROR_CHAIN_FROZEN;
+    }
+
+    /* Check capacity limits */
+    if (chain->event_count >= EVENTCHAINS_MAX_EVENTS) {
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    /* Expand if needed */
+    if (chain->event_count >= chain->event_capacity) {
+        size_t new_capacity;
+        if (!safe_multiply(chain->event_capacity, 2, &new_capacity)) {
+            return EC_ERROR_OVERFLOW;
+        }
+
+        if (new_capacity > EVENTCHAINS_MAX_EVENTS) {
+            new_capacity = EVENTCHAINS_MAX_EVENTS;
+        }
+
+        ChainableEvent **new_events = ec_realloc(
+            chain->events,
+            sizeof(ChainableEvent *) * new_capacity
+        );
+
+        if (!new_events) {
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+
+        chain->events = new_events;
+
+        /* Zero new entries */
+        for (size_t i = chain->event_capacity; i < new_capacity; i++) {
+            chain->events[i] = NULL;
+        }
+
+        chain->event_capacity = new_capacity;
+    }
+
+    event_chain_invalidate_plan(chain);
+    chain->events[chain->event_count++] = event;
+    return EC_SUCCESS;
+}
+
+EventChainErrorCode event_chain_use_middleware(
+    EventChain *chain,
+    EventMiddleware *middleware
+) {
+    if (!chain) return EC_ERROR_NULL_POINTER;
+    if (!middleware) return EC_ERROR_NULL_POINTER;
+    if (!middleware->execute) return EC_ERROR_INVALID_PARAMETER;
+    if (!is_valid_function_pointer((const void *)middleware->execute)) return EC_ERROR_INVALID_PARAMETER;
+
+    /* Check for reentrancy */
+    if (chain->is_executing) {
+        return EC_ERROR_REENTRANCY;
+    }
+
+    if (chain->is_frozen) {
+        return EC_ERROR_CHAIN_FROZEN;
+    }
+
+    /* Check capacity limits */
+    if (chain->middleware_count >= EVENTCHAINS_MAX_MIDDLEWARE) {
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    /* Expand if needed */
+    if (chain->middleware_count >= chain->middleware_capacity) {
+        size_t new_capacity;
+        if (!safe_multiply(chain->middleware_capacity, 2, &new_capacity)) {
+            return EC_ERROR_OVERFLOW;
+        }
+
+        if (new_capacity > EVENTCHAINS_MAX_MIDDLEWARE) {
+            new_capacity = EVENTCHAINS_MAX_MIDDLEWARE;
+        }
+
+        EventMiddleware **new_middlewares = ec_realloc(
+            chain->middlewares,
+            sizeof(EventMiddleware *) * new_capacity
+        );
+
+        if (!new_middlewares) {
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+
+        chain->middlewares = new_middlewares;
+
+        /* Zero new entries */
+        for (size_t i = chain->middleware_capacity; i < new_capacity; i++) {
+            chain->middlewares[i] = NULL;
+        }
+
+        chain->middleware_capacity = new_capacity;
+    }
+
+    event_chain_invalidate_plan(chain);
+    chain->middlewares[chain->middleware_count++] = middleware;
+    return EC_SUCCESS;
 }
 
-EventChainErrorCode event_context_get_ref(
-    EventContext *context,
-    const char *key,
-    RefCountedValue **value_out
+EventChainErrorCode event_chain_set_failure_handler(
+    EventChain *chain,
+    bool (*handler)(const ChainableEvent *event, const char *error, void *user_data),
+    void *user_data
 ) {
-    if (!context) return EC_ERROR_NULL_POINTER;
-    if (!key) return EC_ERROR_NULL_POINTER;
-    if (!value_out) return EC_ERROR_NULL_POINTER;
+    if (!chain) return EC_ERROR_NULL_POINTER;
+    if (chain->is_executing) return EC_ERROR_REENTRANCY;
+    if (chain->is_frozen) return EC_ERROR_CHAIN_FROZEN;
 
-    for (size_t i = 0; i < context->count; i++) {
-        if (context->keys[i] && strcmp(context->keys[i], key) == 0) {
-            *value_out = context->values[i];
-            if (*value_out) {
-                ref_counted_value_retain(*value_out);
-            }
-            return EC_SUCCESS;
-        }
+    /* Validate function pointer if provided */
+    if (handler && !is_valid_function_pointer((const void *)handler)) {
+        return EC_ERROR_INVALID_FUNCTION_POINTER;
     }
 
-    *value_out = NULL;
-    return EC_ERROR_NOT_FOUND;
+    event_chain_invalidate_plan(chain);
+    chain->should_continue = handler;
+    chain->failure_handler_data = user_data;
+    return EC_SUCCESS;
 }
 
-EventChainErrorCode event_context_get(
-    const EventContext *context,
-    const char *key,
-    void **value_out
+EventChainErrorCode event_chain_add_dependency(
+    EventChain *chain,
+    const ChainableEvent *event,
+    const ChainableEvent *prerequisite
 ) {
-    if (!context) return EC_ERROR_NULL_POINTER;
-    if (!key) return EC_ERROR_NULL_POINTER;
-    if (!value_out) return EC_ERROR_NULL_POINTER;
+    if (!chain) return EC_ERROR_NULL_POINTER;
+    if (!event || !prerequisite) return EC_ERROR_NULL_POINTER;
+    if (event == prerequisite) return EC_ERROR_INVALID_PARAMETER;
+    if (chain->is_executing) return EC_ERROR_REENTRANCY;
+    if (chain->is_frozen) return EC_ERROR_CHAIN_FROZEN;
 
-    for (size_t i = 0; i < context->count; i++) {
-        if (context->keys[i] && strcmp(context->keys[i], key) == 0) {
-            *value_out = ref_counted_value_get_data(context->values[i]);
+    size_t event_index = chain->event_count;
+    size_t prerequisite_index = chain->event_count;
+    for (size_t i = 0; i < chain->event_count; i++) {
+        if (chain->events[i] == event) event_index = i;
+        if (chain->events[i] == prerequisite) prerequisite_index = i;
+    }
+
+    if (event_index == chain->event_count || prerequisite_index == chain->event_count) {
+        return EC_ERROR_NOT_FOUND;
+    }
+
+    /* Duplicate edges are harmless but would inflate the graph */
+    for (size_t i = 0; i < chain->dependency_count; i++) {
+        if (chain->dependencies[i].event_index == event_index &&
+            chain->dependencies[i].prerequisite_index == prerequisite_index) {
             return EC_SUCCESS;
         }
     }
 
-    *value_out = NULL;
-    return EC_ERROR_NOT_FOUND;
+    if (chain->dependency_count >= EVENTCHAINS_MAX_DEPENDENCIES) {
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    if (chain->dependency_count >= chain->dependency_capacity) {
+        size_t new_capacity = INITIAL_CAPACITY;
+        if (chain->dependency_capacity > 0 &&
+            !safe_multiply(chain->dependency_capacity, 2, &new_capacity)) {
+            return EC_ERROR_OVERFLOW;
+        }
+
+        if (new_capacity > EVENTCHAINS_MAX_DEPENDENCIES) {
+            new_capacity = EVENTCHAINS_MAX_DEPENDENCIES;
+        }
+
+        EventDependency *new_dependencies = ec_realloc(
+            chain->dependencies,
+            sizeof(EventDependency) * new_capacity
+        );
+
+        if (!new_dependencies) {
+            return EC_ERROR_OUT_OF_MEMORY;
+        }
+
+        chain->dependencies = new_dependencies;
+        chain->dependency_capacity = new_capacity;
+    }
+
+    event_chain_invalidate_plan(chain);
+    chain->dependencies[chain->dependency_count].event_index = event_index;
+    chain->dependencies[chain->dependency_count].prerequisite_index = prerequisite_index;
+    chain->dependency_count++;
+    return EC_SUCCESS;
 }
 
-bool event_context_has(
-    const EventContext *context,
-    const char *key,
-    bool constant_time
+EventContext *event_chain_get_context(EventChain *chain) {
+    if (!chain) return NULL;
+    return chain->context;
+}
+
+bool event_chain_was_interrupted(const EventChain *chain) {
+    if (!chain) return false;
+    return __atomic_load_n(&chain->signal_interrupted, __ATOMIC_RELAXED) != 0;
+}
+
+EventChainErrorCode event_chain_freeze(EventChain *chain) {
+    if (!chain) return EC_ERROR_NULL_POINTER;
+    if (chain->is_frozen) return EC_SUCCESS;
+    if (chain->is_executing) return EC_ERROR_REENTRANCY;
+
+    if (!chain->plan) {
+        EventChainErrorCode err = event_chain_plan_compile(chain, &chain->plan, NULL);
+        if (err != EC_SUCCESS) return err;
+    }
+
+    chain->is_frozen = 1;
+    return EC_SUCCESS;
+}
+
+bool event_chain_is_frozen(const EventChain *chain) {
+    if (!chain) return false;
+    return chain->is_frozen != 0;
+}
+
+/* ==================== Middleware Dispatch ==================== */
+
+/**
+ * Dispatch frame handed to middleware as next_data
+ *
+ * Each layer builds the frame for the layer below it on its own stack, so
+ * dispatch never touches the heap. Frames are never modified after being
+ * handed out, which keeps next() safe to call more than once (retries).
+ */
+typedef struct {
+    const EventChainPlan *plan;
+    const PlanEvent *target;
+    size_t depth;               /* Index of the next layer to enter */
+    const volatile sig_atomic_t *interrupted;
+} MiddlewareFrame;
+
+/**
+ * MiddlewareNextFunc trampoline: runs the next inner middleware, or the
+ * event itself once every layer has been entered
+ */
+static EventResult middleware_dispatch_next(
+    ChainableEvent *event,
+    EventContext *context,
+    void *next_data
 ) {
-    if (!context || !key) return false;
+    const MiddlewareFrame *frame = (const MiddlewareFrame *)next_data;
 
-    if (constant_time) {
-        /* Constant-time comparison for sensitive keys */
-        bool found = false;
-        for (size_t i = 0; i < context->count; i++) {
-            if (context->keys[i]) {
-                if (constant_time_strcmp(context->keys[i], key, EVENTCHAINS_MAX_KEY_LENGTH)) {
-                    found = true;
-                    /* Don't break - must check all entries for constant time */
-                }
-            }
+    if (!frame || !event) {
+        return event_result_failure(
+            "NULL event or middleware frame",
+            EC_ERROR_NULL_POINTER,
+            frame ? frame->plan->error_detail_level : ERROR_DETAIL_FULL
+        );
+    }
+
+    const EventChainPlan *plan = frame->plan;
+
+    /* Check for signal interruption between layers */
+    if (__atomic_load_n(frame->interrupted, __ATOMIC_RELAXED)) {
+        return event_result_failure(
+            "Chain execution interrupted by signal",
+            EC_ERROR_SIGNAL_INTERRUPTED,
+            plan->error_detail_level
+        );
+    }
+
+    if (frame->depth == plan->middleware_count) {
+        if (event == frame->target->event) {
+            return frame->target->execute(context, frame->target->user_data);
         }
-        return found;
-    } else {
-        /* Fast path for non-sensitive keys */
-        for (size_t i = 0; i < context->count; i++) {
-            if (context->keys[i] && strcmp(context->keys[i], key) == 0) {
-                return true;
-            }
+
+        /* Middleware substituted a different event: validate it here */
+        if (!is_valid_function_pointer((const void *)event->execute)) {
+            return event_result_failure(
+                "Event validation failed",
+                EC_ERROR_INVALID_FUNCTION_POINTER,
+                plan->error_detail_level
+            );
         }
-        return false;
+        return event->execute(context, event->user_data);
     }
+
+    const PlanMiddleware *middleware = &plan->middlewares[frame->depth];
+
+    MiddlewareFrame inner;
+    inner.plan = plan;
+    inner.target = frame->target;
+    inner.depth = frame->depth + 1;
+    inner.interrupted = frame->interrupted;
+
+    return middleware->execute(
+        event,
+        context,
+        middleware_dispatch_next,
+        &inner,
+        middleware->user_data
+    );
 }
 
-EventChainErrorCode event_context_remove(EventContext *context, const char *key) {
-    if (!context) return EC_ERROR_NULL_POINTER;
-    if (!key) return EC_ERROR_NULL_POINTER;
+/**
+ * Execute one planned event through the middleware pipeline
+ *
+ * Middleware depth is bounded by EVENTCHAINS_MAX_MIDDLEWARE.
+ */
+static EventResult execute_planned_event(
+    const EventChainPlan *plan,
+    const PlanEvent *target,
+    EventContext *context,
+    const volatile sig_atomic_t *interrupted
+) {
+    /* If no middleware, execute event directly */
+    if (plan->middleware_count == 0) {
+        return target->execute(context, target->user_data);
+    }
 
-    for (size_t i = 0; i < context->count; i++) {
-        if (context->keys[i] && strcmp(context->keys[i], key) == 0) {
-            /* Update memory tracking */
-            size_t removed_memory = strlen(context->keys[i]) + 1 + sizeof(RefCountedValue);
-            context->total_memory_bytes -= removed_memory;
+    MiddlewareFrame outer;
+    outer.plan = plan;
+    outer.target = target;
+    outer.depth = 0;
+    outer.interrupted = interrupted;
 
-            /* Release ref-counted value */
-            if (context->values[i]) {
-                ref_counted_value_release(context->values[i]);
-            }
+    return middleware_dispatch_next(target->event, context, &outer);
+}
 
-            /* Free key */
-            secure_zero(context->keys[i], strlen(context->keys[i]));
-            free(context->keys[i]);
+/* ==================== Chain Execution ==================== */
 
-            /* Shift remaining entries down */
-            for (size_t j = i; j < context->count - 1; j++) {
-                context->keys[j] = context->keys[j + 1];
-                context->values[j] = context->values[j + 1];
-            }
+/**
+ * Append a failure record, growing the failure array as needed
+ */
+static void chain_result_record_failure(
+    ChainResult *result,
+    size_t *failure_capacity,
+    const char *event_name,
+    const char *error_message,
+    EventChainErrorCode error_code,
+    ErrorDetailLevel detail_level,
+    bool sanitize
+) {
+    /* Expand failure array if needed (a zero capacity allocates lazily) */
+    if (result->failure_count >= *failure_capacity) {
+        size_t new_capacity = INITIAL_CAPACITY;
+        if (*failure_capacity > 0 && !safe_multiply(*failure_capacity, 2, &new_capacity)) {
+            return;  /* Can't expand, stop recording failures */
+        }
 
-            /* Clear last entry */
-            context->keys[context->count - 1] = NULL;
-            context->values[context->count - 1] = NULL;
+        EventFailure *new_failures = ec_realloc(
+            result->failures,
+            sizeof(EventFailure) * new_capacity
+        );
+        if (!new_failures) {
+            return;
+        }
+        result->failures = new_failures;
 
-            context->count--;
-            return EC_SUCCESS;
+        /* Zero new entries */
+        for (size_t j = *failure_capacity; j < new_capacity; j++) {
+            memset(&result->failures[j], 0, sizeof(EventFailure));
         }
+
+        *failure_capacity = new_capacity;
     }
 
-    return EC_ERROR_NOT_FOUND;
+    EventFailure *failure = &result->failures[result->failure_count++];
+    safe_strncpy(failure->event_name, event_name, EVENTCHAINS_MAX_NAME_LENGTH);
+    if (sanitize) {
+        sanitize_error_message(
+            failure->error_message,
+            error_message,
+            EVENTCHAINS_MAX_ERROR_LENGTH,
+            detail_level
+        );
+    } else {
+        safe_strncpy(failure->error_message, error_message, EVENTCHAINS_MAX_ERROR_LENGTH);
+    }
+    failure->error_code = error_code;
+
+    int64_t timestamp;
+    if (safe_time_to_int64(time(NULL), &timestamp) == EC_SUCCESS) {
+        failure->timestamp = timestamp;
+    } else {
+        failure->timestamp = 0;
+    }
 }
 
-size_t event_context_count(const EventContext *context) {
-    if (!context) return 0;
-    return context->count;
+/**
+ * Mark every direct dependent of a failed or skipped event as blocked
+ */
+static void plan_block_dependents(
+    const EventChainPlan *plan,
+    size_t index,
+    unsigned char *blocked
+) {
+    for (size_t k = plan->dependent_offsets[index]; k < plan->dependent_offsets[index + 1]; k++) {
+        __atomic_store_n(&blocked[plan->dependents[k]], 1, __ATOMIC_RELAXED);
+    }
 }
 
-size_t event_context_memory_usage(const EventContext *context) {
-    if (!context) return 0;
-    return context->total_memory_bytes;
+/**
+ * Resolve the failure policy for a failed event
+ */
+static bool plan_should_continue(
+    const EventChainPlan *plan,
+    const PlanEvent *target,
+    const char *error_message
+) {
+    switch (plan->on_failure) {
+        case PLAN_ON_FAILURE_CONTINUE:
+            return true;
+
+        case PLAN_ON_FAILURE_ASK:
+            return plan->should_continue(
+                target->event,
+                error_message,
+                plan->failure_handler_data
+            );
+
+        case PLAN_ON_FAILURE_STOP:
+        default:
+            return false;
+    }
 }
 
-void event_context_clear(EventContext *context) {
-    if (!context) return;
+/**
+ * Walk a compiled plan against a context
+ */
+static ChainResult execute_plan(
+    const EventChainPlan *plan,
+    EventContext *context,
+    const volatile sig_atomic_t *interrupted
+) {
+    ChainResult result;
+    result.success = true;
+    result.failures = NULL;
+    result.failure_count = 0;
 
-    /* Release all entries */
-    for (size_t i = 0; i < context->count; i++) {
-        if (context->keys[i]) {
-            secure_zero(context->keys[i], strlen(context->keys[i]));
-            free(context->keys[i]);
-            context->keys[i] = NULL;
+    /* Failure records are allocated on the first failure, never on success */
+    size_t failure_capacity = 0;
+
+    /* Dependents of failed events; only allocated once something fails */
+    unsigned char *blocked = NULL;
+    bool stopped = false;
+
+    /* Execute each event in sequence (topological order) */
+    for (size_t i = 0; i < plan->event_count && !stopped; i++) {
+        /* Check for signal interruption */
+        if (__atomic_load_n(interrupted, __ATOMIC_RELAXED)) {
+            chain_result_record_failure(
+                &result, &failure_capacity,
+                "Chain", "Execution interrupted by signal",
+                EC_ERROR_SIGNAL_INTERRUPTED, plan->error_detail_level, true
+            );
+            stopped = true;
+            break;
         }
 
-        if (context->values[i]) {
-            ref_counted_value_release(context->values[i]);
-            context->values[i] = NULL;
+        const PlanEvent *target = &plan->events[i];
+
+        if (blocked && blocked[i]) {
+            chain_result_record_failure(
+                &result, &failure_capacity,
+                target->event->name, "Skipped: a prerequisite event failed",
+                EC_ERROR_DEPENDENCY_FAILED, plan->error_detail_level, true
+            );
+            plan_block_dependents(plan, i, blocked);
+            continue;
+        }
+
+        /* Execute event through the middleware pipeline */
+        EventResult event_result = execute_planned_event(plan, target, context, interrupted);
+
+        if (!event_result.success) {
+            chain_result_record_failure(
+                &result, &failure_capacity,
+                target->event->name, event_result.error_message,
+                event_result.error_code, plan->error_detail_level, false
+            );
+
+            if (!plan_should_continue(plan, target, event_result.error_message)) {
+                stopped = true;
+                break;
+            }
+
+            if (plan->skip_failed_dependents &&
+                plan->dependent_offsets[i] != plan->dependent_offsets[i + 1]) {
+                if (!blocked) {
+                    blocked = ec_calloc(plan->event_count, sizeof(unsigned char));
+                }
+                if (blocked) {
+                    plan_block_dependents(plan, i, blocked);
+                } else {
+                    /* Cannot track what to skip; running dependents would be worse */
+                    stopped = true;
+                }
+            }
         }
     }
 
-    /* Reset counters but keep arrays allocated */
-    context->count = 0;
-    context->total_memory_bytes = sizeof(EventContext) +
-        (context->capacity * (sizeof(char *) + sizeof(RefCountedValue *)));
+    ec_free(blocked);
+
+    if (stopped) {
+        result.success = false;
+    } else if (result.failure_count > 0) {
+        /* If we got here and have failures, it's partial success */
+        result.success = plan->partial_success_allowed;
+    }
+
+    return result;
 }
 
-/* ==================== EventResult Implementation ==================== */
+/**
+ * Per-context bookkeeping for batch execution
+ */
+typedef struct {
+    size_t failure_capacity;    /* 0 until the context's first failure */
+    bool stopped;
+} BatchSlot;
+
+/**
+ * Walk a compiled plan over many contexts, event-major
+ *
+ * Each event runs for every still-active context before the next event
+ * starts, so its code and user data stay cached across the batch.
+ * Outcomes match running execute_plan() once per context.
+ */
+static void execute_plan_batch(
+    const EventChainPlan *plan,
+    EventContext **contexts,
+    size_t count,
+    ChainResult *results,
+    BatchSlot *slots,
+    const volatile sig_atomic_t *interrupted
+) {
+    /* Per-context dependents of failures; allocated on first need */
+    unsigned char *blocked = NULL;
+    size_t active = count;
+
+    for (size_t i = 0; i < plan->event_count && active > 0; i++) {
+        /* One signal check per event step instead of per context */
+        if (__atomic_load_n(interrupted, __ATOMIC_RELAXED)) {
+            for (size_t c = 0; c < count; c++) {
+                if (slots[c].stopped) continue;
+                chain_result_record_failure(
+                    &results[c], &slots[c].failure_capacity,
+                    "Chain", "Execution interrupted by signal",
+                    EC_ERROR_SIGNAL_INTERRUPTED, plan->error_detail_level, true
+                );
+                slots[c].stopped = true;
+            }
+            break;
+        }
+
+        const PlanEvent *target = &plan->events[i];
+
+        for (size_t c = 0; c < count; c++) {
+            if (slots[c].stopped) continue;
+
+            unsigned char *context_blocked = blocked ? blocked + (c * plan->event_count) : NULL;
+
+            if (context_blocked && context_blocked[i]) {
+                chain_result_record_failure(
+                    &results[c], &slots[c].failure_capacity,
+                    target->event->name, "Skipped: a prerequisite event failed",
+                    EC_ERROR_DEPENDENCY_FAILED, plan->error_detail_level, true
+                );
+                plan_block_dependents(plan, i, context_blocked);
+                continue;
+            }
+
+            EventResult event_result = execute_planned_event(plan, target, contexts[c], interrupted);
+            if (event_result.success) continue;
+
+            chain_result_record_failure(
+                &results[c], &slots[c].failure_capacity,
+                target->event->name, event_result.error_message,
+                event_result.error_code, plan->error_detail_level, false
+            );
+
+            if (!plan_should_continue(plan, target, event_result.error_message)) {
+                slots[c].stopped = true;
+                active--;
+                continue;
+            }
+
+            if (plan->skip_failed_dependents &&
+                plan->dependent_offsets[i] != plan->dependent_offsets[i + 1]) {
+                if (!blocked) {
+                    size_t blocked_bytes;
+                    if (safe_multiply(count, plan->event_count, &blocked_bytes)) {
+                        blocked = ec_calloc(blocked_bytes, sizeof(unsigned char));
+                    }
+                }
+                if (blocked) {
+                    plan_block_dependents(plan, i, blocked + (c * plan->event_count));
+                } else {
+                    /* Cannot track what to skip; running dependents would be worse */
+                    slots[c].stopped = true;
+                    active--;
+                }
+            }
+        }
+    }
+
+    ec_free(blocked);
 
-EventResult event_result_success(void) {
-    EventResult result;
-    result.success = true;
-    result.error_message[0] = '\0';
-    result.error_code = EC_SUCCESS;
-    return result;
+    for (size_t c = 0; c < count; c++) {
+        if (slots[c].stopped) {
+            results[c].success = false;
+        } else if (results[c].failure_count > 0) {
+            results[c].success = plan->partial_success_allowed;
+        }
+    }
 }
 
-EventResult event_result_failure(
+/**
+ * Build a result holding a single chain-level failure
+ */
+static ChainResult chain_result_single_failure(
+    const char *event_name,
     const char *error_message,
     EventChainErrorCode error_code,
     ErrorDetailLevel detail_level
 ) {
-    EventResult result;
+    ChainResult result;
     result.success = false;
-    result.error_code = error_code;
+    result.failures = NULL;
+    result.failure_count = 0;
 
-    sanitize_error_message(
-        result.error_message,
-        error_message,
-        EVENTCHAINS_MAX_ERROR_LENGTH,
-        detail_level
-    );
+    size_t failure_capacity = 1;
+    result.failures = ec_calloc(failure_capacity, sizeof(EventFailure));
+    if (result.failures) {
+        chain_result_record_failure(
+            &result, &failure_capacity,
+            event_name, error_message, error_code, detail_level, true
+        );
+    }
 
     return result;
 }
 
-/* ==================== ChainableEvent Implementation ==================== */
+/* Defined with the executor; runs independent events concurrently */
+static ChainResult execute_plan_dag(
+    const EventChainPlan *plan,
+    EventContext *context,
+    EventChainExecutor *executor,
+    const volatile sig_atomic_t *interrupted
+);
 
-ChainableEvent *chainable_event_create(
-    EventExecuteFunc execute,
-    void *user_data,
-    const char *name
+/**
+ * Clear an interrupt left over from an earlier run
+ *
+ * Other threads may be running the same frozen chain, so the flag is
+ * only touched atomically, and only written when it is set.
+ */
+static void chain_clear_interrupt(EventChain *chain) {
+    if (__atomic_load_n(&chain->signal_interrupted, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&chain->signal_interrupted, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Run a plan inside a borrow epoch on its context
+ *
+ * A NULL executor walks the plan on the calling thread. Only concurrent
+ * contexts are run in parallel, and those take no epoch: the deferred
+ * list an epoch fills is single-threaded, while concurrent contexts
+ * retire values through their shards instead.
+ */
+static ChainResult execute_plan_in_epoch(
+    const EventChainPlan *plan,
+    EventContext *context,
+    EventChainExecutor *executor,
+    const volatile sig_atomic_t *interrupted
 ) {
-    if (!execute) return NULL;
-    if (!is_valid_function_pointer((const void *)execute)) return NULL;
+    if (executor && context->concurrent) {
+        return execute_plan_dag(plan, context, executor, interrupted);
+    }
 
-    ChainableEvent *event = calloc(1, sizeof(ChainableEvent));
-    if (!event) return NULL;
+    if (event_context_epoch_begin(context) != EC_SUCCESS) {
+        return chain_result_single_failure("Chain", "Context epochs nested too deeply",
+            EC_ERROR_OVERFLOW, plan->error_detail_level);
+    }
 
-    event->execute = execute;
-    event->user_data = user_data;
+    ChainResult result = execute_plan(plan, context, interrupted);
 
-    if (name) {
-        safe_strncpy(event->name, name, EVENTCHAINS_MAX_NAME_LENGTH);
-    } else {
-        safe_strncpy(event->name, "UnnamedEvent", EVENTCHAINS_MAX_NAME_LENGTH);
+    event_context_epoch_end(context);
+    return result;
+}
+
+/**
+ * Guarded execution for unfrozen chains: reentrancy check, lazy compile
+ *
+ * A NULL executor walks the plan on the calling thread.
+ */
+static ChainResult event_chain_execute_guarded(
+    EventChain *chain,
+    EventContext *context,
+    EventChainExecutor *executor
+) {
+    /* Check for reentrancy */
+    if (chain->is_executing) {
+        return chain_result_single_failure(
+            "Chain",
+            "Reentrancy detected: chain already executing",
+            EC_ERROR_REENTRANCY,
+            chain->error_detail_level
+        );
     }
 
-    return event;
-}
+    /* Compile on first use; cached until the chain definition changes */
+    if (!chain->plan) {
+        bool cycle;
+        EventChainErrorCode err = event_chain_plan_compile(chain, &chain->plan, &cycle);
+        if (err != EC_SUCCESS) {
+            return chain_result_single_failure(
+                cycle ? "Chain" : "InvalidEvent",
+                cycle ? "Dependency cycle detected" : "Event validation failed",
+                err,
+                chain->error_detail_level
+            );
+        }
+    }
 
-void chainable_event_destroy(ChainableEvent *event) {
-    if (!event) return;
+    /* Set executing flag */
+    chain->is_executing = 1;
+    chain_clear_interrupt(chain);
 
-    secure_zero(event, sizeof(ChainableEvent));
-    free(event);
+    ChainResult result = execute_plan_in_epoch(chain->plan, context, executor,
+                                               &chain->signal_interrupted);
+
+    chain->is_executing = 0;
+    return result;
 }
 
-/* ==================== EventMiddleware Implementation ==================== */
+ChainResult event_chain_execute(EventChain *chain) {
+    if (!chain) {
+        ChainResult result;
+        result.success = false;
+        result.failures = NULL;
+        result.failure_count = 0;
+        return result;
+    }
 
-EventMiddleware *event_middleware_create(
-    MiddlewareExecuteFunc execute,
-    void *user_data,
-    const char *name
-) {
-    if (!execute) return NULL;
-    if (!is_valid_function_pointer((const void *)execute)) return NULL;
+    return event_chain_execute_with_context(chain, chain->context);
+}
 
-    EventMiddleware *middleware = calloc(1, sizeof(EventMiddleware));
-    if (!middleware) return NULL;
+ChainResult event_chain_execute_with_context(EventChain *chain, EventContext *context) {
+    if (!chain) {
+        ChainResult result;
+        result.success = false;
+        result.failures = NULL;
+        result.failure_count = 0;
+        return result;
+    }
 
-    middleware->execute = execute;
-    middleware->user_data = user_data;
+    if (!context) {
+        return chain_result_single_failure(
+            "Chain",
+            "No context supplied for execution",
+            EC_ERROR_NULL_POINTER,
+            chain->error_detail_level
+        );
+    }
 
-    if (name) {
-        safe_strncpy(middleware->name, name, EVENTCHAINS_MAX_NAME_LENGTH);
-    } else {
-        safe_strncpy(middleware->name, "UnnamedMiddleware", EVENTCHAINS_MAX_NAME_LENGTH);
+    /*
+     * A frozen chain is never written during execution (apart from the
+     * interrupt flag, cleared as each run starts), so any number of
+     * threads may run it at once as long as each brings its own context.
+     */
+    if (chain->is_frozen) {
+        chain_clear_interrupt(chain);
+        return execute_plan_in_epoch(chain->plan, context, NULL, &chain->signal_interrupted);
     }
 
-    return middleware;
+    return event_chain_execute_guarded(chain, context, NULL);
 }
 
-void event_middleware_destroy(EventMiddleware *middleware) {
-    if (!middleware) return;
+EventChainErrorCode event_chain_execute_batch(
+    EventChain *chain,
+    EventContext **contexts,
+    size_t count,
+    ChainResult *results
+) {
+    if (!chain || !results) return EC_ERROR_NULL_POINTER;
+    if (count > 0 && !contexts) return EC_ERROR_NULL_POINTER;
 
-    secure_zero(middleware, sizeof(EventMiddleware));
-    free(middleware);
-}
+    for (size_t c = 0; c < count; c++) {
+        results[c].success = true;
+        results[c].failures = NULL;
+        results[c].failure_count = 0;
+    }
 
-/* ==================== EventChain Implementation ==================== */
+    for (size_t c = 0; c < count; c++) {
+        if (!contexts[c]) {
+            for (size_t j = 0; j < count; j++) results[j].success = false;
+            return EC_ERROR_NULL_POINTER;
+        }
+    }
 
-EventChain *event_chain_create_with_detail(
-    FaultToleranceMode mode,
-    ErrorDetailLevel detail_level
-) {
-    EventChain *chain = calloc(1, sizeof(EventChain));
-    if (!chain) return NULL;
+    if (count == 0) return EC_SUCCESS;
 
-    chain->event_capacity = INITIAL_CAPACITY;
-    chain->event_count = 0;
-    chain->events = calloc(chain->event_capacity, sizeof(ChainableEvent *));
+    /* Reentrancy check and compile once for the whole batch */
+    bool guarded = !chain->is_frozen;
+    if (guarded) {
+        if (chain->is_executing) {
+            for (size_t c = 0; c < count; c++) results[c].success = false;
+            return EC_ERROR_REENTRANCY;
+        }
 
-    chain->middleware_capacity = INITIAL_CAPACITY;
-    chain->middleware_count = 0;
-    chain->middlewares = calloc(chain->middleware_capacity, sizeof(EventMiddleware *));
+        if (!chain->plan) {
+            EventChainErrorCode err = event_chain_plan_compile(chain, &chain->plan, NULL);
+            if (err != EC_SUCCESS) {
+                for (size_t c = 0; c < count; c++) results[c].success = false;
+                return err;
+            }
+        }
+    }
 
-    chain->context = event_context_create();
-    chain->fault_tolerance = mode;
-    chain->error_detail_level = detail_level;
-    chain->should_continue = NULL;
-    chain->failure_handler_data = NULL;
-    chain->is_executing = 0;
-    chain->signal_interrupted = 0;
+    BatchSlot *slots = ec_calloc(count, sizeof(BatchSlot));
+    if (!slots) {
+        for (size_t c = 0; c < count; c++) results[c].success = false;
+        return EC_ERROR_OUT_OF_MEMORY;
+    }
 
-    if (!chain->events || !chain->middlewares || !chain->context) {
-        free(chain->events);
-        free(chain->middlewares);
-        event_context_destroy(chain->context);
-        free(chain);
-        return NULL;
+    /*
+     * Every context gets its epoch or none does: ending one that failed
+     * to open would close the caller's own epoch early.
+     */
+    for (size_t c = 0; c < count; c++) {
+        if (event_context_epoch_begin(contexts[c]) != EC_SUCCESS) {
+            while (c-- > 0) event_context_epoch_end(contexts[c]);
+            for (size_t j = 0; j < count; j++) results[j].success = false;
+            ec_free(slots);
+            return EC_ERROR_OVERFLOW;
+        }
     }
 
-    return chain;
-}
+    if (guarded) {
+        chain->is_executing = 1;
+    }
+    chain_clear_interrupt(chain);
 
-EventChain *event_chain_create(FaultToleranceMode mode) {
-    return event_chain_create_with_detail(mode, ERROR_DETAIL_FULL);
+    execute_plan_batch(chain->plan, contexts, count, results, slots, &chain->signal_interrupted);
+    for (size_t c = 0; c < count; c++) {
+        event_context_epoch_end(contexts[c]);
+    }
+
+    if (guarded) {
+        chain->is_executing = 0;
+    }
+
+    ec_free(slots);
+    return EC_SUCCESS;
 }
 
-void event_chain_destroy(EventChain *chain) {
-    if (!chain) return;
+ChainResult event_chain_execute_dag(
+    EventChain *chain,
+    EventContext *context,
+    EventChainExecutor *executor
+) {
+    if (!chain) {
+        ChainResult result;
+        result.success = false;
+        result.failures = NULL;
+        result.failure_count = 0;
+        return result;
+    }
 
-    /* Destroy all events */
-    for (size_t i = 0; i < chain->event_count; i++) {
-        chainable_event_destroy(chain->events[i]);
+    if (!context) {
+        return chain_result_single_failure(
+            "Chain",
+            "No context supplied for execution",
+            EC_ERROR_NULL_POINTER,
+            chain->error_detail_level
+        );
     }
-    free(chain->events);
 
-    /* Destroy all middleware */
-    for (size_t i = 0; i < chain->middleware_count; i++) {
-        event_middleware_destroy(chain->middlewares[i]);
+    if (chain->is_frozen) {
+        chain_clear_interrupt(chain);
+        return execute_plan_in_epoch(chain->plan, context, executor,
+                                     &chain->signal_interrupted);
     }
-    free(chain->middlewares);
 
-    event_context_destroy(chain->context);
+    return event_chain_execute_guarded(chain, context, executor);
+}
 
-    secure_zero(chain, sizeof(EventChain));
-    free(chain);
+/* ==================== ChainResult Implementation ==================== */
+
+void chain_result_destroy(ChainResult *result) {
+    if (!result) return;
+
+    if (result->failures) {
+        /* Zero sensitive data */
+        for (size_t i = 0; i < result->failure_count; i++) {
+            secure_zero(&result->failures[i], sizeof(EventFailure));
+        }
+        ec_free(result->failures);
+        result->failures = NULL;
+    }
+
+    result->failure_count = 0;
 }
 
-EventChainErrorCode event_chain_add_event(
-    EventChain *chain,
-    ChainableEvent *event
-) {
-    if (!chain) return EC_ERROR_NULL_POINTER;
-    if (!event) return EC_ERROR_NULL_POINTER;
-    if (!event->execute) return EC_ERROR_INVALID_PARAMETER;
-    if (!is_valid_function_pointer((const void *)event->execute)) return EC_ERROR_INVALID_PARAMETER;
+void chain_result_print(const ChainResult *result) {
+    if (!result) {
+        printf("NULL result\n");
+        return;
+    }
 
-    /* Check for reentrancy */
-    if (chain->is_executing) {
-        return EC_ERROR_REENTRANCY;
+    printf("\n=== Chain Execution Result ===\n");
+    printf("Success: %s\n", result->success ? "YES" : "NO");
+    printf("Failures: %zu\n", result->failure_count);
+
+    if (result->failure_count > 0) {
+        printf("\nFailure Details:\n");
+        for (size_t i = 0; i < result->failure_count; i++) {
+            printf("  [%zu] Event: %s\n", i + 1, result->failures[i].event_name);
+            printf("      Error: %s\n", result->failures[i].error_message);
+            printf("      Code: %d\n", result->failures[i].error_code);
+            printf("      Time: %lld\n", (long long)result->failures[i].timestamp);
+        }
     }
 
-    /* Check capacity limits */
-    if (chain->event_count >= EVENTCHAINS_MAX_EVENTS) {
-        return EC_ERROR_CAPACITY_EXCEEDED;
+    printf("==============================\n\n");
+}
+
+/* ==================== Executor (Work-Stealing Thread Pool) ==================== */
+
+/**
+ * Unit of work scheduled on the executor
+ */
+typedef struct {
+    void (*run)(void *arg);
+    void *arg;
+} ExecutorTask;
+
+/**
+ * Per-worker double-ended queue
+ *
+ * The owning worker pushes and pops at the bottom (LIFO, cache-warm);
+ * thieves take from the top (FIFO, oldest work first). A short mutex per
+ * deque keeps the owner path uncontended in the common case.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    ExecutorTask *tasks;        /* Ring buffer (owned) */
+    size_t capacity;            /* Power of two */
+    size_t top;                 /* Index of oldest task */
+    size_t bottom;              /* One past newest task */
+} WorkDeque;
+
+typedef struct ExecutorWorker {
+    EventChainExecutor *executor;
+    WorkDeque deque;
+    pthread_t thread;
+    size_t index;
+} ExecutorWorker;
+
+struct EventChainExecutor {
+    ExecutorWorker *workers;
+    size_t worker_count;
+    size_t next_worker;         /* Round-robin target for external submits */
+
+    size_t pending;             /* Reserved or queued, not yet started tasks (atomic) */
+    size_t sleepers;            /* Workers blocked on work_available (atomic) */
+    int shutdown;               /* Set once by destroy (atomic) */
+
+    pthread_mutex_t idle_lock;
+    pthread_cond_t work_available;
+
+    size_t waiters;             /* Threads blocked in event_chain_job_wait (atomic) */
+    pthread_mutex_t completion_lock;
+    pthread_cond_t job_completed;
+};
+
+struct EventChainJob {
+    EventChainExecutor *executor;
+    EventChain *chain;
+    EventContext *context;
+    ChainResult result;
+    bool detached;              /* No handle returned; worker cleans up */
+    int done;                   /* Set once the result is published (atomic) */
+};
+
+/* Worker running on the current thread, if any */
+static __thread ExecutorWorker *current_worker = NULL;
+
+static bool work_deque_init(WorkDeque *deque) {
+    deque->capacity = INITIAL_CAPACITY * 4;
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->tasks = ec_calloc(deque->capacity, sizeof(ExecutorTask));
+    if (!deque->tasks) return false;
+
+    if (pthread_mutex_init(&deque->lock, NULL) != 0) {
+        ec_free(deque->tasks);
+        deque->tasks = NULL;
+        return false;
     }
+    return true;
+}
 
-    /* Expand if needed */
-    if (chain->event_count >= chain->event_capacity) {
+static void work_deque_destroy(WorkDeque *deque) {
+    pthread_mutex_destroy(&deque->lock);
+    ec_free(deque->tasks);
+    deque->tasks = NULL;
+}
+
+static EventChainErrorCode work_deque_push(WorkDeque *deque, ExecutorTask task) {
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->bottom - deque->top == deque->capacity) {
         size_t new_capacity;
-        if (!safe_multiply(chain->event_capacity, 2, &new_capacity)) {
+        if (!safe_multiply(deque->capacity, 2, &new_capacity)) {
+            pthread_mutex_unlock(&deque->lock);
             return EC_ERROR_OVERFLOW;
         }
 
-        if (new_capacity > EVENTCHAINS_MAX_EVENTS) {
-            new_capacity = EVENTCHAINS_MAX_EVENTS;
-        }
-
-        ChainableEvent **new_events = realloc(
-            chain->events,
-            sizeof(ChainableEvent *) * new_capacity
-        );
-
-        if (!new_events) {
+        ExecutorTask *new_tasks = ec_calloc(new_capacity, sizeof(ExecutorTask));
+        if (!new_tasks) {
+            pthread_mutex_unlock(&deque->lock);
             return EC_ERROR_OUT_OF_MEMORY;
         }
 
-        chain->events = new_events;
-
-        /* Zero new entries */
-        for (size_t i = chain->event_capacity; i < new_capacity; i++) {
-            chain->events[i] = NULL;
+        /* Unwrap the ring into the new buffer */
+        for (size_t i = deque->top; i != deque->bottom; i++) {
+            new_tasks[i & (new_capacity - 1)] = deque->tasks[i & (deque->capacity - 1)];
         }
 
-        chain->event_capacity = new_capacity;
+        ec_free(deque->tasks);
+        deque->tasks = new_tasks;
+        deque->capacity = new_capacity;
     }
 
-    chain->events[chain->event_count++] = event;
+    deque->tasks[deque->bottom & (deque->capacity - 1)] = task;
+    deque->bottom++;
+
+    pthread_mutex_unlock(&deque->lock);
     return EC_SUCCESS;
 }
 
-EventChainErrorCode event_chain_use_middleware(
-    EventChain *chain,
-    EventMiddleware *middleware
-) {
-    if (!chain) return EC_ERROR_NULL_POINTER;
-    if (!middleware) return EC_ERROR_NULL_POINTER;
-    if (!middleware->execute) return EC_ERROR_INVALID_PARAMETER;
-    if (!is_valid_function_pointer((const void *)middleware->execute)) return EC_ERROR_INVALID_PARAMETER;
+/* Owner side: newest task first */
+static bool work_deque_pop(WorkDeque *deque, ExecutorTask *task_out) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom != deque->top) {
+        deque->bottom--;
+        *task_out = deque->tasks[deque->bottom & (deque->capacity - 1)];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
 
-    /* Check for reentrancy */
-    if (chain->is_executing) {
-        return EC_ERROR_REENTRANCY;
+/* Thief side: oldest task first; never blocks on a busy deque */
+static bool work_deque_steal(WorkDeque *deque, ExecutorTask *task_out) {
+    bool found = false;
+    if (pthread_mutex_trylock(&deque->lock) != 0) {
+        return false;
+    }
+    if (deque->bottom != deque->top) {
+        *task_out = deque->tasks[deque->top & (deque->capacity - 1)];
+        deque->top++;
+        found = true;
     }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
 
-    /* Check capacity limits */
-    if (chain->middleware_count >= EVENTCHAINS_MAX_MIDDLEWARE) {
-        return EC_ERROR_CAPACITY_EXCEEDED;
+static bool executor_find_task(ExecutorWorker *self, ExecutorTask *task_out) {
+    if (work_deque_pop(&self->deque, task_out)) {
+        return true;
     }
 
-    /* Expand if needed */
-    if (chain->middleware_count >= chain->middleware_capacity) {
-        size_t new_capacity;
-        if (!safe_multiply(chain->middleware_capacity, 2, &new_capacity)) {
-            return EC_ERROR_OVERFLOW;
+    /* Steal, starting with the neighbour to spread contention */
+    EventChainExecutor *executor = self->executor;
+    for (size_t i = 1; i < executor->worker_count; i++) {
+        ExecutorWorker *victim = &executor->workers[(self->index + i) % executor->worker_count];
+        if (work_deque_steal(&victim->deque, task_out)) {
+            return true;
         }
+    }
 
-        if (new_capacity > EVENTCHAINS_MAX_MIDDLEWARE) {
-            new_capacity = EVENTCHAINS_MAX_MIDDLEWARE;
-        }
+    return false;
+}
 
-        EventMiddleware **new_middlewares = realloc(
-            chain->middlewares,
-            sizeof(EventMiddleware *) * new_capacity
-        );
+static void *executor_worker_main(void *arg) {
+    ExecutorWorker *self = (ExecutorWorker *)arg;
+    EventChainExecutor *executor = self->executor;
+    current_worker = self;
 
-        if (!new_middlewares) {
-            return EC_ERROR_OUT_OF_MEMORY;
+    for (;;) {
+        ExecutorTask task;
+        if (executor_find_task(self, &task)) {
+            __atomic_fetch_sub(&executor->pending, 1, __ATOMIC_SEQ_CST);
+            task.run(task.arg);
+            continue;
         }
 
-        chain->middlewares = new_middlewares;
+        if (__atomic_load_n(&executor->pending, __ATOMIC_SEQ_CST) > 0) {
+            /* A task is queued (or about to be pushed) but not yet visible; retry */
+            continue;
+        }
 
-        /* Zero new entries */
-        for (size_t i = chain->middleware_capacity; i < new_capacity; i++) {
-            chain->middlewares[i] = NULL;
+        pthread_mutex_lock(&executor->idle_lock);
+        __atomic_fetch_add(&executor->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&executor->pending, __ATOMIC_SEQ_CST) == 0 &&
+               !__atomic_load_n(&executor->shutdown, __ATOMIC_SEQ_CST)) {
+            pthread_cond_wait(&executor->work_available, &executor->idle_lock);
         }
+        __atomic_fetch_sub(&executor->sleepers, 1, __ATOMIC_SEQ_CST);
+        bool exiting = __atomic_load_n(&executor->shutdown, __ATOMIC_SEQ_CST) &&
+                       __atomic_load_n(&executor->pending, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&executor->idle_lock);
 
-        chain->middleware_capacity = new_capacity;
+        if (exiting) break;
     }
 
-    chain->middlewares[chain->middleware_count++] = middleware;
-    return EC_SUCCESS;
+    current_worker = NULL;
+    return NULL;
 }
 
-EventChainErrorCode event_chain_set_failure_handler(
-    EventChain *chain,
-    bool (*handler)(const ChainableEvent *event, const char *error, void *user_data),
-    void *user_data
-) {
-    if (!chain) return EC_ERROR_NULL_POINTER;
+/**
+ * Queue a task: onto the calling worker's own deque when submitted from
+ * inside the pool, otherwise round-robin across workers
+ */
+static EventChainErrorCode executor_schedule(EventChainExecutor *executor, ExecutorTask task) {
+    if (__atomic_load_n(&executor->shutdown, __ATOMIC_SEQ_CST)) {
+        return EC_ERROR_INVALID_PARAMETER;
+    }
 
-    /* Validate function pointer if provided */
-    if (handler && !is_valid_function_pointer((const void *)handler)) {
-        return EC_ERROR_INVALID_FUNCTION_POINTER;
+    /*
+     * Reserve the slot before the task becomes visible: a worker may pop
+     * and count it off as soon as it is pushed, and must not see pending
+     * at 0 (and sleep or exit) while it sits in a deque.
+     */
+    size_t queued = __atomic_fetch_add(&executor->pending, 1, __ATOMIC_SEQ_CST);
+    if (queued >= EVENTCHAINS_MAX_PENDING_JOBS) {
+        __atomic_fetch_sub(&executor->pending, 1, __ATOMIC_SEQ_CST);
+        return EC_ERROR_CAPACITY_EXCEEDED;
+    }
+
+    ExecutorWorker *target;
+    if (current_worker && current_worker->executor == executor) {
+        target = current_worker;
+    } else {
+        size_t slot = __atomic_fetch_add(&executor->next_worker, 1, __ATOMIC_RELAXED);
+        target = &executor->workers[slot % executor->worker_count];
+    }
+
+    EventChainErrorCode err = work_deque_push(&target->deque, task);
+    if (err != EC_SUCCESS) {
+        __atomic_fetch_sub(&executor->pending, 1, __ATOMIC_SEQ_CST);
+        return err;
+    }
+
+    if (__atomic_load_n(&executor->sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&executor->idle_lock);
+        pthread_cond_signal(&executor->work_available);
+        pthread_mutex_unlock(&executor->idle_lock);
     }
 
-    chain->should_continue = handler;
-    chain->failure_handler_data = user_data;
     return EC_SUCCESS;
 }
 
-EventContext *event_chain_get_context(EventChain *chain) {
-    if (!chain) return NULL;
-    return chain->context;
+static size_t executor_default_worker_count(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0) return (size_t)cores;
+#endif
+    return 4;
 }
 
-bool event_chain_was_interrupted(const EventChain *chain) {
-    if (!chain) return false;
-    return chain->signal_interrupted != 0;
-}
+EventChainExecutor *event_chain_executor_create(size_t worker_count) {
+    if (worker_count == 0) {
+        worker_count = executor_default_worker_count();
+    }
+    if (worker_count > EVENTCHAINS_MAX_WORKERS) {
+        worker_count = EVENTCHAINS_MAX_WORKERS;
+    }
 
-/* ==================== Iterative Middleware Pipeline Execution ==================== */
+    EventChainExecutor *executor = ec_calloc(1, sizeof(EventChainExecutor));
+    if (!executor) return NULL;
 
-/**
- * Execution frame for iterative middleware pipeline
- */
-typedef struct {
-    EventMiddleware *middleware;
-    enum { PHASE_PRE, PHASE_POST } phase;
-} ExecutionFrame;
+    executor->workers = ec_calloc(worker_count, sizeof(ExecutorWorker));
+    if (!executor->workers) {
+        ec_free(executor);
+        return NULL;
+    }
 
-/**
- * Execute event through iterative middleware pipeline
- * This replaces recursive execution to prevent stack overflow
- */
-static EventResult execute_event_with_middleware_iterative(
-    EventChain *chain,
-    ChainableEvent *event
-) {
-    if (!chain || !event) {
-        return event_result_failure(
-            "NULL chain or event",
-            EC_ERROR_NULL_POINTER,
-            chain ? chain->error_detail_level : ERROR_DETAIL_FULL
-        );
+    if (pthread_mutex_init(&executor->idle_lock, NULL) != 0) {
+        ec_free(executor->workers);
+        ec_free(executor);
+        return NULL;
+    }
+    pthread_cond_init(&executor->work_available, NULL);
+    pthread_mutex_init(&executor->completion_lock, NULL);
+    pthread_cond_init(&executor->job_completed, NULL);
+
+    /* Deques must all exist before any worker starts stealing */
+    size_t initialized = 0;
+    for (; initialized < worker_count; initialized++) {
+        ExecutorWorker *worker = &executor->workers[initialized];
+        worker->executor = executor;
+        worker->index = initialized;
+        if (!work_deque_init(&worker->deque)) break;
+    }
+    executor->worker_count = worker_count;
+
+    size_t started = 0;
+    if (initialized == worker_count) {
+        for (; started < worker_count; started++) {
+            ExecutorWorker *worker = &executor->workers[started];
+            if (pthread_create(&worker->thread, NULL, executor_worker_main, worker) != 0) {
+                break;
+            }
+        }
     }
 
-    /* If no middleware, execute event directly */
-    if (chain->middleware_count == 0) {
-        return event->execute(chain->context, event->user_data);
+    if (started < worker_count) {
+        /* Stop whatever did start; workers exit at once with nothing queued */
+        pthread_mutex_lock(&executor->idle_lock);
+        __atomic_store_n(&executor->shutdown, 1, __ATOMIC_SEQ_CST);
+        pthread_cond_broadcast(&executor->work_available);
+        pthread_mutex_unlock(&executor->idle_lock);
+
+        for (size_t i = 0; i < started; i++) {
+            pthread_join(executor->workers[i].thread, NULL);
+        }
+        for (size_t i = 0; i < initialized; i++) {
+            work_deque_destroy(&executor->workers[i].deque);
+        }
+        pthread_cond_destroy(&executor->job_completed);
+        pthread_mutex_destroy(&executor->completion_lock);
+        pthread_cond_destroy(&executor->work_available);
+        pthread_mutex_destroy(&executor->idle_lock);
+        ec_free(executor->workers);
+        ec_free(executor);
+        return NULL;
     }
 
-    /* Allocate execution stack */
-    ExecutionFrame *stack = calloc(chain->middleware_count * 2, sizeof(ExecutionFrame));
-    if (!stack) {
-        return event_result_failure(
-            "Failed to allocate middleware stack",
-            EC_ERROR_OUT_OF_MEMORY,
-            chain->error_detail_level
-        );
+    return executor;
+}
+
+void event_chain_executor_destroy(EventChainExecutor *executor) {
+    if (!executor) return;
+
+    pthread_mutex_lock(&executor->idle_lock);
+    __atomic_store_n(&executor->shutdown, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&executor->work_available);
+    pthread_mutex_unlock(&executor->idle_lock);
+
+    /* Workers drain every queued task before exiting */
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        pthread_join(executor->workers[i].thread, NULL);
     }
 
-    /* Build execution sequence (LIFO order for middleware) */
-    size_t stack_depth = 0;
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        work_deque_destroy(&executor->workers[i].deque);
+    }
 
-    /* Push middleware in reverse order (last registered wraps first) */
-    for (size_t i = chain->middleware_count; i > 0; i--) {
-        size_t idx = i - 1;
+    pthread_cond_destroy(&executor->job_completed);
+    pthread_mutex_destroy(&executor->completion_lock);
+    pthread_cond_destroy(&executor->work_available);
+    pthread_mutex_destroy(&executor->idle_lock);
 
-        if (!chain->middlewares[idx] || !chain->middlewares[idx]->execute) {
-            free(stack);
-            return event_result_failure(
-                "Invalid middleware in chain",
-                EC_ERROR_INVALID_PARAMETER,
-                chain->error_detail_level
-            );
-        }
+    ec_free(executor->workers);
+    secure_zero(executor, sizeof(EventChainExecutor));
+    ec_free(executor);
+}
+
+size_t event_chain_executor_worker_count(const EventChainExecutor *executor) {
+    if (!executor) return 0;
+    return executor->worker_count;
+}
+
+static void executor_run_job(void *arg) {
+    EventChainJob *job = (EventChainJob *)arg;
+    EventChainExecutor *executor = job->executor;
+
+    job->result = event_chain_execute_with_context(job->chain, job->context);
 
-        /* Pre-execution phase */
-        stack[stack_depth].middleware = chain->middlewares[idx];
-        stack[stack_depth].phase = PHASE_PRE;
-        stack_depth++;
+    if (job->detached) {
+        chain_result_destroy(&job->result);
+        ec_free(job);
+        return;
     }
 
-    /* Execute the pipeline */
-    EventResult result = event_result_success();
-    bool event_executed = false;
+    __atomic_store_n(&job->done, 1, __ATOMIC_SEQ_CST);
 
-    for (size_t i = 0; i < stack_depth; i++) {
-        ExecutionFrame *frame = &stack[i];
+    if (__atomic_load_n(&executor->waiters, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&executor->completion_lock);
+        pthread_cond_broadcast(&executor->job_completed);
+        pthread_mutex_unlock(&executor->completion_lock);
+    }
+}
 
-        /* Check for signal interruption */
-        if (chain->signal_interrupted) {
-            result = event_result_failure(
-                "Chain execution interrupted by signal",
-                EC_ERROR_SIGNAL_INTERRUPTED,
-                chain->error_detail_level
-            );
-            free(stack);
-            return result;
-        }
+EventChainErrorCode event_chain_executor_submit(
+    EventChainExecutor *executor,
+    EventChain *chain,
+    EventContext *context,
+    EventChainJob **job_out
+) {
+    if (job_out) *job_out = NULL;
+    if (!executor || !chain || !context) return EC_ERROR_NULL_POINTER;
 
-        if (frame->phase == PHASE_PRE) {
-            /* Pre-processing: middleware runs before event */
-            /* In iterative model, we just pass through to core event */
-            continue;
-        }
+    /* Shared across workers, so the chain must be immutable */
+    if (!chain->is_frozen) {
+        return EC_ERROR_INVALID_PARAMETER;
     }
 
-    /* Execute the actual event at the core */
-    if (!event_executed) {
-        result = event->execute(chain->context, event->user_data);
-        event_executed = true;
+    EventChainJob *job = ec_calloc(1, sizeof(EventChainJob));
+    if (!job) return EC_ERROR_OUT_OF_MEMORY;
+
+    job->executor = executor;
+    job->chain = chain;
+    job->context = context;
+    job->detached = (job_out == NULL);
+    job->done = 0;
+
+    ExecutorTask task;
+    task.run = executor_run_job;
+    task.arg = job;
+
+    EventChainErrorCode err = executor_schedule(executor, task);
+    if (err != EC_SUCCESS) {
+        ec_free(job);
+        return err;
     }
 
-    free(stack);
-    return result;
+    if (job_out) *job_out = job;
+    return EC_SUCCESS;
 }
 
-/* ==================== Chain Execution ==================== */
+bool event_chain_job_is_done(const EventChainJob *job) {
+    if (!job) return false;
+    return __atomic_load_n(&job->done, __ATOMIC_SEQ_CST) != 0;
+}
 
-ChainResult event_chain_execute(EventChain *chain) {
+ChainResult event_chain_job_wait(EventChainJob *job) {
     ChainResult result;
-    result.success = true;
+    result.success = false;
     result.failures = NULL;
     result.failure_count = 0;
 
-    if (!chain) {
-        result.success = false;
-        return result;
-    }
+    if (!job) return result;
 
-    /* Check for reentrancy */
-    if (chain->is_executing) {
-        result.success = false;
+    EventChainExecutor *executor = job->executor;
 
-        result.failures = calloc(1, sizeof(EventFailure));
-        if (result.failures) {
-            EventFailure *failure = &result.failures[0];
-            safe_strncpy(failure->event_name, "Chain", EVENTCHAINS_MAX_NAME_LENGTH);
-            sanitize_error_message(
-                failure->error_message,
-                "Reentrancy detected: chain already executing",
-                EVENTCHAINS_MAX_ERROR_LENGTH,
-                chain->error_detail_level
-            );
-            failure->error_code = EC_ERROR_REENTRANCY;
+    if (!__atomic_load_n(&job->done, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&executor->completion_lock);
+        __atomic_fetch_add(&executor->waiters, 1, __ATOMIC_SEQ_CST);
+        while (!__atomic_load_n(&job->done, __ATOMIC_SEQ_CST)) {
+            pthread_cond_wait(&executor->job_completed, &executor->completion_lock);
+        }
+        __atomic_fetch_sub(&executor->waiters, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&executor->completion_lock);
+    }
 
-            int64_t timestamp;
-            if (safe_time_to_int64(time(NULL), &timestamp) == EC_SUCCESS) {
-                failure->timestamp = timestamp;
-            } else {
-                failure->timestamp = 0;
-            }
+    result = job->result;
+    ec_free(job);
+    return result;
+}
 
-            result.failure_count = 1;
-        }
+/* ==================== Dependency-Graph Execution ==================== */
 
-        return result;
-    }
+typedef struct DagRun DagRun;
 
-    /* Set executing flag */
-    chain->is_executing = 1;
-    chain->signal_interrupted = 0;
+typedef struct {
+    DagRun *run;
+    size_t index;
+} DagNodeTask;
 
-    /* Allocate failure tracking */
-    size_t failure_capacity = 8;
-    result.failures = calloc(failure_capacity, sizeof(EventFailure));
-    if (!result.failures) {
-        result.success = false;
-        chain->is_executing = 0;
-        return result;
+/**
+ * Shared state for one execute_dag call
+ *
+ * Nodes are released to the executor as soon as their last prerequisite
+ * settles. Counters are atomic; the lock only guards the result and the
+ * user failure handler, so the success path never takes it.
+ */
+struct DagRun {
+    const EventChainPlan *plan;
+    EventContext *context;
+    EventChainExecutor *executor;
+    const volatile sig_atomic_t *interrupted;
+
+    size_t *remaining;          /* Unsettled prerequisites per node (atomic) */
+    unsigned char *blocked;     /* A prerequisite failed or was skipped (atomic) */
+    DagNodeTask *tasks;
+    size_t outstanding;         /* Nodes not yet settled (atomic) */
+    int cancelled;              /* Stop releasing work (atomic) */
+
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+    bool done;                  /* Guarded by lock */
+    bool stopped;               /* Guarded by lock */
+    ChainResult result;         /* Guarded by lock */
+    size_t failure_capacity;    /* Guarded by lock */
+};
+
+static void dag_run_node(void *arg);
+
+static void dag_release_node(DagRun *run, size_t index) {
+    ExecutorTask task;
+    task.run = dag_run_node;
+    task.arg = &run->tasks[index];
+
+    /* A full or shutting-down pool must not strand the graph */
+    if (executor_schedule(run->executor, task) != EC_SUCCESS) {
+        dag_run_node(task.arg);
     }
+}
 
-    /* Execute each event in sequence */
-    for (size_t i = 0; i < chain->event_count; i++) {
-        /* Check for signal interruption */
-        if (chain->signal_interrupted) {
-            result.success = false;
-
-            if (result.failure_count < failure_capacity) {
-                EventFailure failure;
-                safe_strncpy(failure.event_name, "Chain", EVENTCHAINS_MAX_NAME_LENGTH);
-                sanitize_error_message(
-                    failure.error_message,
-                    "Execution interrupted by signal",
-                    EVENTCHAINS_MAX_ERROR_LENGTH,
-                    chain->error_detail_level
-                );
-                failure.error_code = EC_ERROR_SIGNAL_INTERRUPTED;
-
-                int64_t timestamp;
-                if (safe_time_to_int64(time(NULL), &timestamp) == EC_SUCCESS) {
-                    failure.timestamp = timestamp;
-                } else {
-                    failure.timestamp = 0;
-                }
+/**
+ * Settle a node: block dependents if it did not succeed, release those
+ * whose prerequisites are now all settled, and wake the caller after the
+ * last node. The run must not be touched after the final decrement.
+ */
+static void dag_settle_node(DagRun *run, size_t index, bool succeeded) {
+    const EventChainPlan *plan = run->plan;
 
-                result.failures[result.failure_count++] = failure;
-            }
+    if (!succeeded && plan->skip_failed_dependents) {
+        plan_block_dependents(plan, index, run->blocked);
+    }
 
-            break;
+    for (size_t k = plan->dependent_offsets[index]; k < plan->dependent_offsets[index + 1]; k++) {
+        size_t dependent = plan->dependents[k];
+        if (__atomic_sub_fetch(&run->remaining[dependent], 1, __ATOMIC_ACQ_REL) == 0) {
+            dag_release_node(run, dependent);
         }
+    }
 
-        ChainableEvent *event = chain->events[i];
+    if (__atomic_sub_fetch(&run->outstanding, 1, __ATOMIC_ACQ_REL) == 0) {
+        pthread_mutex_lock(&run->lock);
+        run->done = true;
+        pthread_cond_signal(&run->finished);
+        pthread_mutex_unlock(&run->lock);
+    }
+}
 
-        if (!event || !event->execute || !is_valid_function_pointer((const void *)event->execute)) {
-            /* Record failure */
-            if (result.failure_count < failure_capacity) {
-                EventFailure failure;
-                safe_strncpy(failure.event_name, "InvalidEvent", EVENTCHAINS_MAX_NAME_LENGTH);
-                sanitize_error_message(
-                    failure.error_message,
-                    "Event validation failed",
-                    EVENTCHAINS_MAX_ERROR_LENGTH,
-                    chain->error_detail_level
-                );
-                failure.error_code = EC_ERROR_INVALID_PARAMETER;
+static void dag_record_failure(
+    DagRun *run,
+    const char *event_name,
+    const char *error_message,
+    EventChainErrorCode error_code,
+    bool sanitize
+) {
+    chain_result_record_failure(
+        &run->result, &run->failure_capacity,
+        event_name, error_message, error_code,
+        run->plan->error_detail_level, sanitize
+    );
+}
 
-                int64_t timestamp;
-                if (safe_time_to_int64(time(NULL), &timestamp) == EC_SUCCESS) {
-                    failure.timestamp = timestamp;
-                } else {
-                    failure.timestamp = 0;
-                }
+static void dag_run_node(void *arg) {
+    DagNodeTask *task = (DagNodeTask *)arg;
+    DagRun *run = task->run;
+    size_t index = task->index;
+    const PlanEvent *target = &run->plan->events[index];
 
-                result.failures[result.failure_count++] = failure;
-            }
-            result.success = false;
-            chain->is_executing = 0;
-            return result;
-        }
+    /* Cancelled nodes settle silently, as they would in sequential mode */
+    if (__atomic_load_n(&run->cancelled, __ATOMIC_ACQUIRE)) {
+        dag_settle_node(run, index, false);
+        return;
+    }
 
-        /* Execute event through iterative middleware pipeline */
-        EventResult event_result = execute_event_with_middleware_iterative(chain, event);
+    if (__atomic_load_n(run->interrupted, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&run->lock);
+        if (!run->stopped) {
+            dag_record_failure(run, "Chain", "Execution interrupted by signal",
+                EC_ERROR_SIGNAL_INTERRUPTED, true);
+            run->stopped = true;
+        }
+        __atomic_store_n(&run->cancelled, 1, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&run->lock);
 
-        if (!event_result.success) {
-            /* Expand failure array if needed */
-            if (result.failure_count >= failure_capacity) {
-                size_t new_capacity;
-                if (!safe_multiply(failure_capacity, 2, &new_capacity)) {
-                    /* Can't expand, stop recording failures */
-                } else {
-                    EventFailure *new_failures = realloc(
-                        result.failures,
-                        sizeof(EventFailure) * new_capacity
-                    );
-                    if (new_failures) {
-                        result.failures = new_failures;
-
-                        /* Zero new entries */
-                        for (size_t j = failure_capacity; j < new_capacity; j++) {
-                            memset(&result.failures[j], 0, sizeof(EventFailure));
-                        }
-
-                        failure_capacity = new_capacity;
-                    }
-                }
-            }
+        dag_settle_node(run, index, false);
+        return;
+    }
 
-            /* Record failure */
-            if (result.failure_count < failure_capacity) {
-                EventFailure failure;
-                safe_strncpy(failure.event_name, event->name, EVENTCHAINS_MAX_NAME_LENGTH);
-                safe_strncpy(failure.error_message, event_result.error_message, EVENTCHAINS_MAX_ERROR_LENGTH);
-                failure.error_code = event_result.error_code;
+    /* All prerequisites have settled, so this flag is final */
+    if (__atomic_load_n(&run->blocked[index], __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&run->lock);
+        dag_record_failure(run, target->event->name, "Skipped: a prerequisite event failed",
+            EC_ERROR_DEPENDENCY_FAILED, true);
+        pthread_mutex_unlock(&run->lock);
 
-                int64_t timestamp;
-                if (safe_time_to_int64(time(NULL), &timestamp) == EC_SUCCESS) {
-                    failure.timestamp = timestamp;
-                } else {
-                    failure.timestamp = 0;
-                }
+        dag_settle_node(run, index, false);
+        return;
+    }
 
-                result.failures[result.failure_count++] = failure;
-            }
+    EventResult event_result = execute_planned_event(
+        run->plan, target, run->context, run->interrupted);
 
-            /* Determine if we should continue */
-            bool should_continue = false;
-
-            switch (chain->fault_tolerance) {
-                case FAULT_TOLERANCE_STRICT:
-                    should_continue = false;
-                    break;
-
-                case FAULT_TOLERANCE_LENIENT:
-                case FAULT_TOLERANCE_BEST_EFFORT:
-                    should_continue = true;
-                    break;
-
-                case FAULT_TOLERANCE_CUSTOM:
-                    if (chain->should_continue) {
-                        should_continue = chain->should_continue(
-                            event,
-                            event_result.error_message,
-                            chain->failure_handler_data
-                        );
-                    } else {
-                        /* No handler provided, default to strict */
-                        should_continue = false;
-                    }
-                    break;
-            }
+    if (!event_result.success) {
+        pthread_mutex_lock(&run->lock);
+        if (!run->stopped) {
+            dag_record_failure(run, target->event->name, event_result.error_message,
+                event_result.error_code, false);
 
-            if (!should_continue) {
-                result.success = false;
-                chain->is_executing = 0;
-                return result;
+            /* Failure handlers are serialized by the run lock */
+            if (!plan_should_continue(run->plan, target, event_result.error_message)) {
+                run->stopped = true;
+                __atomic_store_n(&run->cancelled, 1, __ATOMIC_RELEASE);
             }
         }
+        pthread_mutex_unlock(&run->lock);
     }
 
-    /* If we got here and have failures, it's partial success */
-    if (result.failure_count > 0) {
-        result.success = (chain->fault_tolerance != FAULT_TOLERANCE_STRICT);
-    }
-
-    chain->is_executing = 0;
-    return result;
+    dag_settle_node(run, index, event_result.success);
 }
 
-/* ==================== ChainResult Implementation ==================== */
-
-void chain_result_destroy(ChainResult *result) {
-    if (!result) return;
+static ChainResult execute_plan_dag(
+    const EventChainPlan *plan,
+    EventContext *context,
+    EventChainExecutor *executor,
+    const volatile sig_atomic_t *interrupted
+) {
+    /*
+     * Nothing to overlap, a context whose writers can't run side by side,
+     * or we are already on one of this executor's workers: blocking a
+     * worker on its own pool could deadlock it.
+     */
+    if (plan->event_count < 2 || !context->concurrent ||
+        (current_worker && current_worker->executor == executor)) {
+        return execute_plan(plan, context, interrupted);
+    }
 
-    if (result->failures) {
-        /* Zero sensitive data */
-        for (size_t i = 0; i < result->failure_count; i++) {
-            secure_zero(&result->failures[i], sizeof(EventFailure));
-        }
-        free(result->failures);
-        result->failures = NULL;
+    size_t n = plan->event_count;
+    size_t node_bytes, total_bytes;
+    if (!safe_multiply(n, sizeof(size_t) + sizeof(DagNodeTask) + sizeof(unsigned char), &node_bytes) ||
+        !safe_add(sizeof(DagRun), node_bytes, &total_bytes)) {
+        return chain_result_single_failure("Chain", "Dependency graph too large",
+            EC_ERROR_OVERFLOW, plan->error_detail_level);
     }
 
-    result->failure_count = 0;
-}
+    /* Run state, counters and task slots in one block */
+    DagRun *run = ec_calloc(1, total_bytes);
+    if (!run) {
+        return chain_result_single_failure("Chain", "Out of memory",
+            EC_ERROR_OUT_OF_MEMORY, plan->error_detail_level);
+    }
 
-void chain_result_print(const ChainResult *result) {
-    if (!result) {
-        printf("NULL result\n");
-        return;
+    run->tasks = (DagNodeTask *)(run + 1);
+    run->remaining = (size_t *)(run->tasks + n);
+    run->blocked = (unsigned char *)(run->remaining + n);
+
+    run->plan = plan;
+    run->context = context;
+    run->executor = executor;
+    run->interrupted = interrupted;
+    run->outstanding = n;
+    run->result.success = true;
+    run->failure_capacity = 0;  /* Failure records allocated on first failure */
+
+    if (pthread_mutex_init(&run->lock, NULL) != 0) {
+        ec_free(run);
+        return chain_result_single_failure("Chain", "Out of memory",
+            EC_ERROR_OUT_OF_MEMORY, plan->error_detail_level);
+    }
+    if (pthread_cond_init(&run->finished, NULL) != 0) {
+        pthread_mutex_destroy(&run->lock);
+        ec_free(run);
+        return chain_result_single_failure("Chain", "Out of memory",
+            EC_ERROR_OUT_OF_MEMORY, plan->error_detail_level);
     }
 
-    printf("\n=== Chain Execution Result ===\n");
-    printf("Success: %s\n", result->success ? "YES" : "NO");
-    printf("Failures: %zu\n", result->failure_count);
+    for (size_t i = 0; i < n; i++) {
+        run->tasks[i].run = run;
+        run->tasks[i].index = i;
+        run->remaining[i] = plan->prerequisite_counts[i];
+    }
 
-    if (result->failure_count > 0) {
-        printf("\nFailure Details:\n");
-        for (size_t i = 0; i < result->failure_count; i++) {
-            printf("  [%zu] Event: %s\n", i + 1, result->failures[i].event_name);
-            printf("      Error: %s\n", result->failures[i].error_message);
-            printf("      Code: %d\n", result->failures[i].error_code);
-            printf("      Time: %lld\n", (long long)result->failures[i].timestamp);
+    /* Roots only; everything else is released by its last prerequisite */
+    for (size_t i = 0; i < n; i++) {
+        if (plan->prerequisite_counts[i] == 0) {
+            dag_release_node(run, i);
         }
     }
 
-    printf("==============================\n\n");
+    pthread_mutex_lock(&run->lock);
+    while (!run->done) {
+        pthread_cond_wait(&run->finished, &run->lock);
+    }
+    pthread_mutex_unlock(&run->lock);
+
+    ChainResult result = run->result;
+    if (run->stopped) {
+        result.success = false;
+    } else if (result.failure_count > 0) {
+        result.success = plan->partial_success_allowed;
+    }
+
+    pthread_cond_destroy(&run->finished);
+    pthread_mutex_destroy(&run->lock);
+    ec_free(run);
+    return result;
 }
 
 /* ==================== Utility Functions ==================== */
@@ -1246,6 +7808,12 @@ const char *event_chain_error_string(EventChainErrorCode code) {
             return "Time conversion error";
         case EC_ERROR_SIGNAL_INTERRUPTED:
             return "Signal interrupted";
+        case EC_ERROR_CHAIN_FROZEN:
+            return "Chain is frozen";
+        case EC_ERROR_DEPENDENCY_FAILED:
+            return "Dependency failed";
+        case EC_ERROR_TYPE_MISMATCH:
+            return "Value type mismatch";
         default:
             return "Unknown error";
     }
@@ -1261,14 +7829,32 @@ const char *event_chain_version_string(void) {
 }
 
 const char *event_chain_build_info(void) {
-    static char info[512];
+    static char info[2048];
     snprintf(info, sizeof(info),
         "EventChains v%d.%d.%d - Security-Hardened Build (No Magic Numbers)\n"
         "Features:\n"
         "  - Reference counting for memory safety\n"
         "  - Constant-time comparisons for sensitive data\n"
         "  - Memory usage limits (%zu MB max)\n"
-        "  - Iterative middleware execution (max %d layers)\n"
+        "  - Allocation-free middleware dispatch (max %d layers)\n"
+        "  - Work-stealing executor (max %d workers)\n"
+        "  - Dependency-graph (DAG) execution\n"
+        "  - Allocation-free success path, pluggable allocator\n"
+        "  - Inline typed context values (i64, f64, small structs)\n"
+        "  - Optional bump-arena contexts for request-scoped state\n"
+        "  - Context pool sized to the high-water working set\n"
+        "  - Persistent (HAMT) contexts with O(1) snapshots\n"
+        "  - Concurrent contexts: sharded writers, lock-free readers\n"
+        "  - Thread-safe values with biased reference counting\n"
+        "  - Borrow epochs: refcount-free reads during execution\n"
+        "  - Deferred value cleanup queue (inline drain or reclaimer thread)\n"
+        "  - O(1) context removal (swap-remove, unordered iteration)\n"
+        "  - Ownership transfer (take/move) without ref count traffic\n"
+        "  - Context scopes for scratch entries (push/pop)\n"
+        "  - Binary context images, loadable in place (zero-copy)\n"
+        "  - Context change log for incremental checkpoints\n"
+        "  - Sized values with spill to a memory-mapped file\n"
+        "  - Crit-bit prefix index with prefix iteration and removal\n"
         "  - Reentrancy protection\n"
         "  - Signal safety\n"
         "  - Function pointer validation\n"
@@ -1280,7 +7866,8 @@ const char *event_chain_build_info(void) {
         EVENTCHAINS_VERSION_MINOR,
         EVENTCHAINS_VERSION_PATCH,
         EVENTCHAINS_MAX_CONTEXT_MEMORY / (1024 * 1024),
-        EVENTCHAINS_MAX_MIDDLEWARE
+        EVENTCHAINS_MAX_MIDDLEWARE,
+        EVENTCHAINS_MAX_WORKERS
     );
     return info;
 }
\ No newline at end of file
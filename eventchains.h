@@ -54,6 +54,10 @@ extern "C" {
 #define EVENTCHAINS_MAX_CONTEXT_MEMORY (10 * 1024 * 1024)  /* 10MB total context memory */
 #endif
 
+#ifndef EVENTCHAINS_SPILL_SEGMENT
+#define EVENTCHAINS_SPILL_SEGMENT (4 * 1024 * 1024)  /* Spill file mapping granularity */
+#endif
+
 #ifndef EVENTCHAINS_MAX_KEY_LENGTH
 #define EVENTCHAINS_MAX_KEY_LENGTH 256
 #endif
@@ -66,6 +70,38 @@ extern "C" {
 #define EVENTCHAINS_MAX_ERROR_LENGTH 1024
 #endif
 
+#ifndef EVENTCHAINS_MAX_WORKERS
+#define EVENTCHAINS_MAX_WORKERS 64
+#endif
+
+#ifndef EVENTCHAINS_MAX_PENDING_JOBS
+#define EVENTCHAINS_MAX_PENDING_JOBS 65536  /* Queued jobs per executor */
+#endif
+
+#ifndef EVENTCHAINS_ERROR_ARENA_SLOTS
+#define EVENTCHAINS_ERROR_ARENA_SLOTS 8  /* Live failure messages per thread */
+#endif
+
+#ifndef EVENTCHAINS_MAX_INTERNED_KEYS
+#define EVENTCHAINS_MAX_INTERNED_KEYS 1024  /* Process-wide interned keys */
+#endif
+
+#ifndef EVENTCHAINS_MAX_CODECS
+#define EVENTCHAINS_MAX_CODECS 64  /* Process-wide registered value codecs */
+#endif
+
+#ifndef EVENTCHAINS_SMALL_VALUE_SIZE
+#define EVENTCHAINS_SMALL_VALUE_SIZE 32  /* Largest value stored inline */
+#endif
+
+#ifndef EVENTCHAINS_CONTEXT_ARENA_CHUNK
+#define EVENTCHAINS_CONTEXT_ARENA_CHUNK 4096  /* Default arena chunk size in bytes */
+#endif
+
+#ifndef EVENTCHAINS_MAX_DEPENDENCIES
+#define EVENTCHAINS_MAX_DEPENDENCIES 4096  /* Dependency edges per chain */
+#endif
+
 /* Forward declarations */
 typedef struct EventContext EventContext;
 typedef struct EventResult EventResult;
@@ -74,6 +110,12 @@ typedef struct EventMiddleware EventMiddleware;
 typedef struct EventChain EventChain;
 typedef struct ChainResult ChainResult;
 typedef struct RefCountedValue RefCountedValue;
+typedef struct RefCountOwner RefCountOwner;
+typedef struct EventCleanupQueue EventCleanupQueue;
+typedef struct EventChainPlan EventChainPlan;
+typedef struct EventChainExecutor EventChainExecutor;
+typedef struct EventChainJob EventChainJob;
+typedef struct EventContextPool EventContextPool;
 
 /**
  * Error codes for operations
@@ -94,7 +136,10 @@ typedef enum {
     EC_ERROR_MEMORY_LIMIT_EXCEEDED,
     EC_ERROR_INVALID_FUNCTION_POINTER,
     EC_ERROR_TIME_CONVERSION,
-    EC_ERROR_SIGNAL_INTERRUPTED
+    EC_ERROR_SIGNAL_INTERRUPTED,
+    EC_ERROR_CHAIN_FROZEN,
+    EC_ERROR_DEPENDENCY_FAILED,
+    EC_ERROR_TYPE_MISMATCH
 } EventChainErrorCode;
 
 /**
@@ -123,36 +168,243 @@ typedef enum {
  */
 typedef void (*ValueCleanupFunc)(void *value);
 
+/**
+ * EventValueCodec - Turns a pointer value into bytes and back
+ *
+ * Values stored with a codec (event_context_set_with_codec()) can be
+ * serialized; the codec's name is written next to the bytes, and a
+ * loading process finds the codec by that name (event_codec_register()).
+ */
+typedef struct EventValueCodec {
+    const char *name;           /* Stable identifier written into images */
+
+    /*
+     * Write value's encoding to buffer if it fits in capacity. Returns the
+     * encoded size either way, or SIZE_MAX if value can't be encoded.
+     */
+    size_t (*encode)(const void *value, void *buffer, size_t capacity);
+
+    /* New value from encoded bytes (owned by the caller), or NULL on error */
+    void *(*decode)(const void *bytes, size_t size);
+
+    ValueCleanupFunc cleanup;   /* Frees a decoded (or stored) value; may be NULL */
+} EventValueCodec;
+
 /**
  * RefCountedValue - Reference-counted wrapper for context values
  * Prevents use-after-free when values are shared
+ *
+ * Thread-safe values (see ref_counted_value_create_shared()) use biased
+ * counting: ref_count is then the owner thread's private count and
+ * shared_count holds references taken by every other thread.
  */
 struct RefCountedValue {
     void *data;                 /* The actual data */
-    size_t ref_count;           /* Reference count */
+    size_t ref_count;           /* Reference count (owner thread's, if thread-safe) */
     ValueCleanupFunc cleanup;   /* Cleanup function */
+    bool arena_owned;           /* Node lives in a context arena (never freed alone) */
+    bool thread_safe;           /* Counted with the biased/atomic scheme below */
+    RefCountOwner *owner;       /* Thread the count is biased toward, or NULL */
+    int64_t shared_count;       /* Other threads' count x4 | merge flags (atomic) */
+    RefCountedValue *queue_next; /* Link in the owner's merge queue */
+    const EventValueCodec *codec; /* Serializer, if stored with one (not owned) */
+    size_t size;                /* Declared data size (event_context_set_sized), else 0 */
+    uint64_t stamp;             /* When a sized value was stored (spill order) */
+    bool spilled;               /* data points into the context's spill file */
 };
 
+/**
+ * EventContextKey - Handle for an interned context key (see event_key_intern())
+ */
+typedef uint32_t EventContextKey;
+
+#define EVENT_CONTEXT_KEY_INVALID ((EventContextKey)0)
+
+/**
+ * EventValueType - How a context entry stores its value
+ */
+typedef enum {
+    EVENT_VALUE_POINTER,        /* Ref-counted pointer (event_context_set) */
+    EVENT_VALUE_I64,            /* Inline int64_t */
+    EVENT_VALUE_F64,            /* Inline double */
+    EVENT_VALUE_SMALL           /* Inline copy of up to EVENTCHAINS_SMALL_VALUE_SIZE bytes */
+} EventValueType;
+
+/**
+ * EventInlineValue - Storage for a value kept inside the context entry
+ */
+typedef struct {
+    union {
+        int64_t i64;
+        double f64;
+        unsigned char bytes[EVENTCHAINS_SMALL_VALUE_SIZE];
+    } as;
+    size_t size;                /* Bytes used in as.bytes (SMALL only) */
+} EventInlineValue;
+
+/**
+ * EventContextVisitFunc - Callback for event_context_foreach()
+ *
+ * value is the stored data pointer for EVENT_VALUE_POINTER entries and a
+ * const EventInlineValue * for inline ones; both are valid only during the
+ * call. Return false to stop the walk.
+ */
+typedef bool (*EventContextVisitFunc)(
+    const char *key,
+    EventValueType type,
+    const void *value,
+    void *user_data
+);
+
+/**
+ * EventContextChange - A key reported by event_context_changes_since()
+ *
+ * Carries the key's current state, not the history that led to it: type
+ * and value are as for EventContextVisitFunc and valid only during the
+ * call.
+ */
+typedef struct {
+    const char *key;
+    uint64_t version;           /* Version of the key's latest change */
+    bool removed;               /* The key is no longer in the context */
+    EventValueType type;        /* Current value, if not removed */
+    const void *value;
+} EventContextChange;
+
+/**
+ * EventContextChangeFunc - Callback for event_context_changes_since()
+ *
+ * Return false to stop.
+ */
+typedef bool (*EventContextChangeFunc)(const EventContextChange *change, void *user_data);
+
 /**
  * EventContext - Shared state container with proper ownership and limits
  *
- * Thread-safety: NOT thread-safe. External synchronization required.
+ * Thread-safety: NOT thread-safe. External synchronization required,
+ * except for contexts from event_context_create_concurrent().
  */
 struct EventContext {
     char **keys;                /* Array of string keys (owned) */
     RefCountedValue **values;   /* Array of ref-counted values */
-    size_t count;               /* Number of entries */
+    uint32_t *key_hashes;       /* Hash of each key, parallel to keys (owned) */
+    unsigned char *value_types; /* EventValueType of each entry (owned) */
+    EventInlineValue *inline_values;  /* Inline storage; values[i] is NULL (owned) */
+    size_t count;               /* Number of entries (order unspecified) */
     size_t capacity;            /* Allocated capacity */
     size_t total_memory_bytes;  /* Total memory used (for limits) */
+
+    /*
+     * Open-addressing index over the entries (owned). Each slot packs the
+     * key hash's top 16 bits as a fingerprint with entry index + 1;
+     * 0 marks an empty slot. Kept at most half full.
+     */
+    uint32_t *index_slots;
+    size_t index_mask;          /* Slot count - 1 (power of two) */
+
+    /* Interned-key bindings, filled in lazily by the *_k accessors (owned) */
+    EventContextKey *entry_keys;    /* Key bound to each entry, parallel to keys */
+    uint32_t *key_slots;            /* Entry index + 1 per interned key, 0 = unbound */
+    size_t key_slot_count;
+
+    /*
+     * Arena mode (event_context_create_arena): the context, its entry
+     * arrays, keys and value nodes are bump-allocated from these chunks
+     * and released together. arena_chunks is NULL for heap contexts.
+     */
+    struct EventContextArenaChunk *arena_chunks;  /* Newest first */
+    unsigned char *arena_cursor;
+    unsigned char *arena_limit;
+    unsigned char *arena_reset;     /* Cursor just past the context itself */
+    size_t arena_chunk_size;
+    size_t arena_reset_capacity;    /* Entry capacity re-carved by clear */
+
+    /*
+     * Persistent backend (event_context_create_persistent): entries live
+     * in a shared, immutable trie and the arrays above are unused.
+     */
+    struct EventContextHamtNode *hamt_root;
+    bool persistent;
+
+    /*
+     * Concurrent backend (event_context_create_concurrent): entries are
+     * spread over independently locked shards; the arrays above are unused.
+     */
+    struct EventContextShard *shards;
+    bool concurrent;
+
+    /*
+     * Borrow epochs (event_context_epoch_begin): while epoch_depth > 0,
+     * values the context lets go of (persistent backend: replaced roots)
+     * are parked in epoch_deferred and released when the outermost epoch
+     * ends. Heap-allocated even for arena contexts (owned).
+     */
+    void **epoch_deferred;
+    size_t epoch_deferred_count;
+    size_t epoch_deferred_capacity;
+    unsigned epoch_depth;
+
+    /* Where dying values' cleanups go instead of running inline (not owned) */
+    EventCleanupQueue *cleanup_queue;
+
+    /*
+     * Scopes (event_context_push_scope): one frame per open scope, plus
+     * the outer values those scopes overwrote, kept for the pop. Heap
+     * arrays even for arena contexts (owned).
+     */
+    struct EventContextScope *scopes;
+    size_t scope_depth;
+    size_t scope_capacity;
+    struct EventContextScopeSave *scope_saves;
+    size_t scope_save_count;
+    size_t scope_save_capacity;
+
+    /*
+     * Change log (event_context_record_changes): one record per set or
+     * remove, oldest first, with the keys' bytes packed in change_keys.
+     * Changes up to change_base were trimmed or never kept. Heap arrays
+     * even for arena contexts (owned).
+     */
+    struct EventContextChangeRecord *changes;
+    size_t change_count;
+    size_t change_capacity;
+    char *change_keys;
+    size_t change_keys_size;
+    size_t change_keys_capacity;
+    uint64_t version;           /* Bumped by every recorded change */
+    uint64_t change_base;
+    bool record_changes;
+
+    /* Spill file for sized values (event_context_enable_spill), or NULL (owned) */
+    struct EventContextSpill *spill;
+
+    /* Crit-bit tree over keys (event_context_index_prefixes), or NULL (owned) */
+    struct EventContextPrefixIndex *prefix_index;
+
+    /*
+     * Mapped contexts (event_context_load_mapped): entries are read in
+     * place from a serialized image (not owned) and the context is
+     * read-only. values caches decoded pointer values (owned); the other
+     * arrays above are unused.
+     */
+    const unsigned char *mapped_image;
+    size_t mapped_size;
+    bool mapped;
 };
 
 /**
  * EventResult - Represents the outcome of an event execution
+ *
+ * Kept to a few words so it returns in registers through every
+ * middleware layer. The message is held out of line: either a string
+ * with static storage duration, or a slot in the creating thread's error
+ * arena (see event_result_failure()). Copy it if it must outlive the
+ * call that produced it.
  */
 struct EventResult {
     bool success;
-    char error_message[EVENTCHAINS_MAX_ERROR_LENGTH];
     EventChainErrorCode error_code;
+    const char *error_message;    /* Never NULL; "" on success (not owned) */
 };
 
 /**
@@ -177,6 +429,9 @@ struct ChainableEvent {
 
 /**
  * MiddlewareNextFunc - Function to call the next middleware or event
+ *
+ * Middleware must pass its next_data through unchanged. Calling next more
+ * than once (e.g. for retries) re-runs every inner layer and the event.
  */
 typedef EventResult (*MiddlewareNextFunc)(
     ChainableEvent *event,
@@ -211,10 +466,19 @@ struct EventMiddleware {
     char name[EVENTCHAINS_MAX_NAME_LENGTH];
 };
 
+/**
+ * EventDependency - "event_index runs after prerequisite_index"
+ */
+typedef struct {
+    size_t event_index;
+    size_t prerequisite_index;
+} EventDependency;
+
 /**
  * EventChain - Orchestrates execution of events through middleware
  *
- * Thread-safety: NOT thread-safe. Do not share across threads.
+ * Thread-safety: NOT thread-safe. Do not share across threads, except
+ * frozen chains run via event_chain_execute_with_context().
  */
 struct EventChain {
     ChainableEvent **events;
@@ -225,6 +489,11 @@ struct EventChain {
     size_t middleware_count;
     size_t middleware_capacity;
 
+    /* Ordering constraints between events (indices into events[]) */
+    EventDependency *dependencies;
+    size_t dependency_count;
+    size_t dependency_capacity;
+
     EventContext *context;
     FaultToleranceMode fault_tolerance;
     ErrorDetailLevel error_detail_level;
@@ -240,6 +509,10 @@ struct EventChain {
     /* Reentrancy and signal safety */
     volatile sig_atomic_t is_executing;
     volatile sig_atomic_t signal_interrupted;
+
+    /* Compiled execution plan (owned, rebuilt after the chain changes) */
+    EventChainPlan *plan;
+    volatile sig_atomic_t is_frozen;
 };
 
 /**
@@ -274,13 +547,37 @@ struct ChainResult {
  */
 RefCountedValue *ref_counted_value_create(void *data, ValueCleanupFunc cleanup);
 
+/**
+ * Create a reference-counted value that may be shared between threads
+ *
+ * The count is biased toward the calling thread: its retains and releases
+ * are plain loads and stores, as cheap as for ref_counted_value_create().
+ * Other threads update a separate atomic count. When the owner drops its
+ * last reference the two counts are merged and the value is freed by
+ * whichever thread releases the final reference.
+ *
+ * If another thread releases a reference the owner retained (a hand-off),
+ * the value is queued on the owner and merged the next time the owner
+ * releases a thread-safe value, calls ref_counted_value_process_queued(),
+ * or exits. Its cleanup may run on the owner thread.
+ *
+ * @param data - The data to wrap
+ * @param cleanup - Cleanup function (or NULL); may run on any thread
+ * @return Pointer to ref-counted value, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+RefCountedValue *ref_counted_value_create_shared(void *data, ValueCleanupFunc cleanup);
+
 /**
  * Increment reference count
  *
  * @param value - The ref-counted value
  * @return EC_SUCCESS or error code
  *
- * Thread-safety: NOT thread-safe. Caller must synchronize.
+ * Thread-safety: Safe from any thread for values from
+ * ref_counted_value_create_shared(); otherwise NOT thread-safe.
+ * Caller must synchronize.
  */
 EventChainErrorCode ref_counted_value_retain(RefCountedValue *value);
 
@@ -290,10 +587,22 @@ EventChainErrorCode ref_counted_value_retain(RefCountedValue *value);
  * @param value - The ref-counted value
  * @return EC_SUCCESS or error code
  *
- * Thread-safety: NOT thread-safe. Caller must synchronize.
+ * Thread-safety: Safe from any thread for values from
+ * ref_counted_value_create_shared(); otherwise NOT thread-safe.
+ * Caller must synchronize.
  */
 EventChainErrorCode ref_counted_value_release(RefCountedValue *value);
 
+/**
+ * Merge thread-safe values that other threads queued on this thread
+ *
+ * Long-lived threads that create shared values but rarely release any
+ * can call this periodically so handed-off values are freed promptly.
+ *
+ * Thread-safety: Safe to call from any thread (affects only its own queue)
+ */
+void ref_counted_value_process_queued(void);
+
 /**
  * Get the data from a ref-counted value
  *
@@ -307,6 +616,9 @@ void *ref_counted_value_get_data(const RefCountedValue *value);
 /**
  * Get current reference count
  *
+ * For a thread-safe value this is the sum of the owner's and the shared
+ * count, exact only when no other thread is retaining or releasing.
+ *
  * @param value - The ref-counted value
  * @return Reference count, or 0 if invalid
  *
@@ -314,6 +626,57 @@ void *ref_counted_value_get_data(const RefCountedValue *value);
  */
 size_t ref_counted_value_get_count(const RefCountedValue *value);
 
+/* ==================== Cleanup Queue Functions ==================== */
+
+/**
+ * Create a queue for deferred value cleanup
+ *
+ * Contexts attached with event_context_set_cleanup_queue() hand the
+ * cleanup functions of values they drop to the queue instead of running
+ * them inline, so freeing large structures stays off the request path.
+ *
+ * @param background - true: a reclaimer thread owned by the queue runs
+ *                     cleanups as they arrive; false: they run when an
+ *                     attached context's outermost epoch ends (normally the
+ *                     end of a chain execution) or on
+ *                     event_cleanup_queue_drain()
+ * @return Pointer to new queue, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventCleanupQueue *event_cleanup_queue_create(bool background);
+
+/**
+ * Run every pending cleanup, stop the reclaimer thread and free the queue
+ *
+ * Contexts must be detached or destroyed first.
+ *
+ * @param queue - Queue to destroy (may be NULL)
+ *
+ * Thread-safety: Not thread-safe. No context may use the queue meanwhile.
+ */
+void event_cleanup_queue_destroy(EventCleanupQueue *queue);
+
+/**
+ * Run the pending cleanups on the calling thread
+ *
+ * @param queue - The queue
+ * @return Number of cleanups run
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+size_t event_cleanup_queue_drain(EventCleanupQueue *queue);
+
+/**
+ * Number of cleanups waiting to run
+ *
+ * @param queue - The queue
+ * @return Pending count, or 0 if queue is NULL
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+size_t event_cleanup_queue_pending(EventCleanupQueue *queue);
+
 /* ==================== EventContext Functions ==================== */
 
 /**
@@ -325,6 +688,24 @@ size_t ref_counted_value_get_count(const RefCountedValue *value);
  */
 EventContext *event_context_create(void);
 
+/**
+ * Create an EventContext backed by a bump arena
+ *
+ * Keys, value nodes and entry arrays are carved from chunks owned by the
+ * context instead of being allocated one by one, and are released in one
+ * step by event_context_clear() or event_context_destroy(). Space freed by
+ * remove/overwrite is only reclaimed on clear, so this suits short-lived,
+ * request-scoped contexts. Behaviour is otherwise identical to
+ * event_context_create().
+ *
+ * @param chunk_size - Bytes per arena chunk, or 0 for EVENTCHAINS_CONTEXT_ARENA_CHUNK
+ *                     (rounded up so the first chunk holds the context itself)
+ * @return Pointer to new context, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContext *event_context_create_arena(size_t chunk_size);
+
 /**
  * Destroy an EventContext and free its memory
  *
@@ -371,134 +752,982 @@ EventChainErrorCode event_context_set(
 );
 
 /**
- * Get a value from the context (increments ref count)
+ * Intern a context key
+ *
+ * Returns the same handle for equal strings for the life of the process.
+ * Resolve keys once (e.g. when building a chain) and use the *_k
+ * accessors on hot paths: after the first access in a context they are a
+ * bounds check and an array load.
+ *
+ * @param key - Key name (copied, max EVENTCHAINS_MAX_KEY_LENGTH chars)
+ * @return Key handle, or EVENT_CONTEXT_KEY_INVALID if the key is invalid
+ *         or EVENTCHAINS_MAX_INTERNED_KEYS keys are already interned
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContextKey event_key_intern(const char *key);
+
+/**
+ * Get the string an interned key was created from
+ *
+ * @param key - Key handle
+ * @return Key name, or NULL for an unknown handle
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+const char *event_key_name(EventContextKey key);
+
+/**
+ * Set a value by interned key (caller retains ownership)
  *
- * Caller must call ref_counted_value_release() when done.
+ * Equivalent to event_context_set() with the key's name; entries are
+ * shared with the string API.
  *
  * @param context - The context
- * @param key - Key name
- * @param value_out - Output pointer for the ref-counted value
+ * @param key - Interned key handle
+ * @param value - Value pointer (not owned by context)
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER for an unknown handle,
+ *         or another error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_set_k(
+    EventContext *context,
+    EventContextKey key,
+    void *value
+);
+
+/**
+ * Get a value by interned key (without incrementing ref count)
+ *
+ * The first access binds the key to its entry in this context; later
+ * accesses skip hashing and string comparison entirely.
+ *
+ * @param context - The context
+ * @param key - Interned key handle
+ * @param value_out - Output pointer for the value
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, EC_ERROR_INVALID_PARAMETER for
+ *         an unknown handle, or another error code
+ *
+ * Thread-safety: Not thread-safe. May update the context's key bindings,
+ *                so concurrent readers must use event_context_get().
+ */
+EventChainErrorCode event_context_get_k(
+    EventContext *context,
+    EventContextKey key,
+    void **value_out
+);
+
+/**
+ * Store a 64-bit integer inline in the context
+ *
+ * Inline values need no heap allocation and no reference count (only the
+ * key is copied, and only when the entry is new). Overwrites any existing
+ * value for the key, whatever its type.
+ *
+ * @param context - The context
+ * @param key - Key name (copied, max 256 chars)
+ * @param value - Value to store
  * @return EC_SUCCESS or error code
  *
- * Thread-safety: Not thread-safe for writes. Multiple readers OK.
+ * Thread-safety: Not thread-safe. Caller must synchronize.
  */
-EventChainErrorCode event_context_get_ref(
+EventChainErrorCode event_context_set_i64(EventContext *context, const char *key, int64_t value);
+
+/**
+ * Store a double inline in the context (see event_context_set_i64())
+ */
+EventChainErrorCode event_context_set_f64(EventContext *context, const char *key, double value);
+
+/**
+ * Copy a small value inline into the context (see event_context_set_i64())
+ *
+ * @param context - The context
+ * @param key - Key name (copied, max 256 chars)
+ * @param data - Bytes to copy
+ * @param size - Number of bytes, at most EVENTCHAINS_SMALL_VALUE_SIZE
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER if size is too large,
+ *         or another error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_set_small(
     EventContext *context,
     const char *key,
-    RefCountedValue **value_out
+    const void *data,
+    size_t size
 );
 
 /**
- * Get a value from the context (without incrementing ref count)
- *
- * WARNING: Use only if you won't store the pointer. Prefer get_ref().
+ * Read an inline 64-bit integer
  *
  * @param context - The context
  * @param key - Key name
- * @param value_out - Output pointer for the data
- * @return EC_SUCCESS or error code
+ * @param value_out - Receives the value
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, or EC_ERROR_TYPE_MISMATCH if
+ *         the entry holds another type
  *
  * Thread-safety: Not thread-safe for writes. Multiple readers OK.
  */
-EventChainErrorCode event_context_get(
+EventChainErrorCode event_context_get_i64(
     const EventContext *context,
     const char *key,
-    void **value_out
+    int64_t *value_out
 );
 
 /**
- * Check if a key exists in the context (constant-time for sensitive keys)
+ * Read an inline double (see event_context_get_i64())
+ */
+EventChainErrorCode event_context_get_f64(
+    const EventContext *context,
+    const char *key,
+    double *value_out
+);
+
+/**
+ * Read an inline small value without copying
  *
  * @param context - The context
  * @param key - Key name
- * @param constant_time - If true, use timing-attack resistant comparison
- * @return true if key exists, false otherwise
+ * @param data_out - Receives a pointer to the bytes, valid until the
+ *                   context is next modified
+ * @param size_out - Receives the size in bytes
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, or EC_ERROR_TYPE_MISMATCH
  *
  * Thread-safety: Not thread-safe for writes. Multiple readers OK.
  */
-bool event_context_has(
+EventChainErrorCode event_context_get_small(
     const EventContext *context,
     const char *key,
-    bool constant_time
+    const void **data_out,
+    size_t *size_out
 );
 
 /**
- * Remove a value from the context
- *
- * Releases the reference to the value.
+ * Get the storage type of an entry
  *
  * @param context - The context
  * @param key - Key name
- * @return EC_SUCCESS or error code
+ * @param type_out - Receives the type
+ * @return EC_SUCCESS or EC_ERROR_NOT_FOUND
  *
- * Thread-safety: Not thread-safe. Caller must synchronize.
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
  */
-EventChainErrorCode event_context_remove(EventContext *context, const char *key);
+EventChainErrorCode event_context_get_type(
+    const EventContext *context,
+    const char *key,
+    EventValueType *type_out
+);
 
 /**
- * Get the number of entries in the context
+ * Interned-key variants of the scalar accessors (see event_context_get_k())
  *
- * @param context - The context
- * @return Number of entries, or 0 if context is NULL
- *
- * Thread-safety: Not thread-safe for concurrent modifications.
+ * Thread-safety: Not thread-safe. Caller must synchronize.
  */
-size_t event_context_count(const EventContext *context);
+EventChainErrorCode event_context_set_i64_k(EventContext *context, EventContextKey key, int64_t value);
+EventChainErrorCode event_context_get_i64_k(EventContext *context, EventContextKey key, int64_t *value_out);
+EventChainErrorCode event_context_set_f64_k(EventContext *context, EventContextKey key, double value);
+EventChainErrorCode event_context_get_f64_k(EventContext *context, EventContextKey key, double *value_out);
 
 /**
- * Get current memory usage in bytes
+ * Get a value from the context (increments ref count)
+ *
+ * Caller must call ref_counted_value_release() when done. For an arena
+ * context the entry's node is first moved to the heap so the reference
+ * may outlive the arena; that move makes this call a write.
  *
  * @param context - The context
- * @return Memory usage in bytes, or 0 if context is NULL
+ * @param key - Key name
+ * @param value_out - Output pointer for the ref-counted value
+ * @return EC_SUCCESS or error code
  *
- * Thread-safety: Not thread-safe for concurrent modifications.
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
  */
-size_t event_context_memory_usage(const EventContext *context);
+EventChainErrorCode event_context_get_ref(
+    EventContext *context,
+    const char *key,
+    RefCountedValue **value_out
+);
 
 /**
- * Clear all entries from the context
+ * Get a value from the context (without incrementing ref count)
  *
- * Releases references to all values.
+ * WARNING: Use only if you won't store the pointer. Prefer get_ref().
  *
  * @param context - The context
+ * @param key - Key name
+ * @param value_out - Output pointer for the data
+ * @return EC_SUCCESS, or EC_ERROR_TYPE_MISMATCH for an inline value,
+ *         or another error code
  *
- * Thread-safety: Not thread-safe. Caller must synchronize.
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
  */
-void event_context_clear(EventContext *context);
-
-/* ==================== EventResult Functions ==================== */
+EventChainErrorCode event_context_get(
+    const EventContext *context,
+    const char *key,
+    void **value_out
+);
 
 /**
- * Create a success result
+ * Open a borrow epoch on a context
  *
- * @return Success result
+ * Until the matching event_context_epoch_end(), values removed, replaced
+ * or cleared from the context are not released; their cleanup functions
+ * run when the outermost epoch ends. Epochs nest. Every chain execution
+ * runs inside an epoch on its context, so events never need to open one.
+ * Values dropped inside an epoch accumulate until it ends, so an event
+ * that overwrites the same key in a long loop should prefer inline
+ * values (event_context_set_i64() and friends), which are never parked.
  *
- * Thread-safety: Safe to call from any thread
+ * Concurrent contexts keep no epoch state; the call is a no-op there.
+ *
+ * @param context - The context
+ * @return EC_SUCCESS, EC_ERROR_NULL_POINTER, or EC_ERROR_OVERFLOW if
+ *         epochs are nested too deeply
+ *
+ * Thread-safety: Not thread-safe. Same rules as a write to the context.
  */
-EventResult event_result_success(void);
+EventChainErrorCode event_context_epoch_begin(EventContext *context);
 
 /**
- * Create a failure result with error message
+ * Close a borrow epoch, releasing deferred values if it was the outermost
  *
- * @param error_message - Error description (truncated to max length)
- * @param error_code - Specific error code
- * @param detail_level - Amount of detail to include
- * @return Failure result
+ * @param context - The context
+ * @return EC_SUCCESS, EC_ERROR_NULL_POINTER, or EC_ERROR_INVALID_PARAMETER
+ *         if no epoch is open
  *
- * Thread-safety: Safe to call from any thread
+ * Thread-safety: Not thread-safe. Same rules as a write to the context.
  */
-EventResult event_result_failure(
-    const char *error_message,
-    EventChainErrorCode error_code,
-    ErrorDetailLevel detail_level
-);
-
-/* ==================== ChainableEvent Functions ==================== */
+EventChainErrorCode event_context_epoch_end(EventContext *context);
 
 /**
- * Create a new ChainableEvent
+ * Borrow a value for the rest of the current epoch
  *
- * @param execute - The function that implements the event logic
+ * Like event_context_get(), with no reference count traffic, but the
+ * pointer stays valid until the outermost open epoch ends even if the
+ * entry is removed or overwritten in the meantime. Use it instead of
+ * event_context_get_ref() for values that need not outlive the chain
+ * execution reading them.
+ *
+ * @param context - The context (not a concurrent one)
+ * @param key - Key name
+ * @param value_out - Output pointer for the data
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, EC_ERROR_TYPE_MISMATCH for an
+ *         inline value, or EC_ERROR_INVALID_PARAMETER if no epoch is open
+ *         or the context is concurrent (use event_context_get_ref() there)
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
+ */
+EventChainErrorCode event_context_borrow(
+    const EventContext *context,
+    const char *key,
+    void **value_out
+);
+
+/**
+ * Route the cleanup of values this context drops through a queue
+ *
+ * Applies to overwrite, remove, clear, destroy and epoch release. A value
+ * still referenced elsewhere (see event_context_get_ref()) is cleaned up
+ * inline by whoever releases it last, as before. Returning a context to a
+ * pool detaches it.
+ *
+ * @param context - A heap or arena context
+ * @param queue - Queue to use, or NULL to run cleanups inline again
+ * @return EC_SUCCESS, EC_ERROR_NULL_POINTER, or EC_ERROR_INVALID_PARAMETER
+ *         for persistent and concurrent contexts, whose values are freed
+ *         by trie nodes that may be shared between contexts
+ *
+ * Thread-safety: Not thread-safe. Same rules as a write to the context.
+ */
+EventChainErrorCode event_context_set_cleanup_queue(
+    EventContext *context,
+    EventCleanupQueue *queue
+);
+
+/**
+ * Check if a key exists in the context (constant-time for sensitive keys)
+ *
+ * @param context - The context
+ * @param key - Key name
+ * @param constant_time - If true, use timing-attack resistant comparison
+ * @return true if key exists, false otherwise
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
+ */
+bool event_context_has(
+    const EventContext *context,
+    const char *key,
+    bool constant_time
+);
+
+/**
+ * Remove a value from the context
+ *
+ * Releases the reference to the value. Constant time: the last entry is
+ * moved into the freed position, so entry order is not preserved.
+ *
+ * @param context - The context
+ * @param key - Key name
+ * @return EC_SUCCESS or error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_remove(EventContext *context, const char *key);
+
+/**
+ * Open a scope for scratch entries
+ *
+ * Keys first written inside the scope are dropped by the matching
+ * event_context_pop_scope(); outer keys stay readable, and any outer
+ * value overwritten inside the scope is put back. Pop costs time in the
+ * entries the scope wrote, not in the size of the context (persistent
+ * contexts just return to the root they had). While a scope is open, keys
+ * that predate it cannot be removed, taken or moved out
+ * (EC_ERROR_INVALID_PARAMETER); overwrite them instead. Clearing or
+ * destroying the context closes every scope without restoring.
+ *
+ * @param context - The context (heap, arena or persistent)
+ * @return EC_SUCCESS, EC_ERROR_OVERFLOW past 64 nested scopes,
+ *         EC_ERROR_INVALID_PARAMETER for a concurrent context, or
+ *         EC_ERROR_OUT_OF_MEMORY
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_push_scope(EventContext *context);
+
+/**
+ * Close the innermost scope, dropping its entries and restoring the outer
+ * values it overwrote
+ *
+ * @param context - The context
+ * @return EC_SUCCESS, or EC_ERROR_INVALID_PARAMETER if no scope is open
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_pop_scope(EventContext *context);
+
+/**
+ * Remove an entry and hand its value to the caller
+ *
+ * Ownership moves with a single lookup and no reference count change:
+ * the caller receives the stored pointer and its cleanup, and becomes
+ * responsible for calling cleanup(value) (or storing both elsewhere).
+ * Pointers borrowed from the context earlier in an open epoch stay valid
+ * only while the caller keeps the value.
+ *
+ * @param context - The context (heap or arena)
+ * @param key - Key name
+ * @param value_out - Receives the value
+ * @param cleanup_out - Receives its cleanup; may be NULL only if the value
+ *                      was stored without one
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, EC_ERROR_TYPE_MISMATCH for an
+ *         inline value, or EC_ERROR_INVALID_PARAMETER if another
+ *         reference to the value exists (see event_context_get_ref()), the
+ *         cleanup has nowhere to go, or the context is persistent or
+ *         concurrent
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_take(
+    EventContext *context,
+    const char *key,
+    void **value_out,
+    ValueCleanupFunc *cleanup_out
+);
+
+/**
+ * Move an entry from one context to another
+ *
+ * Overwrites any value dst holds under the key. Between heap contexts
+ * the ref-counted wrapper itself changes hands, so outstanding references
+ * stay valid and no count changes. Otherwise (src is an arena context,
+ * or dst is persistent or concurrent) the value and its cleanup move
+ * instead, which requires that src hold the only reference. Inline
+ * values are copied.
+ *
+ * @param dst - Destination context (any kind)
+ * @param src - Source context (heap or arena)
+ * @param key - Key name
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, EC_ERROR_INVALID_PARAMETER if
+ *         src is persistent or concurrent or the value can't be moved,
+ *         or an error from storing into dst (src is then unchanged)
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize both contexts.
+ */
+EventChainErrorCode event_context_move(
+    EventContext *dst,
+    EventContext *src,
+    const char *key
+);
+
+/**
+ * Call visit for every entry, in unspecified order
+ *
+ * Persistent and concurrent contexts are walked as a snapshot taken at
+ * the call, so the visitor may modify them. Other contexts must not be
+ * modified until the walk returns.
+ *
+ * @param context - The context
+ * @param visit - Called once per entry; returning false stops the walk
+ * @param user_data - Passed through to visit
+ * @return EC_SUCCESS or error code
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK; safe
+ * alongside writers for concurrent contexts.
+ */
+EventChainErrorCode event_context_foreach(
+    const EventContext *context,
+    EventContextVisitFunc visit,
+    void *user_data
+);
+
+/**
+ * Keep a prefix index over the context's keys
+ *
+ * With the index, event_context_iterate_prefix() and
+ * event_context_remove_prefix() go straight to the keys under a prefix
+ * (namespaced keys like "order.items.3"), in time proportional to the
+ * matches rather than the context's size. It costs one small node per key
+ * (not counted toward the context's memory) and a tree walk on every
+ * insert and remove. Enabling indexes the existing keys; disabling frees
+ * the index. The context's pool drops it on release.
+ *
+ * @param context - The context (heap or arena)
+ * @param enabled - Whether to keep the index
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER for a persistent,
+ *         concurrent or mapped context, or EC_ERROR_OUT_OF_MEMORY
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_index_prefixes(EventContext *context, bool enabled);
+
+/**
+ * Call visit for every entry whose key starts with prefix
+ *
+ * Indexed contexts (event_context_index_prefixes()) visit just the
+ * matches, in bytewise key order. Other contexts are scanned in full, in
+ * unspecified order, with the same modification rules as
+ * event_context_foreach(); an indexed context must not be modified until
+ * the walk returns.
+ *
+ * @param context - The context
+ * @param prefix - Key prefix ("" matches every key)
+ * @param visit - Called once per matching entry; returning false stops
+ * @param user_data - Passed through to visit
+ * @return EC_SUCCESS or error code
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK; safe
+ * alongside writers for concurrent contexts.
+ */
+EventChainErrorCode event_context_iterate_prefix(
+    const EventContext *context,
+    const char *prefix,
+    EventContextVisitFunc visit,
+    void *user_data
+);
+
+/**
+ * Remove every entry whose key starts with prefix
+ *
+ * Values are released as by event_context_remove(). On a heap or arena
+ * context nothing is removed if any match predates the innermost open
+ * scope. Indexed contexts cut the matching subtree out in one step and
+ * touch no other entry.
+ *
+ * @param context - The context
+ * @param prefix - Key prefix ("" matches every key)
+ * @param removed_out - Receives the number of entries removed (may be NULL)
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER for a mapped context or
+ *         a match an open scope keeps, or error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize (concurrent
+ * contexts: safe alongside other threads' writes, but not atomic).
+ */
+EventChainErrorCode event_context_remove_prefix(
+    EventContext *context,
+    const char *prefix,
+    size_t *removed_out
+);
+
+/**
+ * Start or stop recording changes
+ *
+ * While recording, every set and remove (including those made by clear,
+ * take, move and scope pops) appends the key to a change log and bumps
+ * the context's version, so a checkpoint or a standby replica can ship
+ * just what changed (event_context_changes_since()) instead of the whole
+ * context. Starting advances the version past any earlier cursor;
+ * stopping frees the log.
+ *
+ * @param context - The context (heap, arena or persistent)
+ * @param enabled - Whether to record
+ * @return EC_SUCCESS, or EC_ERROR_INVALID_PARAMETER for a concurrent or
+ *         mapped context
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_record_changes(EventContext *context, bool enabled);
+
+/**
+ * Get the context's current version
+ *
+ * @param context - The context
+ * @return Version (grows by one per recorded change), or 0 if context is NULL
+ *
+ * Thread-safety: Not thread-safe for concurrent modifications.
+ */
+uint64_t event_context_version(const EventContext *context);
+
+/**
+ * Report every key changed after a version
+ *
+ * Each key is reported once, with its current value or as removed,
+ * however often it changed; order is unspecified. Applying the reports to
+ * a copy taken at version brings it up to event_context_version(). The
+ * visitor must not modify the context.
+ *
+ * @param context - A context recording changes
+ * @param version - Version the reader is at (from event_context_version())
+ * @param visit - Called once per changed key; returning false stops
+ * @param user_data - Passed through to visit
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER if the context isn't
+ *         recording or the log no longer reaches back to version (the
+ *         reader must resync from a full image, see
+ *         event_context_serialize()), or EC_ERROR_OUT_OF_MEMORY
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK.
+ */
+EventChainErrorCode event_context_changes_since(
+    const EventContext *context,
+    uint64_t version,
+    EventContextChangeFunc visit,
+    void *user_data
+);
+
+/**
+ * Drop change records up to a version every reader has caught up with
+ *
+ * Records made inside an open scope are kept until it pops.
+ *
+ * @param context - A context recording changes
+ * @param version - Oldest version a reader may still ask about
+ * @return EC_SUCCESS, or EC_ERROR_INVALID_PARAMETER if the context isn't
+ *         recording
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_trim_changes(EventContext *context, uint64_t version);
+
+/**
+ * Get the number of entries in the context
+ *
+ * @param context - The context
+ * @return Number of entries, or 0 if context is NULL
+ *
+ * Thread-safety: Not thread-safe for concurrent modifications.
+ */
+size_t event_context_count(const EventContext *context);
+
+/**
+ * Get current memory usage in bytes
+ *
+ * @param context - The context
+ * @return Memory usage in bytes, or 0 if context is NULL
+ *
+ * Thread-safety: Not thread-safe for concurrent modifications.
+ */
+size_t event_context_memory_usage(const EventContext *context);
+
+/**
+ * Set a value that declares its size, with ownership transfer
+ *
+ * value is a flat buffer of size bytes. Unlike other values its bytes
+ * count toward the context's memory usage and
+ * EVENTCHAINS_MAX_CONTEXT_MEMORY, and with a spill file
+ * (event_context_enable_spill()) it may be moved out of memory.
+ *
+ * @param context - The context (heap or arena)
+ * @param key - Key name (copied, max 256 chars)
+ * @param value - Buffer of size bytes
+ * @param size - Its size in bytes
+ * @param cleanup - Function to free value, or NULL if caller retains
+ *                  ownership; may run as soon as the value is spilled
+ * @return EC_SUCCESS, EC_ERROR_MEMORY_LIMIT_EXCEEDED if it doesn't fit
+ *         and can't be spilled, EC_ERROR_INVALID_PARAMETER for a
+ *         persistent, concurrent or mapped context, or another error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_set_sized(
+    EventContext *context,
+    const char *key,
+    void *value,
+    size_t size,
+    ValueCleanupFunc cleanup
+);
+
+/**
+ * Let sized values spill to a memory-mapped file when memory runs short
+ *
+ * When storing a sized value would take the context past budget, the
+ * least recently stored sized values are copied to an unlinked temporary
+ * file and their buffers released; a value that doesn't fit even then is
+ * stored in the file directly. Spilled values are read through a shared
+ * mapping, so the kernel pages them in on access and can drop them again
+ * under pressure. get() returns a pointer into the mapping, valid as long
+ * as the entry is unchanged; get_ref(), take() and move() first copy the
+ * value back into memory. File space is reused only after clear().
+ *
+ * Calling it again only changes the budget.
+ *
+ * @param context - The context (heap or arena)
+ * @param directory - Where to create the file, or NULL for $TMPDIR or /tmp
+ * @param budget - Bytes the context may keep in memory; 0 or more than
+ *                 EVENTCHAINS_MAX_CONTEXT_MEMORY means that limit
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER for a persistent,
+ *         concurrent or mapped context or a file that can't be created,
+ *         or EC_ERROR_OUT_OF_MEMORY
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_enable_spill(
+    EventContext *context,
+    const char *directory,
+    size_t budget
+);
+
+/**
+ * Get the bytes of sized values currently spilled to the file
+ *
+ * @param context - The context
+ * @return Spilled bytes, or 0 if context is NULL or has no spill file
+ *
+ * Thread-safety: Not thread-safe for concurrent modifications.
+ */
+size_t event_context_spilled_bytes(const EventContext *context);
+
+/**
+ * Clear all entries from the context
+ *
+ * Releases references to all values.
+ *
+ * @param context - The context
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+void event_context_clear(EventContext *context);
+
+/**
+ * Create an EventContext backed by a persistent hash array mapped trie
+ *
+ * Entries are immutable nodes shared between versions: a write copies
+ * only the O(log n) path it changes, and event_context_snapshot() of a
+ * persistent context is O(1). Every event_context_* function works on
+ * persistent contexts; lookups cost a few pointer hops more than the
+ * array backend, and interned-key bindings are not used.
+ *
+ * @return Pointer to new context, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContext *event_context_create_persistent(void);
+
+/**
+ * Create an EventContext that may be shared between threads
+ *
+ * Keys are spread over independently locked shards, each a persistent
+ * trie (see event_context_create_persistent()). Writers lock only their
+ * key's shard; get, get_ref, has and the typed getters take no lock at
+ * all. Events running on different executor workers can therefore share
+ * one context without a common serialization point.
+ *
+ * Every event_context_* function is safe to call concurrently on such a
+ * context, except event_context_destroy(). Pointers handed out (values
+ * from get(), data from get_small()) stay valid only until another
+ * thread overwrites or removes that key. Values are stored with atomic
+ * reference counts, so a reference from event_context_get_ref() may be
+ * kept and released on any thread.
+ *
+ * @return Pointer to new context, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContext *event_context_create_concurrent(void);
+
+/**
+ * Take an O(1) snapshot (fork) of a persistent context
+ *
+ * The snapshot and the original evolve independently from here: writes to
+ * either are invisible to the other, and shared entries are released when
+ * the last version referencing them is destroyed. Use it to checkpoint
+ * before a risky event or to hand each parallel branch its own view.
+ *
+ * @param context - A persistent context
+ * @return New context sharing all entries, or NULL if context is NULL, not
+ *         persistent, or allocation fails
+ *
+ * Thread-safety: Not thread-safe against writes to context. Distinct
+ * snapshots may be used and destroyed on different threads, except that
+ * event_context_get_ref() on a value shared by several snapshots must be
+ * externally synchronized.
+ */
+EventContext *event_context_snapshot(const EventContext *context);
+
+/* ==================== Serialization Functions ==================== */
+
+/**
+ * Register a value codec under its name
+ *
+ * Images name the codec of each pointer value; loading finds it here.
+ * The codec is not copied and must outlive every context that uses it.
+ *
+ * @param codec - Codec with a name (max EVENTCHAINS_MAX_NAME_LENGTH chars),
+ *                encode and decode
+ * @return EC_SUCCESS (also if this codec is already registered),
+ *         EC_ERROR_INVALID_PARAMETER if another codec has the name, or
+ *         EC_ERROR_CAPACITY_EXCEEDED past EVENTCHAINS_MAX_CODECS codecs
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventChainErrorCode event_codec_register(const EventValueCodec *codec);
+
+/**
+ * Find a registered codec by name
+ *
+ * @param name - Codec name
+ * @return The codec, or NULL if none is registered under name
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+const EventValueCodec *event_codec_find(const char *name);
+
+/**
+ * Set a value that can be serialized, with ownership transfer
+ *
+ * Like event_context_set_with_cleanup(), with codec->cleanup as the
+ * cleanup. The codec need not be registered to serialize, only to load.
+ *
+ * @param context - The context
+ * @param key - Key name (copied, max 256 chars)
+ * @param value - Value pointer (may be NULL)
+ * @param codec - How to encode value (not owned)
+ * @return EC_SUCCESS or error code
+ *
+ * Thread-safety: Not thread-safe. Caller must synchronize.
+ */
+EventChainErrorCode event_context_set_with_codec(
+    EventContext *context,
+    const char *key,
+    void *value,
+    const EventValueCodec *codec
+);
+
+/**
+ * Write a context to a flat binary image
+ *
+ * The image holds every entry, a hash index over them and the encoded
+ * bytes, at 8-byte aligned offsets, so event_context_load_mapped() can
+ * use it in place. Integers are in this machine's byte order; loading
+ * on a machine with the other order is refused.
+ *
+ * @param context - The context (any kind)
+ * @param image_out - Receives the image; free with event_context_image_free()
+ * @param size_out - Receives its size in bytes
+ * @return EC_SUCCESS, EC_ERROR_TYPE_MISMATCH if a pointer value was
+ *         stored without a codec, EC_ERROR_INVALID_PARAMETER if a codec
+ *         fails to encode, or EC_ERROR_OUT_OF_MEMORY
+ *
+ * Thread-safety: Not thread-safe for writes. Multiple readers OK; safe
+ * alongside writers for concurrent contexts.
+ */
+EventChainErrorCode event_context_serialize(
+    const EventContext *context,
+    void **image_out,
+    size_t *size_out
+);
+
+/**
+ * Free an image from event_context_serialize()
+ *
+ * @param image - Image to free (may be NULL)
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+void event_context_image_free(void *image);
+
+/**
+ * Read a serialized image in place, without copying or parsing it
+ *
+ * Only the header is checked, so loading is O(1) whatever the image's
+ * size. Lookups probe the image's own index; scalars and small values are
+ * read straight from it, and pointer values are decoded by their codec
+ * on first access and cached. Each record is bounds-checked as it is
+ * read, so a damaged image yields missing entries rather than bad reads.
+ * A pointer entry whose codec isn't registered reads as missing from
+ * get (event_context_get_encoded() still returns its bytes).
+ *
+ * The context is read-only: writes, remove/take/move out, scopes and
+ * clear return EC_ERROR_INVALID_PARAMETER or do nothing.
+ *
+ * @param image - Image bytes, 8-byte aligned (e.g. from mmap); must stay
+ *                valid and unchanged until the context is destroyed
+ * @param size - Bytes available at image
+ * @return New read-only context, or NULL if the image is not valid
+ *
+ * Thread-safety: Safe to call from any thread. The context may be read
+ * from any number of threads at once.
+ */
+EventContext *event_context_load_mapped(const void *image, size_t size);
+
+/**
+ * Load a serialized image into a new, writable heap context
+ *
+ * Copies every entry and decodes pointer values through their registered
+ * codecs; the image may be freed afterwards.
+ *
+ * @param image - Image bytes, 8-byte aligned
+ * @param size - Bytes available at image
+ * @return New context, or NULL if the image is not valid, a codec is not
+ *         registered or fails, or allocation fails
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContext *event_context_load(const void *image, size_t size);
+
+/**
+ * Get a pointer value's encoded bytes from a mapped context
+ *
+ * The bytes are read in place, with no decode and no copy.
+ *
+ * @param context - A context from event_context_load_mapped()
+ * @param key - Key name
+ * @param bytes_out - Receives the bytes; valid while the image is
+ * @param size_out - Receives their size
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND, EC_ERROR_TYPE_MISMATCH if the
+ *         entry is not an encoded pointer value, or
+ *         EC_ERROR_INVALID_PARAMETER if context is not mapped
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventChainErrorCode event_context_get_encoded(
+    const EventContext *context,
+    const char *key,
+    const void **bytes_out,
+    size_t *size_out
+);
+
+/* ==================== EventContext Pool Functions ==================== */
+
+/**
+ * Create a pool of reusable, arena-backed contexts
+ *
+ * The pool remembers the largest entry capacity and arena footprint seen
+ * across released contexts and sizes the contexts it hands out to match,
+ * so steady-state acquire/release cycles neither grow entry arrays nor
+ * touch the allocator.
+ *
+ * @param max_idle - Most released contexts kept for reuse (0 = 16)
+ * @return Pointer to new pool, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContextPool *event_context_pool_create(size_t max_idle);
+
+/**
+ * Destroy a pool and every idle context in it
+ *
+ * Contexts still acquired stay valid; release them with
+ * event_context_destroy() once the pool is gone.
+ *
+ * @param pool - Pool to destroy (may be NULL)
+ *
+ * Thread-safety: Not thread-safe. No acquire/release may race with destroy.
+ */
+void event_context_pool_destroy(EventContextPool *pool);
+
+/**
+ * Take an empty context from the pool, creating one if none is idle
+ *
+ * @param pool - The pool
+ * @return Empty context, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventContext *event_context_pool_acquire(EventContextPool *pool);
+
+/**
+ * Return a context to the pool
+ *
+ * The context is cleared (value cleanup functions run) before reuse. It
+ * is destroyed instead if the pool is full, if it is smaller than the
+ * pool's high-water mark, or if it did not come from a pool.
+ *
+ * @param pool - The pool
+ * @param context - Context from event_context_pool_acquire() (may be NULL)
+ *
+ * Thread-safety: Safe to call from any thread. The context itself must no
+ * longer be in use.
+ */
+void event_context_pool_release(EventContextPool *pool, EventContext *context);
+
+/* ==================== EventResult Functions ==================== */
+
+/**
+ * Create a success result
+ *
+ * @return Success result
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventResult event_result_success(void);
+
+/**
+ * Create a failure result with error message
+ *
+ * The message is copied into a per-thread ring of
+ * EVENTCHAINS_ERROR_ARENA_SLOTS buffers, so the result's error_message
+ * stays valid until that many further failures are created on the same
+ * thread. Chains copy it into their EventFailure as soon as the event
+ * returns. ERROR_DETAIL_MINIMAL does not touch the arena.
+ *
+ * @param error_message - Error description (truncated to max length)
+ * @param error_code - Specific error code
+ * @param detail_level - Amount of detail to include
+ * @return Failure result
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventResult event_result_failure(
+    const char *error_message,
+    EventChainErrorCode error_code,
+    ErrorDetailLevel detail_level
+);
+
+/**
+ * Create a failure result from a string with static storage duration
+ *
+ * Nothing is copied, so this is the cheapest way to fail with a fixed
+ * message such as a string literal.
+ *
+ * @param error_message - Message that outlives the result (NULL for a
+ *                        generic message)
+ * @param error_code - Specific error code
+ * @return Failure result
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventResult event_result_failure_static(
+    const char *error_message,
+    EventChainErrorCode error_code
+);
+
+/* ==================== ChainableEvent Functions ==================== */
+
+/**
+ * Create a new ChainableEvent
+ *
+ * @param execute - The function that implements the event logic
  * @param user_data - Optional user data (not owned by event)
  * @param name - Name of the event (truncated to max length)
  * @return Pointer to new event, or NULL on failure
@@ -563,6 +1792,24 @@ EventChain *event_chain_create_with_detail(
     ErrorDetailLevel detail_level
 );
 
+/**
+ * Create a reusable chain template with no context of its own
+ *
+ * Define and freeze the template once, then run it any number of times
+ * with event_chain_execute_with_context(), one context per run.
+ * event_chain_get_context() returns NULL for templates.
+ *
+ * @param mode - Fault tolerance mode
+ * @param detail_level - Error message detail level
+ * @return Pointer to new chain, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventChain *event_chain_create_template(
+    FaultToleranceMode mode,
+    ErrorDetailLevel detail_level
+);
+
 /**
  * Create a new EventChain with specified fault tolerance (full detail)
  *
@@ -591,7 +1838,7 @@ void event_chain_destroy(EventChain *chain);
  *
  * @param chain - The chain
  * @param event - Event to add (ownership transferred)
- * @return EC_SUCCESS or error code
+ * @return EC_SUCCESS or error code (EC_ERROR_CHAIN_FROZEN once frozen)
  *
  * Thread-safety: Not thread-safe. Do not call during execution.
  */
@@ -608,7 +1855,7 @@ EventChainErrorCode event_chain_add_event(
  *
  * @param chain - The chain
  * @param middleware - Middleware to add (ownership transferred)
- * @return EC_SUCCESS or error code
+ * @return EC_SUCCESS or error code (EC_ERROR_CHAIN_FROZEN once frozen)
  *
  * Thread-safety: Not thread-safe. Do not call during execution.
  */
@@ -623,7 +1870,7 @@ EventChainErrorCode event_chain_use_middleware(
  * @param chain - The chain
  * @param handler - Callback to determine if execution should continue
  * @param user_data - Data passed to handler (not owned)
- * @return EC_SUCCESS or error code
+ * @return EC_SUCCESS or error code (EC_ERROR_CHAIN_FROZEN once frozen)
  *
  * Thread-safety: Not thread-safe. Set before execution.
  */
@@ -633,13 +1880,69 @@ EventChainErrorCode event_chain_set_failure_handler(
     void *user_data
 );
 
+/**
+ * Declare that an event must run after another event in the same chain
+ *
+ * Dependencies turn the chain into a DAG. Sequential execution runs
+ * events in a topological order that keeps registration order wherever
+ * the dependencies allow; event_chain_execute_dag() additionally runs
+ * events with no path between them concurrently. Unless the chain is
+ * BEST_EFFORT, events downstream of a failure are skipped and reported
+ * with EC_ERROR_DEPENDENCY_FAILED. A cycle is reported when the chain
+ * is frozen or executed (EC_ERROR_INVALID_PARAMETER).
+ *
+ * @param chain - The chain
+ * @param event - Dependent event (already added to the chain)
+ * @param prerequisite - Event that must complete first (already added)
+ * @return EC_SUCCESS, EC_ERROR_NOT_FOUND if either event is not in the
+ *         chain, EC_ERROR_CHAIN_FROZEN once frozen, or another error code
+ *
+ * Thread-safety: Not thread-safe. Set before execution.
+ */
+EventChainErrorCode event_chain_add_dependency(
+    EventChain *chain,
+    const ChainableEvent *event,
+    const ChainableEvent *prerequisite
+);
+
+/**
+ * Freeze the chain into an immutable execution plan
+ *
+ * Compiles events and middleware into one contiguous, read-only plan:
+ * function pointers are validated, middleware order is resolved and the
+ * fault tolerance branch is precomputed. Execution then walks the plan
+ * without re-validating anything. After freezing, adding events or
+ * middleware or changing the failure handler fails with
+ * EC_ERROR_CHAIN_FROZEN. Freezing an already frozen chain is a no-op.
+ *
+ * Unfrozen chains compile the same plan lazily on first execution and
+ * rebuild it whenever the definition changes.
+ *
+ * @param chain - The chain
+ * @return EC_SUCCESS or error code (EC_ERROR_INVALID_PARAMETER if an
+ *         event or middleware fails validation)
+ *
+ * Thread-safety: Not thread-safe. Do not call during execution.
+ */
+EventChainErrorCode event_chain_freeze(EventChain *chain);
+
+/**
+ * Check whether the chain has been frozen
+ *
+ * @param chain - The chain
+ * @return true if frozen, false otherwise
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+bool event_chain_is_frozen(const EventChain *chain);
+
 /**
  * Get the context from the chain
  *
  * Use this to set initial values before execution.
  *
  * @param chain - The chain
- * @return Pointer to context, or NULL if chain is invalid
+ * @return Pointer to context, or NULL if chain is invalid or a template
  *
  * Thread-safety: Not thread-safe for concurrent modifications.
  */
@@ -655,9 +1958,61 @@ EventContext *event_chain_get_context(EventChain *chain);
  */
 ChainResult event_chain_execute(EventChain *chain);
 
+/**
+ * Execute the chain against a caller-supplied context
+ *
+ * The chain's own context is not touched. Unfrozen chains behave like
+ * event_chain_execute() (reentrancy-guarded, plan compiled lazily).
+ * Frozen chains are read-only during execution and may be run from
+ * several threads at once, provided every run uses its own context.
+ *
+ * @param chain - The chain to execute
+ * @param context - Per-run context (not owned)
+ * @return ChainResult that must be freed with chain_result_destroy()
+ *
+ * Thread-safety: Safe to share a frozen chain across threads with
+ *                distinct contexts. Unfrozen chains are not thread-safe.
+ */
+ChainResult event_chain_execute_with_context(EventChain *chain, EventContext *context);
+
+/**
+ * Execute the chain over many independent contexts in one call
+ *
+ * Runs event-major: event 0 for every context, then event 1 for every
+ * context, and so on, so each event's code and user data stay hot in
+ * cache across the batch. The reentrancy check, plan lookup and signal
+ * check are paid once per batch (or per event step) rather than once per
+ * context, and failure records are only allocated for contexts that
+ * fail. Each result is the same as a separate
+ * event_chain_execute_with_context() call for that context would give,
+ * but events of different contexts interleave, so contexts in one batch
+ * must not depend on each other.
+ *
+ * @param chain - The chain to execute
+ * @param contexts - Array of count per-run contexts (not owned)
+ * @param count - Number of contexts
+ * @param results - Array of count results; each must be freed with
+ *                  chain_result_destroy(), even on error
+ * @return EC_SUCCESS if the batch ran (check each result), or an error
+ *         code if it could not start (EC_ERROR_OVERFLOW if a context's
+ *         borrow epochs are already nested as deep as they go)
+ *
+ * Thread-safety: Same rules as event_chain_execute_with_context().
+ */
+EventChainErrorCode event_chain_execute_batch(
+    EventChain *chain,
+    EventContext **contexts,
+    size_t count,
+    ChainResult *results
+);
+
 /**
  * Check if chain was interrupted by signal
  *
+ * Every execution clears the flag as it starts, so it reports an
+ * interrupt raised during the latest run. Threads running one frozen
+ * chain share the flag: an interrupt stops every run in flight.
+ *
  * @param chain - The chain
  * @return true if interrupted, false otherwise
  *
@@ -685,6 +2040,127 @@ void chain_result_destroy(ChainResult *result);
  */
 void chain_result_print(const ChainResult *result);
 
+/* ==================== Executor Functions ==================== */
+
+/**
+ * Create a fixed pool of worker threads for running chains in parallel
+ *
+ * Each worker owns a deque of jobs. Workers take their own newest work
+ * first and steal the oldest work from other workers when idle, so short
+ * chains spread across all cores without a shared run queue.
+ *
+ * @param worker_count - Number of workers, or 0 for one per online core
+ *                       (capped at EVENTCHAINS_MAX_WORKERS)
+ * @return Pointer to new executor, or NULL on failure
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+EventChainExecutor *event_chain_executor_create(size_t worker_count);
+
+/**
+ * Destroy an executor
+ *
+ * Jobs already submitted run to completion first. Handles for those jobs
+ * stay valid and must still be passed to event_chain_job_wait().
+ *
+ * @param executor - Executor to destroy (may be NULL)
+ *
+ * Thread-safety: Not thread-safe. No submits may race with destroy.
+ */
+void event_chain_executor_destroy(EventChainExecutor *executor);
+
+/**
+ * Get the number of running worker threads
+ *
+ * @param executor - The executor
+ * @return Worker count, or 0 if executor is NULL
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+size_t event_chain_executor_worker_count(const EventChainExecutor *executor);
+
+/**
+ * Submit a (chain, context) job
+ *
+ * The chain must be frozen (see event_chain_freeze()); one frozen chain
+ * may back any number of concurrent jobs. The context belongs to the job
+ * until it completes and must not be shared with other running jobs.
+ *
+ * @param executor - The executor
+ * @param chain - Frozen chain to run (not owned)
+ * @param context - Per-job context (not owned)
+ * @param job_out - Receives the completion handle, or NULL to discard the
+ *                  result (fire-and-forget)
+ * @return EC_SUCCESS, EC_ERROR_INVALID_PARAMETER if the chain is not
+ *         frozen or the executor is shutting down,
+ *         EC_ERROR_CAPACITY_EXCEEDED past EVENTCHAINS_MAX_PENDING_JOBS,
+ *         or another error code
+ *
+ * Thread-safety: Safe to call from any thread, including from events
+ *                running on the executor.
+ */
+EventChainErrorCode event_chain_executor_submit(
+    EventChainExecutor *executor,
+    EventChain *chain,
+    EventContext *context,
+    EventChainJob **job_out
+);
+
+/**
+ * Check whether a job has finished
+ *
+ * @param job - Completion handle
+ * @return true if the result is ready, false otherwise
+ *
+ * Thread-safety: Safe to call from any thread
+ */
+bool event_chain_job_is_done(const EventChainJob *job);
+
+/**
+ * Wait for a job and take its result
+ *
+ * Blocks until the job completes, then frees the handle. Each handle must
+ * be waited on exactly once.
+ *
+ * @param job - Completion handle (consumed)
+ * @return ChainResult that must be freed with chain_result_destroy()
+ *
+ * Thread-safety: Safe to call from any thread, once per handle. Do not
+ *                wait from inside a job running on the same executor.
+ */
+ChainResult event_chain_job_wait(EventChainJob *job);
+
+/**
+ * Execute the chain as a dependency graph on an executor
+ *
+ * Each event is released to the executor as soon as all of its
+ * prerequisites (see event_chain_add_dependency()) have settled, so
+ * independent branches run in parallel. Events running at the same time
+ * share the context, so branches only run in parallel on a context from
+ * event_context_create_concurrent(), where any event may write any key.
+ * Every other context's writes touch structure shared by all keys (entry
+ * arrays, index, HAMT root), so on those the graph runs sequentially.
+ * Failures are recorded in completion order. In STRICT mode (or when a
+ * CUSTOM handler returns false) no further events are started after the
+ * first failure; CUSTOM handlers are never called concurrently.
+ *
+ * With a NULL executor, a non-concurrent context, or when called from a
+ * job running on the same executor, the graph runs sequentially on the
+ * calling thread.
+ *
+ * @param chain - The chain to execute
+ * @param context - Per-run context (not owned)
+ * @param executor - Executor to run events on, or NULL
+ * @return ChainResult that must be freed with chain_result_destroy()
+ *
+ * Thread-safety: Same rules as event_chain_execute_with_context().
+ */
+ChainResult event_chain_execute_dag(
+    EventChain *chain,
+    EventContext *context,
+    EventChainExecutor *executor
+);
+
 /* ==================== Factory Functions ==================== */
 
 /**
@@ -722,6 +2198,35 @@ static inline EventChain *event_chain_create_custom(void) {
     return event_chain_create(FAULT_TOLERANCE_CUSTOM);
 }
 
+/* ==================== Allocator Functions ==================== */
+
+/**
+ * EventChainAllocator - Memory functions used for every library allocation
+ *
+ * realloc_fn must accept NULL (allocate) like realloc(); free_fn is never
+ * called with NULL.
+ */
+typedef struct {
+    void *(*malloc_fn)(size_t size, void *user_data);
+    void *(*realloc_fn)(void *ptr, size_t size, void *user_data);
+    void (*free_fn)(void *ptr, void *user_data);
+    void *user_data;
+} EventChainAllocator;
+
+/**
+ * Route library allocations through custom functions
+ *
+ * Memory is always released through the allocator that is installed at
+ * the time, so switch allocators only while no library objects exist
+ * (or when the new allocator can free the old one's memory).
+ *
+ * @param custom - Allocator to copy, or NULL to restore malloc/realloc/free
+ * @return EC_SUCCESS, or EC_ERROR_INVALID_PARAMETER if a function is missing
+ *
+ * Thread-safety: Not thread-safe. Call before any other library use.
+ */
+EventChainErrorCode event_chain_set_allocator(const EventChainAllocator *custom);
+
 /* ==================== Utility Functions ==================== */
 
 /**
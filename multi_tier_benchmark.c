@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <math.h>
+#include <pthread.h>
 
 /* ==================== Timing Infrastructure ==================== */
 
@@ -708,6 +709,1940 @@ static void run_tier4_benchmark(int iterations) {
     free(eventchains_samples);
 }
 
+/* ==================== TIER 5: Reusable Chain Templates ==================== */
+
+#define TIER5_CTX_ITEM "item"
+
+/* Template events find their per-run state in the context, not user_data */
+static EventResult tier5_event_step1(EventContext *ctx, void *user_data) {
+    (void)user_data;
+    void *item_ptr;
+    if (event_context_get(ctx, TIER5_CTX_ITEM, &item_ptr) != EC_SUCCESS) {
+        return event_result_failure("Missing work item", EC_ERROR_NOT_FOUND, ERROR_DETAIL_FULL);
+    }
+    WorkItem *item = (WorkItem *)item_ptr;
+    item->value += 10;
+    do_computational_work(item);
+    return event_result_success();
+}
+
+static EventResult tier5_event_step2(EventContext *ctx, void *user_data) {
+    (void)user_data;
+    void *item_ptr;
+    if (event_context_get(ctx, TIER5_CTX_ITEM, &item_ptr) != EC_SUCCESS) {
+        return event_result_failure("Missing work item", EC_ERROR_NOT_FOUND, ERROR_DETAIL_FULL);
+    }
+    WorkItem *item = (WorkItem *)item_ptr;
+    item->value *= 2;
+    do_computational_work(item);
+    return event_result_success();
+}
+
+static EventResult tier5_event_step3(EventContext *ctx, void *user_data) {
+    (void)user_data;
+    void *item_ptr;
+    if (event_context_get(ctx, TIER5_CTX_ITEM, &item_ptr) != EC_SUCCESS) {
+        return event_result_failure("Missing work item", EC_ERROR_NOT_FOUND, ERROR_DETAIL_FULL);
+    }
+    WorkItem *item = (WorkItem *)item_ptr;
+    item->value -= 5;
+    do_computational_work(item);
+    return event_result_success();
+}
+
+/* Per-request construction: build, execute once, destroy */
+static uint64_t tier5_rebuild_execute(void) {
+    WorkItem item = {42, {0}, 0.0};
+
+    uint64_t start = get_time_ns();
+
+    EventChain *chain = event_chain_create_strict();
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step1, NULL, "Step1"));
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step2, NULL, "Step2"));
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step3, NULL, "Step3"));
+    event_context_set(event_chain_get_context(chain), TIER5_CTX_ITEM, &item);
+
+    ChainResult result = event_chain_execute(chain);
+
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (item.value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+/* Shared template: only the per-request context is created */
+static uint64_t tier5_template_execute(EventChain *template_chain) {
+    WorkItem item = {42, {0}, 0.0};
+
+    uint64_t start = get_time_ns();
+
+    EventContext *ctx = event_context_create();
+    event_context_set(ctx, TIER5_CTX_ITEM, &item);
+
+    ChainResult result = event_chain_execute_with_context(template_chain, ctx);
+
+    chain_result_destroy(&result);
+    event_context_destroy(ctx);
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (item.value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+static void run_tier5_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|   TIER 5: Reusable Templates (Cost of Per-Request Building)   |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    printf("Rebuild: create chain + events + context, execute, destroy\n");
+    printf("Template: frozen chain defined once, fresh context per run\n");
+    printf("Iterations: %d\n\n", iterations);
+
+    EventChain *template_chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_MINIMAL);
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step1, NULL, "Step1"));
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step2, NULL, "Step2"));
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step3, NULL, "Step3"));
+    event_chain_freeze(template_chain);
+
+    uint64_t *rebuild_samples = calloc(iterations, sizeof(uint64_t));
+    uint64_t *template_samples = calloc(iterations, sizeof(uint64_t));
+
+    BenchStats rebuild_stats, template_stats;
+    stats_init(&rebuild_stats);
+    stats_init(&template_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 100; i++) {
+        tier5_rebuild_execute();
+        tier5_template_execute(template_chain);
+    }
+
+    /* Collect samples */
+    for (int i = 0; i < iterations; i++) {
+        uint64_t sample = tier5_rebuild_execute();
+        rebuild_samples[i] = sample;
+        stats_add_sample(&rebuild_stats, sample);
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        uint64_t sample = tier5_template_execute(template_chain);
+        template_samples[i] = sample;
+        stats_add_sample(&template_stats, sample);
+    }
+
+    stats_finalize(&rebuild_stats, rebuild_samples);
+    stats_finalize(&template_stats, template_samples);
+
+    printf("Results:\n");
+    printf("----------------------------------------------------------------\n");
+    stats_print("Rebuild per request", &rebuild_stats);
+    stats_print("Shared frozen template", &template_stats);
+    printf("\n");
+    stats_print_comparison("Template vs Rebuild", &rebuild_stats, &template_stats);
+
+    event_chain_destroy(template_chain);
+    free(rebuild_samples);
+    free(template_samples);
+}
+
+/* ==================== TIER 6: Parallel Executor ==================== */
+
+#define TIER6_BATCH 256
+
+/* One batch of independent chain runs, executed inline on this thread */
+static uint64_t tier6_sequential_batch(EventChain *template_chain,
+                                       EventContext **contexts, WorkItem *items) {
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER6_BATCH; i++) {
+        ChainResult result = event_chain_execute_with_context(template_chain, contexts[i]);
+        chain_result_destroy(&result);
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (items[0].value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+/* The same batch submitted to the work-stealing executor */
+static uint64_t tier6_executor_batch(EventChainExecutor *executor, EventChain *template_chain,
+                                     EventContext **contexts, WorkItem *items) {
+    EventChainJob *jobs[TIER6_BATCH];
+
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER6_BATCH; i++) {
+        if (event_chain_executor_submit(executor, template_chain, contexts[i], &jobs[i]) != EC_SUCCESS) {
+            jobs[i] = NULL;
+        }
+    }
+    for (int i = 0; i < TIER6_BATCH; i++) {
+        if (jobs[i]) {
+            ChainResult result = event_chain_job_wait(jobs[i]);
+            chain_result_destroy(&result);
+        }
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (items[0].value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+static void run_tier6_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 6: Parallel Executor (Throughput Across Cores)      |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    EventChainExecutor *executor = event_chain_executor_create(0);
+    if (!executor) {
+        printf("Executor unavailable, skipping\n");
+        return;
+    }
+
+    int batches = iterations / 100;
+    if (batches < 10) batches = 10;
+
+    printf("Sequential: %d chain runs on the calling thread\n", TIER6_BATCH);
+    printf("Executor: same runs across %zu worker threads\n",
+           event_chain_executor_worker_count(executor));
+    printf("Batches: %d\n\n", batches);
+
+    EventChain *template_chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_MINIMAL);
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step1, NULL, "Step1"));
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step2, NULL, "Step2"));
+    event_chain_add_event(template_chain, chainable_event_create(tier5_event_step3, NULL, "Step3"));
+    event_chain_freeze(template_chain);
+
+    WorkItem *items = calloc(TIER6_BATCH, sizeof(WorkItem));
+    EventContext **contexts = calloc(TIER6_BATCH, sizeof(EventContext *));
+    for (int i = 0; i < TIER6_BATCH; i++) {
+        items[i].value = 42;
+        contexts[i] = event_context_create();
+        event_context_set(contexts[i], TIER5_CTX_ITEM, &items[i]);
+    }
+
+    uint64_t *sequential_samples = calloc(batches, sizeof(uint64_t));
+    uint64_t *executor_samples = calloc(batches, sizeof(uint64_t));
+
+    BenchStats sequential_stats, executor_stats;
+    stats_init(&sequential_stats);
+    stats_init(&executor_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier6_sequential_batch(template_chain, contexts, items);
+        tier6_executor_batch(executor, template_chain, contexts, items);
+    }
+
+    for (int i = 0; i < batches; i++) {
+        uint64_t sample = tier6_sequential_batch(template_chain, contexts, items);
+        sequential_samples[i] = sample;
+        stats_add_sample(&sequential_stats, sample);
+    }
+
+    for (int i = 0; i < batches; i++) {
+        uint64_t sample = tier6_executor_batch(executor, template_chain, contexts, items);
+        executor_samples[i] = sample;
+        stats_add_sample(&executor_stats, sample);
+    }
+
+    stats_finalize(&sequential_stats, sequential_samples);
+    stats_finalize(&executor_stats, executor_samples);
+
+    printf("Results (per batch of %d):\n", TIER6_BATCH);
+    printf("----------------------------------------------------------------\n");
+    stats_print("Sequential", &sequential_stats);
+    stats_print("Executor", &executor_stats);
+    printf("\n");
+    stats_print_comparison("Executor vs Sequential", &sequential_stats, &executor_stats);
+    printf("Throughput: %.0f vs %.0f chains/sec\n",
+           TIER6_BATCH * 1e9 / (double)sequential_stats.avg_ns,
+           TIER6_BATCH * 1e9 / (double)executor_stats.avg_ns);
+
+    for (int i = 0; i < TIER6_BATCH; i++) {
+        event_context_destroy(contexts[i]);
+    }
+    event_chain_executor_destroy(executor);
+    event_chain_destroy(template_chain);
+    free(contexts);
+    free(items);
+    free(sequential_samples);
+    free(executor_samples);
+}
+
+/* ==================== TIER 7: Dependency-Graph Execution ==================== */
+
+#define TIER7_FANOUT 8
+#define TIER7_STEP_LATENCY_NS 200000L  /* Simulated lookup latency per enrichment step */
+
+/* Independent enrichment step: waits on a simulated remote lookup */
+static EventResult tier7_enrich_step(EventContext *ctx, void *user_data) {
+    (void)ctx;
+    struct timespec latency = {0, TIER7_STEP_LATENCY_NS};
+    nanosleep(&latency, NULL);
+    __atomic_add_fetch((int *)user_data, 1, __ATOMIC_RELAXED);
+    return event_result_success();
+}
+
+/* Aggregator: runs once every enrichment step has finished */
+static EventResult tier7_aggregate_step(EventContext *ctx, void *user_data) {
+    (void)ctx;
+    if (__atomic_load_n((int *)user_data, __ATOMIC_RELAXED) % TIER7_FANOUT != 0) {
+        return event_result_failure("Aggregated before enrichment finished",
+                                    EC_ERROR_EVENT_EXECUTION_FAILED, ERROR_DETAIL_MINIMAL);
+    }
+    return event_result_success();
+}
+
+static uint64_t tier7_execute(EventChain *chain, EventContext *context,
+                              EventChainExecutor *executor) {
+    uint64_t start = get_time_ns();
+
+    ChainResult result = event_chain_execute_dag(chain, context, executor);
+    chain_result_destroy(&result);
+
+    uint64_t end = get_time_ns();
+    return end - start;
+}
+
+static void run_tier7_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|     TIER 7: Dependency-Graph Execution (Wide Pipelines)       |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    EventChainExecutor *executor = event_chain_executor_create(TIER7_FANOUT);
+    if (!executor) {
+        printf("Executor unavailable, skipping\n");
+        return;
+    }
+
+    int runs = iterations / 100;
+    if (runs < 20) runs = 20;
+
+    printf("Pipeline: %d independent enrichment steps (%.1f ms each) -> aggregator\n",
+           TIER7_FANOUT, TIER7_STEP_LATENCY_NS / 1e6);
+    printf("Sequential: topological order on the calling thread\n");
+    printf("DAG: ready steps dispatched across %zu workers\n",
+           event_chain_executor_worker_count(executor));
+    printf("Runs: %d\n\n", runs);
+
+    int enriched = 0;
+    EventChain *chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_MINIMAL);
+    ChainableEvent *aggregate = chainable_event_create(tier7_aggregate_step, &enriched, "Aggregate");
+    event_chain_add_event(chain, aggregate);
+    for (int i = 0; i < TIER7_FANOUT; i++) {
+        ChainableEvent *enrich = chainable_event_create(tier7_enrich_step, &enriched, "Enrich");
+        event_chain_add_event(chain, enrich);
+        event_chain_add_dependency(chain, aggregate, enrich);
+    }
+    event_chain_freeze(chain);
+
+    /* Branches only run side by side on a context built for shared writers */
+    EventContext *context = event_context_create_concurrent();
+
+    uint64_t *sequential_samples = calloc(runs, sizeof(uint64_t));
+    uint64_t *dag_samples = calloc(runs, sizeof(uint64_t));
+
+    BenchStats sequential_stats, dag_stats;
+    stats_init(&sequential_stats);
+    stats_init(&dag_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 3; i++) {
+        tier7_execute(chain, context, NULL);
+        tier7_execute(chain, context, executor);
+    }
+
+    for (int i = 0; i < runs; i++) {
+        uint64_t sample = tier7_execute(chain, context, NULL);
+        sequential_samples[i] = sample;
+        stats_add_sample(&sequential_stats, sample);
+    }
+
+    for (int i = 0; i < runs; i++) {
+        uint64_t sample = tier7_execute(chain, context, executor);
+        dag_samples[i] = sample;
+        stats_add_sample(&dag_stats, sample);
+    }
+
+    stats_finalize(&sequential_stats, sequential_samples);
+    stats_finalize(&dag_stats, dag_samples);
+
+    printf("Results (end-to-end latency per run):\n");
+    printf("----------------------------------------------------------------\n");
+    stats_print("Sequential (sum of steps)", &sequential_stats);
+    stats_print("DAG (critical path)", &dag_stats);
+    printf("\n");
+    stats_print_comparison("DAG vs Sequential", &sequential_stats, &dag_stats);
+
+    event_context_destroy(context);
+    event_chain_executor_destroy(executor);
+    event_chain_destroy(chain);
+    free(sequential_samples);
+    free(dag_samples);
+}
+
+/* ==================== TIER 8: Batch Execution ==================== */
+
+#define TIER8_BATCH 256
+
+/* One execute call per context */
+static uint64_t tier8_per_context(EventChain *chain, EventContext **contexts, WorkItem *items) {
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER8_BATCH; i++) {
+        ChainResult result = event_chain_execute_with_context(chain, contexts[i]);
+        chain_result_destroy(&result);
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (items[0].value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+/* One event-major batch call */
+static uint64_t tier8_batched(EventChain *chain, EventContext **contexts,
+                              ChainResult *results, WorkItem *items) {
+    uint64_t start = get_time_ns();
+
+    event_chain_execute_batch(chain, contexts, TIER8_BATCH, results);
+    for (int i = 0; i < TIER8_BATCH; i++) {
+        chain_result_destroy(&results[i]);
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (items[0].value < 0) fflush(stdout);
+
+    return end - start;
+}
+
+static void run_tier8_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|       TIER 8: Batch Execution (Event-Major Loop Order)        |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int batches = iterations / 100;
+    if (batches < 10) batches = 10;
+
+    printf("Per-context: %d separate execute calls\n", TIER8_BATCH);
+    printf("Batched: one event_chain_execute_batch call over %d contexts\n", TIER8_BATCH);
+    printf("Batches: %d\n\n", batches);
+
+    EventChain *chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_MINIMAL);
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step1, NULL, "Step1"));
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step2, NULL, "Step2"));
+    event_chain_add_event(chain, chainable_event_create(tier5_event_step3, NULL, "Step3"));
+
+    WorkItem *items = calloc(TIER8_BATCH, sizeof(WorkItem));
+    EventContext **contexts = calloc(TIER8_BATCH, sizeof(EventContext *));
+    ChainResult *results = calloc(TIER8_BATCH, sizeof(ChainResult));
+    for (int i = 0; i < TIER8_BATCH; i++) {
+        items[i].value = 42;
+        contexts[i] = event_context_create();
+        event_context_set(contexts[i], TIER5_CTX_ITEM, &items[i]);
+    }
+
+    uint64_t *single_samples = calloc(batches, sizeof(uint64_t));
+    uint64_t *batch_samples = calloc(batches, sizeof(uint64_t));
+
+    BenchStats single_stats, batch_stats;
+    stats_init(&single_stats);
+    stats_init(&batch_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier8_per_context(chain, contexts, items);
+        tier8_batched(chain, contexts, results, items);
+    }
+
+    for (int i = 0; i < batches; i++) {
+        uint64_t sample = tier8_per_context(chain, contexts, items);
+        single_samples[i] = sample;
+        stats_add_sample(&single_stats, sample);
+    }
+
+    for (int i = 0; i < batches; i++) {
+        uint64_t sample = tier8_batched(chain, contexts, results, items);
+        batch_samples[i] = sample;
+        stats_add_sample(&batch_stats, sample);
+    }
+
+    stats_finalize(&single_stats, single_samples);
+    stats_finalize(&batch_stats, batch_samples);
+
+    printf("Results (per batch of %d):\n", TIER8_BATCH);
+    printf("----------------------------------------------------------------\n");
+    stats_print("Per-context calls", &single_stats);
+    stats_print("Event-major batch", &batch_stats);
+    printf("\n");
+    stats_print_comparison("Batch vs Per-context", &single_stats, &batch_stats);
+
+    for (int i = 0; i < TIER8_BATCH; i++) {
+        event_context_destroy(contexts[i]);
+    }
+    event_chain_destroy(chain);
+    free(contexts);
+    free(results);
+    free(items);
+    free(single_samples);
+    free(batch_samples);
+}
+
+/* ==================== TIER 9: Result Passing Cost ==================== */
+
+#define TIER9_DEPTH 8
+#define TIER9_CALLS 10000
+
+/* The pre-compaction layout: message buffer embedded by value */
+typedef struct {
+    bool success;
+    char error_message[EVENTCHAINS_MAX_ERROR_LENGTH];
+    EventChainErrorCode error_code;
+} LegacyEventResult;
+
+typedef LegacyEventResult (*LegacyLayerFunc)(int depth);
+typedef EventResult (*CompactLayerFunc)(int depth);
+
+static LegacyEventResult tier9_legacy_layer(int depth);
+static EventResult tier9_compact_layer(int depth);
+
+/* Called through volatile pointers so every layer is a real call */
+static volatile LegacyLayerFunc tier9_legacy_next = tier9_legacy_layer;
+static volatile CompactLayerFunc tier9_compact_next = tier9_compact_layer;
+
+static LegacyEventResult tier9_legacy_layer(int depth) {
+    if (depth == 0) {
+        LegacyEventResult result;
+        result.success = true;
+        result.error_message[0] = '\0';
+        result.error_code = EC_SUCCESS;
+        return result;
+    }
+    return tier9_legacy_next(depth - 1);
+}
+
+static EventResult tier9_compact_layer(int depth) {
+    if (depth == 0) {
+        return event_result_success();
+    }
+    return tier9_compact_next(depth - 1);
+}
+
+static uint64_t tier9_legacy_execute(void) {
+    int successes = 0;
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER9_CALLS; i++) {
+        LegacyEventResult result = tier9_legacy_next(TIER9_DEPTH);
+        successes += result.success;
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (successes < 0) fflush(stdout);
+
+    return end - start;
+}
+
+static uint64_t tier9_compact_execute(void) {
+    int successes = 0;
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER9_CALLS; i++) {
+        EventResult result = tier9_compact_next(TIER9_DEPTH);
+        successes += result.success;
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (successes < 0) fflush(stdout);
+
+    return end - start;
+}
+
+static void run_tier9_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|       TIER 9: Result Passing Through Middleware Layers        |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    printf("Nesting: %d layers, %d calls per sample\n", TIER9_DEPTH, TIER9_CALLS);
+    printf("Legacy result: %zu bytes (message embedded)\n", sizeof(LegacyEventResult));
+    printf("Compact result: %zu bytes (message out of line)\n", sizeof(EventResult));
+    printf("Samples: %d\n\n", samples);
+
+    uint64_t *legacy_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *compact_samples = calloc(samples, sizeof(uint64_t));
+
+    BenchStats legacy_stats, compact_stats;
+    stats_init(&legacy_stats);
+    stats_init(&compact_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier9_legacy_execute();
+        tier9_compact_execute();
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier9_legacy_execute();
+        legacy_samples[i] = sample;
+        stats_add_sample(&legacy_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier9_compact_execute();
+        compact_samples[i] = sample;
+        stats_add_sample(&compact_stats, sample);
+    }
+
+    stats_finalize(&legacy_stats, legacy_samples);
+    stats_finalize(&compact_stats, compact_samples);
+
+    printf("Results (per %d nested calls):\n", TIER9_CALLS);
+    printf("----------------------------------------------------------------\n");
+    stats_print("1 KB result by value", &legacy_stats);
+    stats_print("Compact result", &compact_stats);
+    printf("\n");
+    stats_print_comparison("Compact vs 1 KB", &legacy_stats, &compact_stats);
+
+    free(legacy_samples);
+    free(compact_samples);
+}
+
+/* ==================== TIER 10: Request-Scoped Contexts ==================== */
+
+#define TIER10_ENTRIES 24
+#define TIER10_REQUESTS 1000
+
+static char tier10_keys[TIER10_ENTRIES][16];
+
+typedef enum { TIER10_HEAP, TIER10_ARENA, TIER10_POOL } Tier10Mode;
+
+/* One request: get a context, fill it, read it back, throw it away */
+static uint64_t tier10_execute(Tier10Mode mode, EventContextPool *pool) {
+    static int payload[TIER10_ENTRIES];
+    uintptr_t checksum = 0;
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER10_REQUESTS; r++) {
+        EventContext *ctx = mode == TIER10_POOL ? event_context_pool_acquire(pool) :
+                            mode == TIER10_ARENA ? event_context_create_arena(0) :
+                            event_context_create();
+        for (int i = 0; i < TIER10_ENTRIES; i++) {
+            event_context_set(ctx, tier10_keys[i], &payload[i]);
+        }
+        for (int i = 0; i < TIER10_ENTRIES; i++) {
+            void *value = NULL;
+            event_context_get(ctx, tier10_keys[i], &value);
+            checksum += (uintptr_t)value;
+        }
+        if (mode == TIER10_POOL) {
+            event_context_pool_release(pool, ctx);
+        } else {
+            event_context_destroy(ctx);
+        }
+    }
+
+    uint64_t end = get_time_ns();
+
+    /* Prevent optimization */
+    if (checksum == 1) fflush(stdout);
+
+    return end - start;
+}
+
+static void run_tier10_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|     TIER 10: Request-Scoped Contexts (Heap, Arena, Pool)      |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    for (int i = 0; i < TIER10_ENTRIES; i++) {
+        snprintf(tier10_keys[i], sizeof(tier10_keys[i]), "field_%d", i);
+    }
+
+    printf("Per request: create/acquire, %d sets, %d gets, destroy/release\n",
+           TIER10_ENTRIES, TIER10_ENTRIES);
+    printf("Requests per sample: %d\n", TIER10_REQUESTS);
+    printf("Samples: %d\n\n", samples);
+
+    uint64_t *heap_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *arena_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *pool_samples = calloc(samples, sizeof(uint64_t));
+    EventContextPool *pool = event_context_pool_create(0);
+
+    BenchStats heap_stats, arena_stats, pool_stats;
+    stats_init(&heap_stats);
+    stats_init(&arena_stats);
+    stats_init(&pool_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier10_execute(TIER10_HEAP, NULL);
+        tier10_execute(TIER10_ARENA, NULL);
+        tier10_execute(TIER10_POOL, pool);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier10_execute(TIER10_HEAP, NULL);
+        heap_samples[i] = sample;
+        stats_add_sample(&heap_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier10_execute(TIER10_ARENA, NULL);
+        arena_samples[i] = sample;
+        stats_add_sample(&arena_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier10_execute(TIER10_POOL, pool);
+        pool_samples[i] = sample;
+        stats_add_sample(&pool_stats, sample);
+    }
+
+    stats_finalize(&heap_stats, heap_samples);
+    stats_finalize(&arena_stats, arena_samples);
+    stats_finalize(&pool_stats, pool_samples);
+
+    printf("Results (per %d requests):\n", TIER10_REQUESTS);
+    printf("----------------------------------------------------------------\n");
+    stats_print("Heap context", &heap_stats);
+    stats_print("Arena context", &arena_stats);
+    stats_print("Pooled context", &pool_stats);
+    printf("\n");
+    stats_print_comparison("Arena vs heap", &heap_stats, &arena_stats);
+    stats_print_comparison("Pool vs heap", &heap_stats, &pool_stats);
+
+    event_context_pool_destroy(pool);
+    free(heap_samples);
+    free(arena_samples);
+    free(pool_samples);
+}
+
+/* ==================== TIER 11: Context Forking ==================== */
+
+#define TIER11_ENTRIES 256
+#define TIER11_WRITES 4
+#define TIER11_FORKS 200
+
+static char tier11_keys[TIER11_ENTRIES][16];
+
+/* Fork by copying every entry into a fresh context, then write to it */
+static uint64_t tier11_copy_execute(EventContext *source) {
+    static int payload[TIER11_WRITES];
+    uint64_t start = get_time_ns();
+
+    for (int f = 0; f < TIER11_FORKS; f++) {
+        EventContext *fork = event_context_create();
+        for (int i = 0; i < TIER11_ENTRIES; i++) {
+            void *value = NULL;
+            event_context_get(source, tier11_keys[i], &value);
+            event_context_set(fork, tier11_keys[i], value);
+        }
+        for (int i = 0; i < TIER11_WRITES; i++) {
+            event_context_set(fork, tier11_keys[i * 7], &payload[i]);
+        }
+        event_context_destroy(fork);
+    }
+
+    return get_time_ns() - start;
+}
+
+/* Fork by O(1) snapshot of a persistent context, then write to it */
+static uint64_t tier11_snapshot_execute(EventContext *source) {
+    static int payload[TIER11_WRITES];
+    uint64_t start = get_time_ns();
+
+    for (int f = 0; f < TIER11_FORKS; f++) {
+        EventContext *fork = event_context_snapshot(source);
+        for (int i = 0; i < TIER11_WRITES; i++) {
+            event_context_set(fork, tier11_keys[i * 7], &payload[i]);
+        }
+        event_context_destroy(fork);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier11_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 11: Context Forking (Copy vs Persistent Snapshot)   |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    static int payload[TIER11_ENTRIES];
+    EventContext *array_source = event_context_create();
+    EventContext *persistent_source = event_context_create_persistent();
+    for (int i = 0; i < TIER11_ENTRIES; i++) {
+        snprintf(tier11_keys[i], sizeof(tier11_keys[i]), "state_%d", i);
+        event_context_set(array_source, tier11_keys[i], &payload[i]);
+        event_context_set(persistent_source, tier11_keys[i], &payload[i]);
+    }
+
+    printf("Context size: %d entries, %d writes per fork\n", TIER11_ENTRIES, TIER11_WRITES);
+    printf("Forks per sample: %d\n", TIER11_FORKS);
+    printf("Samples: %d\n\n", samples);
+
+    uint64_t *copy_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *snapshot_samples = calloc(samples, sizeof(uint64_t));
+
+    BenchStats copy_stats, snapshot_stats;
+    stats_init(&copy_stats);
+    stats_init(&snapshot_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier11_copy_execute(array_source);
+        tier11_snapshot_execute(persistent_source);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier11_copy_execute(array_source);
+        copy_samples[i] = sample;
+        stats_add_sample(&copy_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier11_snapshot_execute(persistent_source);
+        snapshot_samples[i] = sample;
+        stats_add_sample(&snapshot_stats, sample);
+    }
+
+    stats_finalize(&copy_stats, copy_samples);
+    stats_finalize(&snapshot_stats, snapshot_samples);
+
+    printf("Results (per %d forks):\n", TIER11_FORKS);
+    printf("----------------------------------------------------------------\n");
+    stats_print("Copy into new context", &copy_stats);
+    stats_print("Persistent snapshot", &snapshot_stats);
+    printf("\n");
+    stats_print_comparison("Snapshot vs copy", &copy_stats, &snapshot_stats);
+
+    event_context_destroy(array_source);
+    event_context_destroy(persistent_source);
+    free(copy_samples);
+    free(snapshot_samples);
+}
+
+/* ==================== TIER 12: Shared Context Scaling ==================== */
+
+#define TIER12_KEYS 64
+#define TIER12_OPS 20000
+#define TIER12_MAX_THREADS 8
+
+static char tier12_keys[TIER12_KEYS][16];
+static pthread_mutex_t tier12_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+    EventContext *ctx;
+    bool locked;            /* Wrap every call in tier12_lock */
+    unsigned seed;
+} Tier12Worker;
+
+/* 90% reads, 10% writes over a shared key set */
+static void *tier12_worker(void *arg) {
+    Tier12Worker *worker = arg;
+    static int payload[TIER12_KEYS];
+    unsigned seed = worker->seed;
+    uintptr_t checksum = 0;
+
+    for (int i = 0; i < TIER12_OPS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int k = (int)((seed >> 8) % TIER12_KEYS);
+        bool write = ((seed >> 20) % 10) == 0;
+
+        if (worker->locked) pthread_mutex_lock(&tier12_lock);
+        if (write) {
+            event_context_set(worker->ctx, tier12_keys[k], &payload[k]);
+        } else {
+            void *value = NULL;
+            event_context_get(worker->ctx, tier12_keys[k], &value);
+            checksum += (uintptr_t)value;
+        }
+        if (worker->locked) pthread_mutex_unlock(&tier12_lock);
+    }
+
+    /* Prevent optimization */
+    if (checksum == 1) fflush(stdout);
+    return NULL;
+}
+
+static uint64_t tier12_execute(EventContext *ctx, bool locked, int thread_count) {
+    pthread_t threads[TIER12_MAX_THREADS];
+    Tier12Worker workers[TIER12_MAX_THREADS];
+    uint64_t start = get_time_ns();
+
+    for (int t = 0; t < thread_count; t++) {
+        workers[t].ctx = ctx;
+        workers[t].locked = locked;
+        workers[t].seed = (unsigned)t * 7919u + 1u;
+        pthread_create(&threads[t], NULL, tier12_worker, &workers[t]);
+    }
+    for (int t = 0; t < thread_count; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier12_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|     TIER 12: Shared Context Scaling (Mutex vs Concurrent)     |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 1000;
+    if (samples < 5) samples = 5;
+
+    static int payload[TIER12_KEYS];
+    EventContext *locked_ctx = event_context_create();
+    EventContext *concurrent_ctx = event_context_create_concurrent();
+    for (int i = 0; i < TIER12_KEYS; i++) {
+        snprintf(tier12_keys[i], sizeof(tier12_keys[i]), "shared_%d", i);
+        event_context_set(locked_ctx, tier12_keys[i], &payload[i]);
+        event_context_set(concurrent_ctx, tier12_keys[i], &payload[i]);
+    }
+
+    printf("Workload: %d ops per thread, 90%% get / 10%% set over %d keys\n",
+           TIER12_OPS, TIER12_KEYS);
+    printf("Mutex: one global lock around an ordinary context\n");
+    printf("Concurrent: event_context_create_concurrent(), no external lock\n");
+    printf("Samples: %d per thread count\n\n", samples);
+
+    printf("Results (million ops/sec, higher is better):\n");
+    printf("----------------------------------------------------------------\n");
+    printf("  Threads      Mutex   Concurrent   Speedup\n");
+
+    for (int threads = 1; threads <= TIER12_MAX_THREADS; threads *= 2) {
+        uint64_t locked_best = UINT64_MAX, concurrent_best = UINT64_MAX;
+
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier12_execute(locked_ctx, true, threads);
+            if (sample < locked_best) locked_best = sample;
+
+            sample = tier12_execute(concurrent_ctx, false, threads);
+            if (sample < concurrent_best) concurrent_best = sample;
+        }
+
+        double ops = (double)threads * TIER12_OPS;
+        double locked_rate = ops * 1e3 / (double)locked_best;
+        double concurrent_rate = ops * 1e3 / (double)concurrent_best;
+        printf("  %7d  %9.2f  %11.2f  %7.2fx\n",
+               threads, locked_rate, concurrent_rate, concurrent_rate / locked_rate);
+    }
+
+    event_context_destroy(locked_ctx);
+    event_context_destroy(concurrent_ctx);
+}
+
+/* ==================== TIER 13: Reference Counting ==================== */
+
+#define TIER13_PAIRS 100000
+
+/* Retain/release pairs, as done when a value is borrowed from a context */
+static uint64_t tier13_execute(RefCountedValue *value) {
+    uint64_t start = get_time_ns();
+
+    for (int i = 0; i < TIER13_PAIRS; i++) {
+        ref_counted_value_retain(value);
+        ref_counted_value_release(value);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void *tier13_create_foreign(void *arg) {
+    return ref_counted_value_create_shared(arg, NULL);
+}
+
+static void run_tier13_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 13: Reference Counting (Plain vs Thread-Safe)      |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    static int payload;
+    RefCountedValue *plain = ref_counted_value_create(&payload, NULL);
+    RefCountedValue *owned = ref_counted_value_create_shared(&payload, NULL);
+
+    /* Biased toward another thread, so every update here is atomic */
+    pthread_t creator;
+    void *foreign = NULL;
+    pthread_create(&creator, NULL, tier13_create_foreign, &payload);
+    pthread_join(creator, &foreign);
+
+    printf("Retain/release pairs per sample: %d\n", TIER13_PAIRS);
+    printf("Shared values come from ref_counted_value_create_shared()\n");
+    printf("Samples: %d\n\n", samples);
+
+    uint64_t *plain_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *owned_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *foreign_samples = calloc(samples, sizeof(uint64_t));
+
+    BenchStats plain_stats, owned_stats, foreign_stats;
+    stats_init(&plain_stats);
+    stats_init(&owned_stats);
+    stats_init(&foreign_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier13_execute(plain);
+        tier13_execute(owned);
+        tier13_execute(foreign);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier13_execute(plain);
+        plain_samples[i] = sample;
+        stats_add_sample(&plain_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier13_execute(owned);
+        owned_samples[i] = sample;
+        stats_add_sample(&owned_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier13_execute(foreign);
+        foreign_samples[i] = sample;
+        stats_add_sample(&foreign_stats, sample);
+    }
+
+    stats_finalize(&plain_stats, plain_samples);
+    stats_finalize(&owned_stats, owned_samples);
+    stats_finalize(&foreign_stats, foreign_samples);
+
+    printf("Results (per %d pairs):\n", TIER13_PAIRS);
+    printf("----------------------------------------------------------------\n");
+    stats_print("Plain value", &plain_stats);
+    stats_print("Shared value, owner thread", &owned_stats);
+    stats_print("Shared value, other thread", &foreign_stats);
+    printf("\n");
+    stats_print_comparison("Owner vs plain", &plain_stats, &owned_stats);
+    stats_print_comparison("Other thread vs plain", &plain_stats, &foreign_stats);
+
+    ref_counted_value_release(plain);
+    ref_counted_value_release(owned);
+    ref_counted_value_release(foreign);
+    free(plain_samples);
+    free(owned_samples);
+    free(foreign_samples);
+}
+
+/* ==================== TIER 14: Borrowed Reads ==================== */
+
+#define TIER14_KEYS 16
+#define TIER14_READS 64
+#define TIER14_EXECUTIONS 1000
+
+static char tier14_keys[TIER14_KEYS][16];
+
+/* Read every key TIER14_READS / TIER14_KEYS times, retaining each value */
+static EventResult tier14_ref_step(EventContext *ctx, void *user_data) {
+    uintptr_t *checksum = user_data;
+    for (int i = 0; i < TIER14_READS; i++) {
+        RefCountedValue *ref = NULL;
+        event_context_get_ref(ctx, tier14_keys[i % TIER14_KEYS], &ref);
+        *checksum += (uintptr_t)ref_counted_value_get_data(ref);
+        ref_counted_value_release(ref);
+    }
+    return event_result_success();
+}
+
+/* Same reads, borrowed for the execution */
+static EventResult tier14_borrow_step(EventContext *ctx, void *user_data) {
+    uintptr_t *checksum = user_data;
+    for (int i = 0; i < TIER14_READS; i++) {
+        void *value = NULL;
+        event_context_borrow(ctx, tier14_keys[i % TIER14_KEYS], &value);
+        *checksum += (uintptr_t)value;
+    }
+    return event_result_success();
+}
+
+static uint64_t tier14_execute(EventChain *chain) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER14_EXECUTIONS; r++) {
+        ChainResult result = event_chain_execute(chain);
+        chain_result_destroy(&result);
+    }
+
+    return get_time_ns() - start;
+}
+
+static EventChain *tier14_chain(EventExecuteFunc step, uintptr_t *checksum) {
+    static int payload[TIER14_KEYS];
+    EventChain *chain = event_chain_create_strict();
+    event_chain_add_event(chain, chainable_event_create(step, checksum, "Read"));
+    for (int i = 0; i < TIER14_KEYS; i++) {
+        event_context_set(event_chain_get_context(chain), tier14_keys[i], &payload[i]);
+    }
+    return chain;
+}
+
+static void run_tier14_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|         TIER 14: Borrowed Reads (get_ref vs borrow)          |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    for (int i = 0; i < TIER14_KEYS; i++) {
+        snprintf(tier14_keys[i], sizeof(tier14_keys[i]), "table_%d", i);
+    }
+
+    uintptr_t checksum = 0;
+    EventChain *ref_chain = tier14_chain(tier14_ref_step, &checksum);
+    EventChain *borrow_chain = tier14_chain(tier14_borrow_step, &checksum);
+
+    printf("Per execution: one event reading %d values over %d keys\n",
+           TIER14_READS, TIER14_KEYS);
+    printf("Executions per sample: %d\n", TIER14_EXECUTIONS);
+    printf("Samples: %d\n\n", samples);
+
+    uint64_t *ref_samples = calloc(samples, sizeof(uint64_t));
+    uint64_t *borrow_samples = calloc(samples, sizeof(uint64_t));
+
+    BenchStats ref_stats, borrow_stats;
+    stats_init(&ref_stats);
+    stats_init(&borrow_stats);
+
+    /* Warm-up */
+    for (int i = 0; i < 5; i++) {
+        tier14_execute(ref_chain);
+        tier14_execute(borrow_chain);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier14_execute(ref_chain);
+        ref_samples[i] = sample;
+        stats_add_sample(&ref_stats, sample);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t sample = tier14_execute(borrow_chain);
+        borrow_samples[i] = sample;
+        stats_add_sample(&borrow_stats, sample);
+    }
+
+    stats_finalize(&ref_stats, ref_samples);
+    stats_finalize(&borrow_stats, borrow_samples);
+
+    printf("Results (per %d executions):\n", TIER14_EXECUTIONS);
+    printf("----------------------------------------------------------------\n");
+    stats_print("get_ref + release", &ref_stats);
+    stats_print("Borrow (epoch)", &borrow_stats);
+    printf("\n");
+    stats_print_comparison("Borrow vs get_ref", &ref_stats, &borrow_stats);
+
+    /* Prevent optimization */
+    if (checksum == 1) fflush(stdout);
+
+    event_chain_destroy(ref_chain);
+    event_chain_destroy(borrow_chain);
+    free(ref_samples);
+    free(borrow_samples);
+}
+
+/* ==================== TIER 15: Deferred Cleanup ==================== */
+
+#define TIER15_NODES 1000
+#define TIER15_EXECUTIONS 100
+
+typedef struct Tier15Node {
+    struct Tier15Node *next;
+    char payload[48];
+} Tier15Node;
+
+/* A "large graph" whose destructor walks and frees every node */
+static void tier15_graph_free(void *value) {
+    Tier15Node *node = value;
+    while (node) {
+        Tier15Node *next = node->next;
+        free(node);
+        node = next;
+    }
+}
+
+static Tier15Node *tier15_graph_build(void) {
+    Tier15Node *head = NULL;
+    for (int i = 0; i < TIER15_NODES; i++) {
+        Tier15Node *node = malloc(sizeof(Tier15Node));
+        node->next = head;
+        node->payload[0] = (char)i;
+        head = node;
+    }
+    return head;
+}
+
+/* Replace the previous graph; the old one dies on this overwrite */
+static EventResult tier15_replace_step(EventContext *ctx, void *user_data) {
+    Tier15Node **next_graph = user_data;
+    event_context_set_with_cleanup(ctx, "graph", *next_graph, tier15_graph_free);
+    return event_result_success();
+}
+
+/* Graphs are built outside the timed region; only executions are timed */
+static uint64_t tier15_execute(EventChain *chain, Tier15Node **next_graph) {
+    static Tier15Node *graphs[TIER15_EXECUTIONS];
+    for (int r = 0; r < TIER15_EXECUTIONS; r++) {
+        graphs[r] = tier15_graph_build();
+    }
+
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER15_EXECUTIONS; r++) {
+        *next_graph = graphs[r];
+        ChainResult result = event_chain_execute(chain);
+        chain_result_destroy(&result);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier15_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|   TIER 15: Deferred Cleanup (Inline vs Queue vs Reclaimer)   |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    const char *labels[3] = { "Inline cleanup", "Queue (drained at end)", "Background reclaimer" };
+    EventCleanupQueue *queues[3] = {
+        NULL, event_cleanup_queue_create(false), event_cleanup_queue_create(true)
+    };
+    EventChain *chains[3];
+    Tier15Node *next_graph[3];
+    BenchStats stats[3];
+    uint64_t *sample_data[3];
+
+    for (int m = 0; m < 3; m++) {
+        chains[m] = event_chain_create_strict();
+        event_chain_add_event(chains[m], chainable_event_create(tier15_replace_step, &next_graph[m], "Replace"));
+        event_context_set_cleanup_queue(event_chain_get_context(chains[m]), queues[m]);
+        stats_init(&stats[m]);
+        sample_data[m] = calloc(samples, sizeof(uint64_t));
+    }
+
+    printf("Per execution: overwrite a %d-node graph (cleanup frees every node)\n", TIER15_NODES);
+    printf("Executions per sample: %d (graphs built outside the timed region)\n", TIER15_EXECUTIONS);
+    printf("Samples: %d\n\n", samples);
+
+    /* Warm-up */
+    for (int i = 0; i < 3; i++) {
+        for (int m = 0; m < 3; m++) {
+            tier15_execute(chains[m], &next_graph[m]);
+        }
+    }
+
+    for (int m = 0; m < 3; m++) {
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier15_execute(chains[m], &next_graph[m]);
+            sample_data[m][i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data[m]);
+    }
+
+    printf("Results (request-path time per %d executions):\n", TIER15_EXECUTIONS);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 3; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    stats_print_comparison("Reclaimer vs inline", &stats[0], &stats[2]);
+
+    for (int m = 0; m < 3; m++) {
+        event_chain_destroy(chains[m]);
+        event_cleanup_queue_destroy(queues[m]);
+        free(sample_data[m]);
+    }
+}
+
+/* ==================== TIER 16: Remove Cost vs Context Size ==================== */
+
+#define TIER16_CHURN 1000
+
+/* Remove and re-add resident keys, spread across the entry arrays */
+static uint64_t tier16_churn(EventContext *ctx, char (*keys)[24], int size, int *cursor) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER16_CHURN; r++) {
+        const char *key = keys[*cursor];
+        *cursor = (*cursor + 7) % size;
+        event_context_remove(ctx, key);
+        event_context_set_i64(ctx, key, r);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier16_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|        TIER 16: Remove Cost vs Context Size (churn)          |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    const int sizes[3] = { 16, 128, EVENTCHAINS_MAX_CONTEXT_ENTRIES };
+    const char *labels[3] = { "16 entries", "128 entries", "512 entries (limit)" };
+    BenchStats stats[3];
+
+    printf("Per sample: %d remove + re-add pairs on resident keys\n", TIER16_CHURN);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 3; m++) {
+        int size = sizes[m];
+        char (*keys)[24] = calloc(size, sizeof(*keys));
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+        EventContext *ctx = event_context_create();
+
+        for (int i = 0; i < size; i++) {
+            snprintf(keys[i], sizeof(keys[i]), "session_%d", i);
+            event_context_set_i64(ctx, keys[i], i);
+        }
+
+        int cursor = 0;
+        tier16_churn(ctx, keys, size, &cursor);     /* Warm-up */
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier16_churn(ctx, keys, size, &cursor);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+
+        event_context_destroy(ctx);
+        free(sample_data);
+        free(keys);
+    }
+
+    printf("Results (per %d pairs):\n", TIER16_CHURN);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 3; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    stats_print_comparison("512 vs 16 entries", &stats[0], &stats[2]);
+}
+
+/* ==================== TIER 17: Value Hand-Off Between Stages ==================== */
+
+#define TIER17_HANDOFFS 1000
+
+static void tier17_buffer_free(void *value) {
+    free(value);
+}
+
+/* get_ref, set in the next stage with the same data, then remove from the first */
+static uint64_t tier17_copy_handoff(EventContext *stages[2]) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER17_HANDOFFS; r++) {
+        EventContext *from = stages[r & 1];
+        EventContext *to = stages[(r + 1) & 1];
+
+        RefCountedValue *ref = NULL;
+        event_context_get_ref(from, "buffer", &ref);
+        event_context_set_with_cleanup(to, "buffer", ref->data, ref->cleanup);
+        ref->cleanup = NULL;
+        ref_counted_value_release(ref);
+        event_context_remove(from, "buffer");
+    }
+
+    return get_time_ns() - start;
+}
+
+static uint64_t tier17_move_handoff(EventContext *stages[2]) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER17_HANDOFFS; r++) {
+        event_context_move(stages[(r + 1) & 1], stages[r & 1], "buffer");
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier17_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|       TIER 17: Value Hand-Off (get/set/remove vs move)       |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    const char *labels[2] = { "get_ref + set + remove", "event_context_move" };
+    uint64_t (*handoff[2])(EventContext *[2]) = { tier17_copy_handoff, tier17_move_handoff };
+    BenchStats stats[2];
+
+    printf("Per sample: %d hand-offs of a 1 MB buffer between two stage contexts\n", TIER17_HANDOFFS);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 2; m++) {
+        EventContext *stages[2] = { event_context_create(), event_context_create() };
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+
+        /* Neighbouring entries so lookups are not trivially first-slot */
+        char key[32];
+        for (int s = 0; s < 2; s++) {
+            for (int i = 0; i < 32; i++) {
+                snprintf(key, sizeof(key), "stage_state_%d", i);
+                event_context_set_i64(stages[s], key, i);
+            }
+        }
+        event_context_set_with_cleanup(stages[0], "buffer", malloc(1 << 20), tier17_buffer_free);
+
+        handoff[m](stages);     /* Warm-up (even count: buffer ends in stage 0) */
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = handoff[m](stages);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+
+        event_context_destroy(stages[0]);
+        event_context_destroy(stages[1]);
+        free(sample_data);
+    }
+
+    printf("Results (per %d hand-offs):\n", TIER17_HANDOFFS);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 2; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    stats_print_comparison("Move vs get/set/remove", &stats[0], &stats[1]);
+}
+
+/* ==================== TIER 18: Scratch Keys (remove vs scope) ==================== */
+
+#define TIER18_PHASES 1000
+#define TIER18_SCRATCH 16
+
+static char tier18_keys[TIER18_SCRATCH][24];
+
+/* Each phase writes scratch keys and overwrites one outer key, then tidies up */
+static uint64_t tier18_phases(EventContext *ctx, bool scoped) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER18_PHASES; r++) {
+        if (scoped) event_context_push_scope(ctx);
+
+        for (int i = 0; i < TIER18_SCRATCH; i++) {
+            event_context_set_i64(ctx, tier18_keys[i], r + i);
+        }
+
+        if (scoped) {
+            event_context_set_i64(ctx, "request_state_0", r);
+            event_context_pop_scope(ctx);
+        } else {
+            int64_t saved = 0;
+            event_context_get_i64(ctx, "request_state_0", &saved);
+            event_context_set_i64(ctx, "request_state_0", r);
+            for (int i = 0; i < TIER18_SCRATCH; i++) {
+                event_context_remove(ctx, tier18_keys[i]);
+            }
+            event_context_set_i64(ctx, "request_state_0", saved);
+        }
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier18_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 18: Scratch Keys (per-key remove vs scope pop)     |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    for (int i = 0; i < TIER18_SCRATCH; i++) {
+        snprintf(tier18_keys[i], sizeof(tier18_keys[i]), "scratch_%d", i);
+    }
+
+    const char *labels[2] = { "Remove each key", "Push/pop scope" };
+    BenchStats stats[2];
+
+    printf("Per phase: %d scratch writes and one outer overwrite, then undone\n", TIER18_SCRATCH);
+    printf("Phases per sample: %d (on a context with 32 outer keys)\n", TIER18_PHASES);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 2; m++) {
+        EventContext *ctx = event_context_create();
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+
+        char key[32];
+        for (int i = 0; i < 32; i++) {
+            snprintf(key, sizeof(key), "request_state_%d", i);
+            event_context_set_i64(ctx, key, i);
+        }
+
+        tier18_phases(ctx, m == 1);     /* Warm-up */
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier18_phases(ctx, m == 1);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+
+        event_context_destroy(ctx);
+        free(sample_data);
+    }
+
+    printf("Results (per %d phases):\n", TIER18_PHASES);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 2; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    stats_print_comparison("Scope vs per-key remove", &stats[0], &stats[1]);
+}
+
+/* ==================== TIER 19: Context Restore (load vs mapped) ==================== */
+
+#define TIER19_LOADS 100
+#define TIER19_BLOB 64
+
+static size_t tier19_blob_encode(const void *value, void *buffer, size_t capacity) {
+    if (capacity >= TIER19_BLOB) {
+        memcpy(buffer, value, TIER19_BLOB);
+    }
+    return TIER19_BLOB;
+}
+
+static void *tier19_blob_decode(const void *bytes, size_t size) {
+    if (size != TIER19_BLOB) return NULL;
+    void *blob = malloc(TIER19_BLOB);
+    if (blob) memcpy(blob, bytes, TIER19_BLOB);
+    return blob;
+}
+
+static void tier19_blob_free(void *value) {
+    free(value);
+}
+
+static const EventValueCodec tier19_blob_codec = {
+    "bench.blob", tier19_blob_encode, tier19_blob_decode, tier19_blob_free
+};
+
+/* Restore the context and read a handful of keys, as a resumed request would */
+static uint64_t tier19_restore(const void *image, size_t size, bool mapped) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER19_LOADS; r++) {
+        EventContext *ctx = mapped ? event_context_load_mapped(image, size)
+                                   : event_context_load(image, size);
+        int64_t step = 0;
+        void *blob = NULL;
+        event_context_get_i64(ctx, "entry_0", &step);
+        event_context_get(ctx, "entry_1", &blob);
+        event_context_get_i64(ctx, "entry_2", &step);
+        event_context_get(ctx, "entry_3", &blob);
+        event_context_destroy(ctx);
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier19_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 19: Context Restore (owning load vs mapped load)   |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    event_codec_register(&tier19_blob_codec);
+
+    const int sizes[3] = { 16, 128, EVENTCHAINS_MAX_CONTEXT_ENTRIES };
+    const char *labels[6] = {
+        "load, 16 entries", "load_mapped, 16 entries",
+        "load, 128 entries", "load_mapped, 128 entries",
+        "load, 512 entries", "load_mapped, 512 entries"
+    };
+    BenchStats stats[6];
+
+    printf("Per sample: %d restores + 4 reads; half the entries are %d-byte blobs\n",
+           TIER19_LOADS, TIER19_BLOB);
+    printf("Samples: %d\n\n", samples);
+
+    for (int s = 0; s < 3; s++) {
+        EventContext *source = event_context_create();
+        char key[32];
+        for (int i = 0; i < sizes[s]; i++) {
+            snprintf(key, sizeof(key), "entry_%d", i);
+            if (i & 1) {
+                event_context_set_with_codec(source, key, calloc(1, TIER19_BLOB), &tier19_blob_codec);
+            } else {
+                event_context_set_i64(source, key, i);
+            }
+        }
+
+        void *image = NULL;
+        size_t size = 0;
+        event_context_serialize(source, &image, &size);
+        event_context_destroy(source);
+
+        for (int m = 0; m < 2; m++) {
+            BenchStats *stat = &stats[s * 2 + m];
+            uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+
+            tier19_restore(image, size, m == 1);     /* Warm-up */
+
+            stats_init(stat);
+            for (int i = 0; i < samples; i++) {
+                uint64_t sample = tier19_restore(image, size, m == 1);
+                sample_data[i] = sample;
+                stats_add_sample(stat, sample);
+            }
+            stats_finalize(stat, sample_data);
+            free(sample_data);
+        }
+
+        event_context_image_free(image);
+    }
+
+    printf("Results (per %d restores):\n", TIER19_LOADS);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 6; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    stats_print_comparison("Mapped vs owning load (512 entries)", &stats[4], &stats[5]);
+}
+
+/* ==================== TIER 20: Checkpoints (full image vs deltas) ==================== */
+
+#define TIER20_EVENTS 100
+#define TIER20_ENTRIES 256
+#define TIER20_WRITES 4
+
+static char tier20_keys[TIER20_ENTRIES][24];
+
+static bool tier20_ship(const EventContextChange *change, void *user_data) {
+    size_t *shipped = user_data;
+    *shipped += strlen(change->key) + sizeof(EventInlineValue);
+    return true;
+}
+
+/* Each event updates a few keys; a checkpoint follows every event */
+static uint64_t tier20_checkpoints(EventContext *ctx, bool deltas, int *cursor, size_t *shipped) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER20_EVENTS; r++) {
+        uint64_t version = event_context_version(ctx);
+        for (int w = 0; w < TIER20_WRITES; w++) {
+            event_context_set_i64(ctx, tier20_keys[*cursor], r);
+            *cursor = (*cursor + 37) % TIER20_ENTRIES;
+        }
+
+        if (deltas) {
+            event_context_changes_since(ctx, version, tier20_ship, shipped);
+            event_context_trim_changes(ctx, event_context_version(ctx));
+        } else {
+            void *image = NULL;
+            size_t size = 0;
+            event_context_serialize(ctx, &image, &size);
+            *shipped += size;
+            event_context_image_free(image);
+        }
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier20_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 20: Checkpoints (full image vs change deltas)      |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    for (int i = 0; i < TIER20_ENTRIES; i++) {
+        snprintf(tier20_keys[i], sizeof(tier20_keys[i]), "state_%d", i);
+    }
+
+    const char *labels[2] = { "Serialize whole context", "changes_since + trim" };
+    BenchStats stats[2];
+    size_t shipped[2] = { 0, 0 };
+
+    printf("Per event: %d writes to a %d-entry context, then a checkpoint\n",
+           TIER20_WRITES, TIER20_ENTRIES);
+    printf("Events per sample: %d\n", TIER20_EVENTS);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 2; m++) {
+        EventContext *ctx = event_context_create();
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+
+        for (int i = 0; i < TIER20_ENTRIES; i++) {
+            event_context_set_i64(ctx, tier20_keys[i], i);
+        }
+        if (m == 1) event_context_record_changes(ctx, true);
+
+        int cursor = 0;
+        size_t warmup = 0;
+        tier20_checkpoints(ctx, m == 1, &cursor, &warmup);
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier20_checkpoints(ctx, m == 1, &cursor, &shipped[m]);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+
+        event_context_destroy(ctx);
+        free(sample_data);
+    }
+
+    printf("Results (per %d checkpoints):\n", TIER20_EVENTS);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 2; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    for (int m = 0; m < 2; m++) {
+        printf("%-35s: %zu bytes per checkpoint\n", labels[m],
+               shipped[m] / ((size_t)samples * TIER20_EVENTS));
+    }
+    printf("\n");
+    stats_print_comparison("Deltas vs full image", &stats[0], &stats[1]);
+}
+
+/* ==================== TIER 21: Large values under a memory budget ==================== */
+
+#define TIER21_BLOCKS 32
+#define TIER21_BLOCK_SIZE (256 * 1024)
+#define TIER21_BUDGET (2 * 1024 * 1024)
+
+static char tier21_keys[TIER21_BLOCKS][24];
+
+/* A batch job that stages large intermediate blocks, then reduces over them */
+static uint64_t tier21_job(bool spill, size_t *peak, size_t *spilled, uint64_t *checksum) {
+    uint64_t start = get_time_ns();
+
+    EventContext *ctx = event_context_create();
+    if (spill) event_context_enable_spill(ctx, NULL, TIER21_BUDGET);
+
+    for (int b = 0; b < TIER21_BLOCKS; b++) {
+        unsigned char *block = malloc(TIER21_BLOCK_SIZE);
+        memset(block, b, TIER21_BLOCK_SIZE);
+        event_context_set_sized(ctx, tier21_keys[b], block, TIER21_BLOCK_SIZE, free);
+
+        size_t usage = event_context_memory_usage(ctx);
+        if (usage > *peak) *peak = usage;
+    }
+    *spilled = event_context_spilled_bytes(ctx);
+
+    for (int b = 0; b < TIER21_BLOCKS; b++) {
+        void *block = NULL;
+        if (event_context_get(ctx, tier21_keys[b], &block) == EC_SUCCESS) {
+            const unsigned char *bytes = block;
+            for (size_t i = 0; i < TIER21_BLOCK_SIZE; i += 4096) *checksum += bytes[i];
+        }
+    }
+
+    event_context_destroy(ctx);
+    return get_time_ns() - start;
+}
+
+static void run_tier21_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 21: Large values (all resident vs spill budget)    |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 1000;
+    if (samples < 5) samples = 5;
+
+    for (int i = 0; i < TIER21_BLOCKS; i++) {
+        snprintf(tier21_keys[i], sizeof(tier21_keys[i]), "block_%d", i);
+    }
+
+    const char *labels[2] = { "All values resident", "Spill over 2MB budget" };
+    BenchStats stats[2];
+    size_t peak[2] = { 0, 0 };
+    size_t spilled[2] = { 0, 0 };
+    uint64_t checksum = 0;
+
+    printf("Per job: %d blocks of %d KB staged, then read back\n",
+           TIER21_BLOCKS, TIER21_BLOCK_SIZE / 1024);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 2; m++) {
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+        tier21_job(m == 1, &peak[m], &spilled[m], &checksum);
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier21_job(m == 1, &peak[m], &spilled[m], &checksum);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+        free(sample_data);
+    }
+
+    printf("Results (per job):\n");
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 2; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    for (int m = 0; m < 2; m++) {
+        printf("%-35s: %zu KB peak resident, %zu KB spilled\n", labels[m],
+               peak[m] / 1024, spilled[m] / 1024);
+    }
+    printf("(checksum %llu)\n\n", (unsigned long long)checksum);
+    stats_print_comparison("Spilling vs all resident", &stats[0], &stats[1]);
+}
+
+/* ==================== TIER 22: Prefix Queries (scan vs index) ==================== */
+
+#define TIER22_NAMESPACES 64
+#define TIER22_KEYS_PER_NAMESPACE 8
+#define TIER22_OPS 200
+
+static char tier22_keys[TIER22_NAMESPACES][TIER22_KEYS_PER_NAMESPACE][24];
+static char tier22_prefixes[TIER22_NAMESPACES][16];
+
+static bool tier22_count(const char *key, EventValueType type, const void *value, void *user_data) {
+    (void)key;
+    (void)type;
+    (void)value;
+    (*(size_t *)user_data)++;
+    return true;
+}
+
+/* Each op reads one namespace, drops it, and writes it back */
+static uint64_t tier22_ops(EventContext *ctx, int *cursor, size_t *matched) {
+    uint64_t start = get_time_ns();
+
+    for (int r = 0; r < TIER22_OPS; r++) {
+        int ns = *cursor;
+        *cursor = (*cursor + 13) % TIER22_NAMESPACES;
+
+        event_context_iterate_prefix(ctx, tier22_prefixes[ns], tier22_count, matched);
+        event_context_remove_prefix(ctx, tier22_prefixes[ns], NULL);
+        for (int k = 0; k < TIER22_KEYS_PER_NAMESPACE; k++) {
+            event_context_set_i64(ctx, tier22_keys[ns][k], r);
+        }
+    }
+
+    return get_time_ns() - start;
+}
+
+static void run_tier22_benchmark(int iterations) {
+    printf("\n|---------------------------------------------------------------|\n");
+    printf("|      TIER 22: Prefix Queries (full scan vs crit-bit index)   |\n");
+    printf("|---------------------------------------------------------------|\n\n");
+
+    int samples = iterations / 100;
+    if (samples < 10) samples = 10;
+
+    for (int ns = 0; ns < TIER22_NAMESPACES; ns++) {
+        snprintf(tier22_prefixes[ns], sizeof(tier22_prefixes[ns]), "ns_%02d.", ns);
+        for (int k = 0; k < TIER22_KEYS_PER_NAMESPACE; k++) {
+            snprintf(tier22_keys[ns][k], sizeof(tier22_keys[ns][k]), "ns_%02d.key_%d", ns, k);
+        }
+    }
+
+    const char *labels[2] = { "Full scan", "Prefix index" };
+    BenchStats stats[2];
+    size_t matched[2] = { 0, 0 };
+
+    printf("Per op: iterate, remove and rewrite one %d-key namespace\n", TIER22_KEYS_PER_NAMESPACE);
+    printf("Context: %d entries\n", TIER22_NAMESPACES * TIER22_KEYS_PER_NAMESPACE);
+    printf("Ops per sample: %d\n", TIER22_OPS);
+    printf("Samples: %d\n\n", samples);
+
+    for (int m = 0; m < 2; m++) {
+        EventContext *ctx = event_context_create();
+        uint64_t *sample_data = calloc(samples, sizeof(uint64_t));
+
+        if (m == 1) event_context_index_prefixes(ctx, true);
+        for (int ns = 0; ns < TIER22_NAMESPACES; ns++) {
+            for (int k = 0; k < TIER22_KEYS_PER_NAMESPACE; k++) {
+                event_context_set_i64(ctx, tier22_keys[ns][k], k);
+            }
+        }
+
+        int cursor = 0;
+        size_t warmup = 0;
+        tier22_ops(ctx, &cursor, &warmup);
+
+        stats_init(&stats[m]);
+        for (int i = 0; i < samples; i++) {
+            uint64_t sample = tier22_ops(ctx, &cursor, &matched[m]);
+            sample_data[i] = sample;
+            stats_add_sample(&stats[m], sample);
+        }
+        stats_finalize(&stats[m], sample_data);
+
+        event_context_destroy(ctx);
+        free(sample_data);
+    }
+
+    printf("Results (per %d ops):\n", TIER22_OPS);
+    printf("----------------------------------------------------------------\n");
+    for (int m = 0; m < 2; m++) {
+        stats_print(labels[m], &stats[m]);
+    }
+    printf("\n");
+    for (int m = 0; m < 2; m++) {
+        printf("%-35s: %zu keys matched per op\n", labels[m],
+               matched[m] / ((size_t)samples * TIER22_OPS));
+    }
+    printf("\n");
+    stats_print_comparison("Index vs full scan", &stats[0], &stats[1]);
+}
+
 /* ==================== Main Benchmark Runner ==================== */
 
 int main(int argc, char *argv[]) {
@@ -738,6 +2673,24 @@ int main(int argc, char *argv[]) {
     run_tier2_benchmark(iterations);
     run_tier3_benchmark(iterations);
     run_tier4_benchmark(iterations);
+    run_tier5_benchmark(iterations);
+    run_tier6_benchmark(iterations);
+    run_tier7_benchmark(iterations);
+    run_tier8_benchmark(iterations);
+    run_tier9_benchmark(iterations);
+    run_tier10_benchmark(iterations);
+    run_tier11_benchmark(iterations);
+    run_tier12_benchmark(iterations);
+    run_tier13_benchmark(iterations);
+    run_tier14_benchmark(iterations);
+    run_tier15_benchmark(iterations);
+    run_tier16_benchmark(iterations);
+    run_tier17_benchmark(iterations);
+    run_tier18_benchmark(iterations);
+    run_tier19_benchmark(iterations);
+    run_tier20_benchmark(iterations);
+    run_tier21_benchmark(iterations);
+    run_tier22_benchmark(iterations);
     
     /* Summary */
     printf("\n|---------------------------------------------------------------|\n");
@@ -748,7 +2701,25 @@ int main(int argc, char *argv[]) {
     printf("  Tier 1 shows raw orchestration framework overhead\n");
     printf("  Tier 2 shows abstraction cost vs feature-equivalent manual code\n");
     printf("  Tier 3 quantifies cost per middleware layer (amortized)\n");
-    printf("  Tier 4 demonstrates real-world instrumentation scenarios\n\n");
+    printf("  Tier 4 demonstrates real-world instrumentation scenarios\n");
+    printf("  Tier 5 compares per-request chain building to shared templates\n");
+    printf("  Tier 6 measures multi-core throughput through the executor\n");
+    printf("  Tier 7 shows DAG latency tracking the critical path, not the sum\n");
+    printf("  Tier 8 compares event-major batches to per-context calls\n");
+    printf("  Tier 9 shows the per-layer cost of returning results by value\n");
+    printf("  Tier 10 compares per-entry heap allocation to arenas and pooling\n");
+    printf("  Tier 11 compares copying a context to a persistent snapshot\n");
+    printf("  Tier 12 shows shared-context throughput from 1 to 8 threads\n");
+    printf("  Tier 13 shows the cost of thread-safe (biased) reference counts\n");
+    printf("  Tier 14 compares retained reads with epoch-borrowed reads\n");
+    printf("  Tier 15 shows request-path time with cleanup moved off the path\n");
+    printf("  Tier 16 shows remove cost staying flat as contexts grow\n");
+    printf("  Tier 17 compares manual value hand-off with event_context_move\n");
+    printf("  Tier 18 compares per-key scratch cleanup with a scope pop\n");
+    printf("  Tier 19 compares decoding a saved context with reading it in place\n");
+    printf("  Tier 20 compares full-image checkpoints with shipping change deltas\n");
+    printf("  Tier 21 shows large values kept under a memory budget by spilling\n");
+    printf("  Tier 22 compares prefix queries by full scan and by key index\n\n");
     
     return 0;
 }
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 /* ==================== Performance Measurement Utilities ==================== */
 
@@ -68,7 +69,7 @@ static EventResult simple_computation_event(EventContext *ctx, void *user_data)
         sum += i;
     }
 
-    event_context_set(ctx, "result", (void *)(intptr_t)sum);
+    event_context_set_i64(ctx, "result", sum);
     return event_result_success();
 }
 
@@ -154,6 +155,42 @@ static EventResult counting_middleware(
     return result;
 }
 
+/* Records the order in which middleware layers are entered */
+typedef struct {
+    int entered[EVENTCHAINS_MAX_MIDDLEWARE];
+    size_t count;
+} DispatchTrace;
+
+typedef struct {
+    DispatchTrace *trace;
+    int id;
+} TracingMiddlewareData;
+
+static EventResult tracing_middleware(
+    ChainableEvent *event,
+    EventContext *context,
+    MiddlewareNextFunc next,
+    void *next_data,
+    void *user_data
+) {
+    TracingMiddlewareData *data = (TracingMiddlewareData *)user_data;
+    if (data->trace->count < EVENTCHAINS_MAX_MIDDLEWARE) {
+        data->trace->entered[data->trace->count++] = data->id;
+    }
+    return next(event, context, next_data);
+}
+
+static int test_failures = 0;
+
+static void check(bool condition, const char *description) {
+    if (condition) {
+        printf("  ✓ %s\n", description);
+    } else {
+        printf("  ✗ %s\n", description);
+        test_failures++;
+    }
+}
+
 /* ==================== Performance Tests ==================== */
 
 void perf_test_minimal_chain(void) {
@@ -169,239 +206,2356 @@ void perf_test_minimal_chain(void) {
     for (int i = 0; i < iterations; i++) {
         EventChain *chain = event_chain_create_strict();
 
-        ChainableEvent *event = chainable_event_create(noop_event, NULL, "NoOp");
-        event_chain_add_event(chain, event);
+        ChainableEvent *event = chainable_event_create(noop_event, NULL, "NoOp");
+        event_chain_add_event(chain, event);
+
+        double start = get_time_ms();
+        ChainResult result = event_chain_execute(chain);
+        double elapsed = get_time_ms() - start;
+
+        update_stats(&stats, elapsed);
+
+        chain_result_destroy(&result);
+        event_chain_destroy(chain);
+    }
+
+    print_stats("Minimal Chain (1 Event, No Middleware)", &stats);
+
+    printf("  ✓ Completed %d iterations successfully\n", iterations);
+}
+
+void perf_test_chain_with_events(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║          PERFORMANCE TEST: Chain with Multiple Events         ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    int event_counts[] = {5, 10, 50, 100};
+
+    for (size_t test = 0; test < sizeof(event_counts) / sizeof(event_counts[0]); test++) {
+        int num_events = event_counts[test];
+
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 1000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventChain *chain = event_chain_create_strict();
+
+            for (int j = 0; j < num_events; j++) {
+                ChainableEvent *event = chainable_event_create(
+                    simple_computation_event, NULL, "Computation"
+                );
+                event_chain_add_event(chain, event);
+            }
+
+            double start = get_time_ms();
+            ChainResult result = event_chain_execute(chain);
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            chain_result_destroy(&result);
+            event_chain_destroy(chain);
+        }
+
+        char test_name[128];
+        snprintf(test_name, sizeof(test_name), "Chain with %d Events", num_events);
+        print_stats(test_name, &stats);
+    }
+}
+
+void perf_test_chain_with_middleware(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║        PERFORMANCE TEST: Chain with Middleware Layers         ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    int middleware_counts[] = {1, 4, 8, 16};
+
+    for (size_t test = 0; test < sizeof(middleware_counts) / sizeof(middleware_counts[0]); test++) {
+        int num_middleware = middleware_counts[test];
+
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 1000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventChain *chain = event_chain_create_strict();
+
+            for (int j = 0; j < num_middleware; j++) {
+                EventMiddleware *mw = event_middleware_create(
+                    passthrough_middleware, NULL, "Passthrough"
+                );
+                event_chain_use_middleware(chain, mw);
+            }
+
+            ChainableEvent *event = chainable_event_create(noop_event, NULL, "NoOp");
+            event_chain_add_event(chain, event);
+
+            double start = get_time_ms();
+            ChainResult result = event_chain_execute(chain);
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            chain_result_destroy(&result);
+            event_chain_destroy(chain);
+        }
+
+        char test_name[128];
+        snprintf(test_name, sizeof(test_name), "Chain with %d Middleware Layers", num_middleware);
+        print_stats(test_name, &stats);
+    }
+}
+
+void perf_test_context_operations(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║           PERFORMANCE TEST: Context Operations                ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    /* Test 1: Context Set Operations */
+    {
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 10000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventContext *ctx = event_context_create();
+
+            double start = get_time_ms();
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_set(ctx, key, (void *)(intptr_t)j);
+            }
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            event_context_destroy(ctx);
+        }
+
+        print_stats("Context: 100 Set Operations", &stats);
+    }
+
+    /* Test 2: Context Get Operations */
+    {
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 10000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventContext *ctx = event_context_create();
+
+            /* Populate context */
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_set(ctx, key, (void *)(intptr_t)j);
+            }
+
+            double start = get_time_ms();
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                void *value;
+                event_context_get(ctx, key, &value);
+            }
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            event_context_destroy(ctx);
+        }
+
+        print_stats("Context: 100 Get Operations", &stats);
+    }
+
+    /* Test 2b: Context Get Operations by Interned Key */
+    {
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 10000;
+
+        /* Resolved once, as events would at chain build time */
+        EventContextKey keys[100];
+        for (int j = 0; j < 100; j++) {
+            char key[32];
+            snprintf(key, sizeof(key), "key_%d", j);
+            keys[j] = event_key_intern(key);
+        }
+
+        for (int i = 0; i < iterations; i++) {
+            EventContext *ctx = event_context_create();
+
+            /* Populate context */
+            for (int j = 0; j < 100; j++) {
+                event_context_set_k(ctx, keys[j], (void *)(intptr_t)j);
+            }
+
+            double start = get_time_ms();
+            for (int j = 0; j < 100; j++) {
+                void *value;
+                event_context_get_k(ctx, keys[j], &value);
+            }
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            event_context_destroy(ctx);
+        }
+
+        print_stats("Context: 100 Interned Get Operations", &stats);
+    }
+
+    /* Test 3: Context Has Operations */
+    {
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 10000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventContext *ctx = event_context_create();
+
+            /* Populate context */
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_set(ctx, key, (void *)(intptr_t)j);
+            }
+
+            double start = get_time_ms();
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_has(ctx, key, false);
+            }
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            event_context_destroy(ctx);
+        }
+
+        print_stats("Context: 100 Has Operations (Fast)", &stats);
+    }
+
+    /* Test 4: Context Has Operations (Constant Time) */
+    {
+        PerformanceStats stats;
+        init_stats(&stats);
+
+        const int iterations = 10000;
+
+        for (int i = 0; i < iterations; i++) {
+            EventContext *ctx = event_context_create();
+
+            /* Populate context */
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_set(ctx, key, (void *)(intptr_t)j);
+            }
+
+            double start = get_time_ms();
+            for (int j = 0; j < 100; j++) {
+                char key[32];
+                snprintf(key, sizeof(key), "key_%d", j);
+                event_context_has(ctx, key, true);
+            }
+            double elapsed = get_time_ms() - start;
+
+            update_stats(&stats, elapsed);
+
+            event_context_destroy(ctx);
+        }
+
+        print_stats("Context: 100 Has Operations (Constant-Time)", &stats);
+    }
+}
+
+void test_middleware_dispatch(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Middleware Dispatch              ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    const int num_events = 5;
+    int counter = 0;
+    DispatchTrace trace = {{0}, 0};
+    TracingMiddlewareData tracing[3];
+
+    EventChain *chain = event_chain_create_strict();
+
+    event_chain_use_middleware(chain, event_middleware_create(
+        counting_middleware, &counter, "Counting"));
+    for (int i = 0; i < 3; i++) {
+        tracing[i].trace = &trace;
+        tracing[i].id = i;
+        event_chain_use_middleware(chain, event_middleware_create(
+            tracing_middleware, &tracing[i], "Tracing"));
+    }
+
+    for (int i = 0; i < num_events; i++) {
+        event_chain_add_event(chain, chainable_event_create(noop_event, NULL, "NoOp"));
+    }
+
+    ChainResult result = event_chain_execute(chain);
+
+    check(result.success, "Chain with middleware succeeds");
+    check(counter == 2 * num_events, "Counting middleware wraps every event");
+    check(trace.count >= 3 &&
+          trace.entered[0] == 2 && trace.entered[1] == 1 && trace.entered[2] == 0,
+          "Middleware entered in LIFO order (last registered is outermost)");
+
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+}
+
+typedef struct {
+    EventChain *chain;
+    bool fired;
+} InterruptOnce;
+
+/* Stands in for a signal handler firing during the first run */
+static EventResult interrupt_once_event(EventContext *ctx, void *user_data) {
+    (void)ctx;
+    InterruptOnce *interrupt = user_data;
+    if (!interrupt->fired) {
+        interrupt->fired = true;
+        interrupt->chain->signal_interrupted = 1;
+    }
+    return event_result_success();
+}
+
+void test_chain_freeze(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Frozen Chain Plans             ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    int counter = 0;
+    EventChain *chain = event_chain_create_lenient();
+
+    event_chain_use_middleware(chain, event_middleware_create(
+        counting_middleware, &counter, "Counting"));
+    event_chain_add_event(chain, chainable_event_create(noop_event, NULL, "NoOp"));
+    event_chain_add_event(chain, chainable_event_create(failing_event_impl, NULL, "Failing"));
+
+    check(event_chain_freeze(chain) == EC_SUCCESS, "Chain freezes");
+    check(event_chain_is_frozen(chain), "Chain reports frozen");
+
+    ChainableEvent *late = chainable_event_create(noop_event, NULL, "Late");
+    check(event_chain_add_event(chain, late) == EC_ERROR_CHAIN_FROZEN,
+          "Frozen chain rejects new events");
+    chainable_event_destroy(late);
+
+    bool lenient_ok = true;
+    for (int i = 0; i < 3; i++) {
+        ChainResult result = event_chain_execute(chain);
+        lenient_ok = lenient_ok && result.success && result.failure_count == 1;
+        chain_result_destroy(&result);
+    }
+    check(lenient_ok, "Frozen plan keeps lenient fault tolerance");
+    check(counter == 2 * 2 * 3, "Frozen plan runs middleware on every execution");
+
+    event_chain_destroy(chain);
+
+    /* An interrupt ends the run it hits, not every later one */
+    chain = event_chain_create_strict();
+    InterruptOnce interrupt = { chain, false };
+    event_chain_add_event(chain, chainable_event_create(interrupt_once_event, &interrupt, "Interrupt"));
+    event_chain_add_event(chain, chainable_event_create(noop_event, NULL, "NoOp"));
+    event_chain_freeze(chain);
+    ChainResult first = event_chain_execute(chain);
+    bool first_interrupted = event_chain_was_interrupted(chain);
+    ChainResult second = event_chain_execute(chain);
+    check(!first.success && first_interrupted && second.success && !event_chain_was_interrupted(chain),
+          "Frozen chain clears the interrupt flag for each run");
+    chain_result_destroy(&first);
+    chain_result_destroy(&second);
+    event_chain_destroy(chain);
+
+    /* A cycle found at execution gets its own message */
+    chain = event_chain_create_strict_dev();
+    ChainableEvent *ping = chainable_event_create(noop_event, NULL, "Ping");
+    ChainableEvent *pong = chainable_event_create(noop_event, NULL, "Pong");
+    event_chain_add_event(chain, ping);
+    event_chain_add_event(chain, pong);
+    event_chain_add_dependency(chain, ping, pong);
+    event_chain_add_dependency(chain, pong, ping);
+    ChainResult cyclic = event_chain_execute(chain);
+    check(!cyclic.success && cyclic.failure_count == 1 &&
+          strcmp(cyclic.failures[0].error_message, "Dependency cycle detected") == 0,
+          "Dependency cycle is reported as a cycle");
+    chain_result_destroy(&cyclic);
+    event_chain_destroy(chain);
+}
+
+static EventResult increment_context_counter_event(EventContext *ctx, void *user_data) {
+    (void)user_data;
+    void *counter_ptr;
+    if (event_context_get(ctx, "counter", &counter_ptr) != EC_SUCCESS) {
+        return event_result_failure("Missing counter", EC_ERROR_NOT_FOUND, ERROR_DETAIL_FULL);
+    }
+    (*(int *)counter_ptr)++;
+    return event_result_success();
+}
+
+void test_chain_template_reuse(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║         CORRECTNESS TEST: Chain Templates with Contexts       ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    EventChain *template_chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    for (int i = 0; i < 3; i++) {
+        event_chain_add_event(template_chain, chainable_event_create(
+            increment_context_counter_event, NULL, "Increment"));
+    }
+    event_chain_freeze(template_chain);
+
+    check(event_chain_get_context(template_chain) == NULL, "Template owns no context");
+
+    ChainResult no_ctx = event_chain_execute(template_chain);
+    check(!no_ctx.success, "Template without a supplied context fails cleanly");
+    chain_result_destroy(&no_ctx);
+
+    int counters[4] = {0, 10, 20, 30};
+    bool all_ok = true;
+    for (int i = 0; i < 4; i++) {
+        EventContext *ctx = event_context_create();
+        event_context_set(ctx, "counter", &counters[i]);
+        ChainResult result = event_chain_execute_with_context(template_chain, ctx);
+        all_ok = all_ok && result.success;
+        chain_result_destroy(&result);
+        event_context_destroy(ctx);
+    }
+
+    check(all_ok, "Template executes against each supplied context");
+    check(counters[0] == 3 && counters[1] == 13 && counters[2] == 23 && counters[3] == 33,
+          "Each run only touches its own context");
+
+    event_chain_destroy(template_chain);
+}
+
+#define SUBMITTERS 4
+#define SUBMITS_PER_THREAD 500
+
+typedef struct {
+    EventChainExecutor *executor;
+    EventChain *chain;
+    EventContext *context;
+    int rejected;
+} SubmitterArgs;
+
+static EventResult count_run_event(EventContext *ctx, void *user_data) {
+    (void)ctx;
+    __atomic_add_fetch((int *)user_data, 1, __ATOMIC_SEQ_CST);
+    return event_result_success();
+}
+
+/* Fire-and-forget submits racing the workers that pop them */
+static void *submit_jobs(void *arg) {
+    SubmitterArgs *args = arg;
+    for (int i = 0; i < SUBMITS_PER_THREAD; i++) {
+        if (event_chain_executor_submit(args->executor, args->chain, args->context, NULL) != EC_SUCCESS) {
+            args->rejected++;
+        }
+    }
+    return NULL;
+}
+
+void test_executor_jobs(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║          CORRECTNESS TEST: Work-Stealing Executor             ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    enum { NUM_JOBS = 256 };
+
+    EventChain *template_chain = event_chain_create_template(
+        FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    for (int i = 0; i < 4; i++) {
+        event_chain_add_event(template_chain, chainable_event_create(
+            increment_context_counter_event, NULL, "Increment"));
+    }
+
+    EventChainExecutor *executor = event_chain_executor_create(4);
+    check(executor != NULL && event_chain_executor_worker_count(executor) == 4,
+          "Executor starts 4 workers");
+
+    EventContext *unfrozen_ctx = event_context_create();
+    EventChainJob *rejected = NULL;
+    check(event_chain_executor_submit(executor, template_chain, unfrozen_ctx, &rejected) ==
+          EC_ERROR_INVALID_PARAMETER && rejected == NULL,
+          "Executor rejects unfrozen chains");
+    event_context_destroy(unfrozen_ctx);
+
+    event_chain_freeze(template_chain);
+
+    static int counters[NUM_JOBS];
+    EventContext *contexts[NUM_JOBS];
+    EventChainJob *jobs[NUM_JOBS];
+    bool submitted = true;
+
+    for (int i = 0; i < NUM_JOBS; i++) {
+        counters[i] = i;
+        contexts[i] = event_context_create();
+        event_context_set(contexts[i], "counter", &counters[i]);
+        submitted = submitted && event_chain_executor_submit(
+            executor, template_chain, contexts[i], &jobs[i]) == EC_SUCCESS;
+    }
+    check(submitted, "All jobs submitted");
+
+    bool all_ok = true;
+    bool all_counted = true;
+    for (int i = 0; i < NUM_JOBS; i++) {
+        ChainResult result = event_chain_job_wait(jobs[i]);
+        all_ok = all_ok && result.success;
+        all_counted = all_counted && counters[i] == i + 4;
+        chain_result_destroy(&result);
+        event_context_destroy(contexts[i]);
+    }
+    check(all_ok, "Every job result reports success");
+    check(all_counted, "Every job ran all events against its own context");
+
+    /* Submitters racing the workers never see a phantom backlog, and nothing is lost */
+    int runs = 0;
+    EventChain *count_chain = event_chain_create_template(FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    event_chain_add_event(count_chain, chainable_event_create(count_run_event, &runs, "Count"));
+    event_chain_freeze(count_chain);
+    EventChainExecutor *racing = event_chain_executor_create(4);
+    EventContext *shared_ctx = event_context_create_concurrent();
+    SubmitterArgs submitters[SUBMITTERS];
+    pthread_t submitter_threads[SUBMITTERS];
+    for (int t = 0; t < SUBMITTERS; t++) {
+        submitters[t] = (SubmitterArgs){ racing, count_chain, shared_ctx, 0 };
+        pthread_create(&submitter_threads[t], NULL, submit_jobs, &submitters[t]);
+    }
+    int refused = 0;
+    for (int t = 0; t < SUBMITTERS; t++) {
+        pthread_join(submitter_threads[t], NULL);
+        refused += submitters[t].rejected;
+    }
+    event_chain_executor_destroy(racing);
+    check(refused == 0 && runs == SUBMITTERS * SUBMITS_PER_THREAD,
+          "Concurrent submits are all accepted and all run");
+    event_context_destroy(shared_ctx);
+    event_chain_destroy(count_chain);
+
+    /* Fire-and-forget jobs are drained by destroy */
+    int detached_counter = 0;
+    EventContext *detached_ctx = event_context_create();
+    event_context_set(detached_ctx, "counter", &detached_counter);
+    event_chain_executor_submit(executor, template_chain, detached_ctx, NULL);
+    event_chain_executor_destroy(executor);
+    check(detached_counter == 4, "Destroy drains fire-and-forget jobs");
+    event_context_destroy(detached_ctx);
+
+    event_chain_destroy(template_chain);
+}
+
+typedef struct {
+    int *clock;
+    int stamp;              /* Order in which the event ran, 0 if never */
+    bool fail;
+} DagStepData;
+
+static EventResult dag_step_event(EventContext *ctx, void *user_data) {
+    (void)ctx;
+    DagStepData *step = (DagStepData *)user_data;
+    step->stamp = __atomic_add_fetch(step->clock, 1, __ATOMIC_SEQ_CST);
+    if (step->fail) {
+        return event_result_failure("Step failed", EC_ERROR_EVENT_EXECUTION_FAILED, ERROR_DETAIL_FULL);
+    }
+    return event_result_success();
+}
+
+/* Diamond A -> {B, C} -> D plus an independent E, registered out of order */
+static EventChain *build_dag_chain(FaultToleranceMode mode, DagStepData steps[5], int *clock) {
+    static const char *names[5] = {"D", "B", "C", "A", "E"};
+    ChainableEvent *events[5];
+
+    EventChain *chain = event_chain_create_template(mode, ERROR_DETAIL_FULL);
+    *clock = 0;
+    for (int i = 0; i < 5; i++) {
+        steps[i].clock = clock;
+        steps[i].stamp = 0;
+        steps[i].fail = false;
+        events[i] = chainable_event_create(dag_step_event, &steps[i], names[i]);
+        event_chain_add_event(chain, events[i]);
+    }
+
+    event_chain_add_dependency(chain, events[1], events[3]);  /* B after A */
+    event_chain_add_dependency(chain, events[2], events[3]);  /* C after A */
+    event_chain_add_dependency(chain, events[0], events[1]);  /* D after B */
+    event_chain_add_dependency(chain, events[0], events[2]);  /* D after C */
+    return chain;
+}
+
+#define DAG_WRITES 64
+
+static int dag_branches_arrived;
+
+/*
+ * Waits (briefly) for the other branch so the writes overlap when the run
+ * is parallel, then writes DAG_WRITES keys of its own, enough to grow the
+ * context's arrays
+ */
+static EventResult dag_write_event(EventContext *ctx, void *user_data) {
+    __atomic_add_fetch(&dag_branches_arrived, 1, __ATOMIC_SEQ_CST);
+    double deadline = get_time_ms() + 100.0;
+    while (__atomic_load_n(&dag_branches_arrived, __ATOMIC_SEQ_CST) < 2 && get_time_ms() < deadline) {
+    }
+
+    char key[32];
+    for (int i = 0; i < DAG_WRITES; i++) {
+        snprintf(key, sizeof(key), "%s_%d", (const char *)user_data, i);
+        event_context_set_i64(ctx, key, i);
+    }
+    return event_result_success();
+}
+
+static int dag_values_released;
+
+static void dag_release_value(void *value) {
+    __atomic_add_fetch(&dag_values_released, 1, __ATOMIC_SEQ_CST);
+    free(value);
+}
+
+/* Overwrites a pointer value of its own, parking the old one until the run ends */
+static EventResult dag_replace_event(EventContext *ctx, void *user_data) {
+    char key[32];
+    snprintf(key, sizeof(key), "%s_ptr", (const char *)user_data);
+    for (int i = 0; i < DAG_WRITES; i++) {
+        event_context_set_with_cleanup(ctx, key, malloc(sizeof(int)), dag_release_value);
+    }
+    return event_result_success();
+}
+
+static bool dag_writes_landed(EventContext *ctx, const char **branches, int count) {
+    char key[32];
+    for (int b = 0; b < count; b++) {
+        for (int i = 0; i < DAG_WRITES; i++) {
+            int64_t value = -1;
+            snprintf(key, sizeof(key), "%s_%d", branches[b], i);
+            if (event_context_get_i64(ctx, key, &value) != EC_SUCCESS || value != i) return false;
+        }
+    }
+    return true;
+}
+
+void test_dag_execution(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║          CORRECTNESS TEST: Dependency-Graph Execution         ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    enum { D, B, C, A, E };
+    DagStepData steps[5];
+    int clock;
+
+    EventChainExecutor *executor = event_chain_executor_create(4);
+    EventContext *ctx = event_context_create();
+    EventContext *shared = event_context_create_concurrent();
+
+    /* Sequential execution follows the topological order */
+    EventChain *chain = build_dag_chain(FAULT_TOLERANCE_STRICT, steps, &clock);
+    ChainResult result = event_chain_execute_with_context(chain, ctx);
+    check(result.success && steps[A].stamp == 1 && steps[B].stamp == 2 &&
+          steps[C].stamp == 3 && steps[D].stamp == 4 && steps[E].stamp == 5,
+          "Sequential run orders events by dependencies");
+    chain_result_destroy(&result);
+
+    /* Parallel execution honors every edge */
+    event_chain_freeze(chain);
+    bool ordered = true;
+    for (int run = 0; run < 50; run++) {
+        clock = 0;
+        for (int i = 0; i < 5; i++) steps[i].stamp = 0;
+        result = event_chain_execute_dag(chain, shared, executor);
+        ordered = ordered && result.success && clock == 5 &&
+                  steps[A].stamp < steps[B].stamp && steps[A].stamp < steps[C].stamp &&
+                  steps[B].stamp < steps[D].stamp && steps[C].stamp < steps[D].stamp;
+        chain_result_destroy(&result);
+    }
+    check(ordered, "DAG run executes every event after its prerequisites");
+    event_chain_destroy(chain);
+
+    /* LENIENT: a failure skips its dependents, independent events still run */
+    chain = build_dag_chain(FAULT_TOLERANCE_LENIENT, steps, &clock);
+    steps[A].fail = true;
+    result = event_chain_execute_dag(chain, shared, executor);
+    size_t skipped = 0;
+    for (size_t i = 0; i < result.failure_count; i++) {
+        if (result.failures[i].error_code == EC_ERROR_DEPENDENCY_FAILED) skipped++;
+    }
+    check(result.success && result.failure_count == 4 && skipped == 3 &&
+          steps[E].stamp != 0 && steps[B].stamp == 0 && steps[D].stamp == 0,
+          "Lenient DAG skips dependents of a failed event");
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+
+    /* STRICT: nothing downstream runs after the first failure */
+    chain = build_dag_chain(FAULT_TOLERANCE_STRICT, steps, &clock);
+    steps[A].fail = true;
+    result = event_chain_execute_dag(chain, shared, executor);
+    check(!result.success && result.failure_count >= 1 &&
+          steps[B].stamp == 0 && steps[C].stamp == 0 && steps[D].stamp == 0,
+          "Strict DAG stops at the first failure");
+    chain_result_destroy(&result);
+
+    /* Cycles are rejected when the plan is compiled */
+    event_chain_add_dependency(chain, chain->events[A], chain->events[D]);
+    check(event_chain_freeze(chain) == EC_ERROR_INVALID_PARAMETER,
+          "Dependency cycle is rejected");
+    event_chain_destroy(chain);
+
+    /* Parallel branches write their own keys; only a concurrent context lets them overlap */
+    chain = event_chain_create_template(FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    static const char *branches[2] = {"left", "right"};
+    for (int i = 0; i < 2; i++) {
+        event_chain_add_event(chain, chainable_event_create(dag_write_event, (void *)branches[i], branches[i]));
+    }
+    event_chain_freeze(chain);
+
+    bool written = true;
+    EventContext *targets[2] = { shared, ctx };
+    for (int t = 0; t < 2; t++) {
+        dag_branches_arrived = 0;
+        result = event_chain_execute_dag(chain, targets[t], executor);
+        written = written && result.success && dag_writes_landed(targets[t], branches, 2);
+        chain_result_destroy(&result);
+    }
+    check(written, "Parallel branches write a shared context safely");
+    event_chain_destroy(chain);
+
+    chain = event_chain_create_template(FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    for (int i = 0; i < 2; i++) {
+        event_chain_add_event(chain, chainable_event_create(dag_replace_event, (void *)branches[i], branches[i]));
+    }
+    event_chain_freeze(chain);
+    dag_values_released = 0;
+    result = event_chain_execute_dag(chain, ctx, executor);
+    check(result.success && dag_values_released == 2 * (DAG_WRITES - 1),
+          "Values replaced during a DAG run are released when it ends");
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+
+    event_context_destroy(shared);
+    event_context_destroy(ctx);
+    event_chain_executor_destroy(executor);
+}
+
+static EventResult fail_on_odd_counter_event(EventContext *ctx, void *user_data) {
+    (void)user_data;
+    void *counter_ptr;
+    if (event_context_get(ctx, "counter", &counter_ptr) != EC_SUCCESS) {
+        return event_result_failure("Missing counter", EC_ERROR_NOT_FOUND, ERROR_DETAIL_FULL);
+    }
+    if (*(int *)counter_ptr % 2 != 0) {
+        return event_result_failure("Odd counter", EC_ERROR_EVENT_EXECUTION_FAILED, ERROR_DETAIL_FULL);
+    }
+    return event_result_success();
+}
+
+void test_batch_execution(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Batch Execution                ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    enum { BATCH = 16 };
+    int counters[BATCH];
+    EventContext *contexts[BATCH];
+    ChainResult results[BATCH];
+
+    /* Increment, fail odd counters, increment again */
+    EventChain *chain = event_chain_create_template(FAULT_TOLERANCE_STRICT, ERROR_DETAIL_FULL);
+    event_chain_add_event(chain, chainable_event_create(increment_context_counter_event, NULL, "Increment"));
+    event_chain_add_event(chain, chainable_event_create(fail_on_odd_counter_event, NULL, "RejectOdd"));
+    event_chain_add_event(chain, chainable_event_create(increment_context_counter_event, NULL, "Increment"));
+
+    for (int i = 0; i < BATCH; i++) {
+        counters[i] = i;
+        contexts[i] = event_context_create();
+        event_context_set(contexts[i], "counter", &counters[i]);
+    }
+
+    check(event_chain_execute_batch(chain, contexts, BATCH, results) == EC_SUCCESS,
+          "Batch executes");
+
+    bool matches = true;
+    for (int i = 0; i < BATCH; i++) {
+        /* Even start -> odd after the first increment -> rejected */
+        bool rejected = (i % 2 == 0);
+        matches = matches &&
+                  results[i].success == !rejected &&
+                  results[i].failure_count == (rejected ? 1u : 0u) &&
+                  counters[i] == (rejected ? i + 1 : i + 2);
+        chain_result_destroy(&results[i]);
+    }
+    check(matches, "Each context stops or continues independently");
+
+    /* Results agree with one call per context */
+    bool agrees = true;
+    for (int i = 0; i < BATCH; i++) {
+        counters[i] = i;
+    }
+    event_chain_execute_batch(chain, contexts, BATCH, results);
+    for (int i = 0; i < BATCH; i++) {
+        int batch_counter = counters[i];
+        counters[i] = i;
+        ChainResult single = event_chain_execute_with_context(chain, contexts[i]);
+        agrees = agrees && single.success == results[i].success &&
+                 single.failure_count == results[i].failure_count &&
+                 counters[i] == batch_counter;
+        chain_result_destroy(&single);
+        chain_result_destroy(&results[i]);
+    }
+    check(agrees, "Batch results match per-context execution");
+
+    /* A context already at the epoch limit stops the batch without touching any epoch */
+    int depth = 0;
+    while (event_context_epoch_begin(contexts[1]) == EC_SUCCESS) depth++;
+    int before = counters[0];
+    bool refused = event_chain_execute_batch(chain, contexts, BATCH, results) == EC_ERROR_OVERFLOW;
+    for (int i = 0; i < BATCH; i++) {
+        chain_result_destroy(&results[i]);
+    }
+    int closed = 0;
+    while (event_context_epoch_end(contexts[1]) == EC_SUCCESS) closed++;
+    check(refused && closed == depth && counters[0] == before &&
+          event_context_epoch_end(contexts[0]) == EC_ERROR_INVALID_PARAMETER,
+          "Batch refuses a context with no epoch left and leaves the others unopened");
+
+    event_context_destroy(contexts[BATCH / 2]);
+    contexts[BATCH / 2] = NULL;
+    check(event_chain_execute_batch(chain, contexts, BATCH, results) == EC_ERROR_NULL_POINTER,
+          "Batch rejects a NULL context");
+    for (int i = 0; i < BATCH; i++) {
+        chain_result_destroy(&results[i]);
+        if (contexts[i]) event_context_destroy(contexts[i]);
+    }
+
+    event_chain_destroy(chain);
+}
+
+void test_event_result_messages(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Compact Event Results            ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    static const char *fixed = "Fixed failure";
+
+    EventResult ok = event_result_success();
+    check(ok.success && ok.error_message && ok.error_message[0] == '\0',
+          "Success result carries an empty message");
+
+    EventResult stat = event_result_failure_static(fixed, EC_ERROR_NOT_FOUND);
+    check(!stat.success && stat.error_message == fixed && stat.error_code == EC_ERROR_NOT_FOUND,
+          "Static failure references its message without copying");
+
+    EventResult minimal = event_result_failure("secret detail", EC_ERROR_INVALID_PARAMETER,
+                                               ERROR_DETAIL_MINIMAL);
+    check(strcmp(minimal.error_message, "Operation failed") == 0,
+          "Minimal detail hides the message");
+
+    /* Arena slots rotate; the first message survives until they wrap */
+    EventResult first = event_result_failure("first", EC_ERROR_INVALID_PARAMETER, ERROR_DETAIL_FULL);
+    for (int i = 1; i < EVENTCHAINS_ERROR_ARENA_SLOTS; i++) {
+        event_result_failure("later", EC_ERROR_INVALID_PARAMETER, ERROR_DETAIL_FULL);
+    }
+    check(strcmp(first.error_message, "first") == 0,
+          "Arena message stays valid for the documented number of failures");
+
+    /* Chains copy the message into the failure record */
+    EventChain *chain = event_chain_create_strict();
+    event_chain_add_event(chain, chainable_event_create(failing_event_impl, NULL, "Failing"));
+    ChainResult result = event_chain_execute(chain);
+    check(result.failure_count == 1 && strcmp(result.failures[0].error_message, "Test failure") == 0,
+          "Chain result keeps its own copy of the message");
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+}
+
+static size_t counted_allocations = 0;
+
+static void *counting_malloc(size_t size, void *user_data) {
+    (void)user_data;
+    counted_allocations++;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *ptr, size_t size, void *user_data) {
+    (void)user_data;
+    counted_allocations++;
+    return realloc(ptr, size);
+}
+
+static void counting_free(void *ptr, void *user_data) {
+    (void)user_data;
+    free(ptr);
+}
+
+/* Middleware around three no-op events; the first run compiles the plan */
+static EventChain *build_warm_chain(int *counter) {
+    EventChain *chain = event_chain_create_strict();
+    event_chain_use_middleware(chain, event_middleware_create(
+        counting_middleware, counter, "Counting"));
+    event_chain_use_middleware(chain, event_middleware_create(
+        passthrough_middleware, NULL, "Passthrough"));
+    for (int i = 0; i < 3; i++) {
+        event_chain_add_event(chain, chainable_event_create(noop_event, NULL, "NoOp"));
+    }
+
+    ChainResult warmup = event_chain_execute(chain);
+    chain_result_destroy(&warmup);
+    return chain;
+}
+
+void test_zero_allocation_success_path(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║         CORRECTNESS TEST: Allocation-Free Execution           ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    int counter = 0;
+    EventChain *chain = build_warm_chain(&counter);
+
+    /* Forwards to libc, so objects created before the switch stay valid */
+    EventChainAllocator counting = {counting_malloc, counting_realloc, counting_free, NULL};
+    check(event_chain_set_allocator(&counting) == EC_SUCCESS, "Counting allocator installed");
+
+    counted_allocations = 0;
+    bool all_ok = true;
+    for (int i = 0; i < 100; i++) {
+        ChainResult result = event_chain_execute(chain);
+        all_ok = all_ok && result.success && result.failures == NULL;
+        chain_result_destroy(&result);
+    }
+    check(all_ok, "Successful executions report no failure records");
+    check(counted_allocations == 0, "Successful execute performs zero heap allocations");
+
+    /* Adding an event drops the plan: recompile it before counting */
+    event_chain_add_event(chain, chainable_event_create(failing_event_impl, NULL, "Failing"));
+    ChainResult failed = event_chain_execute(chain);
+    chain_result_destroy(&failed);
+
+    counted_allocations = 0;
+    failed = event_chain_execute(chain);
+    check(!failed.success && failed.failure_count == 1 && counted_allocations > 0,
+          "Failure records are allocated on demand");
+    chain_result_destroy(&failed);
+    event_chain_destroy(chain);
+
+    chain = build_warm_chain(&counter);
+    counted_allocations = 0;
+    ChainResult rebuilt = event_chain_execute(chain);
+    check(rebuilt.success && rebuilt.failures == NULL && counted_allocations == 0,
+          "A rebuilt chain that succeeds again allocates nothing");
+    chain_result_destroy(&rebuilt);
+
+    event_chain_destroy(chain);
+    event_chain_set_allocator(NULL);
+}
+
+void test_context_hash_index(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Context Hash Index               ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    static int values[EVENTCHAINS_MAX_CONTEXT_ENTRIES];
+    char key[32];
+    EventContext *ctx = event_context_create();
+
+    bool all_set = true;
+    for (int i = 0; i < EVENTCHAINS_MAX_CONTEXT_ENTRIES; i++) {
+        values[i] = i;
+        snprintf(key, sizeof(key), "key_%d", i);
+        all_set = all_set && event_context_set(ctx, key, &values[i]) == EC_SUCCESS;
+    }
+    check(all_set && event_context_count(ctx) == EVENTCHAINS_MAX_CONTEXT_ENTRIES,
+          "Context fills to capacity through index growth");
+
+    /* Overwrite must hit the existing entry, not add a duplicate */
+    event_context_set(ctx, "key_7", &values[8]);
+    void *out = NULL;
+    check(event_context_count(ctx) == EVENTCHAINS_MAX_CONTEXT_ENTRIES &&
+          event_context_get(ctx, "key_7", &out) == EC_SUCCESS && out == &values[8],
+          "Overwrite updates the indexed entry");
+
+    /* Removing entries shifts the rest; the index must follow */
+    for (int i = 0; i < EVENTCHAINS_MAX_CONTEXT_ENTRIES; i += 3) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        event_context_remove(ctx, key);
+    }
+
+    bool lookups_ok = true;
+    for (int i = 0; i < EVENTCHAINS_MAX_CONTEXT_ENTRIES; i++) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        bool expect = (i % 3 != 0);
+        void *value = NULL;
+        bool found = event_context_get(ctx, key, &value) == EC_SUCCESS;
+        lookups_ok = lookups_ok && found == expect &&
+                     event_context_has(ctx, key, false) == expect &&
+                     event_context_has(ctx, key, true) == expect &&
+                     (!found || i == 7 || value == &values[i]);
+    }
+    check(lookups_ok, "Lookups stay correct after removals");
+    check(!event_context_has(ctx, "missing", false) && !event_context_has(ctx, "missing", true),
+          "Missing keys are not found by either has() path");
+
+    event_context_clear(ctx);
+    check(event_context_count(ctx) == 0 && !event_context_has(ctx, "key_1", false),
+          "Clear empties the index");
+    check(event_context_set(ctx, "key_1", &values[1]) == EC_SUCCESS &&
+          event_context_get(ctx, "key_1", &out) == EC_SUCCESS && out == &values[1],
+          "Context is reusable after clear");
+
+    event_context_destroy(ctx);
+}
+
+void test_interned_keys(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Interned Keys                  ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    EventContextKey alpha = event_key_intern("alpha");
+    EventContextKey beta = event_key_intern("beta");
+    check(alpha != EVENT_CONTEXT_KEY_INVALID && beta != EVENT_CONTEXT_KEY_INVALID &&
+          alpha != beta && event_key_intern("alpha") == alpha,
+          "Interning is stable and distinct per string");
+    check(event_key_intern("") == EVENT_CONTEXT_KEY_INVALID &&
+          event_key_name(alpha) && strcmp(event_key_name(alpha), "alpha") == 0,
+          "Empty keys are rejected and names round-trip");
+
+    int a = 1, b = 2, c = 3;
+    void *out = NULL;
+    EventContext *ctx = event_context_create();
+
+    /* String and handle APIs share entries */
+    event_context_set(ctx, "alpha", &a);
+    check(event_context_get_k(ctx, alpha, &out) == EC_SUCCESS && out == &a,
+          "Handle reads a value set by string");
+    event_context_set_k(ctx, beta, &b);
+    check(event_context_get(ctx, "beta", &out) == EC_SUCCESS && out == &b &&
+          event_context_count(ctx) == 2,
+          "String reads a value set by handle");
+
+    /* Bindings survive entries moving underneath them */
+    event_context_set(ctx, "filler", &c);
+    event_context_remove(ctx, "alpha");
+    check(event_context_get_k(ctx, alpha, &out) == EC_ERROR_NOT_FOUND,
+          "Removed key is not found through a stale binding");
+    check(event_context_get_k(ctx, beta, &out) == EC_SUCCESS && out == &b,
+          "Binding is revalidated after entries shift");
+    event_context_set_k(ctx, alpha, &c);
+    check(event_context_get(ctx, "alpha", &out) == EC_SUCCESS && out == &c &&
+          event_context_count(ctx) == 3,
+          "Re-set through a handle adds one entry");
+
+    check(event_context_get_k(ctx, (EventContextKey)EVENTCHAINS_MAX_INTERNED_KEYS + 1, &out) ==
+          EC_ERROR_INVALID_PARAMETER,
+          "Unknown handles are rejected");
+
+    event_context_destroy(ctx);
+}
+
+void test_inline_typed_values(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Inline Typed Values              ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    EventContext *ctx = event_context_create();
+    int64_t i = 0;
+    double f = 0.0;
+    void *out = NULL;
+    EventValueType type;
+
+    check(event_context_set_i64(ctx, "count", -42) == EC_SUCCESS &&
+          event_context_get_i64(ctx, "count", &i) == EC_SUCCESS && i == -42,
+          "i64 round-trips");
+    check(event_context_set_f64(ctx, "ratio", 0.25) == EC_SUCCESS &&
+          event_context_get_f64(ctx, "ratio", &f) == EC_SUCCESS && f == 0.25,
+          "f64 round-trips");
+
+    struct { int x, y; } point = {3, 4};
+    const void *data = NULL;
+    size_t size = 0;
+    check(event_context_set_small(ctx, "point", &point, sizeof(point)) == EC_SUCCESS &&
+          event_context_get_small(ctx, "point", &data, &size) == EC_SUCCESS &&
+          size == sizeof(point) && memcmp(data, &point, size) == 0,
+          "Small struct round-trips by value");
+    char big[EVENTCHAINS_SMALL_VALUE_SIZE + 1] = {0};
+    check(event_context_set_small(ctx, "big", big, sizeof(big)) == EC_ERROR_INVALID_PARAMETER,
+          "Oversized small values are rejected");
+
+    check(event_context_get(ctx, "count", &out) == EC_ERROR_TYPE_MISMATCH && out == NULL &&
+          event_context_get_f64(ctx, "count", &f) == EC_ERROR_TYPE_MISMATCH,
+          "Reading with the wrong type reports a mismatch");
+    check(event_context_get_type(ctx, "ratio", &type) == EC_SUCCESS && type == EVENT_VALUE_F64,
+          "Stored type is reported");
+
+    /* Pointer and inline values can replace each other */
+    int value = 7;
+    event_context_set(ctx, "count", &value);
+    check(event_context_get(ctx, "count", &out) == EC_SUCCESS && out == &value &&
+          event_context_get_i64(ctx, "count", &i) == EC_ERROR_TYPE_MISMATCH,
+          "Pointer overwrite replaces an inline value");
+    event_context_set_i64(ctx, "count", 9);
+    check(event_context_get_i64(ctx, "count", &i) == EC_SUCCESS && i == 9 &&
+          event_context_count(ctx) == 3,
+          "Inline overwrite replaces a pointer value");
+
+    event_context_remove(ctx, "count");
+    check(event_context_get_f64(ctx, "ratio", &f) == EC_SUCCESS && f == 0.25 &&
+          event_context_get_i64(ctx, "count", &i) == EC_ERROR_NOT_FOUND,
+          "Inline values follow entries shifted by remove");
+
+    EventContextKey key = event_key_intern("inline_counter");
+    event_context_set_i64_k(ctx, key, 1);
+
+    EventChainAllocator counting = {counting_malloc, counting_realloc, counting_free, NULL};
+    event_chain_set_allocator(&counting);
+    counted_allocations = 0;
+    for (int n = 0; n < 100; n++) {
+        event_context_get_i64_k(ctx, key, &i);
+        event_context_set_i64_k(ctx, key, i + 1);
+    }
+    event_chain_set_allocator(NULL);
+    check(i == 100 && counted_allocations == 0,
+          "Updating an inline scalar performs no heap allocations");
+
+    event_context_destroy(ctx);
+}
+
+static int arena_cleanups = 0;
+
+static void count_cleanup(void *value) {
+    (void)value;
+    arena_cleanups++;
+}
+
+void test_arena_context(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Arena Contexts                 ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    static int values[32];
+    char key[32];
+
+    EventChainAllocator counting = {counting_malloc, counting_realloc, counting_free, NULL};
+    event_chain_set_allocator(&counting);
+
+    counted_allocations = 0;
+    EventContext *ctx = event_context_create_arena(0);
+    bool all_set = ctx != NULL;
+    for (int i = 0; i < 32; i++) {
+        snprintf(key, sizeof(key), "arena_key_%d", i);
+        all_set = all_set && event_context_set(ctx, key, &values[i]) == EC_SUCCESS;
+    }
+    size_t arena_allocations = counted_allocations;
+
+    counted_allocations = 0;
+    EventContext *heap_ctx = event_context_create();
+    for (int i = 0; i < 32; i++) {
+        snprintf(key, sizeof(key), "arena_key_%d", i);
+        event_context_set(heap_ctx, key, &values[i]);
+    }
+    size_t heap_allocations = counted_allocations;
+    event_context_destroy(heap_ctx);
+    event_chain_set_allocator(NULL);
+
+    printf("  32 entries: %zu allocations (arena) vs %zu (heap)\n",
+           arena_allocations, heap_allocations);
+    check(all_set && arena_allocations <= 3 && heap_allocations > 32,
+          "Arena context carves entries from a few chunks");
+
+    void *out = NULL;
+    bool lookups_ok = true;
+    for (int i = 0; i < 32; i++) {
+        snprintf(key, sizeof(key), "arena_key_%d", i);
+        lookups_ok = lookups_ok && event_context_get(ctx, key, &out) == EC_SUCCESS && out == &values[i];
+    }
+    check(lookups_ok && event_context_remove(ctx, "arena_key_3") == EC_SUCCESS &&
+          event_context_count(ctx) == 31,
+          "Arena context supports lookup and remove");
+
+    /* A retained reference must outlive the arena */
+    RefCountedValue *ref = NULL;
+    event_context_set_with_cleanup(ctx, "escaping", &values[0], count_cleanup);
+    event_context_get_ref(ctx, "escaping", &ref);
+    event_context_set_with_cleanup(ctx, "owned", &values[1], count_cleanup);
+    event_context_set_with_cleanup(ctx, "owned", &values[2], count_cleanup);
+    check(arena_cleanups == 1, "Overwrite runs cleanup for the replaced value");
+
+    event_context_clear(ctx);
+    check(event_context_count(ctx) == 0 && arena_cleanups == 2 &&
+          ref_counted_value_get_data(ref) == &values[0],
+          "Clear releases entries while outside references stay valid");
+    ref_counted_value_release(ref);
+    check(arena_cleanups == 3, "Released reference runs its cleanup");
+
+    check(event_context_set_i64(ctx, "reused", 5) == EC_SUCCESS &&
+          event_context_set(ctx, "other", &values[4]) == EC_SUCCESS &&
+          event_context_get(ctx, "other", &out) == EC_SUCCESS && out == &values[4],
+          "Arena context is reusable after clear");
+
+    event_context_destroy(ctx);
+}
+
+void test_context_pool(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║               CORRECTNESS TEST: Context Pool                  ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    static int values[40];
+    char key[32];
+    EventContextPool *pool = event_context_pool_create(4);
+    check(pool != NULL, "Pool created");
+
+    /* A few requests teach the pool the working-set size */
+    for (int round = 0; round < 3; round++) {
+        EventContext *ctx = event_context_pool_acquire(pool);
+        for (int i = 0; i < 40; i++) {
+            snprintf(key, sizeof(key), "pooled_%d", i);
+            event_context_set(ctx, key, &values[i]);
+        }
+        event_context_pool_release(pool, ctx);
+    }
+
+    EventContext *ctx = event_context_pool_acquire(pool);
+    check(ctx && event_context_count(ctx) == 0 && ctx->capacity >= 40,
+          "Acquired context is empty and pre-sized to the high-water mark");
+    event_context_pool_release(pool, ctx);
+
+    EventChainAllocator counting = {counting_malloc, counting_realloc, counting_free, NULL};
+    event_chain_set_allocator(&counting);
+    counted_allocations = 0;
+    bool all_ok = true;
+    for (int round = 0; round < 100; round++) {
+        ctx = event_context_pool_acquire(pool);
+        for (int i = 0; i < 40; i++) {
+            snprintf(key, sizeof(key), "pooled_%d", i);
+            all_ok = all_ok && event_context_set(ctx, key, &values[i]) == EC_SUCCESS;
+        }
+        event_context_pool_release(pool, ctx);
+    }
+    event_chain_set_allocator(NULL);
+    check(all_ok && counted_allocations == 0,
+          "Steady-state acquire/fill/release performs no heap allocations");
+
+    /* Contexts that did not come from a pool are simply destroyed */
+    event_context_pool_release(pool, event_context_create());
+    event_context_pool_destroy(pool);
+}
+
+void test_persistent_context(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║           CORRECTNESS TEST: Persistent Snapshots              ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    static int values[300];
+    char key[32];
+    void *out = NULL;
+    EventContext *base = event_context_create_persistent();
+
+    bool all_set = true;
+    for (int i = 0; i < 300; i++) {
+        values[i] = i;
+        snprintf(key, sizeof(key), "key_%d", i);
+        all_set = all_set && event_context_set(base, key, &values[i]) == EC_SUCCESS;
+    }
+    check(all_set && event_context_count(base) == 300, "Persistent context holds many entries");
+
+    EventContext *fork = event_context_snapshot(base);
+    event_context_set(fork, "key_5", &values[6]);
+    event_context_remove(fork, "key_7");
+    event_context_set_i64(fork, "extra", 42);
+
+    check(event_context_get(base, "key_5", &out) == EC_SUCCESS && out == &values[5] &&
+          event_context_has(base, "key_7", false) && !event_context_has(base, "extra", false) &&
+          event_context_count(base) == 300,
+          "Writes to a snapshot leave the original untouched");
+
+    int64_t extra = 0;
+    check(event_context_get(fork, "key_5", &out) == EC_SUCCESS && out == &values[6] &&
+          event_context_get(fork, "key_7", &out) == EC_ERROR_NOT_FOUND &&
+          event_context_get_i64(fork, "extra", &extra) == EC_SUCCESS && extra == 42 &&
+          event_context_count(fork) == 300,
+          "Snapshot sees its own writes");
+
+    bool shared_ok = true;
+    for (int i = 8; i < 300; i++) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        shared_ok = shared_ok && event_context_get(fork, key, &out) == EC_SUCCESS && out == &values[i];
+    }
+    check(shared_ok, "Unmodified entries are shared");
+    check(event_context_has(fork, "key_100", true) && !event_context_has(fork, "key_7", true),
+          "Constant-time has() scans the trie");
+
+    /* FNV-1a collides on these two keys */
+    check(event_context_set(fork, "k32728", &values[1]) == EC_SUCCESS &&
+          event_context_set(fork, "k261234", &values[2]) == EC_SUCCESS &&
+          event_context_get(fork, "k32728", &out) == EC_SUCCESS && out == &values[1] &&
+          event_context_remove(fork, "k32728") == EC_SUCCESS &&
+          event_context_get(fork, "k261234", &out) == EC_SUCCESS && out == &values[2],
+          "Full-hash collisions are kept apart");
+
+    /* Cleanup runs once the last version drops the value */
+    arena_cleanups = 0;
+    event_context_set_with_cleanup(base, "owned", &values[0], count_cleanup);
+    EventContext *checkpoint = event_context_snapshot(base);
+    event_context_remove(base, "owned");
+    check(arena_cleanups == 0 && event_context_has(checkpoint, "owned", false),
+          "Checkpoint keeps a removed value alive");
+    event_context_destroy(checkpoint);
+    check(arena_cleanups == 1, "Value is released with the last snapshot");
+
+    EventContextKey handle = event_key_intern("persistent_counter");
+    int64_t counter = 0;
+    EventContext *array_ctx = event_context_create();
+    check(event_context_set_i64_k(base, handle, 7) == EC_SUCCESS &&
+          event_context_get_i64_k(base, handle, &counter) == EC_SUCCESS && counter == 7 &&
+          event_context_snapshot(array_ctx) == NULL,
+          "Interned keys work; array contexts cannot be snapshotted");
+    event_context_destroy(array_ctx);
+
+    event_context_destroy(fork);
+    event_context_destroy(base);
+}
+
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_KEYS 100
+
+typedef struct {
+    EventContext *ctx;
+    int id;
+    bool reads_ok;
+} ConcurrentWorker;
+
+static int concurrent_shared_value = 99;
+
+static void *concurrent_context_worker(void *arg) {
+    ConcurrentWorker *worker = arg;
+    char key[32];
+    worker->reads_ok = true;
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < CONCURRENT_KEYS; i++) {
+            snprintf(key, sizeof(key), "w%d_%d", worker->id, i);
+            event_context_set_i64(worker->ctx, key, round * 1000 + i);
+
+            void *shared = NULL;
+            worker->reads_ok = worker->reads_ok &&
+                event_context_get(worker->ctx, "shared", &shared) == EC_SUCCESS &&
+                shared == &concurrent_shared_value;
+
+            /* A kept reference survives other threads replacing the key */
+            if (i % 10 == 0) {
+                int *hot = malloc(sizeof(int));
+                *hot = worker->id;
+                event_context_set_with_cleanup(worker->ctx, "hot", hot, free);
+            }
+            RefCountedValue *ref = NULL;
+            if (event_context_get_ref(worker->ctx, "hot", &ref) == EC_SUCCESS) {
+                int owner = *(int *)ref->data;
+                worker->reads_ok = worker->reads_ok && owner >= 0 && owner < CONCURRENT_THREADS;
+                ref_counted_value_release(ref);
+            }
+        }
+
+        /* Drop odd keys every round so removals race with the other writers */
+        for (int i = 1; i < CONCURRENT_KEYS; i += 2) {
+            snprintf(key, sizeof(key), "w%d_%d", worker->id, i);
+            event_context_remove(worker->ctx, key);
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_context(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Concurrent Context               ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    EventContext *ctx = event_context_create_concurrent();
+    event_context_set(ctx, "shared", &concurrent_shared_value);
+
+    pthread_t threads[CONCURRENT_THREADS];
+    ConcurrentWorker workers[CONCURRENT_THREADS];
+    for (int t = 0; t < CONCURRENT_THREADS; t++) {
+        workers[t].ctx = ctx;
+        workers[t].id = t;
+        pthread_create(&threads[t], NULL, concurrent_context_worker, &workers[t]);
+    }
+
+    bool reads_ok = true;
+    for (int t = 0; t < CONCURRENT_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        reads_ok = reads_ok && workers[t].reads_ok;
+    }
+    check(reads_ok, "Lock-free readers always see the shared entry");
+    event_context_remove(ctx, "hot");
+
+    bool values_ok = true;
+    char key[32];
+    for (int t = 0; t < CONCURRENT_THREADS; t++) {
+        for (int i = 0; i < CONCURRENT_KEYS; i++) {
+            int64_t value = -1;
+            snprintf(key, sizeof(key), "w%d_%d", t, i);
+            EventChainErrorCode err = event_context_get_i64(ctx, key, &value);
+            values_ok = values_ok && (i % 2 == 0 ? err == EC_SUCCESS && value == 19000 + i
+                                                 : err == EC_ERROR_NOT_FOUND);
+        }
+    }
+    check(values_ok && event_context_count(ctx) == 1 + CONCURRENT_THREADS * CONCURRENT_KEYS / 2,
+          "Concurrent writers leave every shard consistent");
+
+    event_context_clear(ctx);
+    check(event_context_count(ctx) == 0 && !event_context_has(ctx, "shared", false),
+          "Clear empties every shard");
+
+    event_context_destroy(ctx);
+}
+
+#define SHARED_REF_THREADS 4
+#define SHARED_REF_ROUNDS 10000
 
-        double start = get_time_ms();
-        ChainResult result = event_chain_execute(chain);
-        double elapsed = get_time_ms() - start;
+static int shared_ref_cleanups = 0;
 
-        update_stats(&stats, elapsed);
+static void shared_ref_cleanup(void *value) {
+    (void)value;
+    __atomic_fetch_add(&shared_ref_cleanups, 1, __ATOMIC_RELAXED);
+}
 
-        chain_result_destroy(&result);
-        event_chain_destroy(chain);
+static void *shared_ref_churn(void *arg) {
+    RefCountedValue *value = arg;
+    for (int i = 0; i < SHARED_REF_ROUNDS; i++) {
+        ref_counted_value_retain(value);
+        ref_counted_value_release(value);
     }
+    return NULL;
+}
 
-    print_stats("Minimal Chain (1 Event, No Middleware)", &stats);
+static void *shared_ref_release(void *arg) {
+    ref_counted_value_release(arg);
+    return NULL;
+}
 
-    printf("  ✓ Completed %d iterations successfully\n", iterations);
+static void *shared_ref_create(void *arg) {
+    (void)arg;
+    return ref_counted_value_create_shared(&concurrent_shared_value, shared_ref_cleanup);
 }
 
-void perf_test_chain_with_events(void) {
+void test_shared_ref_counting(void) {
     printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
-    printf("║          PERFORMANCE TEST: Chain with Multiple Events         ║\n");
+    printf("║           CORRECTNESS TEST: Thread-Safe Ref Counting          ║\n");
     printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-    int event_counts[] = {5, 10, 50, 100};
+    /* Owner and other threads retain and release at the same time */
+    RefCountedValue *value = ref_counted_value_create_shared(&concurrent_shared_value,
+                                                             shared_ref_cleanup);
+    pthread_t threads[SHARED_REF_THREADS];
+    for (int t = 0; t < SHARED_REF_THREADS; t++) {
+        pthread_create(&threads[t], NULL, shared_ref_churn, value);
+    }
+    shared_ref_churn(value);
+    for (int t = 0; t < SHARED_REF_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    check(ref_counted_value_get_count(value) == 1 && shared_ref_cleanups == 0,
+          "Owner and shared counts balance under contention");
+
+    ref_counted_value_release(value);
+    check(shared_ref_cleanups == 1, "Owner's last release frees the value");
+
+    /* Another thread releases the owner's only reference */
+    value = ref_counted_value_create_shared(&concurrent_shared_value, shared_ref_cleanup);
+    pthread_create(&threads[0], NULL, shared_ref_release, value);
+    pthread_join(threads[0], NULL);
+    check(shared_ref_cleanups == 1, "Handed-off release is queued on the owner");
+    ref_counted_value_process_queued();
+    check(shared_ref_cleanups == 2, "Owner merges and frees queued values");
+
+    /* The owner thread is gone by the time the last reference drops */
+    void *created = NULL;
+    pthread_create(&threads[0], NULL, shared_ref_create, NULL);
+    pthread_join(threads[0], &created);
+    ref_counted_value_retain(created);
+    ref_counted_value_release(created);
+    ref_counted_value_release(created);
+    check(shared_ref_cleanups == 3, "Values outliving their owner thread are freed");
+
+    /* Concurrent-context references may be released on any thread */
+    EventContext *ctx = event_context_create_concurrent();
+    event_context_set_with_cleanup(ctx, "shared", &concurrent_shared_value, shared_ref_cleanup);
+    RefCountedValue *ref = NULL;
+    event_context_get_ref(ctx, "shared", &ref);
+    event_context_remove(ctx, "shared");
+    check(shared_ref_cleanups == 3, "Context reference keeps the value alive");
+    pthread_create(&threads[0], NULL, shared_ref_release, ref);
+    pthread_join(threads[0], NULL);
+    check(shared_ref_cleanups == 4, "Last reference released on another thread frees it");
+    event_context_destroy(ctx);
+}
 
-    for (size_t test = 0; test < sizeof(event_counts) / sizeof(event_counts[0]); test++) {
-        int num_events = event_counts[test];
+static int borrow_cleanups = 0;
 
-        PerformanceStats stats;
-        init_stats(&stats);
+static void borrow_free(void *value) {
+    borrow_cleanups++;
+    free(value);
+}
 
-        const int iterations = 1000;
+static int *borrow_int(int value) {
+    int *p = malloc(sizeof(int));
+    *p = value;
+    return p;
+}
 
-        for (int i = 0; i < iterations; i++) {
-            EventChain *chain = event_chain_create_strict();
+/* Borrow a value, then drop it from the context and keep using it */
+static EventResult borrow_then_remove_event(EventContext *ctx, void *user_data) {
+    int *seen = user_data;
+    void *value = NULL;
+    if (event_context_borrow(ctx, "table", &value) != EC_SUCCESS) {
+        return event_result_failure("borrow failed", EC_ERROR_NOT_FOUND, ERROR_DETAIL_MINIMAL);
+    }
+    event_context_remove(ctx, "table");
+    event_context_set_with_cleanup(ctx, "table", borrow_int(2), borrow_free);
+    *seen = *(int *)value + borrow_cleanups * 100;
+    return event_result_success();
+}
 
-            for (int j = 0; j < num_events; j++) {
-                ChainableEvent *event = chainable_event_create(
-                    simple_computation_event, NULL, "Computation"
-                );
-                event_chain_add_event(chain, event);
-            }
+void test_borrow_epochs(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Borrow Epochs                  ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            double start = get_time_ms();
-            ChainResult result = event_chain_execute(chain);
-            double elapsed = get_time_ms() - start;
+    EventContext *ctx = event_context_create();
+    event_context_set_with_cleanup(ctx, "table", borrow_int(1), borrow_free);
+
+    void *value = NULL;
+    check(event_context_borrow(ctx, "table", &value) == EC_ERROR_INVALID_PARAMETER,
+          "Borrowing outside an epoch is rejected");
+
+    /* Nested epochs: nothing is released until the outermost one ends */
+    event_context_epoch_begin(ctx);
+    event_context_epoch_begin(ctx);
+    event_context_borrow(ctx, "table", &value);
+    event_context_set_with_cleanup(ctx, "table", borrow_int(2), borrow_free);
+    event_context_clear(ctx);
+    event_context_epoch_end(ctx);
+    check(borrow_cleanups == 0 && *(int *)value == 1,
+          "Overwritten and cleared values survive until the epoch ends");
+    event_context_epoch_end(ctx);
+    check(borrow_cleanups == 2, "Closing the outermost epoch releases them");
+    check(event_context_epoch_end(ctx) == EC_ERROR_INVALID_PARAMETER,
+          "Unbalanced epoch end is rejected");
+
+    /* Chain execution opens an epoch on its context */
+    borrow_cleanups = 0;
+    int seen = 0;
+    EventChain *chain = event_chain_create_strict();
+    event_chain_add_event(chain, chainable_event_create(borrow_then_remove_event, &seen, "Borrow"));
+    event_context_set_with_cleanup(event_chain_get_context(chain), "table", borrow_int(7), borrow_free);
+    ChainResult result = event_chain_execute(chain);
+    check(result.success && seen == 7, "Borrowed value stays valid after a mid-execution remove");
+    check(borrow_cleanups == 1, "Deferred release runs when the execution ends");
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
 
-            update_stats(&stats, elapsed);
+    /* Arena contexts park a heap copy, so a clear can reset the arena */
+    borrow_cleanups = 0;
+    EventContext *arena = event_context_create_arena(0);
+    event_context_set_with_cleanup(arena, "table", borrow_int(3), borrow_free);
+    event_context_epoch_begin(arena);
+    event_context_borrow(arena, "table", &value);
+    event_context_clear(arena);
+    event_context_set_with_cleanup(arena, "table", borrow_int(4), borrow_free);
+    check(borrow_cleanups == 0 && *(int *)value == 3, "Arena reset keeps borrowed values alive");
+    event_context_epoch_end(arena);
+    check(borrow_cleanups == 1, "Arena epoch releases the parked value");
+    event_context_destroy(arena);
+
+    /* Persistent contexts defer the replaced root */
+    borrow_cleanups = 0;
+    EventContext *persistent = event_context_create_persistent();
+    event_context_set_with_cleanup(persistent, "table", borrow_int(5), borrow_free);
+    event_context_epoch_begin(persistent);
+    event_context_borrow(persistent, "table", &value);
+    event_context_remove(persistent, "table");
+    check(borrow_cleanups == 0 && *(int *)value == 5, "Persistent remove is deferred");
+    event_context_destroy(persistent);
+    check(borrow_cleanups == 1, "Destroy closes the epoch and releases everything");
 
-            chain_result_destroy(&result);
-            event_chain_destroy(chain);
-        }
+    event_context_destroy(ctx);
+}
 
-        char test_name[128];
-        snprintf(test_name, sizeof(test_name), "Chain with %d Events", num_events);
-        print_stats(test_name, &stats);
-    }
+static int queued_cleanups = 0;
+static pthread_t queued_cleanup_thread;
+
+static void queued_free(void *value) {
+    __atomic_fetch_add(&queued_cleanups, 1, __ATOMIC_RELAXED);
+    queued_cleanup_thread = pthread_self();
+    free(value);
 }
 
-void perf_test_chain_with_middleware(void) {
+static EventResult overwrite_heavy_event(EventContext *ctx, void *user_data) {
+    int *observed = user_data;
+    event_context_set_with_cleanup(ctx, "graph", borrow_int(2), queued_free);
+    *observed = queued_cleanups;
+    return event_result_success();
+}
+
+void test_cleanup_queue(void) {
     printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
-    printf("║        PERFORMANCE TEST: Chain with Middleware Layers         ║\n");
+    printf("║              CORRECTNESS TEST: Cleanup Queue                  ║\n");
     printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-    int middleware_counts[] = {1, 4, 8, 16};
-
-    for (size_t test = 0; test < sizeof(middleware_counts) / sizeof(middleware_counts[0]); test++) {
-        int num_middleware = middleware_counts[test];
+    EventCleanupQueue *queue = event_cleanup_queue_create(false);
+    EventContext *ctx = event_context_create();
+    check(event_context_set_cleanup_queue(ctx, queue) == EC_SUCCESS, "Heap context accepts a queue");
+
+    event_context_set_with_cleanup(ctx, "graph", borrow_int(1), queued_free);
+    event_context_set_with_cleanup(ctx, "graph", borrow_int(2), queued_free);
+    event_context_remove(ctx, "graph");
+    check(queued_cleanups == 0 && event_cleanup_queue_pending(queue) == 2,
+          "Overwrite and remove queue cleanups instead of running them");
+    check(event_cleanup_queue_drain(queue) == 2 && queued_cleanups == 2,
+          "Drain runs the queued cleanups");
+
+    /* A value referenced elsewhere is still cleaned up by its last holder */
+    RefCountedValue *ref = NULL;
+    event_context_set_with_cleanup(ctx, "graph", borrow_int(3), queued_free);
+    event_context_get_ref(ctx, "graph", &ref);
+    event_context_remove(ctx, "graph");
+    check(event_cleanup_queue_pending(queue) == 0, "Values still referenced are not queued");
+    ref_counted_value_release(ref);
+    check(queued_cleanups == 3, "Last holder's release cleans up inline");
+    event_context_destroy(ctx);
 
-        PerformanceStats stats;
-        init_stats(&stats);
+    /* Foreground queues drain when the execution's epoch ends */
+    queued_cleanups = 0;
+    int observed = -1;
+    EventChain *chain = event_chain_create_strict();
+    event_chain_add_event(chain, chainable_event_create(overwrite_heavy_event, &observed, "Overwrite"));
+    event_context_set_cleanup_queue(event_chain_get_context(chain), queue);
+    event_context_set_with_cleanup(event_chain_get_context(chain), "graph", borrow_int(1), queued_free);
+    ChainResult result = event_chain_execute(chain);
+    check(result.success && observed == 0 && queued_cleanups == 1,
+          "Cleanup is off the event's path and done when execution ends");
+    chain_result_destroy(&result);
+    event_chain_destroy(chain);
+    check(queued_cleanups == 1 && event_cleanup_queue_pending(queue) == 1,
+          "Destroying a context queues its values");
+    event_cleanup_queue_destroy(queue);
+    check(queued_cleanups == 2, "Destroying the queue runs what is left");
+
+    /* Background queues free on the reclaimer thread */
+    queued_cleanups = 0;
+    queue = event_cleanup_queue_create(true);
+    ctx = event_context_create_arena(0);
+    event_context_set_cleanup_queue(ctx, queue);
+    for (int i = 0; i < 100; i++) {
+        event_context_set_with_cleanup(ctx, "graph", borrow_int(i), queued_free);
+    }
+    event_context_destroy(ctx);
 
-        const int iterations = 1000;
+    EventContext *persistent = event_context_create_persistent();
+    check(event_context_set_cleanup_queue(persistent, queue) == EC_ERROR_INVALID_PARAMETER,
+          "Persistent contexts reject a cleanup queue");
+    event_context_destroy(persistent);
 
-        for (int i = 0; i < iterations; i++) {
-            EventChain *chain = event_chain_create_strict();
+    event_cleanup_queue_destroy(queue);
+    check(queued_cleanups == 100 && !pthread_equal(queued_cleanup_thread, pthread_self()),
+          "Reclaimer thread runs every cleanup before the queue is destroyed");
+}
 
-            for (int j = 0; j < num_middleware; j++) {
-                EventMiddleware *mw = event_middleware_create(
-                    passthrough_middleware, NULL, "Passthrough"
-                );
-                event_chain_use_middleware(chain, mw);
-            }
+static bool foreach_sum(const char *key, EventValueType type, const void *value, void *user_data) {
+    (void)key;
+    if (type == EVENT_VALUE_I64) {
+        *(int64_t *)user_data += ((const EventInlineValue *)value)->as.i64;
+    }
+    return true;
+}
 
-            ChainableEvent *event = chainable_event_create(noop_event, NULL, "NoOp");
-            event_chain_add_event(chain, event);
+static bool foreach_first(const char *key, EventValueType type, const void *value, void *user_data) {
+    (void)key; (void)type; (void)value;
+    (*(int *)user_data)++;
+    return false;
+}
 
-            double start = get_time_ms();
-            ChainResult result = event_chain_execute(chain);
-            double elapsed = get_time_ms() - start;
+void test_unordered_remove(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Unordered Remove                 ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            update_stats(&stats, elapsed);
+    EventContext *ctx = event_context_create();
+    char key[32];
+    for (int i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "entry_%d", i);
+        event_context_set_i64(ctx, key, i);
+    }
 
-            chain_result_destroy(&result);
-            event_chain_destroy(chain);
+    /* Bind both the removed key and the one that will fill its position */
+    EventContextKey middle = event_key_intern("entry_50");
+    EventContextKey tail = event_key_intern("entry_199");
+    int64_t value = -1;
+    event_context_get_i64_k(ctx, middle, &value);
+    event_context_get_i64_k(ctx, tail, &value);
+
+    check(event_context_remove(ctx, "entry_50") == EC_SUCCESS, "Remove from the middle");
+    check(event_context_count(ctx) == 199, "Count drops by one");
+    check(event_context_get_i64_k(ctx, middle, &value) == EC_ERROR_NOT_FOUND,
+          "Removed interned key is not found");
+    check(event_context_get_i64_k(ctx, tail, &value) == EC_SUCCESS && value == 199,
+          "Moved entry keeps its interned binding");
+
+    bool all_found = true;
+    for (int i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "entry_%d", i);
+        value = -1;
+        EventChainErrorCode err = event_context_get_i64(ctx, key, &value);
+        if (i == 50 ? err != EC_ERROR_NOT_FOUND : (err != EC_SUCCESS || value != i)) {
+            all_found = false;
         }
+    }
+    check(all_found, "Every other entry is still found with its value");
+
+    /* Churn temporary keys; the index must not fill with dead slots */
+    size_t memory = event_context_memory_usage(ctx);
+    for (int i = 0; i < 20000; i++) {
+        snprintf(key, sizeof(key), "temp_%d", i % 37);
+        event_context_set_i64(ctx, key, i);
+        event_context_remove(ctx, key);
+    }
+    check(event_context_count(ctx) == 199 && event_context_memory_usage(ctx) == memory,
+          "Insert/remove churn leaves count and memory unchanged");
+    check(event_context_get_i64(ctx, "entry_0", &value) == EC_SUCCESS && value == 0,
+          "Lookups still work after churn");
+
+    int64_t sum = 0;
+    event_context_foreach(ctx, foreach_sum, &sum);
+    check(sum == 199 * 200 / 2 - 50, "Foreach visits every entry once");
+    int visited = 0;
+    event_context_foreach(ctx, foreach_first, &visited);
+    check(visited == 1, "Foreach stops when the visitor returns false");
+    event_context_destroy(ctx);
 
-        char test_name[128];
-        snprintf(test_name, sizeof(test_name), "Chain with %d Middleware Layers", num_middleware);
-        print_stats(test_name, &stats);
+    EventContext *persistent = event_context_create_persistent();
+    EventContext *concurrent = event_context_create_concurrent();
+    for (int i = 1; i <= 100; i++) {
+        snprintf(key, sizeof(key), "entry_%d", i);
+        event_context_set_i64(persistent, key, i);
+        event_context_set_i64(concurrent, key, i);
     }
+    int64_t persistent_sum = 0, concurrent_sum = 0;
+    event_context_foreach(persistent, foreach_sum, &persistent_sum);
+    event_context_foreach(concurrent, foreach_sum, &concurrent_sum);
+    check(persistent_sum == 5050 && concurrent_sum == 5050,
+          "Foreach walks persistent and concurrent contexts");
+    event_context_destroy(persistent);
+    event_context_destroy(concurrent);
 }
 
-void perf_test_context_operations(void) {
+void test_value_transfer(void) {
     printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
-    printf("║           PERFORMANCE TEST: Context Operations                ║\n");
+    printf("║              CORRECTNESS TEST: Value Transfer                 ║\n");
     printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-    /* Test 1: Context Set Operations */
-    {
-        PerformanceStats stats;
-        init_stats(&stats);
-
-        const int iterations = 10000;
+    borrow_cleanups = 0;
+    EventContext *ctx = event_context_create();
+    event_context_set_with_cleanup(ctx, "buffer", borrow_int(7), borrow_free);
+
+    void *value = NULL;
+    ValueCleanupFunc cleanup = NULL;
+    check(event_context_take(ctx, "buffer", &value, NULL) == EC_ERROR_INVALID_PARAMETER,
+          "Take refuses to drop a cleanup on the floor");
+    check(event_context_take(ctx, "buffer", &value, &cleanup) == EC_SUCCESS &&
+          *(int *)value == 7 && cleanup == borrow_free,
+          "Take hands over the value and its cleanup");
+    check(!event_context_has(ctx, "buffer", false) && borrow_cleanups == 0,
+          "Taken entry is gone and its cleanup did not run");
+    cleanup(value);
+    check(borrow_cleanups == 1, "The caller runs the cleanup it took");
+
+    RefCountedValue *ref = NULL;
+    event_context_set_with_cleanup(ctx, "shared", borrow_int(8), borrow_free);
+    event_context_get_ref(ctx, "shared", &ref);
+    check(event_context_take(ctx, "shared", &value, &cleanup) == EC_ERROR_INVALID_PARAMETER &&
+          event_context_has(ctx, "shared", false),
+          "Take refuses a value referenced elsewhere");
+
+    /* Heap to heap: the wrapper changes hands, outstanding references survive */
+    EventContext *next = event_context_create();
+    event_context_set_i64(next, "shared", 1);
+    check(event_context_move(next, ctx, "shared") == EC_SUCCESS, "Move between heap contexts");
+    void *moved = NULL;
+    check(!event_context_has(ctx, "shared", false) &&
+          event_context_get(next, "shared", &moved) == EC_SUCCESS && moved == ref->data,
+          "Moved value replaces the destination's entry");
+    check(ref_counted_value_get_count(ref) == 2, "Move leaves the reference count alone");
+    ref_counted_value_release(ref);
+
+    event_context_set_i64(ctx, "counter", 42);
+    int64_t counter = 0;
+    check(event_context_move(next, ctx, "counter") == EC_SUCCESS &&
+          event_context_get_i64(next, "counter", &counter) == EC_SUCCESS && counter == 42,
+          "Inline values move too");
+    check(event_context_move(next, ctx, "missing") == EC_ERROR_NOT_FOUND,
+          "Moving a missing key reports not found");
+    event_context_destroy(ctx);
 
-        for (int i = 0; i < iterations; i++) {
-            EventContext *ctx = event_context_create();
+    /* Arena to persistent: the value and its cleanup move instead */
+    EventContext *arena = event_context_create_arena(0);
+    EventContext *persistent = event_context_create_persistent();
+    event_context_set_with_cleanup(arena, "buffer", borrow_int(9), borrow_free);
+    check(event_context_move(persistent, arena, "buffer") == EC_SUCCESS &&
+          event_context_count(arena) == 0,
+          "Move from an arena into a persistent context");
+    event_context_destroy(arena);
+    check(borrow_cleanups == 1 && event_context_get(persistent, "buffer", &moved) == EC_SUCCESS &&
+          *(int *)moved == 9,
+          "Destroying the source leaves the moved value alone");
+    check(event_context_take(persistent, "buffer", &value, &cleanup) == EC_ERROR_INVALID_PARAMETER,
+          "Persistent contexts refuse take");
+    event_context_destroy(persistent);
+    check(borrow_cleanups == 2, "The destination runs the cleanup");
+
+    event_context_destroy(next);
+    check(borrow_cleanups == 3, "Moved heap value is cleaned up once");
+}
 
-            double start = get_time_ms();
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_set(ctx, key, (void *)(intptr_t)j);
-            }
-            double elapsed = get_time_ms() - start;
+void test_context_scopes(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║              CORRECTNESS TEST: Context Scopes                 ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            update_stats(&stats, elapsed);
+    borrow_cleanups = 0;
+    EventContext *ctx = event_context_create();
+    int *original = borrow_int(1);
+    event_context_set_i64(ctx, "config", 1);
+    event_context_set_with_cleanup(ctx, "shared", original, borrow_free);
+    size_t memory = event_context_memory_usage(ctx);
+
+    check(event_context_push_scope(ctx) == EC_SUCCESS, "Push a scope");
+    char key[32];
+    for (int i = 0; i < 5; i++) {
+        snprintf(key, sizeof(key), "scratch_%d", i);
+        event_context_set_i64(ctx, key, i);
+    }
+    event_context_set_i64(ctx, "config", 2);
+    event_context_set_with_cleanup(ctx, "shared", borrow_int(2), borrow_free);
+
+    int64_t value = 0;
+    void *data = NULL;
+    check(event_context_get_i64(ctx, "config", &value) == EC_SUCCESS && value == 2 &&
+          event_context_count(ctx) == 7,
+          "Scope sees its own writes on top of the outer keys");
+    check(event_context_remove(ctx, "config") == EC_ERROR_INVALID_PARAMETER,
+          "Outer keys cannot be removed inside a scope");
+    check(event_context_remove(ctx, "scratch_3") == EC_SUCCESS, "Scratch keys can be removed");
+
+    /* An inner scope overwriting the outer scope's scratch key */
+    event_context_push_scope(ctx);
+    event_context_set_i64(ctx, "scratch_0", 99);
+    event_context_set_i64(ctx, "inner", 1);
+    event_context_pop_scope(ctx);
+    check(event_context_get_i64(ctx, "scratch_0", &value) == EC_SUCCESS && value == 0 &&
+          !event_context_has(ctx, "inner", false),
+          "Inner pop restores the outer scope's view");
+    check(borrow_cleanups == 0, "Outer value survives being overwritten in a scope");
+
+    check(event_context_pop_scope(ctx) == EC_SUCCESS, "Pop the scope");
+    check(event_context_count(ctx) == 2 && !event_context_has(ctx, "scratch_4", false),
+          "Pop drops every scratch entry");
+    check(event_context_get_i64(ctx, "config", &value) == EC_SUCCESS && value == 1 &&
+          event_context_get(ctx, "shared", &data) == EC_SUCCESS && data == original,
+          "Pop restores overwritten outer values");
+    check(borrow_cleanups == 1 && event_context_memory_usage(ctx) == memory,
+          "Scoped value is cleaned up and accounting returns to where it was");
+    check(event_context_pop_scope(ctx) == EC_ERROR_INVALID_PARAMETER,
+          "Pop without an open scope is rejected");
+
+    event_context_push_scope(ctx);
+    event_context_set_i64(ctx, "scratch", 1);
+    event_context_clear(ctx);
+    check(event_context_pop_scope(ctx) == EC_ERROR_INVALID_PARAMETER && borrow_cleanups == 2,
+          "Clear closes open scopes");
+    event_context_destroy(ctx);
 
-            event_context_destroy(ctx);
-        }
+    EventContext *persistent = event_context_create_persistent();
+    event_context_set_i64(persistent, "config", 1);
+    event_context_push_scope(persistent);
+    event_context_set_i64(persistent, "config", 2);
+    event_context_set_i64(persistent, "scratch", 3);
+    check(event_context_remove(persistent, "config") == EC_SUCCESS,
+          "Persistent scopes allow removing outer keys");
+    event_context_pop_scope(persistent);
+    check(event_context_count(persistent) == 1 &&
+          event_context_get_i64(persistent, "config", &value) == EC_SUCCESS && value == 1,
+          "Persistent pop returns to the saved root");
+    event_context_destroy(persistent);
+
+    EventContext *concurrent = event_context_create_concurrent();
+    check(event_context_push_scope(concurrent) == EC_ERROR_INVALID_PARAMETER,
+          "Concurrent contexts reject scopes");
+    event_context_destroy(concurrent);
+}
 
-        print_stats("Context: 100 Set Operations", &stats);
+static size_t int_codec_encode(const void *value, void *buffer, size_t capacity) {
+    if (capacity >= sizeof(int)) {
+        memcpy(buffer, value, sizeof(int));
     }
+    return sizeof(int);
+}
 
-    /* Test 2: Context Get Operations */
-    {
-        PerformanceStats stats;
-        init_stats(&stats);
-
-        const int iterations = 10000;
+static void *int_codec_decode(const void *bytes, size_t size) {
+    if (size != sizeof(int)) return NULL;
+    int value;
+    memcpy(&value, bytes, sizeof(int));
+    return borrow_int(value);
+}
 
-        for (int i = 0; i < iterations; i++) {
-            EventContext *ctx = event_context_create();
+static const EventValueCodec int_codec = {
+    "test.int", int_codec_encode, int_codec_decode, borrow_free
+};
 
-            /* Populate context */
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_set(ctx, key, (void *)(intptr_t)j);
-            }
+void test_context_serialization(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║           CORRECTNESS TEST: Context Serialization             ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            double start = get_time_ms();
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                void *value;
-                event_context_get(ctx, key, &value);
-            }
-            double elapsed = get_time_ms() - start;
+    borrow_cleanups = 0;
+    EventContext *ctx = event_context_create();
+    event_context_set_i64(ctx, "count", 42);
+    event_context_set_f64(ctx, "ratio", 0.5);
+    event_context_set_small(ctx, "tag", "blue", 5);
+    event_context_set(ctx, "nothing", NULL);
+    event_context_set_with_codec(ctx, "answer", borrow_int(7), &int_codec);
+
+    void *image = NULL;
+    size_t size = 0;
+    check(event_context_serialize(ctx, &image, &size) == EC_SUCCESS && size > 0,
+          "Serialize a context with codec and inline values");
+
+    EventContext *mapped = event_context_load_mapped(image, size);
+    void *data = NULL;
+    check(mapped && event_context_count(mapped) == 5 &&
+          event_context_has(mapped, "answer", false) &&
+          event_context_get(mapped, "answer", &data) == EC_ERROR_NOT_FOUND,
+          "Without its codec registered, a value reads as missing");
+    event_context_destroy(mapped);
+
+    check(event_codec_register(&int_codec) == EC_SUCCESS &&
+          event_codec_register(&int_codec) == EC_SUCCESS &&
+          event_codec_find("test.int") == &int_codec,
+          "Register a codec (idempotent)");
+    EventValueCodec impostor = int_codec;
+    check(event_codec_register(&impostor) == EC_ERROR_INVALID_PARAMETER,
+          "A second codec cannot take a registered name");
+
+    /* Mapped: scalars and small values straight from the image */
+    mapped = event_context_load_mapped(image, size);
+    int64_t count = 0;
+    double ratio = 0.0;
+    const void *tag = NULL;
+    size_t tag_size = 0;
+    check(mapped && event_context_get_i64(mapped, "count", &count) == EC_SUCCESS && count == 42 &&
+          event_context_get_f64(mapped, "ratio", &ratio) == EC_SUCCESS && ratio == 0.5,
+          "Mapped scalars read back");
+    check(event_context_get_small(mapped, "tag", &tag, &tag_size) == EC_SUCCESS &&
+          tag_size == 5 && strcmp(tag, "blue") == 0 &&
+          (const char *)tag > (const char *)image && (const char *)tag < (const char *)image + size,
+          "Mapped small values are read in place");
+
+    const void *bytes = NULL;
+    size_t bytes_size = 0;
+    check(event_context_get_encoded(mapped, "answer", &bytes, &bytes_size) == EC_SUCCESS &&
+          bytes_size == sizeof(int) && memcmp(bytes, &(int){7}, sizeof(int)) == 0,
+          "Encoded bytes are available without decoding");
+    check(event_context_get(mapped, "answer", &data) == EC_SUCCESS && *(int *)data == 7 &&
+          event_context_get(mapped, "nothing", &data) == EC_SUCCESS && data == NULL,
+          "Pointer values decode on first access");
+
+    check(event_context_set_i64(mapped, "count", 1) == EC_ERROR_INVALID_PARAMETER &&
+          event_context_remove(mapped, "count") == EC_ERROR_INVALID_PARAMETER &&
+          event_context_push_scope(mapped) == EC_ERROR_INVALID_PARAMETER,
+          "Mapped contexts are read-only");
+    event_context_clear(mapped);
+    check(event_context_count(mapped) == 5, "Clear leaves a mapped context alone");
+
+    /* A mapped context serializes like any other */
+    void *copy_image = NULL;
+    size_t copy_size = 0;
+    check(event_context_serialize(mapped, &copy_image, &copy_size) == EC_SUCCESS &&
+          copy_size == size,
+          "Mapped context re-serializes");
+    event_context_image_free(copy_image);
+    event_context_destroy(mapped);
+    check(borrow_cleanups == 1, "Decoded value is freed with the mapped context");
+
+    /* Owning load: a writable heap context, independent of the image */
+    EventContext *loaded = event_context_load(image, size);
+    check(loaded && event_context_get(loaded, "answer", &data) == EC_SUCCESS && *(int *)data == 7 &&
+          event_context_set_i64(loaded, "count", 43) == EC_SUCCESS,
+          "Owning load decodes into a writable context");
+    event_context_destroy(loaded);
+
+    /* Damaged images */
+    check(event_context_load_mapped(image, size - 8) == NULL, "Truncated image is rejected");
+    ((unsigned char *)image)[0] ^= 0xFF;
+    check(event_context_load_mapped(image, size) == NULL && event_context_load(image, size) == NULL,
+          "Bad magic is rejected");
+    event_context_image_free(image);
+
+    event_context_set_with_cleanup(ctx, "opaque", borrow_int(1), borrow_free);
+    check(event_context_serialize(ctx, &image, &size) == EC_ERROR_TYPE_MISMATCH && image == NULL,
+          "Values without a codec cannot be serialized");
+    event_context_destroy(ctx);
 
-            update_stats(&stats, elapsed);
+    /* Persistent contexts serialize through the same walk */
+    EventContext *persistent = event_context_create_persistent();
+    event_context_set_with_codec(persistent, "answer", borrow_int(9), &int_codec);
+    event_context_serialize(persistent, &image, &size);
+    mapped = event_context_load_mapped(image, size);
+    check(mapped && event_context_get(mapped, "answer", &data) == EC_SUCCESS && *(int *)data == 9,
+          "Persistent context round trip");
+    event_context_destroy(mapped);
+    event_context_image_free(image);
+    event_context_destroy(persistent);
+}
 
-            event_context_destroy(ctx);
-        }
+typedef struct {
+    int count;
+    char keys[8][32];
+    bool removed[8];
+    int64_t values[8];
+} ChangeLog;
+
+static bool collect_change(const EventContextChange *change, void *user_data) {
+    ChangeLog *log = user_data;
+    if (log->count < 8) {
+        snprintf(log->keys[log->count], sizeof(log->keys[0]), "%s", change->key);
+        log->removed[log->count] = change->removed;
+        log->values[log->count] = !change->removed && change->type == EVENT_VALUE_I64
+                                      ? ((const EventInlineValue *)change->value)->as.i64 : -1;
+    }
+    log->count++;
+    return true;
+}
 
-        print_stats("Context: 100 Get Operations", &stats);
+/* Index of key in the collected changes, or -1 */
+static int change_index(const ChangeLog *log, const char *key) {
+    for (int i = 0; i < log->count && i < 8; i++) {
+        if (strcmp(log->keys[i], key) == 0) return i;
     }
+    return -1;
+}
 
-    /* Test 3: Context Has Operations */
-    {
-        PerformanceStats stats;
-        init_stats(&stats);
+static bool change_removed(const ChangeLog *log, const char *key) {
+    int i = change_index(log, key);
+    return i >= 0 && log->removed[i];
+}
 
-        const int iterations = 10000;
+static void test_changelog_backend(EventContext *ctx, const char *backend) {
+    ChangeLog log;
+    printf("  %s context:\n", backend);
+
+    event_context_set_i64(ctx, "stable", 1);
+    event_context_set_i64(ctx, "doomed", 1);
+    event_context_record_changes(ctx, true);
+    uint64_t start = event_context_version(ctx);
+
+    event_context_set_i64(ctx, "counter", 1);
+    event_context_set_i64(ctx, "counter", 2);
+    event_context_set_i64(ctx, "counter", 3);
+    event_context_remove(ctx, "doomed");
+    event_context_set_i64(ctx, "scratch", 1);
+    event_context_remove(ctx, "scratch");
+
+    memset(&log, 0, sizeof(log));
+    int counter = -1;
+    check(event_context_changes_since(ctx, start, collect_change, &log) == EC_SUCCESS &&
+          log.count == 3 && (counter = change_index(&log, "counter")) >= 0 &&
+          log.values[counter] == 3 &&
+          change_removed(&log, "doomed") && change_removed(&log, "scratch") &&
+          change_index(&log, "stable") < 0,
+          "Each changed key reported once with its final state");
+
+    /* A scope's writes are undone on pop, so its keys change again */
+    uint64_t before_scope = event_context_version(ctx);
+    event_context_push_scope(ctx);
+    event_context_set_i64(ctx, "counter", 99);
+    event_context_set_i64(ctx, "temporary", 1);
+    event_context_pop_scope(ctx);
+    memset(&log, 0, sizeof(log));
+    event_context_changes_since(ctx, before_scope, collect_change, &log);
+    counter = change_index(&log, "counter");
+    check(log.count == 2 && counter >= 0 && log.values[counter] == 3 &&
+          change_removed(&log, "temporary"),
+          "Scope pop reports the restored values");
+
+    uint64_t now = event_context_version(ctx);
+    memset(&log, 0, sizeof(log));
+    check(event_context_changes_since(ctx, now, collect_change, &log) == EC_SUCCESS && log.count == 0,
+          "Nothing new at the current version");
+
+    check(event_context_trim_changes(ctx, before_scope) == EC_SUCCESS &&
+          event_context_changes_since(ctx, start, collect_change, &log) == EC_ERROR_INVALID_PARAMETER &&
+          event_context_changes_since(ctx, before_scope, collect_change, &log) == EC_SUCCESS,
+          "Trimmed versions must resync, later ones still work");
+
+    event_context_clear(ctx);
+    memset(&log, 0, sizeof(log));
+    event_context_changes_since(ctx, now, collect_change, &log);
+    check(log.count == 2 && log.removed[0] && log.removed[1],
+          "Clear reports every key removed");
+
+    event_context_record_changes(ctx, false);
+    check(event_context_changes_since(ctx, now, collect_change, &log) == EC_ERROR_INVALID_PARAMETER,
+          "Stopping recording drops the log");
+}
 
-        for (int i = 0; i < iterations; i++) {
-            EventContext *ctx = event_context_create();
+void test_context_changelog(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║             CORRECTNESS TEST: Context Change Log              ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            /* Populate context */
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_set(ctx, key, (void *)(intptr_t)j);
-            }
+    EventContext *ctx = event_context_create();
+    ChangeLog log;
+    check(event_context_changes_since(ctx, 0, collect_change, &log) == EC_ERROR_INVALID_PARAMETER,
+          "Changes are only available while recording");
+    test_changelog_backend(ctx, "Heap");
+    event_context_destroy(ctx);
 
-            double start = get_time_ms();
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_has(ctx, key, false);
-            }
-            double elapsed = get_time_ms() - start;
+    EventContext *persistent = event_context_create_persistent();
+    test_changelog_backend(persistent, "Persistent");
+    event_context_destroy(persistent);
+
+    /* Take and move are removals too */
+    EventContext *src = event_context_create();
+    EventContext *dst = event_context_create();
+    event_context_set_with_cleanup(src, "payload", borrow_int(5), borrow_free);
+    event_context_record_changes(src, true);
+    event_context_record_changes(dst, true);
+    uint64_t src_start = event_context_version(src);
+    uint64_t dst_start = event_context_version(dst);
+    event_context_move(dst, src, "payload");
+    memset(&log, 0, sizeof(log));
+    event_context_changes_since(src, src_start, collect_change, &log);
+    bool src_removed = log.count == 1 && log.removed[0];
+    memset(&log, 0, sizeof(log));
+    event_context_changes_since(dst, dst_start, collect_change, &log);
+    check(src_removed && log.count == 1 && !log.removed[0],
+          "Move is logged as a removal from src and a set in dst");
+    event_context_destroy(src);
+    event_context_destroy(dst);
+
+    EventContext *concurrent = event_context_create_concurrent();
+    check(event_context_record_changes(concurrent, true) == EC_ERROR_INVALID_PARAMETER,
+          "Concurrent contexts do not record changes");
+    event_context_destroy(concurrent);
+}
 
-            update_stats(&stats, elapsed);
+static unsigned char *sized_buffer(size_t size, unsigned char fill) {
+    unsigned char *buffer = malloc(size);
+    memset(buffer, fill, size);
+    return buffer;
+}
 
-            event_context_destroy(ctx);
-        }
+static bool buffer_filled(const void *data, size_t size, unsigned char fill) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != fill) return false;
+    }
+    return data != NULL;
+}
 
-        print_stats("Context: 100 Has Operations (Fast)", &stats);
+void test_sized_values(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║          CORRECTNESS TEST: Sized Values and Spilling          ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
+
+    borrow_cleanups = 0;
+    EventContext *ctx = event_context_create();
+    size_t memory = event_context_memory_usage(ctx);
+    event_context_set_sized(ctx, "small", sized_buffer(1000, 1), 1000, borrow_free);
+    check(event_context_memory_usage(ctx) >= memory + 1000, "Sized values count their bytes");
+
+    unsigned char *huge = calloc(1, EVENTCHAINS_MAX_CONTEXT_MEMORY);
+    check(event_context_set_sized(ctx, "huge", huge, EVENTCHAINS_MAX_CONTEXT_MEMORY, free) ==
+          EC_ERROR_MEMORY_LIMIT_EXCEEDED,
+          "Without a spill file, a value over the limit is refused");
+    free(huge);
+
+    const size_t budget = 8192;
+    check(event_context_enable_spill(ctx, NULL, budget) == EC_SUCCESS, "Enable spilling");
+    char key[32];
+    for (int i = 0; i < 4; i++) {
+        snprintf(key, sizeof(key), "block_%d", i);
+        event_context_set_sized(ctx, key, sized_buffer(3000, (unsigned char)(10 + i)), 3000, borrow_free);
     }
+    void *data = NULL;
+    check(event_context_spilled_bytes(ctx) >= 3000 && event_context_memory_usage(ctx) <= budget,
+          "Oldest values spill to keep memory within the budget");
+    check(event_context_get(ctx, "small", &data) == EC_SUCCESS && buffer_filled(data, 1000, 1) &&
+          event_context_get(ctx, "block_3", &data) == EC_SUCCESS && buffer_filled(data, 3000, 13),
+          "Spilled and resident values read back intact");
+    check(borrow_cleanups >= 1, "Spilled buffers are freed");
+
+    size_t spilled = event_context_spilled_bytes(ctx);
+    event_context_set_sized(ctx, "block_3", sized_buffer(3000, 23), 3000, borrow_free);
+    check(event_context_spilled_bytes(ctx) == spilled &&
+          event_context_get(ctx, "block_3", &data) == EC_SUCCESS && buffer_filled(data, 3000, 23),
+          "Overwriting a value with one of the same size spills nothing");
+
+    check(event_context_set_sized(ctx, "oversized", sized_buffer(20000, 7), 20000, borrow_free) ==
+              EC_SUCCESS &&
+          event_context_spilled_bytes(ctx) >= spilled + 20000 &&
+          event_context_memory_usage(ctx) <= budget &&
+          event_context_get(ctx, "oversized", &data) == EC_SUCCESS && buffer_filled(data, 20000, 7),
+          "A value bigger than the budget goes straight to the file");
+
+    spilled = event_context_spilled_bytes(ctx);
+    RefCountedValue *ref = NULL;
+    check(event_context_get_ref(ctx, "small", &ref) == EC_SUCCESS &&
+          buffer_filled(ref->data, 1000, 1) && event_context_spilled_bytes(ctx) < spilled,
+          "get_ref faults a spilled value back into memory");
+    ref_counted_value_release(ref);
+
+    void *taken = NULL;
+    ValueCleanupFunc taken_cleanup = NULL;
+    check(event_context_take(ctx, "block_0", &taken, &taken_cleanup) == EC_SUCCESS &&
+          buffer_filled(taken, 3000, 10) && taken_cleanup != NULL,
+          "Take hands out a resident copy of a spilled value");
+    taken_cleanup(taken);
+
+    event_context_clear(ctx);
+    check(event_context_spilled_bytes(ctx) == 0, "Clear releases the spill file");
+    event_context_destroy(ctx);
 
-    /* Test 4: Context Has Operations (Constant Time) */
-    {
-        PerformanceStats stats;
-        init_stats(&stats);
+    EventContext *persistent = event_context_create_persistent();
+    check(event_context_set_sized(persistent, "block", &spilled, sizeof(spilled), NULL) ==
+              EC_ERROR_INVALID_PARAMETER &&
+          event_context_enable_spill(persistent, NULL, 0) == EC_ERROR_INVALID_PARAMETER,
+          "Persistent contexts do not take sized values");
+    event_context_destroy(persistent);
+}
 
-        const int iterations = 10000;
+typedef struct {
+    char keys[16][40];
+    int count;
+} PrefixMatches;
+
+static bool collect_prefix(const char *key, EventValueType type, const void *value, void *user_data) {
+    (void)type;
+    (void)value;
+    PrefixMatches *matches = user_data;
+    if (matches->count < 16) {
+        snprintf(matches->keys[matches->count], sizeof(matches->keys[0]), "%s", key);
+    }
+    matches->count++;
+    return true;
+}
 
-        for (int i = 0; i < iterations; i++) {
-            EventContext *ctx = event_context_create();
+static int count_prefix(EventContext *ctx, const char *prefix) {
+    PrefixMatches matches = { .count = 0 };
+    event_context_iterate_prefix(ctx, prefix, collect_prefix, &matches);
+    return matches.count;
+}
 
-            /* Populate context */
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_set(ctx, key, (void *)(intptr_t)j);
-            }
+void test_context_prefixes(void) {
+    printf("\n╔═══════════════════════════════════════════════════════════════╗\n");
+    printf("║            CORRECTNESS TEST: Prefix-Indexed Keys              ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════╝\n");
 
-            double start = get_time_ms();
-            for (int j = 0; j < 100; j++) {
-                char key[32];
-                snprintf(key, sizeof(key), "key_%d", j);
-                event_context_has(ctx, key, true);
-            }
-            double elapsed = get_time_ms() - start;
+    static const char *keys[] = {
+        "user.profile.name", "user.profile.age", "user.id",
+        "order.total", "order.items.2", "order.items.1", "orders"
+    };
+    const int key_count = (int)(sizeof(keys) / sizeof(keys[0]));
 
-            update_stats(&stats, elapsed);
+    EventContext *ctx = event_context_create();
+    EventContext *plain = event_context_create();
+    EventContext *persistent = event_context_create_persistent();
+    event_context_set_i64(ctx, keys[0], 0);
+    check(event_context_index_prefixes(ctx, true) == EC_SUCCESS, "Index existing keys");
+
+    borrow_cleanups = 0;
+    for (int i = 1; i < key_count; i++) {
+        event_context_set_with_cleanup(ctx, keys[i], borrow_int(i), borrow_free);
+        event_context_set_i64(plain, keys[i], i);
+        event_context_set_i64(persistent, keys[i], i);
+    }
 
-            event_context_destroy(ctx);
+    PrefixMatches matches = { .count = 0 };
+    event_context_iterate_prefix(ctx, "order.", collect_prefix, &matches);
+    check(matches.count == 3 && strcmp(matches.keys[0], "order.items.1") == 0 &&
+          strcmp(matches.keys[1], "order.items.2") == 0 &&
+          strcmp(matches.keys[2], "order.total") == 0,
+          "Indexed iteration visits just the matches, in key order");
+    check(count_prefix(ctx, "order.items.") == 2 && count_prefix(ctx, "") == key_count &&
+          count_prefix(ctx, "shipping.") == 0 && count_prefix(ctx, "user.profile.name.x") == 0,
+          "Prefixes match whole subtrees, everything, or nothing");
+    check(count_prefix(plain, "order.") == 3 && count_prefix(persistent, "order.") == 3,
+          "Unindexed contexts give the same matches");
+
+    size_t removed = 0;
+    check(event_context_remove_prefix(ctx, "user.profile.", &removed) == EC_SUCCESS && removed == 2 &&
+          borrow_cleanups == 1 && event_context_has(ctx, "user.id", false) &&
+          !event_context_has(ctx, "user.profile.age", false) && event_context_count(ctx) == 5,
+          "Remove a prefix, releasing its values");
+    check(event_context_remove_prefix(plain, "order.", &removed) == EC_SUCCESS && removed == 3 &&
+          event_context_remove_prefix(persistent, "order.", &removed) == EC_SUCCESS && removed == 3 &&
+          event_context_count(plain) == 3 && event_context_count(persistent) == 3,
+          "Unindexed contexts remove by prefix too");
+
+    event_context_push_scope(ctx);
+    event_context_set_i64(ctx, "order.scratch", 1);
+    check(event_context_remove_prefix(ctx, "order.", &removed) == EC_ERROR_INVALID_PARAMETER &&
+          count_prefix(ctx, "order.") == 4,
+          "Nothing is removed when an open scope keeps a match");
+    check(event_context_remove_prefix(ctx, "order.scratch", &removed) == EC_SUCCESS && removed == 1,
+          "A scope's own keys can be removed by prefix");
+    event_context_pop_scope(ctx);
+
+    event_context_clear(ctx);
+    event_context_set_i64(ctx, "order.total", 1);
+    check(count_prefix(ctx, "order.") == 1 && count_prefix(ctx, "user.") == 0,
+          "Clear empties the index");
+
+    /* Random churn against an unindexed twin */
+    event_context_clear(ctx);
+    event_context_clear(plain);
+    uint32_t seed = 12345;
+    bool agree = true;
+    char key[32];
+    for (int step = 0; step < 4000 && agree; step++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(key, sizeof(key), "ns%u.k%u", (seed >> 8) % 4, (seed >> 12) % 64);
+        if ((seed >> 24) % 3 == 0) {
+            event_context_remove(ctx, key);
+            event_context_remove(plain, key);
+        } else {
+            event_context_set_i64(ctx, key, step);
+            event_context_set_i64(plain, key, step);
+        }
+        if (step % 97 == 0) {
+            snprintf(key, sizeof(key), "ns%u.k%u", (seed >> 4) % 4, (seed >> 16) % 8);
+            agree = count_prefix(ctx, key) == count_prefix(plain, key) &&
+                    count_prefix(ctx, "ns1.") == count_prefix(plain, "ns1.");
         }
-
-        print_stats("Context: 100 Has Operations (Constant-Time)", &stats);
     }
+    check(agree && event_context_count(ctx) == event_context_count(plain),
+          "Index matches a full scan through random churn");
+
+    check(event_context_index_prefixes(persistent, true) == EC_ERROR_INVALID_PARAMETER,
+          "Persistent contexts scan rather than index");
+    event_context_destroy(ctx);
+    event_context_destroy(plain);
+    event_context_destroy(persistent);
 }
 
 /* ==================== Stress Tests ==================== */
@@ -822,6 +2976,31 @@ int main(void) {
     perf_test_chain_with_events();
     perf_test_chain_with_middleware();
     perf_test_context_operations();
+    test_middleware_dispatch();
+    test_chain_freeze();
+    test_chain_template_reuse();
+    test_executor_jobs();
+    test_dag_execution();
+    test_batch_execution();
+    test_event_result_messages();
+    test_zero_allocation_success_path();
+    test_context_hash_index();
+    test_interned_keys();
+    test_inline_typed_values();
+    test_arena_context();
+    test_context_pool();
+    test_persistent_context();
+    test_concurrent_context();
+    test_shared_ref_counting();
+    test_borrow_epochs();
+    test_cleanup_queue();
+    test_unordered_remove();
+    test_value_transfer();
+    test_context_scopes();
+    test_context_serialization();
+    test_context_changelog();
+    test_sized_values();
+    test_context_prefixes();
 
     /* Stress Tests */
     printf("\n");
@@ -843,6 +3022,12 @@ int main(void) {
     printf("║                       Test Complete                           ║\n");
     printf("╚═══════════════════════════════════════════════════════════════╝\n");
     printf("\n");
+    if (test_failures > 0) {
+        printf("  ✗ %d correctness check(s) failed\n", test_failures);
+        printf("\n");
+        return 1;
+    }
+
     printf("  ✓ All stress and performance tests completed successfully\n");
     printf("  ✓ No memory leaks detected\n");
     printf("  ✓ System remained stable under load\n");